@@ -0,0 +1,282 @@
+/** @file atomic.h
+*
+* @brief BASEPRI critical sections and LDREX/STREX atomics for driver state shared with ISRs.
+*
+* Critical sections raise BASEPRI only up to the given preemption level: handlers above it keep running.
+* The read-modify-write helpers use the exclusive monitor, they never mask interrupts. An exception
+* entry clears the monitor, so an interrupted update fails its STREX and is retried.
+*
+*/
+
+#ifndef ATOMIC_H_
+#define ATOMIC_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "nvic.h"
+
+
+// === Macros ===
+//
+/*
+ * @ATOMIC_LEVEL
+ * BASEPRI value masking the preemption levels >= preempt, with the NVIC_PLAN_PREEMPT_BITS grouping
+ */
+#define ATOMIC_LEVEL(preempt)		((uint8_t)((preempt) << (8 - NVIC_PLAN_PREEMPT_BITS)))
+
+#define ATOMIC_BARRIER()			__asm volatile ("" ::: "memory")
+
+
+// === Inline API Functions ===
+//
+/*!
+ * @fn			- ATOMIC_MaskEnter
+ *
+ * @brief 		- Enters a critical section against the handlers of the given preemption level and below
+ *
+ * @param[in]	- preempt: lowest masked preemption level (@NVIC_PLAN_PREEMPT), must be >= 1
+ * @param[out]	- none
+ *
+ * @return 		- Previous BASEPRI, to be passed to ATOMIC_MaskExit
+ *
+ * @note		- BASEPRI_MAX only raises the mask, so nested sections never unmask a stricter outer one
+*/
+static inline uint32_t ATOMIC_MaskEnter (uint8_t preempt)
+{
+	uint32_t basepri;
+
+	__asm volatile ("MRS %0, basepri" : "=r" (basepri));
+	__asm volatile ("MSR basepri_max, %0" :: "r" ((uint32_t)ATOMIC_LEVEL(preempt)) : "memory");
+
+	return basepri;
+}
+
+/*!
+ * @fn			- ATOMIC_MaskExit
+ *
+ * @brief 		- Leaves the critical section
+ *
+ * @param[in]	- basepri: value returned by ATOMIC_MaskEnter
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static inline void ATOMIC_MaskExit (uint32_t basepri)
+{
+	__asm volatile ("MSR basepri, %0" :: "r" (basepri) : "memory");
+}
+
+/*!
+ * @fn			- ATOMIC_IrqDisable
+ *
+ * @brief 		- Masks every configurable interrupt (PRIMASK)
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Previous PRIMASK, to be passed to ATOMIC_IrqRestore
+ *
+ * @note		- Last resort, it blocks the critical level as well
+*/
+static inline uint32_t ATOMIC_IrqDisable (void)
+{
+	uint32_t primask;
+
+	__asm volatile ("MRS %0, primask\n\tCPSID i" : "=r" (primask) :: "memory");
+
+	return primask;
+}
+
+/*!
+ * @fn			- ATOMIC_IrqRestore
+ *
+ * @brief 		- Restores PRIMASK
+ *
+ * @param[in]	- primask: value returned by ATOMIC_IrqDisable
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static inline void ATOMIC_IrqRestore (uint32_t primask)
+{
+	__asm volatile ("MSR primask, %0" :: "r" (primask) : "memory");
+}
+
+/*!
+ * @fn			- ATOMIC_CAS32
+ *
+ * @brief 		- Compare-and-swap of a word
+ *
+ * @param[in]	- *p_Value: shared word
+ * @param[in]	- expected: value required for the swap
+ * @param[in]	- desired: new value
+ *
+ * @return 		- SET: swapped, RESET: *p_Value differed from expected
+ *
+ * @note		- none
+*/
+static inline uint8_t ATOMIC_CAS32 (volatile uint32_t *p_Value, uint32_t expected, uint32_t desired)
+{
+	uint32_t current, failed;
+
+	do
+	{
+		__asm volatile ("LDREX %0, [%1]" : "=r" (current) : "r" (p_Value) : "memory");
+		if (current != expected)
+		{
+			__asm volatile ("CLREX" ::: "memory");
+			return RESET;
+		}
+		__asm volatile ("STREX %0, %2, [%1]" : "=&r" (failed) : "r" (p_Value), "r" (desired) : "memory");
+	} while (failed);
+
+	return SET;
+}
+
+/*!
+ * @fn			- ATOMIC_CAS8
+ *
+ * @brief 		- Compare-and-swap of a byte (state fields)
+ *
+ * @param[in]	- *p_Value: shared byte
+ * @param[in]	- expected: value required for the swap
+ * @param[in]	- desired: new value
+ *
+ * @return 		- SET: swapped, RESET: *p_Value differed from expected
+ *
+ * @note		- none
+*/
+static inline uint8_t ATOMIC_CAS8 (volatile uint8_t *p_Value, uint8_t expected, uint8_t desired)
+{
+	uint32_t current, failed;
+
+	do
+	{
+		__asm volatile ("LDREXB %0, [%1]" : "=r" (current) : "r" (p_Value) : "memory");
+		if (current != expected)
+		{
+			__asm volatile ("CLREX" ::: "memory");
+			return RESET;
+		}
+		__asm volatile ("STREXB %0, %2, [%1]" : "=&r" (failed) : "r" (p_Value), "r" ((uint32_t)desired) : "memory");
+	} while (failed);
+
+	return SET;
+}
+
+/*!
+ * @fn			- ATOMIC_FetchAdd
+ *
+ * @brief 		- Adds to a word
+ *
+ * @param[in]	- *p_Value: shared word
+ * @param[in]	- value: addend (two's complement for subtraction)
+ *
+ * @return 		- Value before the addition
+ *
+ * @note		- none
+*/
+static inline uint32_t ATOMIC_FetchAdd (volatile uint32_t *p_Value, uint32_t value)
+{
+	uint32_t old, failed;
+
+	do
+	{
+		__asm volatile ("LDREX %0, [%1]" : "=r" (old) : "r" (p_Value) : "memory");
+		__asm volatile ("STREX %0, %2, [%1]" : "=&r" (failed) : "r" (p_Value), "r" (old + value) : "memory");
+	} while (failed);
+
+	return old;
+}
+
+/*!
+ * @fn			- ATOMIC_FetchOr
+ *
+ * @brief 		- Sets bits of a word
+ *
+ * @param[in]	- *p_Value: shared word
+ * @param[in]	- mask: bits to be set
+ *
+ * @return 		- Value before the update
+ *
+ * @note		- none
+*/
+static inline uint32_t ATOMIC_FetchOr (volatile uint32_t *p_Value, uint32_t mask)
+{
+	uint32_t old, failed;
+
+	do
+	{
+		__asm volatile ("LDREX %0, [%1]" : "=r" (old) : "r" (p_Value) : "memory");
+		__asm volatile ("STREX %0, %2, [%1]" : "=&r" (failed) : "r" (p_Value), "r" (old | mask) : "memory");
+	} while (failed);
+
+	return old;
+}
+
+/*!
+ * @fn			- ATOMIC_FetchAnd
+ *
+ * @brief 		- Clears bits of a word
+ *
+ * @param[in]	- *p_Value: shared word
+ * @param[in]	- mask: bits to be kept
+ *
+ * @return 		- Value before the update
+ *
+ * @note		- none
+*/
+static inline uint32_t ATOMIC_FetchAnd (volatile uint32_t *p_Value, uint32_t mask)
+{
+	uint32_t old, failed;
+
+	do
+	{
+		__asm volatile ("LDREX %0, [%1]" : "=r" (old) : "r" (p_Value) : "memory");
+		__asm volatile ("STREX %0, %2, [%1]" : "=&r" (failed) : "r" (p_Value), "r" (old & mask) : "memory");
+	} while (failed);
+
+	return old;
+}
+
+/*!
+ * @fn			- ATOMIC_FlagTestAndSet
+ *
+ * @brief 		- Lock-free flag: sets a bit of a flag word
+ *
+ * @param[in]	- *p_Flags: shared flag word
+ * @param[in]	- bit: flag number (0 - 31)
+ *
+ * @return 		- Previous state of the flag: RESET means the caller took it
+ *
+ * @note		- none
+*/
+static inline uint8_t ATOMIC_FlagTestAndSet (volatile uint32_t *p_Flags, uint8_t bit)
+{
+	return (ATOMIC_FetchOr(p_Flags, (1u << bit)) & (1u << bit)) ? SET : RESET;
+}
+
+/*!
+ * @fn			- ATOMIC_FlagClear
+ *
+ * @brief 		- Lock-free flag: clears a bit of a flag word
+ *
+ * @param[in]	- *p_Flags: shared flag word
+ * @param[in]	- bit: flag number (0 - 31)
+ *
+ * @return 		- Previous state of the flag
+ *
+ * @note		- none
+*/
+static inline uint8_t ATOMIC_FlagClear (volatile uint32_t *p_Flags, uint8_t bit)
+{
+	return (ATOMIC_FetchAnd(p_Flags, ~(1u << bit)) & (1u << bit)) ? SET : RESET;
+}
+
+#endif /* ATOMIC_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,166 @@
+/** @file clock.h
+*
+* @brief Clock tree configuration (HSI/HSE, main PLL, over-drive, flash accelerator) header file.
+*
+*/
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Type Definitions ===
+//
+typedef struct CLOCK_Profile
+{
+	const char *p_Name;
+	uint8_t source;					// @CLOCK_SOURCE
+	uint32_t hseHz;					// HSE frequency, ignored for HSI
+	uint8_t usePll;					// SET: SYSCLK from PLL P, RESET: SYSCLK straight from the source
+	uint8_t pllM;					// 2 - 63, the VCO input must be 1 - 2 MHz
+	uint16_t pllN;					// 50 - 432, the VCO output must be 100 - 432 MHz
+	uint8_t pllP;					// 2, 4, 6 or 8
+	uint8_t pllQ;					// 2 - 15
+	uint16_t ahbDiv;				// 1, 2, 4, 8, 16, 64, 128, 256 or 512
+	uint8_t apb1Div;				// 1, 2, 4, 8 or 16, PCLK1 up to CLOCK_PCLK1_MAX
+	uint8_t apb2Div;				// 1, 2, 4, 8 or 16, PCLK2 up to CLOCK_PCLK2_MAX
+	uint8_t flashAccel;				// ENABLE: ART prefetch, instruction and data caches
+} CLOCK_Profile_t;
+
+typedef struct CLOCK_Plan
+{
+	uint8_t source;					// @CLOCK_SOURCE
+	uint32_t hseHz;					// HSE frequency, 0 for HSI
+	uint8_t sysclkSource;			// @RCC_SYSCLK_SOURCE
+	uint32_t pllcfgr;				// PLLCFGR word, used with RCC_SYSCLK_PLLP only
+	uint32_t cfgr;					// CFGR HPRE, PPRE1 and PPRE2 fields
+	uint32_t acr;					// FLASH ACR LATENCY and accelerator bits
+	uint8_t vos;					// PWR CR VOS field
+	uint8_t overdrive;				// SET: over-drive on
+	uint32_t sysclkHz;
+	uint32_t hclkHz;
+	uint32_t pclk1Hz;
+	uint32_t pclk2Hz;
+} CLOCK_Plan_t;
+
+typedef struct CLOCK_Freq
+{
+	uint32_t sysclkHz;
+	uint32_t hclkHz;				// AHB: core, DMA, GPIO
+	uint32_t pclk1Hz;				// APB1: SPI2/3, USART2/3, UART4/5, I2C
+	uint32_t pclk2Hz;				// APB2: SPI1/4, USART1/6, SYSCFG
+	uint32_t timclk1Hz;				// TIM2-7, TIM12-14
+	uint32_t timclk2Hz;				// TIM1, TIM8-11
+} CLOCK_Freq_t;
+
+typedef void (*CLOCK_NotifyFunc_t) (void *p_Context, uint8_t event, const CLOCK_Freq_t *p_Freq);
+
+typedef struct CLOCK_Notifier
+{
+	CLOCK_NotifyFunc_t callback;
+	void *p_Context;
+	struct CLOCK_Notifier *p_Next;
+} CLOCK_Notifier_t;
+
+typedef struct CLOCK_SwitchStat
+{
+	uint32_t count;					// Completed CLOCK_Switch calls
+	uint32_t lastUs;				// Last switch, first PRE callback to the last POST callback
+	uint32_t maxUs;
+	uint32_t lastApplyUs;			// Clock tree reprogramming part of the last switch
+} CLOCK_SwitchStat_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @CLOCK_SOURCE
+ * Oscillator feeding SYSCLK or the PLL
+ */
+#define CLOCK_SOURCE_HSI			0		// 16 MHz internal RC
+#define CLOCK_SOURCE_HSE			1		// Crystal on OSC_IN/OSC_OUT (4 - 26 MHz)
+#define CLOCK_SOURCE_HSE_BYPASS		2		// External clock on OSC_IN (Nucleo: 8 MHz MCO of the ST-LINK)
+
+/*
+ * @CLOCK_STATUS
+ * Return values
+ */
+#define CLOCK_OK					0
+#define CLOCK_ERR_PARAM				1		// Divider or source out of range
+#define CLOCK_ERR_VCO				2		// VCO input or output out of range
+#define CLOCK_ERR_LIMIT				3		// SYSCLK, HCLK, PCLK1 or PCLK2 above its maximum
+#define CLOCK_ERR_SOURCE			4		// Oscillator not ready in time
+#define CLOCK_ERR_PLL				5		// PLL not locked in time
+#define CLOCK_ERR_REGULATOR			6		// Over-drive or voltage scaling not ready in time
+#define CLOCK_ERR_SWITCH			7		// SYSCLK switch or flash latency not taken
+
+/*
+ * @CLOCK_EVENT
+ * Notifications of a CLOCK_Switch, p_Freq is the clock tree before which the driver has to act
+ */
+#define CLOCK_EVENT_PRE_CHANGE		0		// Target frequencies: finish transfers, the clocks are about to move
+#define CLOCK_EVENT_POST_CHANGE		1		// Running frequencies: recompute prescalers (also after a failed switch)
+
+/*
+ * @CLOCK_LIMITS
+ * STM32F446 limits at VDD 2.7 - 3.6 V
+ */
+#define CLOCK_HSI_HZ				16000000U
+#define CLOCK_HSE_DEFAULT_HZ		8000000U	// Assumed until a profile names the HSE frequency
+#define CLOCK_SYSCLK_MAX			180000000U	// Scale 1 with over-drive
+#define CLOCK_SYSCLK_MAX_NO_OD		168000000U	// Scale 1 without over-drive
+#define CLOCK_SCALE2_MAX			144000000U
+#define CLOCK_SCALE3_MAX			120000000U
+#define CLOCK_PCLK1_MAX				45000000U
+#define CLOCK_PCLK2_MAX				90000000U
+#define CLOCK_FLASH_WS_HZ			30000000U	// HCLK per flash wait state
+#define CLOCK_VCO_IN_MIN			1000000U
+#define CLOCK_VCO_IN_MAX			2000000U
+#define CLOCK_VCO_OUT_MIN			100000000U
+#define CLOCK_VCO_OUT_MAX			432000000U
+
+/*
+ * @CLOCK_TIMEOUTS
+ * Ready flag waits, microseconds
+ */
+#define CLOCK_TIMEOUT_HSE_US		100000U
+#define CLOCK_TIMEOUT_READY_US		10000U
+
+
+// === Built-in Profiles ===
+//
+extern const CLOCK_Profile_t CLOCK_Profile_HSI16;		// Reset clock: HSI, no PLL
+extern const CLOCK_Profile_t CLOCK_Profile_HSI180;		// HSI / 8 * 180 / 2
+extern const CLOCK_Profile_t CLOCK_Profile_HSE180;		// 8 MHz HSE bypass / 4 * 180 / 2
+extern const CLOCK_Profile_t CLOCK_Profile_HSI84;		// HSI / 8 * 168 / 4
+
+#define CLOCK_PROFILE_PERFORMANCE	(&CLOCK_Profile_HSI180)
+#define CLOCK_PROFILE_BALANCED		(&CLOCK_Profile_HSI84)
+#define CLOCK_PROFILE_LOW_POWER		(&CLOCK_Profile_HSI16)
+
+
+// === API Functions ===
+//
+uint8_t CLOCK_Plan (const CLOCK_Profile_t *p_Profile, CLOCK_Plan_t *p_Plan);
+uint8_t CLOCK_Apply (const CLOCK_Plan_t *p_Plan);
+uint8_t CLOCK_Configure (const CLOCK_Profile_t *p_Profile);
+void CLOCK_Refresh (void);
+void CLOCK_GetFrequencies (CLOCK_Freq_t *p_Freq);
+uint32_t CLOCK_GetSysclk (void);
+uint32_t CLOCK_GetHclk (void);
+uint32_t CLOCK_GetPclk1 (void);
+uint32_t CLOCK_GetPclk2 (void);
+uint32_t CLOCK_GetTimerClk1 (void);
+uint32_t CLOCK_GetTimerClk2 (void);
+uint32_t CLOCK_GetBusClock (volatile uint32_t *p_ClkEnReg);
+void CLOCK_NotifierRegister (CLOCK_Notifier_t *p_Notifier, CLOCK_NotifyFunc_t callback, void *p_Context);
+void CLOCK_NotifierUnregister (CLOCK_Notifier_t *p_Notifier);
+uint8_t CLOCK_Switch (const CLOCK_Profile_t *p_Profile);
+const CLOCK_Profile_t *CLOCK_GetProfile (void);
+void CLOCK_GetSwitchStat (CLOCK_SwitchStat_t *p_Stat);
+
+#endif /* CLOCK_H_ */
+
+/*** EOF ***/
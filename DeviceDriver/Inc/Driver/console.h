@@ -0,0 +1,58 @@
+/** @file console.h
+*
+* @brief Buffered stdout over USART TX DMA header file.
+*
+*/
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "usart.h"
+
+
+// === Type Definitions ===
+//
+typedef struct CONSOLE_Stat
+{
+	uint32_t written;				// Bytes queued
+	uint32_t dropped;				// Bytes lost to a full buffer
+	uint16_t highWater;				// Highest buffer fill, bytes
+	uint32_t maxWriteCycles;		// Longest CONSOLE_Write, core cycles
+} CONSOLE_Stat_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @CONSOLE_POLICY
+ * What a write does when the buffer is full
+ */
+#define CONSOLE_POLICY_DROP			0		// Queue what fits, count the rest as dropped: never waits
+#define CONSOLE_POLICY_BLOCK		1		// Sleep until the DMA frees room (thread mode only, else drop)
+
+/*
+ * @CONSOLE_LIMITS
+ * Buffer geometry, override on the command line
+ */
+#ifndef CONSOLE_BUFFER_SIZE
+#define CONSOLE_BUFFER_SIZE			1024	// Power of two
+#endif
+#define CONSOLE_FLUSH_TIMEOUT_US	2000000U	// CONSOLE_DeInit: a full buffer at 9600 baud
+
+
+// === API Functions ===
+//
+void CONSOLE_Init (USART_Handle_t *p_UsartHandle, uint8_t policy);
+void CONSOLE_DeInit (void);
+uint8_t CONSOLE_IsAttached (void);
+void CONSOLE_SetPolicy (uint8_t policy);
+uint32_t CONSOLE_Write (const uint8_t *p_Data, uint32_t len);
+uint8_t CONSOLE_Flush (uint32_t timeoutUs);
+void CONSOLE_GetStat (CONSOLE_Stat_t *p_Stat);
+void CONSOLE_ResetStat (void);
+
+#endif /* CONSOLE_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,61 @@
+/** @file debounce.h
+*
+* @brief Timestamp-based debouncing engine for EXTI inputs header file.
+*
+*/
+
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "gpio.h"
+#include "exti.h"
+
+
+// === Type Definitions ===
+//
+typedef uint32_t (*DEBOUNCE_GetTick_t) (void);
+typedef void (*DEBOUNCE_Callback_t) (uint8_t id, uint8_t event, void *p_Context);
+
+typedef struct DEBOUNCE_Config
+{
+	GPIO_RegDef_t *p_GPIOx;
+	uint8_t pinNumber;				// According to @GPIO_PIN_NUM
+	uint8_t activeLevel;			// Pin level of the pressed state: SET or RESET
+	uint16_t windowMs;				// Edges within this window after the first one are ignored
+	uint16_t longPressMs;			// 0: no long-press event
+	DEBOUNCE_Callback_t callback;
+	void *p_Context;
+} DEBOUNCE_Config_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @DEBOUNCE_EVENTS
+ * Clean events delivered to the application
+ */
+#define DEBOUNCE_EVENT_PRESS		0
+#define DEBOUNCE_EVENT_RELEASE		1
+#define DEBOUNCE_EVENT_LONG_PRESS	2
+
+/*
+ * @DEBOUNCE_LIMITS
+ * Engine limits and error codes
+ */
+#define DEBOUNCE_MAX_INPUTS			8
+#define DEBOUNCE_ID_INVALID			0xff
+
+
+// === API Functions ===
+//
+void DEBOUNCE_Init (DEBOUNCE_GetTick_t getTick);
+uint8_t DEBOUNCE_Add (const DEBOUNCE_Config_t *p_Config);
+void DEBOUNCE_Remove (uint8_t id);
+void DEBOUNCE_Process (void);
+uint8_t DEBOUNCE_IsPressed (uint8_t id);
+
+#endif /* DEBOUNCE_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,48 @@
+/** @file defer.h
+*
+* @brief Lock-free deferred-work queue header file.
+*
+*/
+
+#ifndef DEFER_H_
+#define DEFER_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Type Definitions ===
+//
+typedef void (*DEFER_Func_t) (void *p_Context, uint32_t arg);
+
+
+// === Constant Definitions ===
+//
+/*
+ * @DEFER_MODE
+ * Who drains the queue
+ */
+#define DEFER_MODE_OFF				0		// Not initialized: DEFER_Post refuses every item
+#define DEFER_MODE_PENDSV			1		// PendSV at the lowest priority, pended by every post
+#define DEFER_MODE_POLL				2		// The main loop calls DEFER_Process
+
+/*
+ * @DEFER_LIMITS
+ * Queue geometry
+ */
+#define DEFER_QUEUE_SIZE			32		// Power of two
+
+
+// === API Functions ===
+//
+void DEFER_Init (uint8_t mode);
+uint8_t DEFER_Post (DEFER_Func_t func, void *p_Context, uint32_t arg);
+uint16_t DEFER_Process (void);
+uint8_t DEFER_IsEmpty (void);
+uint8_t DEFER_GetMode (void);
+uint32_t DEFER_GetDropped (void);
+uint16_t DEFER_GetHighWater (void);
+
+#endif /* DEFER_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,194 @@
+/** @file dma.h
+*
+* @brief DMA stream driver (stream arbitration, FIFO / burst, double buffer, callbacks) header file.
+*
+*/
+
+#ifndef DMA_H_
+#define DMA_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Type Definitions ===
+//
+typedef void (*DMA_CallbackFunc_t) (void *p_Context, uint8_t event);
+
+typedef struct DMA_Route
+{
+	DMA_RegDef_t *p_DMAx;			// NULL: unused entry
+	uint8_t stream;					// @DMA_STREAM
+	uint8_t channel;				// @DMA_CHANNEL
+} DMA_Route_t;
+
+typedef struct DMA_Config
+{
+	uint8_t channel;				// @DMA_CHANNEL
+	uint8_t direction;				// @DMA_DIR
+	uint8_t periphInc;				// ENABLE or DISABLE
+	uint8_t memInc;					// ENABLE or DISABLE
+	uint8_t periphSize;				// @DMA_SIZE
+	uint8_t memSize;				// @DMA_SIZE
+	uint8_t circular;				// ENABLE or DISABLE
+	uint8_t priority;				// @DMA_PRIORITY
+	uint8_t fifoThreshold;			// @DMA_FIFO, DMA_FIFO_DIRECT: no FIFO (not allowed memory-to-memory)
+	uint8_t memBurst;				// @DMA_BURST, FIFO mode only
+	uint8_t periphBurst;			// @DMA_BURST, FIFO mode only
+} DMA_Config_t;
+
+typedef struct DMA_Handle
+{
+	DMA_RegDef_t *p_DMAx;
+	uint8_t stream;					// @DMA_STREAM
+	DMA_Config_t DmaConfig;
+	DMA_CallbackFunc_t callback;	// Called by DMA_IRQHandling with @DMA_EVENT, NULL: flags are only cleared
+	void *p_Context;
+} DMA_Handle_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @DMA_STREAM
+ * DMA stream numbers
+ */
+#define DMA_STREAM_0			0
+#define DMA_STREAM_1			1
+#define DMA_STREAM_2			2
+#define DMA_STREAM_3			3
+#define DMA_STREAM_4			4
+#define DMA_STREAM_5			5
+#define DMA_STREAM_6			6
+#define DMA_STREAM_7			7
+
+/*
+ * @DMA_CHANNEL
+ * DMA request channel selection (see RM0390 DMA request mapping tables)
+ */
+#define DMA_CHANNEL_0			0
+#define DMA_CHANNEL_1			1
+#define DMA_CHANNEL_2			2
+#define DMA_CHANNEL_3			3
+#define DMA_CHANNEL_4			4
+#define DMA_CHANNEL_5			5
+#define DMA_CHANNEL_6			6
+#define DMA_CHANNEL_7			7
+
+/*
+ * @DMA_DIR
+ * DMA data transfer direction
+ */
+#define DMA_DIR_P2M				0		// Peripheral-to-memory
+#define DMA_DIR_M2P				1		// Memory-to-peripheral
+#define DMA_DIR_M2M				2		// Memory-to-memory (DMA2 only)
+
+/*
+ * @DMA_SIZE
+ * DMA data item size
+ */
+#define DMA_SIZE_BYTE			0
+#define DMA_SIZE_HALFWORD		1
+#define DMA_SIZE_WORD			2
+
+/*
+ * @DMA_PRIORITY
+ * DMA stream software priority
+ */
+#define DMA_PRIORITY_LOW		0
+#define DMA_PRIORITY_MEDIUM		1
+#define DMA_PRIORITY_HIGH		2
+#define DMA_PRIORITY_VHIGH		3
+
+/*
+ * @DMA_IT
+ * Stream interrupt enables, at their SxCR bit positions
+ */
+#define DMA_IT_DME				(1 << DMA_SxCRREG_DMEIE)	// Direct mode error
+#define DMA_IT_TE				(1 << DMA_SxCRREG_TEIE)		// Transfer error
+#define DMA_IT_HT				(1 << DMA_SxCRREG_HTIE)		// Half transfer
+#define DMA_IT_TC				(1 << DMA_SxCRREG_TCIE)		// Transfer complete
+
+/*
+ * @DMA_FIFO
+ * FIFO threshold, FTH + 1: DMA_FIFO_DIRECT keeps the stream in direct mode
+ */
+#define DMA_FIFO_DIRECT			0
+#define DMA_FIFO_1_4			1
+#define DMA_FIFO_1_2			2
+#define DMA_FIFO_3_4			3
+#define DMA_FIFO_FULL			4
+
+/*
+ * @DMA_BURST
+ * Beats of a burst transfer, at their MBURST / PBURST encoding
+ */
+#define DMA_BURST_SINGLE		0
+#define DMA_BURST_INC4			1
+#define DMA_BURST_INC8			2
+#define DMA_BURST_INC16			3
+
+/*
+ * @DMA_EVENT
+ * Events passed to DMA_Handle_t::callback
+ */
+#define DMA_EVENT_HALF			0		// Half transfer (in double buffer mode: half of the current target)
+#define DMA_EVENT_FULL			1		// Transfer complete (in circular / double buffer mode: end of a round)
+#define DMA_EVENT_ERROR			2		// Transfer error (the stream is disabled by hardware) or enabled direct mode error
+
+/*
+ * @DMA_STATUS
+ * Return values
+ */
+#define DMA_OK					0
+#define DMA_ERR_PARAM			1		// Unknown controller or stream, or no route given
+#define DMA_ERR_BUSY			2		// Stream owned by another handle, or every route taken
+#define DMA_ERR_CONFIG			3		// FIFO threshold, burst and data sizes do not fit together
+
+
+// === Macros ===
+//
+#define DMA_STREAM(p_DMA, stream)	(&(p_DMA)->S[(stream)])
+#define DMA_ROUTE(p_DMA, s, ch)		{ (p_DMA), DMA_STREAM_##s, DMA_CHANNEL_##ch }	// DMA_Route_t initializer
+#define DMA_ROUTE_NONE				{ NULL, 0, 0 }
+
+
+// === API Functions ===
+//
+// DMA Init and Control
+//
+void DMA_PeriClockControl (DMA_RegDef_t *p_DMA, uint8_t enable);
+uint8_t DMA_Init (DMA_Handle_t *p_DmaHandle);
+void DMA_Start (DMA_Handle_t *p_DmaHandle, uint32_t periphAddr, uint32_t memAddr, uint16_t len);
+void DMA_Stop (DMA_Handle_t *p_DmaHandle);
+uint8_t DMA_IsBusy (DMA_Handle_t *p_DmaHandle);
+uint16_t DMA_GetCount (DMA_Handle_t *p_DmaHandle);
+void DMA_InterruptControl (DMA_Handle_t *p_DmaHandle, uint8_t interrupts, uint8_t enable);
+
+// DMA Stream Arbitration
+//
+uint8_t DMA_Request (DMA_Handle_t *p_DmaHandle);
+uint8_t DMA_Allocate (DMA_Handle_t *p_DmaHandle, const DMA_Route_t *p_Routes, uint8_t count);
+void DMA_Release (DMA_Handle_t *p_DmaHandle);
+DMA_Handle_t *DMA_GetOwner (DMA_RegDef_t *p_DMA, uint8_t stream);
+
+// DMA Double Buffer
+//
+void DMA_StartDoubleBuffer (DMA_Handle_t *p_DmaHandle, uint32_t periphAddr, uint32_t mem0Addr, uint32_t mem1Addr, uint16_t len);
+void DMA_SetNextBuffer (DMA_Handle_t *p_DmaHandle, uint32_t memAddr);
+uint8_t DMA_GetCurrentTarget (DMA_Handle_t *p_DmaHandle);
+
+// DMA Flags
+//
+uint8_t DMA_GetFlags (DMA_RegDef_t *p_DMA, uint8_t stream);
+void DMA_ClearFlags (DMA_RegDef_t *p_DMA, uint8_t stream, uint8_t flags);
+
+// DMA IRQ Handling
+//
+uint8_t DMA_IRQNumber (DMA_RegDef_t *p_DMA, uint8_t stream);
+void DMA_IRQHandling (DMA_Handle_t *p_DmaHandle);
+void DMA_IRQBind (DMA_Handle_t *p_DmaHandle, uint8_t enable);
+
+#endif /* DMA_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,44 @@
+/** @file encoder.h
+*
+* @brief Table-driven EXTI quadrature encoder decoder header file.
+*
+*/
+
+#ifndef ENCODER_H_
+#define ENCODER_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "gpio.h"
+#include "exti.h"
+
+
+// === Type Definitions ===
+//
+typedef struct ENCODER_Handle
+{
+	GPIO_RegDef_t *p_GPIOx;			// Both channels must be on the same port
+	uint8_t pinA;					// Channel A, according to @GPIO_PIN_NUM
+	uint8_t pinB;					// Channel B, according to @GPIO_PIN_NUM, different EXTI line than A
+	uint8_t pinPuPdControl;			// According to @GPIO_PIN_PUPD
+	uint8_t state;					// Last decoded (A << 1) | B
+	volatile int32_t position;		// Quadrature (x4) counts
+	volatile uint32_t illegal;		// Transitions where both channels changed (lost edge)
+	volatile uint32_t edgeStamp;	// DWT CYCCNT of the last counted edge
+	volatile uint32_t edgePeriod;	// Cycles between the last two counted edges
+	volatile int8_t direction;		// +1 / -1 of the last counted edge
+} ENCODER_Handle_t;
+
+
+// === API Functions ===
+//
+void ENCODER_Init (ENCODER_Handle_t *p_EncHandle);
+void ENCODER_DeInit (ENCODER_Handle_t *p_EncHandle);
+void ENCODER_Reset (ENCODER_Handle_t *p_EncHandle);
+int32_t ENCODER_GetPosition (ENCODER_Handle_t *p_EncHandle);
+int32_t ENCODER_GetVelocity (ENCODER_Handle_t *p_EncHandle, uint32_t cpuHz);
+uint32_t ENCODER_GetIllegalCount (ENCODER_Handle_t *p_EncHandle);
+
+#endif /* ENCODER_H_ */
+
+/*** EOF ***/
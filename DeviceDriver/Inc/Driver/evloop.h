@@ -0,0 +1,64 @@
+/** @file evloop.h
+*
+* @brief Run-to-completion cooperative event loop header file.
+*
+*/
+
+#ifndef EVLOOP_H_
+#define EVLOOP_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "defer.h"
+
+
+// === Type Definitions ===
+//
+typedef void (*EVLOOP_TimerFunc_t) (void *p_Context);
+
+typedef struct EVLOOP_Timer
+{
+	EVLOOP_TimerFunc_t handler;
+	void *p_Context;
+	uint32_t deadline;				// Timebase tick of the next expiry
+	uint32_t period;				// 0: one-shot
+	uint8_t active;					// SET while linked into the timer list
+	struct EVLOOP_Timer *p_Next;
+} EVLOOP_Timer_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @EVLOOP_TIMEBASE
+ * Free-running 32-bit timer of the loop, no periodic tick
+ */
+#define EVLOOP_TIM					TIM2
+#define EVLOOP_TIM_IRQ				IRQ_NO_TIM2
+#define EVLOOP_TICK_HZ				1000000U	// 1 us resolution, wraps after ~71 minutes
+#define EVLOOP_MAX_DELAY			0x7FFFFFFFU	// Longest delay the wrap-safe compare can handle
+
+
+// === Macros ===
+//
+#define EVLOOP_US(us)				((uint32_t)(us) * (EVLOOP_TICK_HZ / 1000000U))
+#define EVLOOP_MS(ms)				((uint32_t)(ms) * (EVLOOP_TICK_HZ / 1000U))
+
+
+// === API Functions ===
+//
+void EVLOOP_Init (void);
+void EVLOOP_DeInit (void);
+void EVLOOP_Run (void);
+void EVLOOP_Stop (void);
+uint8_t EVLOOP_Post (DEFER_Func_t func, void *p_Context, uint32_t arg);
+void EVLOOP_TimerInit (EVLOOP_Timer_t *p_Timer, EVLOOP_TimerFunc_t handler, void *p_Context);
+void EVLOOP_TimerStart (EVLOOP_Timer_t *p_Timer, uint32_t delay, uint32_t period);
+void EVLOOP_TimerStop (EVLOOP_Timer_t *p_Timer);
+uint32_t EVLOOP_Now (void);
+uint16_t EVLOOP_GetLoad (void);
+void EVLOOP_ResetLoad (void);
+
+#endif /* EVLOOP_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,72 @@
+/** @file exti.h
+*
+* @brief EXTI dispatch manager header file.
+*
+*/
+
+#ifndef EXTI_H_
+#define EXTI_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Type Definitions ===
+//
+typedef void (*EXTI_Callback_t) (uint8_t line, void *p_Context);
+
+
+// === Constant Definitions ===
+//
+/*
+ * @EXTI_LINES
+ * EXTI line count: 0-15 GPIO lines, 16-22 PVD, RTC, USB, Ethernet wakeup lines
+ */
+#define EXTI_NUM_LINES			23
+#define EXTI_NUM_GPIO_LINES		16
+
+/*
+ * @EXTI_VECTOR_MASK
+ * Lines served by the EXTI interrupt vectors
+ */
+#define EXTI_MASK_EXTI0			(1u << 0)
+#define EXTI_MASK_EXTI1			(1u << 1)
+#define EXTI_MASK_EXTI2			(1u << 2)
+#define EXTI_MASK_EXTI3			(1u << 3)
+#define EXTI_MASK_EXTI4			(1u << 4)
+#define EXTI_MASK_EXTI9_5		(0x1fu << 5)
+#define EXTI_MASK_EXTI15_10		(0x3fu << 10)
+#define EXTI_MASK_PVD			(1u << 16)
+#define EXTI_MASK_RTC_ALARM		(1u << 17)
+#define EXTI_MASK_OTG_FS_WKUP	(1u << 18)
+#define EXTI_MASK_OTG_HS_WKUP	(1u << 20)
+#define EXTI_MASK_TAMP_STAMP	(1u << 21)
+#define EXTI_MASK_RTC_WKUP		(1u << 22)
+
+
+// === Macros ===
+//
+#define EXTI_LINE_BIT(line)		(1u << (line))
+
+
+// === API Functions ===
+//
+// EXTI Callback Registration
+//
+void EXTI_RegisterCallback (uint8_t line, EXTI_Callback_t callback, void *p_Context);
+void EXTI_UnregisterCallback (uint8_t line);
+uint8_t EXTI_IRQNumber (uint8_t line);
+
+// EXTI Line Control
+//
+void EXTI_LineControl (uint8_t line, uint8_t enable);
+void EXTI_SoftwareTrigger (uint32_t lineMask);
+
+// EXTI IRQ Handling
+//
+void EXTI_IRQHandling (uint32_t lineMask);
+
+#endif /* EXTI_H_ */
+
+/*** EOF ***/
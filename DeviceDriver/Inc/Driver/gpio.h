@@ -30,6 +30,17 @@ typedef struct GPIO_Handle
 
 } GPIO_Handle_t;
 
+typedef struct GPIO_Snapshot
+{
+	GPIO_RegDef_t *p_GPIOx;			// Port to be saved, filled in by the caller
+	uint32_t MODER;
+	uint32_t OTYPER;
+	uint32_t OSPEEDR;
+	uint32_t PUPDR;
+	uint32_t ODR;
+	uint32_t AFR[2];
+} GPIO_Snapshot_t;
+
 // === Constant Definitions ===
 //
 /*
@@ -130,6 +141,12 @@ void GPIO_WritePin (GPIO_RegDef_t *p_GPIO, uint8_t pinNumber, uint8_t value);
 void GPIO_WritePort (GPIO_RegDef_t *p_GPIO, uint16_t value);
 void GPIO_TogglePin (GPIO_RegDef_t *p_GPIO, uint8_t pinNumber);
 
+// GPIO Configuration Snapshot (low-power transitions)
+//
+void GPIO_SnapshotSave (GPIO_Snapshot_t *p_Snapshot, uint8_t count);
+void GPIO_SnapshotRestore (const GPIO_Snapshot_t *p_Snapshot, uint8_t count);
+void GPIO_SetPortAnalog (GPIO_RegDef_t *p_GPIO, uint16_t keepMask);
+
 // GPIO IRQ Handling
 //
 void GPIO_IRQHandling (uint8_t pinNumber);
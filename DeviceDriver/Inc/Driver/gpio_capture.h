@@ -0,0 +1,72 @@
+/** @file gpio_capture.h
+*
+* @brief Run-length-compressed GPIO port capture (on-target logic analyzer) header file.
+*
+*/
+
+#ifndef GPIO_CAPTURE_H_
+#define GPIO_CAPTURE_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "gpio.h"
+
+
+// === Type Definitions ===
+//
+typedef struct GPIO_CaptureRecord
+{
+	uint16_t value;					// Port value after the transition (masked)
+	uint16_t delta;					// CPU cycles since the previous record, saturated at GPIO_CAPTURE_DELTA_MAX
+} GPIO_CaptureRecord_t;
+
+typedef struct GPIO_Capture
+{
+	GPIO_RegDef_t *p_GPIOx;
+	uint16_t pinMask;				// Lines to watch, the others are ignored
+	uint8_t mode;					// @GPIO_CAPTURE_MODE
+	GPIO_CaptureRecord_t *p_Ring;	// Record ring buffer
+	uint16_t size;					// Ring size in records, must be a power of 2
+	uint16_t head;					// Next record to be written
+	uint16_t count;					// Number of valid records in the ring
+	uint8_t overflow;				// SET if records were lost (STOP mode) or overwritten (RING mode)
+	uint32_t samples;				// Number of port reads during the last run
+	uint32_t cycles;				// Length of the last run in CPU cycles
+} GPIO_Capture_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @GPIO_CAPTURE_MODE
+ * Behavior when the ring is full
+ */
+#define GPIO_CAPTURE_MODE_STOP		0		// Stop the capture, keep the first records
+#define GPIO_CAPTURE_MODE_RING		1		// Overwrite the oldest records, keep the last ones
+
+/*
+ * @GPIO_CAPTURE_STATUS
+ * Return values of GPIO_Capture_Init
+ */
+#define GPIO_CAPTURE_OK				0
+#define GPIO_CAPTURE_ERR_RING		1		// No ring buffer, or its size is not a power of 2
+
+/*
+ * @GPIO_CAPTURE_RECORD
+ * Record limits and the ITM dump format
+ */
+#define GPIO_CAPTURE_DELTA_MAX		0xffff		// Longer gaps are split into several records with the same value
+#define GPIO_CAPTURE_ITM_PORT		1			// Default ITM stimulus port of the dump
+#define GPIO_CAPTURE_ITM_SYNC		0xCAB7u		// Upper half-word of the dump header word, lower half-word: record count
+
+
+// === API Functions ===
+//
+uint8_t GPIO_Capture_Init (GPIO_Capture_t *p_Capture);
+uint16_t GPIO_Capture_Run (GPIO_Capture_t *p_Capture, uint32_t durationCycles);
+uint8_t GPIO_Capture_GetRecord (GPIO_Capture_t *p_Capture, uint16_t index, GPIO_CaptureRecord_t *p_Record);
+void GPIO_Capture_DumpITM (GPIO_Capture_t *p_Capture, uint8_t itmPort);
+
+#endif /* GPIO_CAPTURE_H_ */
+
+/*** EOF ***/
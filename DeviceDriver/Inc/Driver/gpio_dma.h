@@ -0,0 +1,63 @@
+/** @file gpio_dma.h
+*
+* @brief Timer-paced DMA pattern generator and sampler on GPIO ports header file.
+*
+*/
+
+#ifndef GPIO_DMA_H_
+#define GPIO_DMA_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "gpio.h"
+#include "dma.h"
+
+
+// === Constant Definitions ===
+//
+/*
+ * @GPIO_DMA_RESOURCES
+ * Fixed timer / DMA stream pairs, only DMA2 can reach the AHB1 GPIO ports. The streams are claimed
+ * from DMA_Init at start until the matching stop.
+ * 	Pattern generator: TIM1_UP -> DMA2 Stream 5 Channel 6 -> GPIOx->BSRR
+ * 	Sampler:		   TIM8_UP -> DMA2 Stream 1 Channel 7 <- GPIOx->IDR
+ */
+#define GPIO_DMA_PATTERN_TIM		TIM1
+#define GPIO_DMA_PATTERN_STREAM		DMA_STREAM_5
+#define GPIO_DMA_PATTERN_CHANNEL	DMA_CHANNEL_6
+#define GPIO_DMA_SAMPLE_TIM			TIM8
+#define GPIO_DMA_SAMPLE_STREAM		DMA_STREAM_1
+#define GPIO_DMA_SAMPLE_CHANNEL		DMA_CHANNEL_7
+
+/*
+ * @GPIO_DMA_PERIOD
+ * Shortest pacing period in timer input clock cycles: the update event needs ARR >= 1.
+ * Longer periods are split between PSC and ARR, so any uint32_t period from here up is reachable.
+ */
+#define GPIO_DMA_PERIOD_MIN			2
+
+
+// === Macros ===
+//
+#define GPIO_DMA_BSRR(value, mask)	((((uint32_t)(~(value) & (mask))) << 16) | ((value) & (mask)))		// One BSRR word of the pattern
+
+
+// === API Functions ===
+//
+// Pattern Generator (memory -> BSRR)
+//
+void GPIO_DMA_BuildPattern (uint32_t *p_Bsrr, const uint16_t *p_Values, uint16_t len, uint16_t pinMask);
+uint8_t GPIO_DMA_PatternStart (GPIO_RegDef_t *p_GPIO, const uint32_t *p_Bsrr, uint16_t len, uint32_t period, uint8_t circular);
+void GPIO_DMA_PatternStop (void);
+uint8_t GPIO_DMA_PatternIsBusy (void);
+
+// Sampler (IDR -> memory)
+//
+uint8_t GPIO_DMA_SampleStart (GPIO_RegDef_t *p_GPIO, uint16_t *p_Samples, uint16_t len, uint32_t period, uint8_t circular);
+void GPIO_DMA_SampleStop (void);
+uint8_t GPIO_DMA_SampleIsBusy (void);
+uint16_t GPIO_DMA_SampleCount (void);
+
+#endif /* GPIO_DMA_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,181 @@
+/** @file i2c.h
+*
+* @brief I2C master driver (interrupt state machine, repeated start, DMA for long transfers) header file.
+*
+*/
+
+#ifndef I2C_H_
+#define I2C_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "clock.h"
+#include "dma.h"
+
+
+// === Type Definitions ===
+//
+typedef struct I2C_Segment
+{
+	uint8_t devAddr;				// 7 bit device address
+	uint8_t result;					// @I2C_STATUS, written by the driver when the segment ends
+	uint16_t txLen;					// Bytes to write, 0: read only
+	uint16_t rxLen;					// Bytes to read, 0: write only
+	const uint8_t *p_TxBuffer;
+	uint8_t *p_RxBuffer;
+} I2C_Segment_t;
+
+typedef void (*I2C_BatchDoneFunc_t) (void *p_Context, I2C_Segment_t *p_Segments, uint8_t failed);
+
+typedef struct I2C_Config
+{
+	uint32_t sclSpeed;				// SCL frequency, Hz, up to I2C_SCL_SPEED_FM
+	uint8_t fmDuty;					// @I2C_FM_DUTY, fast mode only
+	uint8_t dmaThreshold;			// Phases of at least this many bytes use DMA, 0: interrupts only
+} I2C_Config_t;
+
+typedef struct I2C_Handle
+{
+	I2C_RegDef_t *p_I2Cx;
+	I2C_Config_t I2cConfig;
+	DMA_Handle_t RxDma;				// Allocated by I2C_Init from the request mapping
+	DMA_Handle_t TxDma;
+	uint8_t devAddr;				// 7 bit address of the running transaction
+	const uint8_t *p_TxBuffer;		// Write phase, ISR only
+	uint8_t *p_RxBuffer;			// Read phase, ISR only
+	uint16_t TxLen;					// Bytes left to write
+	uint16_t RxLen;					// Bytes left to read
+	uint8_t phase;					// @I2C_PHASE
+	uint8_t dmaPhase;				// SET while a stream moves the bytes of the current phase
+	volatile uint8_t State;			// @I2C_API_STATE, claimed by CAS in thread mode, released by the ISR
+	volatile uint8_t Hold;			// SET while a clock switch keeps the interface parked
+	volatile uint8_t Result;		// @I2C_STATUS of the last transaction
+	volatile uint16_t ErrorFlags;	// @I2C_ERRORS seen since I2C_Init, cleared by the application
+	uint8_t fastEvents;				// I2C_EVENT_MASK(@I2C_API_EVENTS) raised in ISR context, the others are deferred
+	volatile uint32_t IrqCount;		// Event, error and RX stream interrupts, for the benchmarks
+	I2C_Segment_t *p_Batch;			// Running segment list, NULL for a single transaction
+	uint8_t BatchCount;				// Segments in the list
+	uint8_t BatchIndex;				// Running segment, ISR only
+	uint8_t BatchFailed;			// Segments ended with an error so far
+	I2C_BatchDoneFunc_t batchDone;	// Called in the ISR after the last segment, NULL: I2C_EVENT_BATCH_CMPLT
+	void *p_BatchContext;
+	CLOCK_Notifier_t clockNotifier;
+} I2C_Handle_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @I2C_SCL_SPEED
+ * Mode limits of the I2C1..3 interfaces: fast mode plus (1 MHz) is served by FMPI2C1 only
+ */
+#define I2C_SCL_SPEED_SM		100000U		// Standard mode
+#define I2C_SCL_SPEED_FM		400000U		// Fast mode
+
+/*
+ * @I2C_FM_DUTY
+ * Fast mode SCL low / high ratio
+ */
+#define I2C_FM_DUTY_2			0			// Tlow / Thigh = 2
+#define I2C_FM_DUTY_16_9		1			// Tlow / Thigh = 16 / 9, reaches 400 kHz from a PCLK1 multiple of 10 MHz
+
+/*
+ * @I2C_PHASE
+ * Position of the state machine within a transaction
+ */
+#define I2C_PHASE_ADDR_W		0			// START sent, write address pending
+#define I2C_PHASE_ADDR_R		1			// (Repeated) START sent, read address pending
+#define I2C_PHASE_WRITE			2
+#define I2C_PHASE_READ			3
+
+/*
+ * @I2C_API_STATE
+ * The possible I2C application states
+ */
+#define I2C_ST_READY			0
+#define I2C_ST_BUSY				1
+
+/*
+ * @I2C_STATUS
+ * Return values and transaction results
+ */
+#define I2C_OK					0
+#define I2C_ERR_PARAM			1			// Unknown interface or empty transaction
+#define I2C_ERR_SPEED			2			// SCL speed out of reach of the mode or of PCLK1
+#define I2C_ERR_BUSY			3			// A transaction is running or a clock switch holds the interface
+#define I2C_ERR_NACK			4			// Address or data byte not acknowledged
+#define I2C_ERR_BUS				5			// Bus error, arbitration lost, overrun or DMA error
+#define I2C_ERR_TIMEOUT			6			// Blocking call ran out of time, the transaction is aborted
+#define I2C_ERR_SKIPPED			7			// Segment not run: an earlier one lost the bus
+#define I2C_ERR_DMA				8			// Every DMA stream of a direction is owned by another driver
+
+/*
+ * @I2C_API_EVENTS
+ * The possible I2C application events
+ */
+#define I2C_EVENT_CMPLT			0			// Transaction done, STOP on the line
+#define I2C_EVENT_NACK			1			// Transaction ended by a NACK, STOP on the line
+#define I2C_EVENT_ERROR			2			// Transaction ended by an error, see I2C_Handle_t::ErrorFlags
+#define I2C_EVENT_BATCH_CMPLT	3			// Segment list done, see I2C_Segment_t::result and I2C_Handle_t::BatchFailed
+
+#define I2C_EVENT_MASK(event)	(1 << (event))	// Bit of the event in I2C_Handle_t::fastEvents
+
+/*
+ * @I2C_ERRORS
+ * Bits of I2C_Handle_t::ErrorFlags, the bus errors keep their SR1 positions
+ */
+#define I2C_ERROR_BUS			I2C_FLAG_BERR
+#define I2C_ERROR_ARBITRATION	I2C_FLAG_ARLO
+#define I2C_ERROR_NACK			I2C_FLAG_AF
+#define I2C_ERROR_OVERRUN		I2C_FLAG_OVR
+#define I2C_ERROR_TIMEOUT		I2C_FLAG_TIMEOUT
+#define I2C_ERROR_DMA			(1 << 13)	// RX stream transfer error (reserved SR1 bit)
+
+/*
+ * @I2C_IRQ
+ * Interrupt lines of an I2C interface
+ */
+#define I2C_IRQ_EV				0
+#define I2C_IRQ_ER				1
+#define I2C_IRQ_RX_DMA			2
+
+/*
+ * @I2C_TIMEOUTS
+ * Upper bounds of the driver waits, microseconds
+ */
+#define I2C_STOP_TIMEOUT_US		1000U		// STOP of the previous transaction, ten SCL periods at 10 kHz
+#define I2C_RETIME_TIMEOUT_US	10000U		// Running transaction before a clock switch
+
+
+// === API Functions ===
+//
+// I2C Init and Deinit
+//
+void I2C_PeriClockControl (I2C_RegDef_t *p_I2C, uint8_t enable);
+uint8_t I2C_Init (I2C_Handle_t *p_I2cHandle);
+void I2C_DeInit (I2C_Handle_t *p_I2cHandle);
+uint8_t I2C_IRQNumber (I2C_Handle_t *p_I2cHandle, uint8_t line);
+uint32_t I2C_GetSclSpeed (I2C_RegDef_t *p_I2C);
+void I2C_ClockTrack (I2C_Handle_t *p_I2cHandle, uint8_t enable);
+
+// I2C Master Transactions
+//
+uint8_t I2C_MasterTransferIT (I2C_Handle_t *p_I2cHandle, uint8_t devAddr, const uint8_t *p_TxBuffer, uint16_t txLen, uint8_t *p_RxBuffer, uint16_t rxLen);
+uint8_t I2C_MasterTransfer (I2C_Handle_t *p_I2cHandle, uint8_t devAddr, const uint8_t *p_TxBuffer, uint16_t txLen, uint8_t *p_RxBuffer, uint16_t rxLen, uint32_t timeoutUs);
+uint8_t I2C_MemRead (I2C_Handle_t *p_I2cHandle, uint8_t devAddr, uint8_t regAddr, uint8_t *p_RxBuffer, uint16_t len, uint32_t timeoutUs);
+uint8_t I2C_BatchStartIT (I2C_Handle_t *p_I2cHandle, I2C_Segment_t *p_Segments, uint8_t count, I2C_BatchDoneFunc_t doneFunc, void *p_Context);
+void I2C_Abort (I2C_Handle_t *p_I2cHandle);
+
+// I2C IRQ Handling
+//
+void I2C_EV_IRQHandling (I2C_Handle_t *p_I2cHandle);
+void I2C_ER_IRQHandling (I2C_Handle_t *p_I2cHandle);
+void I2C_IRQBind (I2C_Handle_t *p_I2cHandle, uint8_t enable);
+
+// I2C Application Callback
+//
+void I2C_API_EventCallback (I2C_Handle_t *p_I2cHandle, uint8_t appEvent);
+
+#endif /* I2C_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,83 @@
+/** @file irqprof.h
+*
+* @brief Interrupt latency and duration profiler header file.
+*
+* Build with -DIRQ_PROFILE_ENABLE=1 to instrument the handlers. When disabled, the hooks expand to
+* nothing and the profiler has no RAM or cycle cost.
+*
+*/
+
+#ifndef IRQPROF_H_
+#define IRQPROF_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Build Configuration ===
+//
+#ifndef IRQ_PROFILE_ENABLE
+#define IRQ_PROFILE_ENABLE			0
+#endif
+
+
+// === Constant Definitions ===
+//
+/*
+ * @IRQPROF_LIMITS
+ * Profiler geometry
+ */
+#define IRQPROF_MAX_SLOTS			8		// Number of IRQs tracked at once, assigned on the first entry
+#define IRQPROF_HIST_BINS			16		// log2 histogram: bin b holds [2^(b-1), 2^b) cycles, the last bin is open
+#define IRQPROF_ITM_PORT			0		// Stimulus port of the dump (0: SWV console)
+
+
+// === Type Definitions ===
+//
+typedef struct IRQPROF_Stat
+{
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t hist[IRQPROF_HIST_BINS];
+} IRQPROF_Stat_t;
+
+typedef struct IRQPROF_Record
+{
+	uint8_t IRQNumber;
+	volatile uint8_t pendMarked;	// SET between IRQPROF_MarkPending and the next entry
+	uint32_t pendStamp;				// DWT CYCCNT when the IRQ was requested
+	uint32_t entryStamp;			// DWT CYCCNT at the handler entry
+	IRQPROF_Stat_t latency;			// Request to entry, only for IRQs marked pending
+	IRQPROF_Stat_t duration;		// Entry to exit, including the time of preempting handlers
+} IRQPROF_Record_t;
+
+
+// === Instrumentation Hooks ===
+//
+#if IRQ_PROFILE_ENABLE
+#define IRQPROF_ENTER(IRQNumber)		IRQPROF_Enter(IRQNumber)
+#define IRQPROF_EXIT(IRQNumber)			IRQPROF_Exit(IRQNumber)
+#define IRQPROF_MARK_PENDING(IRQNumber)	IRQPROF_MarkPending(IRQNumber)
+#else
+#define IRQPROF_ENTER(IRQNumber)		((void)0)
+#define IRQPROF_EXIT(IRQNumber)			((void)0)
+#define IRQPROF_MARK_PENDING(IRQNumber)	((void)0)
+#endif
+
+
+// === API Functions ===
+//
+#if IRQ_PROFILE_ENABLE
+void IRQPROF_Enter (uint8_t IRQNumber);
+void IRQPROF_Exit (uint8_t IRQNumber);
+void IRQPROF_MarkPending (uint8_t IRQNumber);
+void IRQPROF_Reset (void);
+const IRQPROF_Record_t *IRQPROF_Get (uint8_t IRQNumber);
+void IRQPROF_Dump (uint8_t itmPort);
+#endif
+
+#endif /* IRQPROF_H_ */
+
+/*** EOF ***/
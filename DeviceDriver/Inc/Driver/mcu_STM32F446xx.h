@@ -14,6 +14,7 @@
 // =============================
 //
 #define _WEAK					__attribute__((weak))
+#define _RAMFUNC				__attribute__((section(".RamFunc"), noinline))	// Copied to SRAM with .data, no flash wait states
 
 // =============================
 // | NVIC Interrupt Controller |
@@ -35,10 +36,11 @@ typedef struct NVIC_GEN_Reg_Def
 } NVIC_GEN_Reg_Def_t;
 
 // === NVIC Interrupt IPR Register ===
+// Byte accessible: one 8 bit priority field per interrupt
 //
 typedef struct NVIC_IPR_Reg_Def
 {
-	volatile uint32_t reg[60];
+	volatile uint8_t reg[240];
 } NVIC_IPR_Reg_Def_t;
 
 // === NVIC Interrupt Register Definition ===
@@ -48,7 +50,136 @@ typedef struct NVIC_IPR_Reg_Def
 #define NVIC_ISPR				((NVIC_GEN_Reg_Def_t *) NVIC_ISPR_BASE)
 #define NVIC_ICPR				((NVIC_GEN_Reg_Def_t *) NVIC_ICPR_BASE)
 #define NVIC_IABR				((NVIC_GEN_Reg_Def_t *) NVIC_IABR_BASE)
-#define NVIC_IPR				((NVIC_IPR_Reg_Def_t *) NVIC_IABR_BASE)
+#define NVIC_IPR				((NVIC_IPR_Reg_Def_t *) NVIC_IPR_BASE)
+
+
+// ============================
+// | SCB System Control Block |
+// ============================
+//
+//=== SCB Register Base Address ===
+#define SCB_BASE				0xE000ED00U				// System control block base
+
+// === SCB Register ===
+//
+typedef struct SCB_RegDef
+{
+	volatile uint32_t CPUID;		// CPUID base register
+	volatile uint32_t ICSR;			// Interrupt control and state register
+	volatile uint32_t VTOR;			// Vector table offset register
+	volatile uint32_t AIRCR;		// Application interrupt and reset control register
+	volatile uint32_t SCR;			// System control register
+	volatile uint32_t CCR;			// Configuration and control register
+	volatile uint8_t  SHPR[12];		// System handler priority registers (exceptions 4-15)
+	volatile uint32_t SHCSR;		// System handler control and state register
+	volatile uint32_t CFSR;			// Configurable fault status register
+	volatile uint32_t HFSR;			// HardFault status register
+	volatile uint32_t DFSR;			// Debug fault status register
+	volatile uint32_t MMFAR;		// MemManage fault address register
+	volatile uint32_t BFAR;			// BusFault address register
+	volatile uint32_t AFSR;			// Auxiliary fault status register
+} SCB_RegDef_t;
+
+// === SCB Register Definition ===
+//
+#define SCB						((SCB_RegDef_t *) SCB_BASE)
+
+#define SCB_ICSRREG_VECTACTIVE	0		// 8:0 Active exception number
+#define SCB_ICSRREG_PENDSTCLR	25		// SysTick exception clear-pending
+#define SCB_ICSRREG_PENDSTSET	26		// SysTick exception set-pending
+#define SCB_ICSRREG_PENDSVCLR	27		// PendSV clear-pending
+#define SCB_ICSRREG_PENDSVSET	28		// PendSV set-pending
+#define SCB_AIRCRREG_PRIGROUP	8		// 10:8 Interrupt priority grouping
+#define SCB_AIRCRREG_VECTKEY	16		// 31:16 Register key
+#define SCB_AIRCR_VECTKEY		0x05FAu	// Write key of AIRCR
+#define SCB_SCRREG_SLEEPONEXIT	1		// Sleep on return from handler to thread mode
+#define SCB_SCRREG_SLEEPDEEP	2		// Deep sleep (STOP/STANDBY) instead of sleep
+#define SCB_SCRREG_SEVONPEND	4		// Pending interrupts, even disabled ones, are wake-up events
+
+//=== SysTick Register Base Address ===
+#define SYSTICK_BASE			0xE000E010U				// System timer base
+
+// === SysTick Register ===
+//
+typedef struct SYSTICK_RegDef
+{
+	volatile uint32_t CTRL;			// SysTick control and status register
+	volatile uint32_t LOAD;			// SysTick reload value register
+	volatile uint32_t VAL;			// SysTick current value register
+	volatile uint32_t CALIB;		// SysTick calibration value register
+} SYSTICK_RegDef_t;
+
+// === SysTick Register Definition ===
+//
+#define SYSTICK					((SYSTICK_RegDef_t *) SYSTICK_BASE)
+
+#define SYSTICK_CTRLREG_ENABLE		0	// Counter enable
+#define SYSTICK_CTRLREG_TICKINT		1	// Exception on reaching zero
+#define SYSTICK_CTRLREG_CLKSOURCE	2	// 1: processor clock, 0: processor clock / 8
+#define SYSTICK_CTRLREG_COUNTFLAG	16	// Reached zero since the last read
+#define SYSTICK_LOAD_MAX			0x00FFFFFFu	// 24-bit reload
+
+
+// ===============================
+// | Debug and Trace (Core) Unit |
+// ===============================
+//
+//=== Debug Register Base Address ===
+#define ITM_BASE				0xE0000000U				// Instrumentation trace macrocell base
+#define DWT_BASE				0xE0001000U				// Data watchpoint and trace unit base
+#define COREDEBUG_BASE			0xE000EDF0U				// Core debug registers base (DHCSR)
+
+// === ITM (Instrumentation Trace Macrocell) Register ===
+//
+typedef struct ITM_RegDef
+{
+	volatile uint32_t PORT[32];		// ITM stimulus port registers
+	uint32_t		  RESERVED0[864];	// 0x080 - 0xDFC
+	volatile uint32_t TER;			// ITM trace enable register
+	uint32_t		  RESERVED1[15];	// 0xE04 - 0xE3C
+	volatile uint32_t TPR;			// ITM trace privilege register
+	uint32_t		  RESERVED2[15];	// 0xE44 - 0xE7C
+	volatile uint32_t TCR;			// ITM trace control register
+} ITM_RegDef_t;
+
+// === DWT (Data Watchpoint and Trace) Register ===
+//
+typedef struct DWT_RegDef
+{
+	volatile uint32_t CTRL;			// DWT control register
+	volatile uint32_t CYCCNT;		// DWT cycle count register
+	volatile uint32_t CPICNT;		// DWT CPI count register
+	volatile uint32_t EXCCNT;		// DWT exception overhead count register
+	volatile uint32_t SLEEPCNT;		// DWT sleep count register
+	volatile uint32_t LSUCNT;		// DWT LSU count register
+	volatile uint32_t FOLDCNT;		// DWT folded-instruction count register
+	volatile uint32_t PCSR;			// DWT program counter sample register
+} DWT_RegDef_t;
+
+// === Core Debug Register ===
+//
+typedef struct COREDEBUG_RegDef
+{
+	volatile uint32_t DHCSR;		// Debug halting control and status register
+	volatile uint32_t DCRSR;		// Debug core register selector register
+	volatile uint32_t DCRDR;		// Debug core register data register
+	volatile uint32_t DEMCR;		// Debug exception and monitor control register
+} COREDEBUG_RegDef_t;
+
+// === Debug Register Definition ===
+//
+#define ITM						((ITM_RegDef_t *) ITM_BASE)
+#define DWT						((DWT_RegDef_t *) DWT_BASE)
+#define COREDEBUG				((COREDEBUG_RegDef_t *) COREDEBUG_BASE)
+
+#define DWT_CTRLREG_CYCCNTENA	0		// Cycle counter enable
+#define COREDEBUG_DEMCRREG_TRCENA	24	// Trace system (DWT, ITM) enable
+#define ITM_TCRREG_ITMENA		0		// ITM enable
+
+// === Debug Macros ===
+//
+#define DWT_CYCCNT_EN()			do { COREDEBUG->DEMCR |= (1 << COREDEBUG_DEMCRREG_TRCENA); DWT->CTRL |= (1 << DWT_CTRLREG_CYCCNTENA); } while(0)
+#define DWT_CYCCNT()			(DWT->CYCCNT)
 
 
 // ================
@@ -71,13 +202,27 @@ typedef struct NVIC_IPR_Reg_Def
 #define AHB1_PERIPH_BASE		0x40020000U
 #define AHB2_PERIPH_BASE		0x50000000U
 
+//=== Bit-Band Alias Base Address ===
+//
+#define BITBAND_PERIPH_BASE		0x42000000U				// Alias of the first 1 MB of the peripheral space
+
+// Single bit of a peripheral register: one store is an atomic read-modify-write done by the bus
+#define BITBAND_PERIPH(p_Reg, bit)	(*(volatile uint32_t *)(BITBAND_PERIPH_BASE + (((uint32_t)(p_Reg) - PERIPH_BASE) << 5) + ((bit) << 2)))
+
 //=== APB1 Peripherals Base Address ===
 //
 #define I2C1_BASE				(APB1_PERIPH_BASE + 0x5400)
 #define I2C2_BASE				(APB1_PERIPH_BASE + 0x5800)
 #define I2C3_BASE				(APB1_PERIPH_BASE + 0x5C00)
+#define TIM2_BASE				(APB1_PERIPH_BASE + 0x0000)
+#define TIM3_BASE				(APB1_PERIPH_BASE + 0x0400)
+#define TIM4_BASE				(APB1_PERIPH_BASE + 0x0800)
+#define TIM5_BASE				(APB1_PERIPH_BASE + 0x0C00)
+#define TIM6_BASE				(APB1_PERIPH_BASE + 0x1000)
+#define TIM7_BASE				(APB1_PERIPH_BASE + 0x1400)
 #define SPI2_BASE				(APB1_PERIPH_BASE + 0x3800)
 #define SPI3_BASE				(APB1_PERIPH_BASE + 0x3C00)
+#define PWR_BASE				(APB1_PERIPH_BASE + 0x7000)
 #define USART2_BASE				(APB1_PERIPH_BASE + 0x4400)
 #define USART3_BASE				(APB1_PERIPH_BASE + 0x4800)
 #define UART4_BASE				(APB1_PERIPH_BASE + 0x4C00)
@@ -85,10 +230,12 @@ typedef struct NVIC_IPR_Reg_Def
 
 //=== APB2 Peripherals Base Address ===
 //
+#define TIM1_BASE				(APB2_PERIPH_BASE + 0x0000)
+#define TIM8_BASE				(APB2_PERIPH_BASE + 0x0400)
 #define USART1_BASE				(APB2_PERIPH_BASE + 0x1000)
 #define USART6_BASE				(APB2_PERIPH_BASE + 0x1400)
 #define SPI1_BASE				(APB2_PERIPH_BASE + 0x3000)
-#define SPI4_BASE				(APB2_PERIPH_BASE + 0x37FF)
+#define SPI4_BASE				(APB2_PERIPH_BASE + 0x3400)
 #define SYSCFG_BASE				(APB2_PERIPH_BASE + 0x3800)
 #define EXTI_BASE				(APB2_PERIPH_BASE + 0x3C00)
 
@@ -103,6 +250,9 @@ typedef struct NVIC_IPR_Reg_Def
 #define GPIOG_BASE				(AHB1_PERIPH_BASE + 0x1800)
 #define GPIOH_BASE				(AHB1_PERIPH_BASE + 0x1C00)
 #define RCC_BASE				(AHB1_PERIPH_BASE + 0x3800)
+#define FLASH_R_BASE			(AHB1_PERIPH_BASE + 0x3C00)		// Flash interface registers
+#define DMA1_BASE				(AHB1_PERIPH_BASE + 0x6000)
+#define DMA2_BASE				(AHB1_PERIPH_BASE + 0x6400)
 
 
 // =======================
@@ -139,6 +289,82 @@ typedef struct SPI_RegDef
 	volatile uint32_t SPI_I2SPR;	// SPI_I2S prescaler register
 } SPI_RegDef_t;
 
+// === USART Peripheral Register ===
+//
+typedef struct USART_RegDef
+{
+	volatile uint32_t SR;			// USART status register
+	volatile uint32_t DR;			// USART data register
+	volatile uint32_t BRR;			// USART baud rate register
+	volatile uint32_t CR1;			// USART control register 1
+	volatile uint32_t CR2;			// USART control register 2
+	volatile uint32_t CR3;			// USART control register 3
+	volatile uint32_t GTPR;			// USART guard time and prescaler register
+} USART_RegDef_t;
+
+// === I2C Peripheral Register ===
+//
+typedef struct I2C_RegDef
+{
+	volatile uint32_t CR1;			// I2C control register 1
+	volatile uint32_t CR2;			// I2C control register 2
+	volatile uint32_t OAR1;			// I2C own address register 1
+	volatile uint32_t OAR2;			// I2C own address register 2
+	volatile uint32_t DR;			// I2C data register
+	volatile uint32_t SR1;			// I2C status register 1
+	volatile uint32_t SR2;			// I2C status register 2
+	volatile uint32_t CCR;			// I2C clock control register
+	volatile uint32_t TRISE;		// I2C TRISE register
+	volatile uint32_t FLTR;			// I2C FLTR register
+} I2C_RegDef_t;
+
+// === TIM (General purpose / Advanced control timer) Peripheral Register ===
+//
+typedef struct TIM_RegDef
+{
+	volatile uint32_t CR1;			// TIM control register 1
+	volatile uint32_t CR2;			// TIM control register 2
+	volatile uint32_t SMCR;			// TIM slave mode control register
+	volatile uint32_t DIER;			// TIM DMA/interrupt enable register
+	volatile uint32_t SR;			// TIM status register
+	volatile uint32_t EGR;			// TIM event generation register
+	volatile uint32_t CCMR1;		// TIM capture/compare mode register 1
+	volatile uint32_t CCMR2;		// TIM capture/compare mode register 2
+	volatile uint32_t CCER;			// TIM capture/compare enable register
+	volatile uint32_t CNT;			// TIM counter
+	volatile uint32_t PSC;			// TIM prescaler
+	volatile uint32_t ARR;			// TIM auto-reload register
+	volatile uint32_t RCR;			// TIM repetition counter register (TIM1/TIM8 only)
+	volatile uint32_t CCR[4];		// TIM capture/compare register 1-4
+	volatile uint32_t BDTR;			// TIM break and dead-time register (TIM1/TIM8 only)
+	volatile uint32_t DCR;			// TIM DMA control register
+	volatile uint32_t DMAR;			// TIM DMA address for full transfer
+	volatile uint32_t OR;			// TIM option register (TIM2/TIM5 only)
+} TIM_RegDef_t;
+
+// === DMA Stream Register ===
+//
+typedef struct DMA_Stream_RegDef
+{
+	volatile uint32_t CR;			// DMA stream x configuration register
+	volatile uint32_t NDTR;			// DMA stream x number of data register
+	volatile uint32_t PAR;			// DMA stream x peripheral address register
+	volatile uint32_t M0AR;			// DMA stream x memory 0 address register
+	volatile uint32_t M1AR;			// DMA stream x memory 1 address register
+	volatile uint32_t FCR;			// DMA stream x FIFO control register
+} DMA_Stream_RegDef_t;
+
+// === DMA Controller Register ===
+//
+typedef struct DMA_RegDef
+{
+	volatile uint32_t LISR;			// DMA low interrupt status register (stream 0-3)
+	volatile uint32_t HISR;			// DMA high interrupt status register (stream 4-7)
+	volatile uint32_t LIFCR;		// DMA low interrupt flag clear register (stream 0-3)
+	volatile uint32_t HIFCR;		// DMA high interrupt flag clear register (stream 4-7)
+	DMA_Stream_RegDef_t S[8];		// DMA stream 0-7 registers
+} DMA_RegDef_t;
+
 // === RCC (Reset-Clock Control) Peripheral Register ===
 //
 typedef struct RCC_RegDef
@@ -204,6 +430,26 @@ typedef struct SYSCFG_RegDef
 	volatile uint32_t CFGR;			// SYSCFG configuration register
 } SYSCFG_RegDef_t;
 
+// === FLASH Interface Register ===
+//
+typedef struct FLASH_RegDef
+{
+	volatile uint32_t ACR;			// Flash access control register
+	volatile uint32_t KEYR;			// Flash key register
+	volatile uint32_t OPTKEYR;		// Flash option key register
+	volatile uint32_t SR;			// Flash status register
+	volatile uint32_t CR;			// Flash control register
+	volatile uint32_t OPTCR;		// Flash option control register
+} FLASH_RegDef_t;
+
+// === PWR (Power Control) Register ===
+//
+typedef struct PWR_RegDef
+{
+	volatile uint32_t CR;			// PWR power control register
+	volatile uint32_t CSR;			// PWR power control/status register
+} PWR_RegDef_t;
+
 
 // =========================
 // | Peripheral Definition |
@@ -255,10 +501,239 @@ typedef struct SYSCFG_RegDef
 #define SPI_FLAG_BUSY			(1 << SPI_SRREG_BSY)
 #define SPI_FLAG_OVR			(1 << SPI_SRREG_OVR)
 
+// === USART Interface Definition ===
+//
+#define USART1					((USART_RegDef_t *) USART1_BASE)
+#define USART2					((USART_RegDef_t *) USART2_BASE)
+#define USART3					((USART_RegDef_t *) USART3_BASE)
+#define UART4					((USART_RegDef_t *) UART4_BASE)
+#define UART5					((USART_RegDef_t *) UART5_BASE)
+#define USART6					((USART_RegDef_t *) USART6_BASE)
+
+// === USART Register Definition ===
+//
+#define USART_SRREG_PE			0		// Parity error
+#define USART_SRREG_FE			1		// Framing error
+#define USART_SRREG_NF			2		// Noise detected flag
+#define USART_SRREG_ORE			3		// Overrun error
+#define USART_SRREG_IDLE		4		// IDLE line detected
+#define USART_SRREG_RXNE		5		// Read data register not empty
+#define USART_SRREG_TC			6		// Transmission complete
+#define USART_SRREG_TXE			7		// Transmit data register empty
+#define USART_CR1REG_RE			2		// Receiver enable
+#define USART_CR1REG_TE			3		// Transmitter enable
+#define USART_CR1REG_IDLEIE		4		// IDLE interrupt enable
+#define USART_CR1REG_RXNEIE		5		// RXNE interrupt enable
+#define USART_CR1REG_TCIE		6		// Transmission complete interrupt enable
+#define USART_CR1REG_TXEIE		7		// TXE interrupt enable
+#define USART_CR1REG_PEIE		8		// PE interrupt enable
+#define USART_CR1REG_PS			9		// Parity selection
+#define USART_CR1REG_PCE		10		// Parity control enable
+#define USART_CR1REG_M			12		// Word length
+#define USART_CR1REG_UE			13		// USART enable
+#define USART_CR1REG_OVER8		15		// Oversampling mode
+#define USART_CR2REG_STOP		12		// 13:12 Stop bits
+#define USART_CR3REG_EIE		0		// Error interrupt enable
+#define USART_CR3REG_DMAR		6		// DMA enable receiver
+#define USART_CR3REG_DMAT		7		// DMA enable transmitter
+
+// === USART Generic Definition ===
+//
+#define USART_FLAG_PE			(1 << USART_SRREG_PE)
+#define USART_FLAG_FE			(1 << USART_SRREG_FE)
+#define USART_FLAG_NF			(1 << USART_SRREG_NF)
+#define USART_FLAG_ORE			(1 << USART_SRREG_ORE)
+#define USART_FLAG_IDLE			(1 << USART_SRREG_IDLE)
+#define USART_FLAG_RXNE			(1 << USART_SRREG_RXNE)
+#define USART_FLAG_TC			(1 << USART_SRREG_TC)
+#define USART_FLAG_TXE			(1 << USART_SRREG_TXE)
+#define USART_FLAG_ERRORS		(USART_FLAG_PE | USART_FLAG_FE | USART_FLAG_NF | USART_FLAG_ORE)
+
+// === I2C Interface Definition ===
+//
+#define I2C1					((I2C_RegDef_t *) I2C1_BASE)
+#define I2C2					((I2C_RegDef_t *) I2C2_BASE)
+#define I2C3					((I2C_RegDef_t *) I2C3_BASE)
+
+// === I2C Register Definition ===
+//
+#define I2C_CR1REG_PE			0		// Peripheral enable
+#define I2C_CR1REG_NOSTRETCH	7		// Clock stretching disable (slave mode)
+#define I2C_CR1REG_START		8		// Start generation
+#define I2C_CR1REG_STOP			9		// Stop generation
+#define I2C_CR1REG_ACK			10		// Acknowledge enable
+#define I2C_CR1REG_POS			11		// Acknowledge/PEC position (for data reception)
+#define I2C_CR1REG_SWRST		15		// Software reset
+#define I2C_CR2REG_FREQ			0		// 5:0 Peripheral clock frequency, MHz
+#define I2C_CR2REG_ITERREN		8		// Error interrupt enable
+#define I2C_CR2REG_ITEVTEN		9		// Event interrupt enable
+#define I2C_CR2REG_ITBUFEN		10		// Buffer interrupt enable
+#define I2C_CR2REG_DMAEN		11		// DMA requests enable
+#define I2C_CR2REG_LAST			12		// DMA last transfer
+#define I2C_SR1REG_SB			0		// Start bit (master mode)
+#define I2C_SR1REG_ADDR			1		// Address sent (master mode)
+#define I2C_SR1REG_BTF			2		// Byte transfer finished
+#define I2C_SR1REG_STOPF		4		// Stop detection (slave mode)
+#define I2C_SR1REG_RXNE			6		// Data register not empty (receivers)
+#define I2C_SR1REG_TXE			7		// Data register empty (transmitters)
+#define I2C_SR1REG_BERR			8		// Bus error
+#define I2C_SR1REG_ARLO			9		// Arbitration lost (master mode)
+#define I2C_SR1REG_AF			10		// Acknowledge failure
+#define I2C_SR1REG_OVR			11		// Overrun/Underrun
+#define I2C_SR1REG_TIMEOUT		14		// Timeout or Tlow error
+#define I2C_SR2REG_MSL			0		// Master/slave
+#define I2C_SR2REG_BUSY			1		// Bus busy
+#define I2C_SR2REG_TRA			2		// Transmitter/receiver
+#define I2C_CCRREG_CCR			0		// 11:0 Clock control register in Fm/Sm mode (master mode)
+#define I2C_CCRREG_DUTY			14		// Fm mode duty cycle
+#define I2C_CCRREG_FS			15		// I2C master mode selection
+
+// === I2C Generic Definition ===
+//
+#define I2C_FLAG_SB				(1 << I2C_SR1REG_SB)
+#define I2C_FLAG_ADDR			(1 << I2C_SR1REG_ADDR)
+#define I2C_FLAG_BTF			(1 << I2C_SR1REG_BTF)
+#define I2C_FLAG_RXNE			(1 << I2C_SR1REG_RXNE)
+#define I2C_FLAG_TXE			(1 << I2C_SR1REG_TXE)
+#define I2C_FLAG_BERR			(1 << I2C_SR1REG_BERR)
+#define I2C_FLAG_ARLO			(1 << I2C_SR1REG_ARLO)
+#define I2C_FLAG_AF				(1 << I2C_SR1REG_AF)
+#define I2C_FLAG_OVR			(1 << I2C_SR1REG_OVR)
+#define I2C_FLAG_TIMEOUT		(1 << I2C_SR1REG_TIMEOUT)
+#define I2C_FLAG_ERRORS			(I2C_FLAG_BERR | I2C_FLAG_ARLO | I2C_FLAG_AF | I2C_FLAG_OVR | I2C_FLAG_TIMEOUT)
+
+// === TIM Timer Definition ===
+//
+#define TIM1					((TIM_RegDef_t *) TIM1_BASE)
+#define TIM2					((TIM_RegDef_t *) TIM2_BASE)
+#define TIM3					((TIM_RegDef_t *) TIM3_BASE)
+#define TIM4					((TIM_RegDef_t *) TIM4_BASE)
+#define TIM5					((TIM_RegDef_t *) TIM5_BASE)
+#define TIM6					((TIM_RegDef_t *) TIM6_BASE)
+#define TIM7					((TIM_RegDef_t *) TIM7_BASE)
+#define TIM8					((TIM_RegDef_t *) TIM8_BASE)
+
+// === TIM Register Definition ===
+//
+#define TIM_CR1REG_CEN			0		// Counter enable
+#define TIM_CR1REG_UDIS			1		// Update disable
+#define TIM_CR1REG_URS			2		// Update request source
+#define TIM_CR1REG_OPM			3		// One-pulse mode
+#define TIM_CR1REG_ARPE			7		// Auto-reload preload enable
+#define TIM_DIERREG_UIE			0		// Update interrupt enable
+#define TIM_DIERREG_CC1IE		1		// Capture/Compare 1 interrupt enable
+#define TIM_DIERREG_UDE			8		// Update DMA request enable
+#define TIM_SRREG_UIF			0		// Update interrupt flag
+#define TIM_SRREG_CC1IF			1		// Capture/Compare 1 interrupt flag
+#define TIM_EGRREG_UG			0		// Update generation
+
+// === DMA Controller Definition ===
+//
+#define DMA1					((DMA_RegDef_t *) DMA1_BASE)
+#define DMA2					((DMA_RegDef_t *) DMA2_BASE)
+
+// === DMA Register Definition ===
+//
+#define DMA_SxCRREG_EN			0		// Stream enable
+#define DMA_SxCRREG_DMEIE		1		// Direct mode error interrupt enable
+#define DMA_SxCRREG_TEIE		2		// Transfer error interrupt enable
+#define DMA_SxCRREG_HTIE		3		// Half transfer interrupt enable
+#define DMA_SxCRREG_TCIE		4		// Transfer complete interrupt enable
+#define DMA_SxCRREG_PFCTRL		5		// Peripheral flow controller
+#define DMA_SxCRREG_DIR			6		// 7:6 Data transfer direction
+#define DMA_SxCRREG_CIRC		8		// Circular mode
+#define DMA_SxCRREG_PINC		9		// Peripheral increment mode
+#define DMA_SxCRREG_MINC		10		// Memory increment mode
+#define DMA_SxCRREG_PSIZE		11		// 12:11 Peripheral data size
+#define DMA_SxCRREG_MSIZE		13		// 14:13 Memory data size
+#define DMA_SxCRREG_PL			16		// 17:16 Priority level
+#define DMA_SxCRREG_DBM			18		// Double buffer mode
+#define DMA_SxCRREG_CT			19		// Current target (double buffer mode only)
+#define DMA_SxCRREG_PBURST		21		// 22:21 Peripheral burst transfer configuration
+#define DMA_SxCRREG_MBURST		23		// 24:23 Memory burst transfer configuration
+#define DMA_SxCRREG_CHSEL		25		// 27:25 Channel selection
+#define DMA_SxFCRREG_FTH		0		// 1:0 FIFO threshold selection
+#define DMA_SxFCRREG_DMDIS		2		// Direct mode disable
+#define DMA_SxFCRREG_FEIE		7		// FIFO error interrupt enable
+
+// === DMA Stream Flag Definition (relative to the stream's field in xISR / xIFCR) ===
+//
+#define DMA_FLAG_FEIF			(1 << 0)	// FIFO error
+#define DMA_FLAG_DMEIF			(1 << 2)	// Direct mode error
+#define DMA_FLAG_TEIF			(1 << 3)	// Transfer error
+#define DMA_FLAG_HTIF			(1 << 4)	// Half transfer
+#define DMA_FLAG_TCIF			(1 << 5)	// Transfer complete
+#define DMA_FLAG_ALL			(DMA_FLAG_FEIF | DMA_FLAG_DMEIF | DMA_FLAG_TEIF | DMA_FLAG_HTIF | DMA_FLAG_TCIF)
+
 // === RCC Register Definition ===
 //
 #define RCC						((RCC_RegDef_t *) RCC_BASE)
 
+#define RCC_CRREG_HSION			0		// HSI clock enable
+#define RCC_CRREG_HSIRDY		1		// HSI clock ready flag
+#define RCC_CRREG_HSEON			16		// HSE clock enable
+#define RCC_CRREG_HSERDY		17		// HSE clock ready flag
+#define RCC_CRREG_HSEBYP		18		// HSE clock bypass (external clock on OSC_IN)
+#define RCC_CRREG_PLLON			24		// Main PLL enable
+#define RCC_CRREG_PLLRDY		25		// Main PLL clock ready flag
+#define RCC_PLLCFGRREG_PLLM		0		// 5:0 Division factor of the PLL input
+#define RCC_PLLCFGRREG_PLLN		6		// 14:6 Multiplication factor of the VCO
+#define RCC_PLLCFGRREG_PLLP		16		// 17:16 Division factor of the main system clock (2, 4, 6, 8)
+#define RCC_PLLCFGRREG_PLLSRC	22		// PLL source: 0 HSI, 1 HSE
+#define RCC_PLLCFGRREG_PLLQ		24		// 27:24 Division factor of the 48 MHz clocks
+#define RCC_PLLCFGRREG_PLLR		28		// 30:28 Division factor of the I2S / SPDIF / system clock
+#define RCC_CFGRREG_SW			0		// 1:0 System clock switch
+#define RCC_CFGRREG_SWS			2		// 3:2 System clock switch status
+#define RCC_CFGRREG_HPRE		4		// 7:4 AHB prescaler
+#define RCC_CFGRREG_PPRE1		10		// 12:10 APB1 prescaler
+#define RCC_CFGRREG_PPRE2		13		// 15:13 APB2 prescaler
+#define RCC_CFGRREG_MCO1		21		// 22:21 Microcontroller clock output 1
+#define RCC_CFGRREG_MCO1PRE		24		// 26:24 MCO1 prescaler
+#define RCC_CFGRREG_MCO2PRE		27		// 29:27 MCO2 prescaler
+#define RCC_CFGRREG_MCO2		30		// 31:30 Microcontroller clock output 2
+#define RCC_DCKCFGRREG_TIMPRE	24		// Timer clock prescaler selection
+#define RCC_AHB1ENRREG_FLITFEN	15		// Flash interface clock (AHB1LPENR only)
+#define RCC_AHB1ENRREG_SRAM1EN	16		// SRAM 1 interface clock (AHB1LPENR only)
+#define RCC_AHB1ENRREG_SRAM2EN	17		// SRAM 2 interface clock (AHB1LPENR only)
+#define RCC_APB1ENRREG_TIM2EN	0		// TIM2 clock enable
+#define RCC_APB1ENRREG_TIM6EN	4		// TIM6 clock enable
+#define RCC_APB1ENRREG_TIM7EN	5		// TIM7 clock enable
+#define RCC_APB1ENRREG_PWREN	28		// Power interface clock enable
+#define RCC_APB2ENRREG_TIM1EN	0		// TIM1 clock enable
+#define RCC_APB2ENRREG_TIM8EN	1		// TIM8 clock enable
+#define RCC_APB2ENRREG_SYSCFGEN	14		// System configuration controller clock enable
+
+/*
+ * @RCC_SYSCLK_SOURCE
+ * Values of CFGR SW / SWS
+ */
+#define RCC_SYSCLK_HSI			0
+#define RCC_SYSCLK_HSE			1
+#define RCC_SYSCLK_PLLP			2
+#define RCC_SYSCLK_PLLR			3
+
+// === FLASH Interface Definition ===
+//
+#define FLASH					((FLASH_RegDef_t *) FLASH_R_BASE)
+
+#define FLASH_ACRREG_LATENCY	0		// 3:0 Wait states
+#define FLASH_ACRREG_PRFTEN		8		// Prefetch enable
+#define FLASH_ACRREG_ICEN		9		// Instruction cache enable
+#define FLASH_ACRREG_DCEN		10		// Data cache enable
+#define FLASH_ACRREG_ICRST		11		// Instruction cache reset (cache disabled only)
+#define FLASH_ACRREG_DCRST		12		// Data cache reset (cache disabled only)
+
+// === PWR Definition ===
+//
+#define PWR						((PWR_RegDef_t *) PWR_BASE)
+
+#define PWR_CRREG_VOS			14		// 15:14 Regulator voltage scaling output selection
+#define PWR_CRREG_ODEN			16		// Over-drive enable
+#define PWR_CRREG_ODSWEN		17		// Over-drive switching enabled
+#define PWR_CSRREG_VOSRDY		14		// Regulator voltage scaling output selection ready
+#define PWR_CSRREG_ODRDY		16		// Over-drive mode ready
+#define PWR_CSRREG_ODSWRDY		17		// Over-drive mode switching ready
+
 // === EXTI Register Definition ===
 //
 #define EXTI					((EXTI_RegDef_t *) EXTI_BASE)
@@ -290,10 +765,30 @@ typedef struct SYSCFG_RegDef
 #define SPI3_PCLK_EN()			(RCC->APB1ENR |= (1 << 15))
 #define SPI4_PCLK_EN()			(RCC->APB2ENR |= (1 << 13))
 
+//=== TIMx Clock Enable Macro ===
+//
+#define TIM1_PCLK_EN()			(RCC->APB2ENR |= (1 << 0))
+#define TIM2_PCLK_EN()			(RCC->APB1ENR |= (1 << 0))
+#define TIM3_PCLK_EN()			(RCC->APB1ENR |= (1 << 1))
+#define TIM4_PCLK_EN()			(RCC->APB1ENR |= (1 << 2))
+#define TIM5_PCLK_EN()			(RCC->APB1ENR |= (1 << 3))
+#define TIM6_PCLK_EN()			(RCC->APB1ENR |= (1 << 4))
+#define TIM7_PCLK_EN()			(RCC->APB1ENR |= (1 << 5))
+#define TIM8_PCLK_EN()			(RCC->APB2ENR |= (1 << 1))
+
+//=== DMAx Clock Enable Macro ===
+//
+#define DMA1_PCLK_EN()			(RCC->AHB1ENR |= (1 << 21))
+#define DMA2_PCLK_EN()			(RCC->AHB1ENR |= (1 << 22))
+
 //=== SYSCFG Clock Enable Macro ===
 //
 #define SYSCFG_PCLK_EN()		(RCC->APB2ENR |= (1 << 14))
 
+//=== PWR Clock Enable Macro ===
+//
+#define PWR_PCLK_EN()			(RCC->APB1ENR |= (1 << 28))
+
 //=== I2Cx Clock Enable Macro ===
 //
 #define I2C1_PCLK_EN()			(RCC->APB1ENR |= (1 << 21))
@@ -325,10 +820,30 @@ typedef struct SYSCFG_RegDef
 //
 #define I2C1_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 21))
 
+//=== TIMx Clock Disable Macro ===
+//
+#define TIM1_PCLK_DI()			(RCC->APB2ENR &= ~(1 << 0))
+#define TIM2_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 0))
+#define TIM3_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 1))
+#define TIM4_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 2))
+#define TIM5_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 3))
+#define TIM6_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 4))
+#define TIM7_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 5))
+#define TIM8_PCLK_DI()			(RCC->APB2ENR &= ~(1 << 1))
+
+//=== DMAx Clock Disable Macro ===
+//
+#define DMA1_PCLK_DI()			(RCC->AHB1ENR &= ~(1 << 21))
+#define DMA2_PCLK_DI()			(RCC->AHB1ENR &= ~(1 << 22))
+
 //=== SYSCFG Clock Disable Macro ===
 //
 #define SYSCFG_PCLK_DI()		(RCC->APB2ENR &= ~(1 << 14))
 
+//=== PWR Clock Disable Macro ===
+//
+#define PWR_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 28))
+
 
 // ====================
 // | Peripheral Reset |
@@ -347,10 +862,39 @@ typedef struct SYSCFG_RegDef
 
 //=== SPI Peripheral Reset ===
 //
-#define SPI1_REG_RESET()		do { RCC->APB2RSTR |= (1 << 12); RCC->AHB2RSTR &= ~(1 << 12); } while(0)
-#define SPI2_REG_RESET()		do { RCC->APB1RSTR |= (1 << 14); RCC->AHB1RSTR &= ~(1 << 14); } while(0)
-#define SPI3_REG_RESET()		do { RCC->APB1RSTR |= (1 << 15); RCC->AHB1RSTR &= ~(1 << 15); } while(0)
-#define SPI4_REG_RESET()		do { RCC->APB2RSTR |= (1 << 13); RCC->AHB2RSTR &= ~(1 << 12); } while(0)
+#define SPI1_REG_RESET()		do { RCC->APB2RSTR |= (1 << 12); RCC->APB2RSTR &= ~(1 << 12); } while(0)
+#define SPI2_REG_RESET()		do { RCC->APB1RSTR |= (1 << 14); RCC->APB1RSTR &= ~(1 << 14); } while(0)
+#define SPI3_REG_RESET()		do { RCC->APB1RSTR |= (1 << 15); RCC->APB1RSTR &= ~(1 << 15); } while(0)
+#define SPI4_REG_RESET()		do { RCC->APB2RSTR |= (1 << 13); RCC->APB2RSTR &= ~(1 << 13); } while(0)
+
+//=== DMA Controller Reset ===
+//
+#define DMA1_REG_RESET()		do { RCC->AHB1RSTR |= (1 << 21); RCC->AHB1RSTR &= ~(1 << 21); } while(0)
+#define DMA2_REG_RESET()		do { RCC->AHB1RSTR |= (1 << 22); RCC->AHB1RSTR &= ~(1 << 22); } while(0)
+
+
+// =========================
+// | Peripheral Descriptor |
+// =========================
+//
+// === Peripheral Descriptor Type ===
+// One constant table per peripheral class (GPIO, SPI, DMA, ...) replaces the per-instance
+// if/else chains: the drivers find the entry of an instance by address arithmetic.
+//
+typedef struct PERIPH_Desc
+{
+	uint32_t baseAddr;				// Peripheral base address, validates the looked up entry
+	volatile uint32_t *p_ClkEnReg;	// RCC xxxENR clock enable register
+	volatile uint32_t *p_RstReg;	// RCC xxxRSTR reset register
+	uint8_t clkEnBit;				// Bit position in the clock enable register
+	uint8_t rstBit;					// Bit position in the reset register
+	uint8_t IRQNumber;				// Global interrupt of the peripheral, IRQ_NO_NONE if not applicable
+	uint8_t code;					// Class specific code (e.g. GPIO port code for SYSCFG_EXTICR)
+} PERIPH_Desc_t;
+
+// === Peripheral Descriptor Initializer ===
+//
+#define PERIPH_DESC(base, enReg, rstReg, bit, irq, code)	{ (base), &RCC->enReg, &RCC->rstReg, (bit), (bit), (irq), (code) }
 
 // ==========================
 // | Interrupt Vector Table |
@@ -358,17 +902,55 @@ typedef struct SYSCFG_RegDef
 //
 // === EXTI IRQ Numbers ===
 //
+#define IRQ_NO_PVD				1
+#define IRQ_NO_TAMP_STAMP		2
+#define IRQ_NO_RTC_WKUP			3
 #define IRQ_NO_EXTI0			6
 #define IRQ_NO_EXTI1			7
 #define IRQ_NO_EXTI2			8
 #define IRQ_NO_EXTI3			9
 #define IRQ_NO_EXTI4			10
+#define IRQ_NO_DMA1_STREAM0		11
+#define IRQ_NO_DMA1_STREAM1		12
+#define IRQ_NO_DMA1_STREAM2		13
+#define IRQ_NO_DMA1_STREAM3		14
+#define IRQ_NO_DMA1_STREAM4		15
+#define IRQ_NO_DMA1_STREAM5		16
+#define IRQ_NO_DMA1_STREAM6		17
 #define IRQ_NO_EXTI9_5			23
+#define IRQ_NO_TIM2				28
+#define IRQ_NO_I2C1_EV			31
+#define IRQ_NO_I2C1_ER			32
+#define IRQ_NO_I2C2_EV			33
+#define IRQ_NO_I2C2_ER			34
 #define IRQ_NO_SPI1				35
 #define IRQ_NO_SPI2				36
+#define IRQ_NO_USART1			37
+#define IRQ_NO_USART2			38
+#define IRQ_NO_USART3			39
 #define IRQ_NO_EXTI15_10		40
+#define IRQ_NO_RTC_ALARM		41
+#define IRQ_NO_OTG_FS_WKUP		42
+#define IRQ_NO_DMA1_STREAM7		47
 #define IRQ_NO_SPI3				51
+#define IRQ_NO_UART4			52
+#define IRQ_NO_UART5			53
+#define IRQ_NO_TIM6_DAC			54
+#define IRQ_NO_TIM7				55
+#define IRQ_NO_DMA2_STREAM0		56
+#define IRQ_NO_DMA2_STREAM1		57
+#define IRQ_NO_DMA2_STREAM2		58
+#define IRQ_NO_DMA2_STREAM3		59
+#define IRQ_NO_DMA2_STREAM4		60
+#define IRQ_NO_DMA2_STREAM5		68
+#define IRQ_NO_DMA2_STREAM6		69
+#define IRQ_NO_DMA2_STREAM7		70
+#define IRQ_NO_USART6			71
+#define IRQ_NO_I2C3_EV			72
+#define IRQ_NO_I2C3_ER			73
+#define IRQ_NO_OTG_HS_WKUP		76
 #define IRQ_NO_SPI4				84
+#define IRQ_NO_NONE				0xff	// No interrupt vector assigned
 
 // === EXTI IRQ Priorities ===
 //
@@ -392,6 +974,7 @@ typedef struct SYSCFG_RegDef
 // === EXTI IRQ Special Config ===
 //
 #define NO_IPR_BITS				4	// CPU specific, lower nibbles are might not be implemented in the IPR
+#define NVIC_NUM_IRQS			97	// STM32F446xx external interrupts (0 - 96)
 
 
 // ======================
@@ -411,6 +994,8 @@ typedef struct SYSCFG_RegDef
 //
 void IRQInterruptConfig (uint8_t IRQNumber,  uint8_t enable);
 void IRQPriorityConfig (uint8_t IRQNumber, uint8_t IRQPriority);
+void PERIPH_ClockControl (const PERIPH_Desc_t *p_Desc, uint8_t enable);
+void PERIPH_Reset (const PERIPH_Desc_t *p_Desc);
 
 
 #endif /* MCU_STM32F446XX_H_ */
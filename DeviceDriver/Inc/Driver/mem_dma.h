@@ -0,0 +1,79 @@
+/** @file mem_dma.h
+*
+* @brief Memory copy / fill offloaded to a DMA2 stream above a size threshold header file.
+*
+*/
+
+#ifndef MEM_DMA_H_
+#define MEM_DMA_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "dma.h"
+
+
+// === Type Definitions ===
+//
+typedef uint32_t MEM_DMA_Token_t;	// Completion token of an asynchronous copy / fill
+
+typedef struct MEM_DMA_Stat
+{
+	uint32_t dmaCount;				// Operations moved by the stream
+	uint32_t cpuCount;				// Operations below the threshold
+	uint32_t fallbacks;				// Operations above the threshold done by the CPU: stream busy or held
+	uint32_t errors;				// Stream transfer errors, the blocking calls redo the work by CPU
+} MEM_DMA_Stat_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @MEM_DMA_STATUS
+ * Return values
+ */
+#define MEM_DMA_OK					0
+#define MEM_DMA_ERR_BUSY			1		// Every DMA2 route is owned by another driver
+#define MEM_DMA_ERR_TIMEOUT			2		// The transfer of the token is still running
+#define MEM_DMA_ERR_DMA				3		// The transfer of the token ended in a stream error
+
+/*
+ * @MEM_DMA_TOKEN
+ * Token of an operation already finished when the call returned (CPU path)
+ */
+#define MEM_DMA_TOKEN_DONE			0
+
+/*
+ * @MEM_DMA_LIMITS
+ * Threshold and alignment of the DMA path, bytes
+ */
+#define MEM_DMA_THRESHOLD_DEFAULT	256U		// Below: CPU loop, until MEM_DMA_Calibrate measures the crossover
+#define MEM_DMA_ALIGN				16U			// Destination alignment of the stream part, one INC4 word burst
+#define MEM_DMA_CALIBRATE_MIN		32U			// Smallest length tried by MEM_DMA_Calibrate
+#define MEM_DMA_WAIT_TIMEOUT_US		100000U		// Blocking calls, 256 KB at 16 MHz with byte reads takes ~50 ms
+#define MEM_DMA_RETIME_TIMEOUT_US	10000U		// Running transfer before a clock switch
+
+
+// === API Functions ===
+//
+// MEM DMA Init and Deinit
+//
+uint8_t MEM_DMA_Init (void);
+void MEM_DMA_DeInit (void);
+uint8_t MEM_DMA_IRQNumber (void);
+void MEM_DMA_SetThreshold (uint32_t bytes);
+uint32_t MEM_DMA_GetThreshold (void);
+uint32_t MEM_DMA_Calibrate (void *p_Scratch, uint32_t size);
+void MEM_DMA_GetStat (MEM_DMA_Stat_t *p_Stat);
+
+// MEM DMA Copy and Fill
+//
+void *MEM_DMA_Copy (void *p_Dst, const void *p_Src, uint32_t len);
+void *MEM_DMA_Set (void *p_Dst, uint8_t value, uint32_t len);
+MEM_DMA_Token_t MEM_DMA_CopyAsync (void *p_Dst, const void *p_Src, uint32_t len);
+MEM_DMA_Token_t MEM_DMA_SetAsync (void *p_Dst, uint8_t value, uint32_t len);
+uint8_t MEM_DMA_IsDone (MEM_DMA_Token_t token);
+uint8_t MEM_DMA_Wait (MEM_DMA_Token_t token, uint32_t timeoutUs);
+
+#endif /* MEM_DMA_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,85 @@
+/** @file nvic.h
+*
+* @brief Priority-grouped NVIC manager header file.
+*
+*/
+
+#ifndef NVIC_H_
+#define NVIC_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Type Definitions ===
+//
+typedef struct NVIC_PlanEntry
+{
+	uint8_t IRQNumber;				// According to IRQ_NO_xxx
+	uint8_t preempt;				// According to @NVIC_PLAN_PREEMPT
+	uint8_t sub;					// Order among pending IRQs of the same preemption level
+} NVIC_PlanEntry_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @NVIC_PREEMPT_BITS
+ * Priority grouping: bits of the 4 bit priority field used as preemption priority, the rest is sub-priority
+ */
+#define NVIC_PREEMPT_BITS_0			0		// 0 preemption levels, 16 sub-priorities
+#define NVIC_PREEMPT_BITS_1			1		// 2 preemption levels, 8 sub-priorities
+#define NVIC_PREEMPT_BITS_2			2		// 4 preemption levels, 4 sub-priorities
+#define NVIC_PREEMPT_BITS_3			3		// 8 preemption levels, 2 sub-priorities
+#define NVIC_PREEMPT_BITS_4			4		// 16 preemption levels, 0 sub-priorities (reset value)
+
+/*
+ * @NVIC_SYS_EXCEPTIONS
+ * System exception numbers with configurable priority
+ */
+#define NVIC_EXC_MEMMANAGE			4
+#define NVIC_EXC_BUSFAULT			5
+#define NVIC_EXC_USAGEFAULT			6
+#define NVIC_EXC_SVCALL				11
+#define NVIC_EXC_DEBUGMON			12
+#define NVIC_EXC_PENDSV				14
+#define NVIC_EXC_SYSTICK			15
+
+/*
+ * @NVIC_PLAN_PREEMPT
+ * Preemption levels of the static priority plan: a lower level preempts a higher one
+ */
+#define NVIC_PLAN_PREEMPT_BITS		NVIC_PREEMPT_BITS_2
+#define NVIC_PLAN_PREEMPT_CRITICAL	0		// Reserved: hard real-time (DMA errors, timebase)
+#define NVIC_PLAN_PREEMPT_DATA		1		// Data path: SPI, USART, I2C
+#define NVIC_PLAN_PREEMPT_UI		2		// User interface: EXTI lines, buttons, encoders
+#define NVIC_PLAN_PREEMPT_BACKGROUND 3		// Deferred work
+
+/*
+ * @NVIC_ACTIVE
+ * Return value of NVIC_GetActiveIRQ in thread mode
+ */
+#define NVIC_NO_ACTIVE				(-16)
+
+
+// === API Functions ===
+//
+void NVIC_SetPriorityGrouping (uint8_t preemptBits);
+uint8_t NVIC_GetPriorityGrouping (void);
+uint8_t NVIC_EncodePriority (uint8_t preempt, uint8_t sub);
+void NVIC_SetPriority (uint8_t IRQNumber, uint8_t preempt, uint8_t sub);
+void NVIC_SetPreemptPriority (uint8_t IRQNumber, uint8_t preempt);
+void NVIC_SetSubPriority (uint8_t IRQNumber, uint8_t sub);
+uint8_t NVIC_GetPreemptPriority (uint8_t IRQNumber);
+uint8_t NVIC_GetSubPriority (uint8_t IRQNumber);
+void NVIC_SetSystemPriority (uint8_t exception, uint8_t preempt, uint8_t sub);
+void NVIC_SetPending (uint8_t IRQNumber);
+void NVIC_ClearPending (uint8_t IRQNumber);
+uint8_t NVIC_IsPending (uint8_t IRQNumber);
+uint8_t NVIC_IsActive (uint8_t IRQNumber);
+int16_t NVIC_GetActiveIRQ (void);
+void NVIC_ApplyPriorityPlan (void);
+
+#endif /* NVIC_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,50 @@
+/** @file pclk.h
+*
+* @brief Reference-counted peripheral clock gating header file.
+*
+*/
+
+#ifndef PCLK_H_
+#define PCLK_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Constant Definitions ===
+//
+/*
+ * @PCLK_BUS
+ * Clock enable registers, index from RCC AHB1ENR (the LPENR registers follow at the same layout)
+ */
+#define PCLK_BUS_AHB1				0
+#define PCLK_BUS_AHB2				1
+#define PCLK_BUS_AHB3				2
+#define PCLK_BUS_APB1				4
+#define PCLK_BUS_APB2				5
+#define PCLK_NUM_BUS				6		// Including the reserved slot at 3
+
+#define PCLK_COUNT_MAX				0xFFU	// References per clock, a saturated count is never decremented
+
+/*
+ * @PCLK_SLEEP_KEEP
+ * AHB1LPENR clocks which stay on in sleep without a reference: the DMA needs the SRAMs and the flash
+ */
+#define PCLK_SLEEP_KEEP_AHB1		((1u << RCC_AHB1ENRREG_FLITFEN) | (1u << RCC_AHB1ENRREG_SRAM1EN) | (1u << RCC_AHB1ENRREG_SRAM2EN))
+
+
+// === Macros ===
+//
+#define PCLK_LPENR(p_ClkEnReg)		((p_ClkEnReg) + (&RCC->AHB1LPENR - &RCC->AHB1ENR))
+
+
+// === API Functions ===
+//
+void PCLK_Init (void);
+uint8_t PCLK_Control (volatile uint32_t *p_ClkEnReg, uint8_t bit, uint8_t enable);
+void PCLK_SleepControl (volatile uint32_t *p_ClkEnReg, uint8_t bit, uint8_t enable);
+uint8_t PCLK_GetCount (volatile uint32_t *p_ClkEnReg, uint8_t bit);
+
+#endif /* PCLK_H_ */
+
+/*** EOF ***/
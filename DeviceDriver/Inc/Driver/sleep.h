@@ -0,0 +1,37 @@
+/** @file sleep.h
+*
+* @brief Core sleep (WFI / WFE / sleep-on-exit) idle integration header file.
+*
+*/
+
+#ifndef SLEEP_H_
+#define SLEEP_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Constant Definitions ===
+//
+/*
+ * @SLEEP_MODE
+ * How the core waits for the next interrupt
+ */
+#define SLEEP_MODE_BUSY				0		// No sleep: reference for the latency figures
+#define SLEEP_MODE_WFI				1		// WFI in a thread loop
+#define SLEEP_MODE_WFE				2		// WFE in a thread loop, SEVONPEND set
+#define SLEEP_MODE_ON_EXIT			3		// Sleep-on-exit: handlers run back to back, thread mode stays parked
+
+
+// === API Functions ===
+//
+void SLEEP_WaitForInterrupt (void);
+void SLEEP_WaitForEvent (void);
+void SLEEP_EventOnPend (uint8_t enable);
+void SLEEP_OnExit (void);
+void SLEEP_WakeMain (void);
+uint8_t SLEEP_IsOnExit (void);
+
+#endif /* SLEEP_H_ */
+
+/*** EOF ***/
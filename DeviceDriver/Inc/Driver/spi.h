@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include "mcu_STM32F446xx.h"
+#include "clock.h"
 
 // === Type Definitions ===
 //
@@ -34,8 +35,11 @@ typedef struct SPI_Handle
 	uint8_t *p_RxBuffer;
 	uint8_t TxLen;
 	uint8_t RxLen;
-	uint8_t TxState;				// @SPI_API_STATE
-	uint8_t RxState;				// @SPI_API_STATE
+	volatile uint8_t TxState;		// @SPI_API_STATE, claimed by CAS in thread mode, released by the ISR
+	volatile uint8_t RxState;		// @SPI_API_STATE, claimed by CAS in thread mode, released by the ISR
+	uint8_t fastEvents;				// SPI_EVENT_MASK(@SPI_API_EVENTS) raised in ISR context, the others are deferred
+	uint32_t maxSclkHz;				// SCLK limit kept across clock switches, see SPI_ClockTrack
+	CLOCK_Notifier_t clockNotifier;
 } SPI_Handle_t;
 
 
@@ -129,6 +133,14 @@ in a multimaster environment.
 #define SPI_EVENT_RX_CMPLT		1		// SPI Rx reception complete
 #define SPI_EVENT_OVR_CMPLT		2		// SPI OVR overrun error occurred complete
 
+#define SPI_EVENT_MASK(event)	(1 << (event))	// Bit of the event in SPI_Handle_t::fastEvents
+
+/*
+ * @SPI_TIMEOUTS
+ * Upper bound of the wait for a running transfer before a clock switch, microseconds
+ */
+#define SPI_RETIME_TIMEOUT_US	10000U
+
 
 // === API Functions ===
 //
@@ -137,6 +149,10 @@ in a multimaster environment.
 void SPI_PeriClockControl (SPI_RegDef_t *p_SPI, uint8_t enable);
 void SPI_Init (SPI_Handle_t *p_SPIhandle);
 void SPI_DeInit (SPI_RegDef_t *p_SPI);
+uint8_t SPI_IRQNumber (SPI_RegDef_t *p_SPI);
+uint8_t SPI_SpeedFor (SPI_RegDef_t *p_SPI, uint32_t maxSclkHz);
+uint32_t SPI_GetSclkHz (SPI_RegDef_t *p_SPI);
+void SPI_ClockTrack (SPI_Handle_t *p_SpiHandle, uint32_t maxSclkHz, uint8_t enable);
 
 // SPI Data Send and Receive
 //
@@ -148,6 +164,7 @@ uint8_t SPI_ReceiveDataIT (SPI_Handle_t *p_SpiHandle, uint8_t *p_RxBuffer, uint3
 // SPI IRQ Handling
 //
 void SPI_IRQHandling (SPI_Handle_t *p_SpiHandle);
+void SPI_IRQBind (SPI_Handle_t *p_SpiHandle, uint8_t enable);
 
 // SPI Control
 //
@@ -0,0 +1,57 @@
+/** @file timebase.h
+*
+* @brief SysTick millisecond timebase and DWT cycle delays header file.
+*
+*/
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Type Definitions ===
+//
+typedef struct TIMEBASE_Timeout
+{
+	uint32_t start;					// DWT CYCCNT at the start
+	uint32_t span;					// Cycles until expiry
+} TIMEBASE_Timeout_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @TIMEBASE_CLOCK
+ * Core clock assumed until the clock configuration reports the real one
+ */
+#define TIMEBASE_HCLK_RESET			16000000U	// HSI, no PLL
+#define TIMEBASE_TICK_HZ			1000U		// SysTick rate: 1 ms
+
+/*
+ * @TIMEBASE_LIMITS
+ * Longest span of the cycle based helpers (CYCCNT is compared wrap-safe on 31 bits)
+ */
+#define TIMEBASE_MAX_CYCLES			0x7FFFFFFFU
+
+
+// === API Functions ===
+//
+void TIMEBASE_Init (uint32_t hclkHz);
+void TIMEBASE_SetClock (uint32_t hclkHz);
+uint32_t TIMEBASE_GetClock (void);
+uint64_t TIMEBASE_GetMs (void);
+uint32_t TIMEBASE_GetMs32 (void);
+void TIMEBASE_DelayMs (uint32_t ms);
+void TIMEBASE_DelayUs (uint32_t us);
+void TIMEBASE_DelayCycles (uint32_t cycles);
+void TIMEBASE_TimeoutStart (TIMEBASE_Timeout_t *p_Timeout, uint32_t us);
+uint8_t TIMEBASE_TimeoutExpired (const TIMEBASE_Timeout_t *p_Timeout);
+uint8_t TIMEBASE_WaitBits (volatile uint32_t *p_Reg, uint32_t mask, uint32_t value, uint32_t timeoutUs);
+uint8_t TIMEBASE_SuspendTick (void);
+void TIMEBASE_ResumeTick (uint32_t sleptUs);
+
+#endif /* TIMEBASE_H_ */
+
+/*** EOF ***/
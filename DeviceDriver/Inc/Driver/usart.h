@@ -0,0 +1,163 @@
+/** @file usart.h
+*
+* @brief USART driver (circular DMA reception with idle-line detection, DMA transmission) header file.
+*
+*/
+
+#ifndef USART_H_
+#define USART_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+#include "clock.h"
+#include "dma.h"
+
+
+// === Type Definitions ===
+//
+typedef void (*USART_TxDoneFunc_t) (void *p_Context);
+
+typedef struct USART_Config
+{
+	uint32_t baudRate;				// Bits per second, OVER8 is selected when OVER16 can not reach it
+	uint8_t mode;					// @USART_MODE
+	uint8_t wordLength;				// @USART_WORDLEN
+	uint8_t stopBits;				// @USART_STOPBITS
+	uint8_t parity;					// @USART_PARITY
+} USART_Config_t;
+
+typedef struct USART_Handle
+{
+	USART_RegDef_t *p_USARTx;
+	USART_Config_t UsartConfig;
+	DMA_Handle_t RxDma;				// Allocated by USART_Init from the request mapping
+	DMA_Handle_t TxDma;
+	uint8_t *p_RxBuffer;			// Circular DMA ring, owned by the application
+	uint16_t RxSize;				// Power of two
+	uint16_t RxPos;					// Ring position of the DMA at the last update, ISR only
+	volatile uint32_t RxWritten;	// Bytes stored by the DMA, free running, ISR only
+	volatile uint32_t RxRead;		// Bytes taken by USART_Read, free running, thread only
+	uint32_t RxDropped;				// Bytes overwritten before USART_Read got them
+	volatile uint8_t TxState;		// @USART_API_STATE, claimed by CAS in thread mode, released by the ISR
+	volatile uint8_t TxHold;		// SET while a clock switch keeps the transmitter parked
+	USART_TxDoneFunc_t txDone;		// Driver-level owner of the transmitter (console), NULL for the application
+	void *p_TxDoneContext;
+	volatile uint8_t ErrorFlags;	// @USART_ERRORS seen since USART_Init, cleared by the application
+	uint8_t fastEvents;				// USART_EVENT_MASK(@USART_API_EVENTS) raised in ISR context, the others are deferred
+	volatile uint32_t IrqCount;		// USART and RX stream interrupts, for the benchmarks
+	CLOCK_Notifier_t clockNotifier;
+} USART_Handle_t;
+
+
+// === Constant Definitions ===
+//
+/*
+ * @USART_MODE
+ * Directions in use
+ */
+#define USART_MODE_TX			1
+#define USART_MODE_RX			2
+#define USART_MODE_TXRX			3
+
+/*
+ * @USART_WORDLEN
+ * Frame length including the parity bit: DMA moves bytes, so 9 bits are meant with parity
+ */
+#define USART_WORDLEN_8BITS		0
+#define USART_WORDLEN_9BITS		1
+
+/*
+ * @USART_STOPBITS
+ * CR2 STOP field values
+ */
+#define USART_STOPBITS_1		0
+#define USART_STOPBITS_0_5		1
+#define USART_STOPBITS_2		2
+#define USART_STOPBITS_1_5		3
+
+/*
+ * @USART_PARITY
+ * Parity control
+ */
+#define USART_PARITY_NONE		0
+#define USART_PARITY_EVEN		1
+#define USART_PARITY_ODD		2
+
+/*
+ * @USART_API_STATE
+ * The possible USART application states
+ */
+#define USART_ST_READY			0
+#define USART_ST_BUSY_TX		1
+#define USART_ST_HELD			2		// Refused during a clock switch, the txDone owner is called afterwards
+
+/*
+ * @USART_STATUS
+ * Return values
+ */
+#define USART_OK				0
+#define USART_ERR_PARAM			1		// Unknown interface, empty buffer or ring size not a power of two
+#define USART_ERR_BAUD			2		// Baud rate out of reach of the bus clock
+#define USART_ERR_DMA			3		// Every DMA stream of a direction is owned by another driver
+
+/*
+ * @USART_API_EVENTS
+ * The possible USART application events
+ */
+#define USART_EVENT_TX_CMPLT	0		// DMA transmission complete, last stop bit sent (not raised with txDone)
+#define USART_EVENT_RX_DATA		1		// New bytes in the ring: idle line, half or full ring
+#define USART_EVENT_RX_OVERRUN	2		// The DMA lapped USART_Read, the oldest bytes are lost
+#define USART_EVENT_ERROR		3		// Line or DMA error, see USART_Handle_t::ErrorFlags
+
+#define USART_EVENT_MASK(event)	(1 << (event))	// Bit of the event in USART_Handle_t::fastEvents
+
+/*
+ * @USART_ERRORS
+ * Bits of USART_Handle_t::ErrorFlags, the line errors keep their SR positions
+ */
+#define USART_ERROR_PARITY		USART_FLAG_PE
+#define USART_ERROR_FRAMING		USART_FLAG_FE
+#define USART_ERROR_NOISE		USART_FLAG_NF
+#define USART_ERROR_OVERRUN		USART_FLAG_ORE
+#define USART_ERROR_DMA			(1 << 7)	// RX stream transfer error, reception stopped
+
+/*
+ * @USART_TIMEOUTS
+ * Upper bound of the wait for a running transmission before a clock switch, microseconds
+ */
+#define USART_RETIME_TIMEOUT_US	10000U
+
+
+// === API Functions ===
+//
+// USART Init and Deinit
+//
+void USART_PeriClockControl (USART_RegDef_t *p_USART, uint8_t enable);
+uint8_t USART_Init (USART_Handle_t *p_UsartHandle);
+void USART_DeInit (USART_Handle_t *p_UsartHandle);
+uint8_t USART_IRQNumber (USART_RegDef_t *p_USART);
+uint8_t USART_RxDmaIRQNumber (USART_Handle_t *p_UsartHandle);
+uint32_t USART_GetBaudRate (USART_RegDef_t *p_USART);
+void USART_ClockTrack (USART_Handle_t *p_UsartHandle, uint8_t enable);
+
+// USART Data Send and Receive
+//
+void USART_SendData (USART_RegDef_t *p_USART, const uint8_t *p_TxBuffer, uint32_t len);
+uint8_t USART_SendDataDMA (USART_Handle_t *p_UsartHandle, const uint8_t *p_TxBuffer, uint16_t len);
+uint8_t USART_RxStart (USART_Handle_t *p_UsartHandle, uint8_t *p_RxBuffer, uint16_t size);
+void USART_RxStop (USART_Handle_t *p_UsartHandle);
+uint32_t USART_RxAvailable (USART_Handle_t *p_UsartHandle);
+uint32_t USART_Read (USART_Handle_t *p_UsartHandle, uint8_t *p_Buffer, uint32_t len);
+
+// USART IRQ Handling
+//
+void USART_IRQHandling (USART_Handle_t *p_UsartHandle);
+void USART_IRQBind (USART_Handle_t *p_UsartHandle, uint8_t enable);
+
+// USART Application Callback
+//
+void USART_API_EventCallback (USART_Handle_t *p_UsartHandle, uint8_t appEvent);
+
+#endif /* USART_H_ */
+
+/*** EOF ***/
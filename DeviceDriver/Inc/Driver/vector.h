@@ -0,0 +1,41 @@
+/** @file vector.h
+*
+* @brief SRAM vector table with runtime ISR registration header file.
+*
+*/
+
+#ifndef VECTOR_H_
+#define VECTOR_H_
+
+#include <stdint.h>
+#include "mcu_STM32F446xx.h"
+
+
+// === Type Definitions ===
+//
+typedef void (*VECTOR_Raw_t) (void);						// Plain vector table entry
+typedef void (*VECTOR_Handler_t) (void *p_Context);			// Handler with instance context
+
+
+// === Constant Definitions ===
+//
+/*
+ * @VECTOR_TABLE
+ * Table geometry: 16 core exceptions + NVIC_NUM_IRQS external interrupts
+ */
+#define VECTOR_NUM_CORE			16
+#define VECTOR_NUM_ENTRIES		(VECTOR_NUM_CORE + NVIC_NUM_IRQS)
+#define VECTOR_ALIGN			512			// VTOR: entries rounded up to a power of two, in bytes
+
+
+// === API Functions ===
+//
+void VECTOR_Init (void);
+uint8_t VECTOR_IsRelocated (void);
+void VECTOR_SetRaw (uint8_t IRQNumber, VECTOR_Raw_t handler);
+void VECTOR_Register (uint8_t IRQNumber, VECTOR_Handler_t handler, void *p_Context);
+void VECTOR_Unregister (uint8_t IRQNumber);
+
+#endif /* VECTOR_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,42 @@
+/** @file clock_test.h
+*
+* @brief Clock tree configuration test flows.
+*
+*/
+
+#ifndef CLOCK_TEST_H_
+#define CLOCK_TEST_H_
+
+#include <stdio.h>
+
+#include "mcu_STM32F446xx.h"
+#include "clock.h"
+#include "timebase.h"
+#include "spi.h"
+#include "gpio.h"
+#include "pclk.h"
+
+// === Type Definitions ===
+//
+
+
+// === Constant Definitions ===
+//
+#define CLOCK_TEST_SCLK_MAX_HZ	4000000U	// SCLK limit of the tracked SPI1
+
+
+// === Macros ===
+//
+#define NUM_OF(x)				(sizeof(x) / sizeof(*x))
+
+
+// === Public API Functions ===
+//
+void CLOCK_Test_Profiles (void);
+void CLOCK_Test_Switching (uint16_t cycle);
+void CLOCK_Test_Gating (void);
+
+
+#endif /* CLOCK_TEST_H_ */
+
+/*** EOF ***/
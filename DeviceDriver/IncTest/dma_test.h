@@ -0,0 +1,43 @@
+/** @file dma_test.h
+*
+* @brief DMA stream arbitration, memory-to-memory bandwidth and CPU / DMA crossover test flows.
+*
+*/
+
+#ifndef DMA_TEST_H_
+#define DMA_TEST_H_
+
+#include <stdio.h>
+
+#include "mcu_STM32F446xx.h"
+#include "dma.h"
+#include "mem_dma.h"
+#include "nvic.h"
+#include "clock.h"
+#include "timebase.h"
+
+// === Type Definitions ===
+//
+
+
+// === Constant Definitions ===
+//
+#define DMA_TEST_BLOCK_SIZE			4096U		// Bytes per memory-to-memory transfer
+#define DMA_TEST_TIMEOUT_US			10000U		// Per transfer, far above the 4 KB at 16 MHz
+
+
+// === Macros ===
+//
+#define NUM_OF(x)					(sizeof(x) / sizeof(*x))
+
+
+// === Public API Functions ===
+//
+void DMA_Test_Arbitration (void);
+void DMA_Test_BurstBandwidth (uint16_t cycle);
+void DMA_Test_MemCrossover (uint16_t cycle);
+
+
+#endif /* DMA_TEST_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,44 @@
+/** @file exti_test.h
+*
+* @brief EXTI dispatch manager test flows.
+*
+*/
+
+#ifndef EXTI_TEST_H_
+#define EXTI_TEST_H_
+
+#include <stdio.h>
+
+#include "mcu_STM32F446xx.h"
+#include "gpio.h"
+#include "exti.h"
+#include "nvic.h"
+#include "debounce.h"
+#include "timebase.h"
+#include "encoder.h"
+#include "gpio_dma.h"
+
+// === Type Definitions ===
+//
+
+
+// === Constant Definitions ===
+//
+
+
+// === Macros ===
+//
+#define NUM_OF(x)				(sizeof(x) / sizeof(*x))
+
+
+// === Public API Functions ===
+//
+void EXTI_Test_DispatchLatency (uint16_t cycle);
+void EXTI_Test_PriorityPlan (void);
+void EXTI_Test_Debounce (void);
+void EXTI_Test_EncoderBenchmark (void);
+
+
+#endif /* EXTI_TEST_H_ */
+
+/*** EOF ***/
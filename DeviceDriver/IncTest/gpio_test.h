@@ -11,6 +11,12 @@
 
 #include "mcu_STM32F446xx.h"
 #include "gpio.h"
+#include "exti.h"
+#include "gpio_dma.h"
+#include "gpio_capture.h"
+#include "evloop.h"
+#include "timebase.h"
+#include "sleep.h"
 
 // === Type Definitions ===
 //
@@ -24,14 +30,19 @@
 
 // === Macros ===
 //
+#define NUM_OF(x)			(sizeof(x) / sizeof(*x))
 
 
 // === Public API Functions ===
 //
 void GPIO_Test_LedToggleNoIT (uint8_t cycle);
+void GPIO_Test_LedToggleEvLoop (uint8_t cycle);
 void GPIO_Test_LedToggleByButton (void);
 void GPIO_Test_LedToggleByButtonIT (void);
 void GPIO_Test_ClockOut (void);
+void GPIO_Test_DmaPatternAndSample (uint32_t period);
+void GPIO_Test_CaptureBenchmark (uint32_t period);
+void GPIO_Test_SnapshotRestore (void);
 
 
 #endif /* GPIO_TEST_H_ */
@@ -0,0 +1,45 @@
+/** @file i2c_test.h
+*
+* @brief I2C master register read / block read test flows.
+*
+*/
+
+#ifndef I2C_TEST_H_
+#define I2C_TEST_H_
+
+#include <stdio.h>
+
+#include "mcu_STM32F446xx.h"
+#include "i2c.h"
+#include "gpio.h"
+#include "nvic.h"
+#include "clock.h"
+#include "timebase.h"
+
+// === Type Definitions ===
+//
+
+
+// === Constant Definitions ===
+//
+#define I2C_TEST_EEPROM_ADDR		0x50		// 24xx256 EEPROM, A2..A0 tied low
+#define I2C_TEST_BLOCK_SIZE			256U		// Sequential read per block
+#define I2C_TEST_DMA_THRESHOLD		16U			// Phases from this length on use DMA
+#define I2C_TEST_TIMEOUT_US			100000U		// Per transaction, far above the 23 ms of a block at 100 kHz
+#define I2C_TEST_IMU_ADDR			0x68		// MPU-6050 style IMU, optional: a NACK keeps the batch going
+
+
+// === Macros ===
+//
+#define NUM_OF(x)					(sizeof(x) / sizeof(*x))
+
+
+// === Public API Functions ===
+//
+void I2C_Test_EepromBenchmark (uint16_t cycle);
+void I2C_Test_BatchPoll (uint16_t cycle);
+
+
+#endif /* I2C_TEST_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,45 @@
+/** @file irq_test.h
+*
+* @brief Interrupt infrastructure (vector table, NVIC) test flows.
+*
+*/
+
+#ifndef IRQ_TEST_H_
+#define IRQ_TEST_H_
+
+#include <stdio.h>
+
+#include "mcu_STM32F446xx.h"
+#include "nvic.h"
+#include "vector.h"
+#include "atomic.h"
+#include "irqprof.h"
+#include "exti.h"
+#include "sleep.h"
+#include "timebase.h"
+#include "clock.h"
+#include "pclk.h"
+
+// === Type Definitions ===
+//
+
+
+// === Constant Definitions ===
+//
+
+
+// === Macros ===
+//
+
+
+// === Public API Functions ===
+//
+void IRQ_Test_VectorEntry (uint16_t cycle);
+void IRQ_Test_Atomics (void);
+void IRQ_Test_Profiler (uint16_t cycle);
+void IRQ_Test_SleepWakeLatency (uint16_t cycle);
+
+
+#endif /* IRQ_TEST_H_ */
+
+/*** EOF ***/
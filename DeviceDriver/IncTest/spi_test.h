@@ -13,6 +13,12 @@
 #include "mcu_STM32F446xx.h"
 #include "gpio.h"
 #include "spi.h"
+#include "nvic.h"
+#include "defer.h"
+#include "evloop.h"
+#include "timebase.h"
+#include "irqprof.h"
+#include "clock.h"
 
 // === Type Definitions ===
 //
@@ -21,6 +27,7 @@
 
 // === Constant Definitions ===
 //
+#define SPI_TEST_SCLK_MAX_HZ		2000000U	// Arduino slave: PCLK2 / 8 at the reset clock
 
 
 // === Macros ===
@@ -33,6 +40,8 @@ void SPI_Test_SendData (uint16_t cycle);
 void SPI_Test_ReceiveData (uint16_t cycle);
 void SPI_Test_SendDataIT (uint16_t cycle);
 void SPI_Test_ReceiveDataIT (void);
+void SPI_Test_DeferredEvents (uint16_t cycle);
+void SPI_Test_SendDataEvLoop (uint16_t cycle);
 
 #endif /* SPI_TEST_H_ */
 
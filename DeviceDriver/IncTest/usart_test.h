@@ -0,0 +1,45 @@
+/** @file usart_test.h
+*
+* @brief USART DMA reception / transmission test flows.
+*
+*/
+
+#ifndef USART_TEST_H_
+#define USART_TEST_H_
+
+#include <stdio.h>
+
+#include "mcu_STM32F446xx.h"
+#include "usart.h"
+#include "console.h"
+#include "gpio.h"
+#include "nvic.h"
+#include "clock.h"
+#include "timebase.h"
+
+// === Type Definitions ===
+//
+
+
+// === Constant Definitions ===
+//
+#define USART_TEST_BLOCK_SIZE		4096U		// Bytes per DMA transmission
+#define USART_TEST_RING_SIZE		1024U		// RX ring, power of two
+#define USART_TEST_TIMEOUT_US		100000U		// Per block, far above the 20 ms of 4 KB at 2 Mbaud
+#define USART_TEST_CONSOLE_BAUD		115200U		// ST-LINK virtual COM port
+
+
+// === Macros ===
+//
+#define NUM_OF(x)					(sizeof(x) / sizeof(*x))
+
+
+// === Public API Functions ===
+//
+void USART_Test_LoopbackBenchmark (uint16_t cycle);
+void USART_Test_ConsoleLatency (void);
+
+
+#endif /* USART_TEST_H_ */
+
+/*** EOF ***/
@@ -0,0 +1,1046 @@
+/** @file clock.c
+*
+* @brief Clock tree configuration (HSI/HSE, main PLL, over-drive, flash accelerator).
+*
+* A profile is a declarative description of the clock tree. CLOCK_Plan turns it into register words
+* and frequencies and checks every limit without touching the hardware, so a profile can be verified
+* off-target against a register model. CLOCK_Apply then programs a plan in a fixed, safe order:
+* SYSCLK falls back to HSI, the PLL and the regulator are reconfigured, the flash wait states are raised
+* before the clock goes up (or lowered after it went down), and the timebase is rescaled.
+*
+* The frequency queries decode RCC CFGR and PLLCFGR once and serve the cached result until the next
+* reconfiguration, so drivers can derive their prescalers from the real input clock at no cost.
+*
+* CLOCK_Switch moves between named profiles at runtime. Registered drivers are called before the change,
+* to let their transfers end on the old clock, and after it, to recompute their prescalers. The switch
+* latency is measured on the cycle counter phase by phase, each phase scaled with the HCLK it ran on.
+*
+*/
+
+#include <stddef.h>
+#include "clock.h"
+#include "timebase.h"
+#include "pclk.h"
+
+
+// === Private Variables ===
+//
+static CLOCK_Freq_t Freq;
+static uint8_t FreqValid;
+static uint32_t HseHz = CLOCK_HSE_DEFAULT_HZ;
+static CLOCK_Notifier_t *p_NotifierList;		// Thread mode only
+static const CLOCK_Profile_t *p_CurrentProfile = &CLOCK_Profile_HSI16;
+static CLOCK_SwitchStat_t SwitchStat;
+static uint32_t ApplyUs;						// Duration of the last successful CLOCK_Apply
+
+
+// === Built-in Profiles ===
+//
+const CLOCK_Profile_t CLOCK_Profile_HSI16 =
+{
+	.p_Name = "HSI 16 MHz",
+	.source = CLOCK_SOURCE_HSI,
+	.usePll = RESET,
+	.ahbDiv = 1,
+	.apb1Div = 1,
+	.apb2Div = 1,
+	.flashAccel = ENABLE,
+};
+
+const CLOCK_Profile_t CLOCK_Profile_HSI180 =
+{
+	.p_Name = "HSI PLL 180 MHz",
+	.source = CLOCK_SOURCE_HSI,
+	.usePll = SET,
+	.pllM = 8,						// 2 MHz VCO input
+	.pllN = 180,					// 360 MHz VCO output
+	.pllP = 2,
+	.pllQ = 8,
+	.ahbDiv = 1,
+	.apb1Div = 4,					// 45 MHz
+	.apb2Div = 2,					// 90 MHz
+	.flashAccel = ENABLE,
+};
+
+const CLOCK_Profile_t CLOCK_Profile_HSE180 =
+{
+	.p_Name = "HSE PLL 180 MHz",
+	.source = CLOCK_SOURCE_HSE_BYPASS,
+	.hseHz = 8000000,
+	.usePll = SET,
+	.pllM = 4,
+	.pllN = 180,
+	.pllP = 2,
+	.pllQ = 8,
+	.ahbDiv = 1,
+	.apb1Div = 4,
+	.apb2Div = 2,
+	.flashAccel = ENABLE,
+};
+
+const CLOCK_Profile_t CLOCK_Profile_HSI84 =
+{
+	.p_Name = "HSI PLL 84 MHz",
+	.source = CLOCK_SOURCE_HSI,
+	.usePll = SET,
+	.pllM = 8,						// 2 MHz VCO input
+	.pllN = 168,					// 336 MHz VCO output
+	.pllP = 4,
+	.pllQ = 7,						// 48 MHz
+	.ahbDiv = 1,
+	.apb1Div = 2,					// 42 MHz
+	.apb2Div = 1,					// 84 MHz
+	.flashAccel = ENABLE,
+};
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- EncodeAhb
+ *
+ * @brief 		- CFGR HPRE code of an AHB divider
+ *
+ * @param[in]	- div: 1, 2, 4, 8, 16, 64, 128, 256 or 512
+ * @param[out]	- none
+ *
+ * @return 		- Field value, 0xFF if the divider does not exist
+ *
+ * @note		- There is no /32
+*/
+static uint8_t EncodeAhb (uint16_t div)
+{
+	switch (div)
+	{
+		case 1:		return 0x0;
+		case 2:		return 0x8;
+		case 4:		return 0x9;
+		case 8:		return 0xA;
+		case 16:	return 0xB;
+		case 64:	return 0xC;
+		case 128:	return 0xD;
+		case 256:	return 0xE;
+		case 512:	return 0xF;
+		default:	return 0xFF;
+	}
+}
+
+/*!
+ * @fn			- EncodeApb
+ *
+ * @brief 		- CFGR PPREx code of an APB divider
+ *
+ * @param[in]	- div: 1, 2, 4, 8 or 16
+ * @param[out]	- none
+ *
+ * @return 		- Field value, 0xFF if the divider does not exist
+ *
+ * @note		- none
+*/
+static uint8_t EncodeApb (uint8_t div)
+{
+	switch (div)
+	{
+		case 1:		return 0x0;
+		case 2:		return 0x4;
+		case 4:		return 0x5;
+		case 8:		return 0x6;
+		case 16:	return 0x7;
+		default:	return 0xFF;
+	}
+}
+
+/*!
+ * @fn			- DecodeAhb
+ *
+ * @brief 		- AHB divider of a CFGR HPRE code
+ *
+ * @param[in]	- hpre: field value
+ * @param[out]	- none
+ *
+ * @return 		- Divider
+ *
+ * @note		- none
+*/
+static uint16_t DecodeAhb (uint8_t hpre)
+{
+	static const uint16_t Divider[8] = { 2, 4, 8, 16, 64, 128, 256, 512 };
+
+	return (hpre & 0x8) ? Divider[hpre & 0x7] : 1;
+}
+
+/*!
+ * @fn			- DecodeApb
+ *
+ * @brief 		- APB divider of a CFGR PPREx code
+ *
+ * @param[in]	- ppre: field value
+ * @param[out]	- none
+ *
+ * @return 		- Divider
+ *
+ * @note		- none
+*/
+static uint8_t DecodeApb (uint8_t ppre)
+{
+	return (ppre & 0x4) ? (2 << (ppre & 0x3)) : 1;
+}
+
+/*!
+ * @fn			- TimerClock
+ *
+ * @brief 		- Timer kernel clock of an APB domain
+ *
+ * @param[in]	- pclkHz: APB clock
+ * @param[in]	- apbDiv: APB divider
+ *
+ * @return 		- Hz
+ *
+ * @note		- TIMPRE = 0: x1 with APB /1, x2 otherwise. TIMPRE = 1: HCLK up to APB /4, x4 otherwise.
+*/
+static uint32_t TimerClock (uint32_t pclkHz, uint8_t apbDiv)
+{
+	if (RCC->DCKCFGR & (1 << RCC_DCKCFGRREG_TIMPRE))
+	{
+		return (apbDiv <= 4) ? (pclkHz * apbDiv) : (pclkHz * 4);
+	}
+
+	return (1 == apbDiv) ? pclkHz : (pclkHz * 2);
+}
+
+/*!
+ * @fn			- CyclesToUs
+ *
+ * @brief 		- Converts cycle counter ticks taken at a given HCLK to microseconds
+ *
+ * @param[in]	- cycles: DWT CYCCNT difference
+ * @param[in]	- hclkHz: core clock during the measurement
+ *
+ * @return 		- Microseconds
+ *
+ * @note		- none
+*/
+static uint32_t CyclesToUs (uint32_t cycles, uint32_t hclkHz)
+{
+	return (hclkHz >= 1000000U) ? (cycles / (hclkHz / 1000000U)) : 0;
+}
+
+/*!
+ * @fn			- Notify
+ *
+ * @brief 		- Calls every registered driver
+ *
+ * @param[in]	- event: @CLOCK_EVENT
+ * @param[in]	- *p_Freq: frequencies handed over to the drivers
+ *
+ * @return 		- none
+ *
+ * @note		- Registration order
+*/
+static void Notify (uint8_t event, const CLOCK_Freq_t *p_Freq)
+{
+	for (CLOCK_Notifier_t *p_Notifier = p_NotifierList; NULL != p_Notifier; p_Notifier = p_Notifier->p_Next)
+	{
+		p_Notifier->callback(p_Notifier->p_Context, event, p_Freq);
+	}
+}
+
+/*!
+ * @fn			- WaitFlag
+ *
+ * @brief 		- Waits for a single bit of a clock register
+ *
+ * @param[in]	- *p_Reg: register
+ * @param[in]	- bit: bit position
+ * @param[in]	- state: SET or RESET
+ *
+ * @return 		- SET: reached, RESET: timed out
+ *
+ * @note		- none
+*/
+static uint8_t WaitFlag (volatile uint32_t *p_Reg, uint8_t bit, uint8_t state)
+{
+	return TIMEBASE_WaitBits(p_Reg, (1 << bit), state ? (1 << bit) : 0, CLOCK_TIMEOUT_READY_US);
+}
+
+/*!
+ * @fn			- SwitchSysclk
+ *
+ * @brief 		- Selects the SYSCLK source and waits until the switch is done
+ *
+ * @param[in]	- sysclkSource: @RCC_SYSCLK_SOURCE
+ * @param[out]	- none
+ *
+ * @return 		- SET: switched, RESET: timed out
+ *
+ * @note		- The source must be ready
+*/
+static uint8_t SwitchSysclk (uint8_t sysclkSource)
+{
+	RCC->CFGR = (RCC->CFGR & ~(0x3 << RCC_CFGRREG_SW)) | (sysclkSource << RCC_CFGRREG_SW);
+
+	return TIMEBASE_WaitBits(&RCC->CFGR, (0x3 << RCC_CFGRREG_SWS), (sysclkSource << RCC_CFGRREG_SWS), CLOCK_TIMEOUT_READY_US);
+}
+
+/*!
+ * @fn			- SetFlashLatency
+ *
+ * @brief 		- Writes the flash wait states and checks that they are taken
+ *
+ * @param[in]	- latency: wait states
+ * @param[out]	- none
+ *
+ * @return 		- SET: taken, RESET: the read-back differs
+ *
+ * @note		- The accelerator bits are kept
+*/
+static uint8_t SetFlashLatency (uint32_t latency)
+{
+	FLASH->ACR = (FLASH->ACR & ~(0xF << FLASH_ACRREG_LATENCY)) | (latency << FLASH_ACRREG_LATENCY);
+
+	return (((FLASH->ACR >> FLASH_ACRREG_LATENCY) & 0xF) == latency) ? SET : RESET;
+}
+
+/*!
+ * @fn			- SetFlashAccelerator
+ *
+ * @brief 		- Enables or disables the ART prefetch and the caches
+ *
+ * @param[in]	- acr: accelerator bits of the plan
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The caches are flushed while disabled, so no stale line survives a re-enable
+*/
+static void SetFlashAccelerator (uint32_t acr)
+{
+	uint32_t accelMask = (1 << FLASH_ACRREG_PRFTEN) | (1 << FLASH_ACRREG_ICEN) | (1 << FLASH_ACRREG_DCEN);
+	uint32_t latency = FLASH->ACR & (0xF << FLASH_ACRREG_LATENCY);
+
+	if ((FLASH->ACR & accelMask) == (acr & accelMask))
+	{
+		return;
+	}
+
+	FLASH->ACR = latency;
+	FLASH->ACR = latency | (1 << FLASH_ACRREG_ICRST) | (1 << FLASH_ACRREG_DCRST);
+	FLASH->ACR = latency | (acr & accelMask);
+}
+
+/*!
+ * @fn			- StartHse
+ *
+ * @brief 		- Starts the HSE oscillator in crystal or bypass mode
+ *
+ * @param[in]	- source: CLOCK_SOURCE_HSE or CLOCK_SOURCE_HSE_BYPASS
+ * @param[out]	- none
+ *
+ * @return 		- SET: ready, RESET: timed out
+ *
+ * @note		- HSEBYP can only change while HSE is off
+*/
+static uint8_t StartHse (uint8_t source)
+{
+	uint8_t bypass = (CLOCK_SOURCE_HSE_BYPASS == source) ? SET : RESET;
+
+	if ((RCC->CR & (1 << RCC_CRREG_HSEON)) && (((RCC->CR >> RCC_CRREG_HSEBYP) & 1) != bypass))
+	{
+		RCC->CR &= ~(1 << RCC_CRREG_HSEON);
+		WaitFlag(&RCC->CR, RCC_CRREG_HSERDY, RESET);
+	}
+
+	if (bypass)
+	{
+		RCC->CR |= (1 << RCC_CRREG_HSEBYP);
+	}
+	else
+	{
+		RCC->CR &= ~(1 << RCC_CRREG_HSEBYP);
+	}
+	RCC->CR |= (1 << RCC_CRREG_HSEON);
+
+	return TIMEBASE_WaitBits(&RCC->CR, (1 << RCC_CRREG_HSERDY), (1 << RCC_CRREG_HSERDY), CLOCK_TIMEOUT_HSE_US);
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- CLOCK_Plan
+ *
+ * @brief 		- Checks a profile and computes its register words and frequencies
+ *
+ * @param[in]	- *p_Profile: clock profile
+ * @param[out]	- *p_Plan: register words and resulting frequencies
+ *
+ * @return 		- @CLOCK_STATUS
+ *
+ * @note		- Pure function, no register access
+*/
+uint8_t CLOCK_Plan (const CLOCK_Profile_t *p_Profile, CLOCK_Plan_t *p_Plan)
+{
+	uint32_t sourceHz;
+
+	// 1. Oscillator
+	switch (p_Profile->source)
+	{
+		case CLOCK_SOURCE_HSI:
+			sourceHz = CLOCK_HSI_HZ;
+			break;
+
+		case CLOCK_SOURCE_HSE:
+			if ((p_Profile->hseHz < 4000000) || (p_Profile->hseHz > 26000000))
+			{
+				return CLOCK_ERR_PARAM;
+			}
+			sourceHz = p_Profile->hseHz;
+			break;
+
+		case CLOCK_SOURCE_HSE_BYPASS:
+			if ((p_Profile->hseHz < 1000000) || (p_Profile->hseHz > 50000000))
+			{
+				return CLOCK_ERR_PARAM;
+			}
+			sourceHz = p_Profile->hseHz;
+			break;
+
+		default:
+			return CLOCK_ERR_PARAM;
+	}
+
+	p_Plan->source = p_Profile->source;
+	p_Plan->hseHz = (CLOCK_SOURCE_HSI == p_Profile->source) ? 0 : sourceHz;
+	p_Plan->pllcfgr = 0;
+
+	// 2. SYSCLK, directly or through the PLL
+	if (p_Profile->usePll)
+	{
+		if ((p_Profile->pllM < 2) || (p_Profile->pllM > 63) ||
+			(p_Profile->pllN < 50) || (p_Profile->pllN > 432) ||
+			(p_Profile->pllP < 2) || (p_Profile->pllP > 8) || (p_Profile->pllP & 1) ||
+			(p_Profile->pllQ < 2) || (p_Profile->pllQ > 15))
+		{
+			return CLOCK_ERR_PARAM;
+		}
+
+		uint32_t vcoIn = sourceHz / p_Profile->pllM;
+		uint32_t vcoOut = (uint32_t)(((uint64_t)sourceHz * p_Profile->pllN) / p_Profile->pllM);
+		if ((vcoIn < CLOCK_VCO_IN_MIN) || (vcoIn > CLOCK_VCO_IN_MAX) ||
+			(vcoOut < CLOCK_VCO_OUT_MIN) || (vcoOut > CLOCK_VCO_OUT_MAX))
+		{
+			return CLOCK_ERR_VCO;
+		}
+
+		p_Plan->sysclkHz = vcoOut / p_Profile->pllP;
+		p_Plan->sysclkSource = RCC_SYSCLK_PLLP;
+		p_Plan->pllcfgr = (p_Profile->pllM << RCC_PLLCFGRREG_PLLM) |
+						  (p_Profile->pllN << RCC_PLLCFGRREG_PLLN) |
+						  (((p_Profile->pllP / 2) - 1) << RCC_PLLCFGRREG_PLLP) |
+						  ((CLOCK_SOURCE_HSI != p_Profile->source) << RCC_PLLCFGRREG_PLLSRC) |
+						  (p_Profile->pllQ << RCC_PLLCFGRREG_PLLQ) |
+						  (2u << RCC_PLLCFGRREG_PLLR);						// Reset value, R output unused
+	}
+	else
+	{
+		p_Plan->sysclkHz = sourceHz;
+		p_Plan->sysclkSource = (CLOCK_SOURCE_HSI == p_Profile->source) ? RCC_SYSCLK_HSI : RCC_SYSCLK_HSE;
+	}
+
+	// 3. Bus prescalers
+	uint8_t hpre = EncodeAhb(p_Profile->ahbDiv);
+	uint8_t ppre1 = EncodeApb(p_Profile->apb1Div);
+	uint8_t ppre2 = EncodeApb(p_Profile->apb2Div);
+	if ((0xFF == hpre) || (0xFF == ppre1) || (0xFF == ppre2))
+	{
+		return CLOCK_ERR_PARAM;
+	}
+
+	p_Plan->hclkHz = p_Plan->sysclkHz / p_Profile->ahbDiv;
+	p_Plan->pclk1Hz = p_Plan->hclkHz / p_Profile->apb1Div;
+	p_Plan->pclk2Hz = p_Plan->hclkHz / p_Profile->apb2Div;
+	p_Plan->cfgr = (hpre << RCC_CFGRREG_HPRE) | (ppre1 << RCC_CFGRREG_PPRE1) | (ppre2 << RCC_CFGRREG_PPRE2);
+
+	if ((p_Plan->sysclkHz > CLOCK_SYSCLK_MAX) || (p_Plan->pclk1Hz > CLOCK_PCLK1_MAX) || (p_Plan->pclk2Hz > CLOCK_PCLK2_MAX))
+	{
+		return CLOCK_ERR_LIMIT;
+	}
+
+	// 4. Regulator: the lowest scale which carries HCLK
+	p_Plan->overdrive = (p_Plan->hclkHz > CLOCK_SYSCLK_MAX_NO_OD) ? SET : RESET;
+	if (p_Plan->hclkHz <= CLOCK_SCALE3_MAX)
+	{
+		p_Plan->vos = 1;
+	}
+	else if (p_Plan->hclkHz <= CLOCK_SCALE2_MAX)
+	{
+		p_Plan->vos = 2;
+	}
+	else
+	{
+		p_Plan->vos = 3;
+	}
+
+	// 5. Flash wait states and accelerator
+	p_Plan->acr = (p_Plan->hclkHz ? ((p_Plan->hclkHz - 1) / CLOCK_FLASH_WS_HZ) : 0) << FLASH_ACRREG_LATENCY;
+	if (ENABLE == p_Profile->flashAccel)
+	{
+		p_Plan->acr |= (1 << FLASH_ACRREG_PRFTEN) | (1 << FLASH_ACRREG_ICEN) | (1 << FLASH_ACRREG_DCEN);
+	}
+
+	return CLOCK_OK;
+}
+
+/*!
+ * @fn			- CLOCK_Apply
+ *
+ * @brief 		- Programs a plan
+ *
+ * @param[in]	- *p_Plan: output of CLOCK_Plan
+ * @param[out]	- none
+ *
+ * @return 		- @CLOCK_STATUS, SYSCLK stays on HSI after a failure (the cached frequencies are stale
+ * 				  then: call CLOCK_Refresh)
+ *
+ * @note		- Peripherals see the frequency change: stop the transfers which depend on it first, or
+ * 				  use CLOCK_Switch. The PLL and VOS can only be changed with the PLL off, so SYSCLK runs
+ * 				  from HSI meanwhile.
+*/
+uint8_t CLOCK_Apply (const CLOCK_Plan_t *p_Plan)
+{
+	uint32_t latency = (p_Plan->acr >> FLASH_ACRREG_LATENCY) & 0xF;
+	uint32_t prescalerMask = (0xF << RCC_CFGRREG_HPRE) | (0x7 << RCC_CFGRREG_PPRE1) | (0x7 << RCC_CFGRREG_PPRE2);
+	uint32_t hsiHclkHz = CLOCK_HSI_HZ / DecodeAhb((RCC->CFGR >> RCC_CFGRREG_HPRE) & 0xF);
+	uint32_t oldHclkHz = CLOCK_GetHclk();
+	uint32_t mark = DWT_CYCCNT();
+	uint32_t us;
+
+	// The clock driver holds one reference on the PWR interface for good
+	if (!PCLK_GetCount(&RCC->APB1ENR, RCC_APB1ENRREG_PWREN))
+	{
+		PCLK_Control(&RCC->APB1ENR, RCC_APB1ENRREG_PWREN, ENABLE);
+	}
+
+	// 1. Fall back to HSI: the current wait states cover it
+	RCC->CR |= (1 << RCC_CRREG_HSION);
+	if (!WaitFlag(&RCC->CR, RCC_CRREG_HSIRDY, SET) || !SwitchSysclk(RCC_SYSCLK_HSI))
+	{
+		return CLOCK_ERR_SWITCH;
+	}
+	us = CyclesToUs(DWT_CYCCNT() - mark, oldHclkHz);
+	mark = DWT_CYCCNT();
+
+	// 2. PLL and over-drive off (over-drive switching first, then over-drive)
+	RCC->CR &= ~(1 << RCC_CRREG_PLLON);
+	PWR->CR &= ~(1 << PWR_CRREG_ODSWEN);
+	PWR->CR &= ~(1 << PWR_CRREG_ODEN);
+	if (!WaitFlag(&RCC->CR, RCC_CRREG_PLLRDY, RESET))
+	{
+		return CLOCK_ERR_PLL;
+	}
+
+	// 3. Oscillator
+	if ((CLOCK_SOURCE_HSI != p_Plan->source) && !StartHse(p_Plan->source))
+	{
+		return CLOCK_ERR_SOURCE;
+	}
+
+	// 4. Regulator scale (taken when the PLL starts), PLL, over-drive
+	PWR->CR = (PWR->CR & ~(0x3 << PWR_CRREG_VOS)) | (p_Plan->vos << PWR_CRREG_VOS);
+
+	if (RCC_SYSCLK_PLLP == p_Plan->sysclkSource)
+	{
+		RCC->PLLCFGR = p_Plan->pllcfgr;
+		RCC->CR |= (1 << RCC_CRREG_PLLON);
+		if (!WaitFlag(&RCC->CR, RCC_CRREG_PLLRDY, SET))
+		{
+			return CLOCK_ERR_PLL;
+		}
+
+		if (p_Plan->overdrive)
+		{
+			PWR->CR |= (1 << PWR_CRREG_ODEN);
+			if (!WaitFlag(&PWR->CSR, PWR_CSRREG_ODRDY, SET))
+			{
+				return CLOCK_ERR_REGULATOR;
+			}
+			PWR->CR |= (1 << PWR_CRREG_ODSWEN);
+			if (!WaitFlag(&PWR->CSR, PWR_CSRREG_ODSWRDY, SET))
+			{
+				return CLOCK_ERR_REGULATOR;
+			}
+		}
+
+		if (!WaitFlag(&PWR->CSR, PWR_CSRREG_VOSRDY, SET))
+		{
+			return CLOCK_ERR_REGULATOR;
+		}
+	}
+
+	// 5. Wait states up before the clock goes up
+	if ((latency > ((FLASH->ACR >> FLASH_ACRREG_LATENCY) & 0xF)) && !SetFlashLatency(latency))
+	{
+		return CLOCK_ERR_SWITCH;
+	}
+
+	// 6. Prescalers (harmless on HSI), then the switch
+	RCC->CFGR = (RCC->CFGR & ~prescalerMask) | (p_Plan->cfgr & prescalerMask);
+	if (!SwitchSysclk(p_Plan->sysclkSource))
+	{
+		return CLOCK_ERR_SWITCH;
+	}
+	us += CyclesToUs(DWT_CYCCNT() - mark, hsiHclkHz);
+	mark = DWT_CYCCNT();
+
+	// 7. Wait states down once the clock went down
+	if ((latency < ((FLASH->ACR >> FLASH_ACRREG_LATENCY) & 0xF)) && !SetFlashLatency(latency))
+	{
+		return CLOCK_ERR_SWITCH;
+	}
+
+	SetFlashAccelerator(p_Plan->acr);
+
+	// 8. Unused oscillator off, timebase rescaled
+	if (CLOCK_SOURCE_HSI == p_Plan->source)
+	{
+		RCC->CR &= ~(1 << RCC_CRREG_HSEON);
+	}
+
+	if (p_Plan->hseHz)
+	{
+		HseHz = p_Plan->hseHz;
+	}
+	CLOCK_Refresh();
+	TIMEBASE_SetClock(Freq.hclkHz);
+	ApplyUs = us + CyclesToUs(DWT_CYCCNT() - mark, Freq.hclkHz);
+
+	return CLOCK_OK;
+}
+
+/*!
+ * @fn			- CLOCK_Configure
+ *
+ * @brief 		- Plans and applies a profile
+ *
+ * @param[in]	- *p_Profile: clock profile
+ * @param[out]	- none
+ *
+ * @return 		- @CLOCK_STATUS, nothing is changed if the profile is invalid
+ *
+ * @note		- The registered drivers are not notified, see CLOCK_Switch
+*/
+uint8_t CLOCK_Configure (const CLOCK_Profile_t *p_Profile)
+{
+	CLOCK_Plan_t plan;
+	uint8_t status = CLOCK_Plan(p_Profile, &plan);
+
+	if (CLOCK_OK != status)
+	{
+		return status;
+	}
+
+	status = CLOCK_Apply(&plan);
+	p_CurrentProfile = (CLOCK_OK == status) ? p_Profile : NULL;
+
+	return status;
+}
+
+/*!
+ * @fn			- CLOCK_Refresh
+ *
+ * @brief 		- Decodes the clock tree from the RCC registers into the cache
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Called by CLOCK_Apply. Call it after changing RCC CFGR/PLLCFGR by other means.
+ * 				  The HSE frequency is the one of the last applied HSE profile (CLOCK_HSE_DEFAULT_HZ before).
+*/
+void CLOCK_Refresh (void)
+{
+	uint32_t cfgr = RCC->CFGR;
+	uint32_t pllcfgr = RCC->PLLCFGR;
+	uint8_t apb1Div = DecodeApb((cfgr >> RCC_CFGRREG_PPRE1) & 0x7);
+	uint8_t apb2Div = DecodeApb((cfgr >> RCC_CFGRREG_PPRE2) & 0x7);
+
+	switch ((cfgr >> RCC_CFGRREG_SWS) & 0x3)
+	{
+		case RCC_SYSCLK_HSE:
+			Freq.sysclkHz = HseHz;
+			break;
+
+		case RCC_SYSCLK_PLLP:
+		case RCC_SYSCLK_PLLR:
+		{
+			uint32_t pllIn = (pllcfgr & (1 << RCC_PLLCFGRREG_PLLSRC)) ? HseHz : CLOCK_HSI_HZ;
+			uint32_t pllM = (pllcfgr >> RCC_PLLCFGRREG_PLLM) & 0x3F;
+			uint32_t pllN = (pllcfgr >> RCC_PLLCFGRREG_PLLN) & 0x1FF;
+			uint32_t vcoHz = pllM ? (uint32_t)(((uint64_t)pllIn * pllN) / pllM) : 0;
+			uint32_t outDiv = (RCC_SYSCLK_PLLP == ((cfgr >> RCC_CFGRREG_SWS) & 0x3)) ?
+							  ((((pllcfgr >> RCC_PLLCFGRREG_PLLP) & 0x3) + 1) * 2) :
+							  ((pllcfgr >> RCC_PLLCFGRREG_PLLR) & 0x7);
+			Freq.sysclkHz = outDiv ? (vcoHz / outDiv) : 0;
+			break;
+		}
+
+		default:
+			Freq.sysclkHz = CLOCK_HSI_HZ;
+			break;
+	}
+
+	Freq.hclkHz = Freq.sysclkHz / DecodeAhb((cfgr >> RCC_CFGRREG_HPRE) & 0xF);
+	Freq.pclk1Hz = Freq.hclkHz / apb1Div;
+	Freq.pclk2Hz = Freq.hclkHz / apb2Div;
+	Freq.timclk1Hz = TimerClock(Freq.pclk1Hz, apb1Div);
+	Freq.timclk2Hz = TimerClock(Freq.pclk2Hz, apb2Div);
+	FreqValid = SET;
+}
+
+/*!
+ * @fn			- CLOCK_GetFrequencies
+ *
+ * @brief 		- Copies every clock of the tree
+ *
+ * @param[out]	- *p_Freq: frequencies
+ * @param[in]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void CLOCK_GetFrequencies (CLOCK_Freq_t *p_Freq)
+{
+	if (!FreqValid)
+	{
+		CLOCK_Refresh();
+	}
+
+	*p_Freq = Freq;
+}
+
+/*!
+ * @fn			- CLOCK_GetSysclk
+ *
+ * @brief 		- SYSCLK frequency
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Hz
+ *
+ * @note		- none
+*/
+uint32_t CLOCK_GetSysclk (void)
+{
+	if (!FreqValid)
+	{
+		CLOCK_Refresh();
+	}
+
+	return Freq.sysclkHz;
+}
+
+/*!
+ * @fn			- CLOCK_GetHclk
+ *
+ * @brief 		- HCLK (core, AHB) frequency
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Hz
+ *
+ * @note		- none
+*/
+uint32_t CLOCK_GetHclk (void)
+{
+	if (!FreqValid)
+	{
+		CLOCK_Refresh();
+	}
+
+	return Freq.hclkHz;
+}
+
+/*!
+ * @fn			- CLOCK_GetPclk1
+ *
+ * @brief 		- APB1 frequency
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Hz
+ *
+ * @note		- none
+*/
+uint32_t CLOCK_GetPclk1 (void)
+{
+	if (!FreqValid)
+	{
+		CLOCK_Refresh();
+	}
+
+	return Freq.pclk1Hz;
+}
+
+/*!
+ * @fn			- CLOCK_GetPclk2
+ *
+ * @brief 		- APB2 frequency
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Hz
+ *
+ * @note		- none
+*/
+uint32_t CLOCK_GetPclk2 (void)
+{
+	if (!FreqValid)
+	{
+		CLOCK_Refresh();
+	}
+
+	return Freq.pclk2Hz;
+}
+
+/*!
+ * @fn			- CLOCK_GetTimerClk1
+ *
+ * @brief 		- Kernel clock of the APB1 timers
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Hz
+ *
+ * @note		- none
+*/
+uint32_t CLOCK_GetTimerClk1 (void)
+{
+	if (!FreqValid)
+	{
+		CLOCK_Refresh();
+	}
+
+	return Freq.timclk1Hz;
+}
+
+/*!
+ * @fn			- CLOCK_GetTimerClk2
+ *
+ * @brief 		- Kernel clock of the APB2 timers
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Hz
+ *
+ * @note		- none
+*/
+uint32_t CLOCK_GetTimerClk2 (void)
+{
+	if (!FreqValid)
+	{
+		CLOCK_Refresh();
+	}
+
+	return Freq.timclk2Hz;
+}
+
+/*!
+ * @fn			- CLOCK_GetBusClock
+ *
+ * @brief 		- Input clock of a peripheral, found from its RCC enable register
+ *
+ * @param[in]	- *p_ClkEnReg: RCC xxxENR register of the peripheral (PERIPH_Desc_t::p_ClkEnReg)
+ * @param[out]	- none
+ *
+ * @return 		- Hz: PCLK1, PCLK2 or HCLK
+ *
+ * @note		- none
+*/
+uint32_t CLOCK_GetBusClock (volatile uint32_t *p_ClkEnReg)
+{
+	if (&RCC->APB1ENR == p_ClkEnReg)
+	{
+		return CLOCK_GetPclk1();
+	}
+	else if (&RCC->APB2ENR == p_ClkEnReg)
+	{
+		return CLOCK_GetPclk2();
+	}
+	else
+	{
+		return CLOCK_GetHclk();
+	}
+}
+
+/*!
+ * @fn			- CLOCK_NotifierRegister
+ *
+ * @brief 		- Registers a driver for the clock switch notifications
+ *
+ * @param[in]	- *p_Notifier: notifier, owned by the driver, must stay valid while registered
+ * @param[in]	- callback: called with @CLOCK_EVENT
+ * @param[in]	- *p_Context: handed over to the callback
+ *
+ * @return 		- none
+ *
+ * @note		- Thread mode, not from a callback. Registering a notifier again only updates it.
+*/
+void CLOCK_NotifierRegister (CLOCK_Notifier_t *p_Notifier, CLOCK_NotifyFunc_t callback, void *p_Context)
+{
+	p_Notifier->callback = callback;
+	p_Notifier->p_Context = p_Context;
+
+	for (CLOCK_Notifier_t *p_Linked = p_NotifierList; NULL != p_Linked; p_Linked = p_Linked->p_Next)
+	{
+		if (p_Linked == p_Notifier)
+		{
+			return;
+		}
+	}
+
+	p_Notifier->p_Next = p_NotifierList;
+	p_NotifierList = p_Notifier;
+}
+
+/*!
+ * @fn			- CLOCK_NotifierUnregister
+ *
+ * @brief 		- Removes a driver from the clock switch notifications
+ *
+ * @param[in]	- *p_Notifier: registered notifier
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Thread mode, not from a callback
+*/
+void CLOCK_NotifierUnregister (CLOCK_Notifier_t *p_Notifier)
+{
+	CLOCK_Notifier_t **pp_Link = &p_NotifierList;
+
+	while (NULL != *pp_Link)
+	{
+		if (*pp_Link == p_Notifier)
+		{
+			*pp_Link = p_Notifier->p_Next;
+			break;
+		}
+		pp_Link = &(*pp_Link)->p_Next;
+	}
+
+	p_Notifier->p_Next = NULL;
+}
+
+/*!
+ * @fn			- CLOCK_Switch
+ *
+ * @brief 		- Moves the clock tree to another profile and re-times the registered drivers
+ *
+ * @param[in]	- *p_Profile: clock profile, e.g. CLOCK_PROFILE_PERFORMANCE
+ * @param[out]	- none
+ *
+ * @return 		- @CLOCK_STATUS, nothing is changed (and nobody notified) if the profile is invalid
+ *
+ * @note		- Thread mode. The drivers get CLOCK_EVENT_PRE_CHANGE with the target frequencies, then
+ * 				  CLOCK_EVENT_POST_CHANGE with the running ones, even if the switch failed half-way.
+ * 				  Switching to the current profile returns at once.
+*/
+uint8_t CLOCK_Switch (const CLOCK_Profile_t *p_Profile)
+{
+	CLOCK_Plan_t plan;
+	CLOCK_Freq_t target;
+	uint8_t status;
+	uint32_t preUs, postUs, mark;
+
+	if (p_Profile == p_CurrentProfile)
+	{
+		return CLOCK_OK;
+	}
+
+	status = CLOCK_Plan(p_Profile, &plan);
+	if (CLOCK_OK != status)
+	{
+		return status;
+	}
+
+	// 1. Drivers finish on the old clock
+	target.sysclkHz = plan.sysclkHz;
+	target.hclkHz = plan.hclkHz;
+	target.pclk1Hz = plan.pclk1Hz;
+	target.pclk2Hz = plan.pclk2Hz;
+	target.timclk1Hz = TimerClock(plan.pclk1Hz, plan.hclkHz / plan.pclk1Hz);
+	target.timclk2Hz = TimerClock(plan.pclk2Hz, plan.hclkHz / plan.pclk2Hz);
+
+	mark = DWT_CYCCNT();
+	Notify(CLOCK_EVENT_PRE_CHANGE, &target);
+	preUs = CyclesToUs(DWT_CYCCNT() - mark, CLOCK_GetHclk());
+
+	// 2. Clock tree
+	ApplyUs = 0;
+	status = CLOCK_Apply(&plan);
+	if (CLOCK_OK != status)
+	{
+		CLOCK_Refresh();
+		TIMEBASE_SetClock(Freq.hclkHz);
+	}
+	p_CurrentProfile = (CLOCK_OK == status) ? p_Profile : NULL;
+
+	// 3. Drivers follow the clock which actually runs
+	mark = DWT_CYCCNT();
+	Notify(CLOCK_EVENT_POST_CHANGE, &Freq);
+	postUs = CyclesToUs(DWT_CYCCNT() - mark, Freq.hclkHz);
+
+	SwitchStat.count++;
+	SwitchStat.lastApplyUs = ApplyUs;
+	SwitchStat.lastUs = preUs + ApplyUs + postUs;
+	if (SwitchStat.lastUs > SwitchStat.maxUs)
+	{
+		SwitchStat.maxUs = SwitchStat.lastUs;
+	}
+
+	return status;
+}
+
+/*!
+ * @fn			- CLOCK_GetProfile
+ *
+ * @brief 		- Profile applied last
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Profile, NULL after a failed switch
+ *
+ * @note		- CLOCK_Profile_HSI16 after reset
+*/
+const CLOCK_Profile_t *CLOCK_GetProfile (void)
+{
+	return p_CurrentProfile;
+}
+
+/*!
+ * @fn			- CLOCK_GetSwitchStat
+ *
+ * @brief 		- Copies the switch latency statistics
+ *
+ * @param[out]	- *p_Stat: statistics
+ * @param[in]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The CLOCK_Apply part of a failed switch reads 0
+*/
+void CLOCK_GetSwitchStat (CLOCK_SwitchStat_t *p_Stat)
+{
+	*p_Stat = SwitchStat;
+}
+
+/*** EOF ***/
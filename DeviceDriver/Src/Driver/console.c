@@ -0,0 +1,336 @@
+/** @file console.c
+*
+* @brief Buffered stdout over USART TX DMA.
+*
+* _write copies into a ring and returns: the cost of a printf no longer depends on the length of the
+* message nor on the baud rate. The TX stream sends the longest contiguous part of the ring, and its
+* completion, reported by the USART ISR, frees that part and starts the next one. The producers (thread
+* and handlers up to the data level) fill the ring under a BASEPRI section at the data level, which also
+* keeps the USART ISR out, so the ring needs no lock of its own.
+*
+*/
+
+#include <stddef.h>
+#include "console.h"
+#include "atomic.h"
+#include "nvic.h"
+#include "sleep.h"
+#include "timebase.h"
+
+
+// === Private Variables ===
+//
+static USART_Handle_t *p_ConsoleUsart;			// NULL: not attached, _write falls back to ITM
+static uint8_t Buffer[CONSOLE_BUFFER_SIZE];
+static volatile uint32_t Head;					// Bytes queued, free running
+static volatile uint32_t Tail;					// Bytes sent, free running
+static volatile uint16_t InFlight;				// Bytes handed to the TX stream
+static uint8_t Policy = CONSOLE_POLICY_DROP;
+static CONSOLE_Stat_t Stat;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- Kick
+ *
+ * @brief 		- Hands the next contiguous part of the ring to the TX stream
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Called with the data level masked or from the USART ISR. A refused start (clock switch)
+ * 				  leaves the bytes queued: the USART driver calls TxDone once the switch is over.
+*/
+static void Kick (void)
+{
+	uint32_t pending = Head - Tail;
+	uint32_t offset = Tail & (CONSOLE_BUFFER_SIZE - 1);
+	uint32_t chunk = CONSOLE_BUFFER_SIZE - offset;
+
+	if ((0 != InFlight) || (0 == pending))
+	{
+		return;
+	}
+
+	if (chunk > pending)
+	{
+		chunk = pending;
+	}
+
+	if (USART_ST_READY == USART_SendDataDMA(p_ConsoleUsart, &Buffer[offset], (uint16_t)chunk))
+	{
+		InFlight = (uint16_t)chunk;
+	}
+}
+
+/*!
+ * @fn			- TxDone
+ *
+ * @brief 		- Frees the sent part of the ring and chains the next one
+ *
+ * @param[in]	- *p_Context: unused
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- USART txDone owner hook: ISR after the last stop bit, thread mode after a clock switch
+*/
+static void TxDone (void *p_Context)
+{
+	uint32_t basepri = ATOMIC_MaskEnter(NVIC_PLAN_PREEMPT_DATA);
+	(void)p_Context;
+
+	// After a timed out clock switch the stream may still run: its own completion follows
+	if (USART_ST_READY == p_ConsoleUsart->TxState)
+	{
+		Tail += InFlight;
+		InFlight = 0;
+		Kick();
+	}
+
+	ATOMIC_MaskExit(basepri);
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- CONSOLE_Init
+ *
+ * @brief 		- Attaches stdout to the transmitter of a USART
+ *
+ * @param[in]	- *p_UsartHandle: initialized USART handle with USART_MODE_TX, bound to its IRQ
+ * @param[in]	- policy: @CONSOLE_POLICY
+ *
+ * @return 		- none
+ *
+ * @note		- The console owns the transmitter from now on: USART_EVENT_TX_CMPLT is no longer raised.
+ * 				  The handle must stay valid while attached.
+*/
+void CONSOLE_Init (USART_Handle_t *p_UsartHandle, uint8_t policy)
+{
+	Head = 0;
+	Tail = 0;
+	InFlight = 0;
+	Policy = policy;
+	CONSOLE_ResetStat();
+
+	p_UsartHandle->p_TxDoneContext = NULL;
+	p_UsartHandle->txDone = TxDone;
+	ATOMIC_BARRIER();
+	p_ConsoleUsart = p_UsartHandle;
+}
+
+/*!
+ * @fn			- CONSOLE_DeInit
+ *
+ * @brief 		- Sends what is queued and gives the transmitter back to the application
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- stdout falls back to ITM
+*/
+void CONSOLE_DeInit (void)
+{
+	USART_Handle_t *p_UsartHandle = p_ConsoleUsart;
+
+	if (NULL == p_UsartHandle)
+	{
+		return;
+	}
+
+	(void)CONSOLE_Flush(CONSOLE_FLUSH_TIMEOUT_US);
+
+	p_ConsoleUsart = NULL;
+	ATOMIC_BARRIER();
+	p_UsartHandle->txDone = NULL;
+}
+
+/*!
+ * @fn			- CONSOLE_IsAttached
+ *
+ * @brief 		- Checks whether stdout goes to the USART
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- SET or RESET
+ *
+ * @note		- none
+*/
+uint8_t CONSOLE_IsAttached (void)
+{
+	return (NULL != p_ConsoleUsart) ? SET : RESET;
+}
+
+/*!
+ * @fn			- CONSOLE_SetPolicy
+ *
+ * @brief 		- Selects what a write does when the buffer is full
+ *
+ * @param[in]	- policy: @CONSOLE_POLICY
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void CONSOLE_SetPolicy (uint8_t policy)
+{
+	Policy = policy;
+}
+
+/*!
+ * @fn			- CONSOLE_Write
+ *
+ * @brief 		- Queues bytes for the USART and returns
+ *
+ * @param[in]	- *p_Data: bytes to send
+ * @param[in]	- len: number of bytes
+ *
+ * @return 		- Bytes queued, less than len if the drop policy applied
+ *
+ * @note		- Thread mode or handlers up to NVIC_PLAN_PREEMPT_DATA, never from the critical level.
+ * 				  The copy runs with the data level masked; the block policy sleeps outside of it and
+ * 				  falls back to dropping in handler mode or with interrupts masked.
+*/
+uint32_t CONSOLE_Write (const uint8_t *p_Data, uint32_t len)
+{
+	uint32_t start = DWT_CYCCNT();
+	uint32_t queued = 0;
+	uint32_t primask;
+	uint8_t canBlock;
+
+	if (NULL == p_ConsoleUsart)
+	{
+		return 0;
+	}
+
+	__asm volatile ("MRS %0, primask" : "=r" (primask));
+	canBlock = ((CONSOLE_POLICY_BLOCK == Policy) && (NVIC_NO_ACTIVE == NVIC_GetActiveIRQ()) && !primask) ? SET : RESET;
+
+	while (queued < len)
+	{
+		uint32_t basepri = ATOMIC_MaskEnter(NVIC_PLAN_PREEMPT_DATA);
+		uint32_t fill = Head - Tail;
+		uint32_t count = CONSOLE_BUFFER_SIZE - fill;
+
+		if (count > (len - queued))
+		{
+			count = len - queued;
+		}
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			Buffer[(Head + i) & (CONSOLE_BUFFER_SIZE - 1)] = p_Data[queued + i];
+		}
+		Head += count;
+		queued += count;
+
+		if ((fill + count) > Stat.highWater)
+		{
+			Stat.highWater = (uint16_t)(fill + count);
+		}
+
+		Kick();
+		ATOMIC_MaskExit(basepri);
+
+		if (queued < len)
+		{
+			if (!canBlock)
+			{
+				Stat.dropped += len - queued;
+				break;
+			}
+
+			// Every exception return sets the event register: the TX completion ends the wait
+			SLEEP_WaitForEvent();
+		}
+	}
+
+	Stat.written += queued;
+	if ((DWT_CYCCNT() - start) > Stat.maxWriteCycles)
+	{
+		Stat.maxWriteCycles = DWT_CYCCNT() - start;
+	}
+
+	return queued;
+}
+
+/*!
+ * @fn			- CONSOLE_Flush
+ *
+ * @brief 		- Waits until every queued byte has left the USART
+ *
+ * @param[in]	- timeoutUs: upper bound of the wait
+ * @param[out]	- none
+ *
+ * @return 		- SET: empty, RESET: timed out
+ *
+ * @note		- Call it before a sleep mode which stops the USART clock
+*/
+uint8_t CONSOLE_Flush (uint32_t timeoutUs)
+{
+	TIMEBASE_Timeout_t timeout;
+
+	if (NULL == p_ConsoleUsart)
+	{
+		return SET;
+	}
+
+	TIMEBASE_TimeoutStart(&timeout, timeoutUs);
+	while ((Head != Tail) || (USART_ST_READY != p_ConsoleUsart->TxState))
+	{
+		if (TIMEBASE_TimeoutExpired(&timeout))
+		{
+			return RESET;
+		}
+	}
+
+	return SET;
+}
+
+/*!
+ * @fn			- CONSOLE_GetStat
+ *
+ * @brief 		- Copies the console statistics
+ *
+ * @param[out]	- *p_Stat: statistics
+ * @param[in]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void CONSOLE_GetStat (CONSOLE_Stat_t *p_Stat)
+{
+	*p_Stat = Stat;
+}
+
+/*!
+ * @fn			- CONSOLE_ResetStat
+ *
+ * @brief 		- Clears the console statistics
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void CONSOLE_ResetStat (void)
+{
+	Stat.written = 0;
+	Stat.dropped = 0;
+	Stat.highWater = 0;
+	Stat.maxWriteCycles = 0;
+}
+
+/*** EOF ***/
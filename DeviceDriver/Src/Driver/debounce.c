@@ -0,0 +1,237 @@
+/** @file debounce.c
+*
+* @brief Timestamp-based debouncing engine for EXTI inputs.
+*
+* The first edge of a burst is timestamped in the EXTI callback and the line is masked, so the
+* bounces raise no further interrupts. DEBOUNCE_Process() samples the settled level once the
+* window is over, unmasks the line and turns level changes into press / release / long-press events.
+*
+*/
+
+#include <stddef.h>
+#include "debounce.h"
+
+
+// === Private Variables ===
+//
+typedef struct DEBOUNCE_Input
+{
+	DEBOUNCE_Config_t config;
+	volatile uint32_t edgeMs;		// Timestamp of the first edge of the burst (written by the ISR)
+	volatile uint8_t settling;		// SET by the ISR, cleared by DEBOUNCE_Process once the window is over
+	uint8_t used;
+	uint8_t pressed;				// Debounced state
+	uint8_t longSent;
+	uint32_t pressMs;
+} DEBOUNCE_Input_t;
+
+static DEBOUNCE_Input_t Inputs[DEBOUNCE_MAX_INPUTS];
+static DEBOUNCE_GetTick_t GetTick;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- EdgeCallback
+ *
+ * @brief 		- EXTI callback: stamps the first edge and masks the line for the window
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[in]	- *p_Context: pointer to the input
+ *
+ * @return 		- none
+ *
+ * @note		- ISR context, a few dozen cycles
+*/
+static void EdgeCallback (uint8_t line, void *p_Context)
+{
+	DEBOUNCE_Input_t *p_Input = (DEBOUNCE_Input_t *)p_Context;
+
+	EXTI_LineControl(line, DISABLE);
+	p_Input->edgeMs = GetTick();
+	p_Input->settling = SET;
+}
+
+/*!
+ * @fn			- IsActive
+ *
+ * @brief 		- Reads the pin and compares it with the pressed level
+ *
+ * @param[in]	- *p_Input: pointer to the input
+ * @param[out]	- none
+ *
+ * @return 		- SET: pressed, RESET: released
+ *
+ * @note		- none
+*/
+static inline uint8_t IsActive (DEBOUNCE_Input_t *p_Input)
+{
+	return (GPIO_ReadPin(p_Input->config.p_GPIOx, p_Input->config.pinNumber) == p_Input->config.activeLevel) ? SET : RESET;
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- DEBOUNCE_Init
+ *
+ * @brief 		- Initializes the engine with its millisecond time source
+ *
+ * @param[in]	- getTick: returns a free running millisecond counter
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void DEBOUNCE_Init (DEBOUNCE_GetTick_t getTick)
+{
+	GetTick = getTick;
+
+	for (uint8_t id = 0; id < DEBOUNCE_MAX_INPUTS; ++id)
+	{
+		Inputs[id].used = RESET;
+	}
+}
+
+/*!
+ * @fn			- DEBOUNCE_Add
+ *
+ * @brief 		- Puts an EXTI input under debounce control
+ *
+ * @param[in]	- *p_Config: pin, window, long-press time and event callback
+ * @param[out]	- none
+ *
+ * @return 		- Input id, DEBOUNCE_ID_INVALID if there is no free slot or no callback
+ *
+ * @note		- The pin must be initialized with GPIO_MODE_IT_FRT, only one input per EXTI line
+*/
+uint8_t DEBOUNCE_Add (const DEBOUNCE_Config_t *p_Config)
+{
+	if ((NULL == p_Config) || (NULL == p_Config->callback))
+	{
+		return DEBOUNCE_ID_INVALID;
+	}
+
+	for (uint8_t id = 0; id < DEBOUNCE_MAX_INPUTS; ++id)
+	{
+		DEBOUNCE_Input_t *p_Input = &Inputs[id];
+
+		if (!p_Input->used)
+		{
+			p_Input->config = *p_Config;
+			p_Input->used = SET;
+			p_Input->settling = RESET;
+			p_Input->longSent = RESET;
+			p_Input->pressMs = GetTick();
+			p_Input->pressed = IsActive(p_Input);
+
+			EXTI_RegisterCallback(p_Config->pinNumber, EdgeCallback, p_Input);
+
+			return id;
+		}
+	}
+
+	return DEBOUNCE_ID_INVALID;
+}
+
+/*!
+ * @fn			- DEBOUNCE_Remove
+ *
+ * @brief 		- Releases the input and its EXTI line
+ *
+ * @param[in]	- id: input id returned by DEBOUNCE_Add
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void DEBOUNCE_Remove (uint8_t id)
+{
+	if ((id < DEBOUNCE_MAX_INPUTS) && Inputs[id].used)
+	{
+		EXTI_UnregisterCallback(Inputs[id].config.pinNumber);
+		Inputs[id].used = RESET;
+	}
+}
+
+/*!
+ * @fn			- DEBOUNCE_Process
+ *
+ * @brief 		- Evaluates the settled inputs and raises the events
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Call it from the main loop or a periodic (~1 ms) timer, it never blocks.
+ * 				  The line is unmasked before the level is sampled, so an edge after the sample
+ * 				  starts a new window instead of being lost.
+*/
+void DEBOUNCE_Process (void)
+{
+	uint32_t now = GetTick();
+
+	for (uint8_t id = 0; id < DEBOUNCE_MAX_INPUTS; ++id)
+	{
+		DEBOUNCE_Input_t *p_Input = &Inputs[id];
+
+		if (!p_Input->used)
+		{
+			continue;
+		}
+
+		// 1. Window over: re-arm the line and take the settled level. The edge time is read before
+		// the line is unmasked: a new edge overwrites it from the ISR.
+		if (p_Input->settling && ((now - p_Input->edgeMs) >= p_Input->config.windowMs))
+		{
+			uint32_t edgeMs = p_Input->edgeMs;
+
+			p_Input->settling = RESET;
+			EXTI_LineControl(p_Input->config.pinNumber, ENABLE);
+
+			uint8_t active = IsActive(p_Input);
+			if (active != p_Input->pressed)
+			{
+				p_Input->pressed = active;
+
+				if (active)
+				{
+					p_Input->pressMs = edgeMs;
+					p_Input->longSent = RESET;
+				}
+
+				p_Input->config.callback(id, active ? DEBOUNCE_EVENT_PRESS : DEBOUNCE_EVENT_RELEASE, p_Input->config.p_Context);
+			}
+		}
+
+		// 2. Long press
+		if (p_Input->pressed && !p_Input->longSent && p_Input->config.longPressMs &&
+			((now - p_Input->pressMs) >= p_Input->config.longPressMs))
+		{
+			p_Input->longSent = SET;
+			p_Input->config.callback(id, DEBOUNCE_EVENT_LONG_PRESS, p_Input->config.p_Context);
+		}
+	}
+}
+
+/*!
+ * @fn			- DEBOUNCE_IsPressed
+ *
+ * @brief 		- Debounced state of the input
+ *
+ * @param[in]	- id: input id
+ * @param[out]	- none
+ *
+ * @return 		- SET: pressed, RESET: released or invalid id
+ *
+ * @note		- none
+*/
+uint8_t DEBOUNCE_IsPressed (uint8_t id)
+{
+	return ((id < DEBOUNCE_MAX_INPUTS) && Inputs[id].used) ? Inputs[id].pressed : RESET;
+}
+
+/*** EOF ***/
@@ -0,0 +1,297 @@
+/** @file defer.c
+*
+* @brief Lock-free deferred-work queue: ISRs post small records, PendSV or the main loop runs them.
+*
+* Multi-producer / single-consumer ring with a sequence number per slot. A producer reserves a slot
+* by a CAS on the head, fills it and publishes it by advancing the sequence number, so producers of
+* any priority can preempt each other without masking interrupts. The consumer stops at the first
+* unpublished slot; the producer pends PendSV again once it has published.
+*
+*/
+
+#include <stddef.h>
+#include "defer.h"
+#include "atomic.h"
+#include "sleep.h"
+
+
+// === Private Variables ===
+//
+typedef struct DEFER_Item
+{
+	DEFER_Func_t func;
+	void *p_Context;
+	uint32_t arg;
+	volatile uint32_t seq;			// == position: free, == position + 1: published
+} DEFER_Item_t;
+
+static DEFER_Item_t Ring[DEFER_QUEUE_SIZE];
+static volatile uint32_t Head;		// Next position to reserve (producers)
+static uint32_t Tail;				// Next position to run (consumer only)
+static volatile uint32_t Dropped;
+static uint16_t HighWater;
+static uint8_t Mode = DEFER_MODE_OFF;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- PendConsumer
+ *
+ * @brief 		- Requests PendSV in PendSV mode, wakes the main loop in poll mode
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- ICSR is write-1-to-set for PENDSVSET, the other bits are not affected by 0.
+ * 				  A main loop parked in sleep-on-exit is released to run DEFER_Process.
+*/
+static inline void PendConsumer (void)
+{
+	if (DEFER_MODE_PENDSV == Mode)
+	{
+		SCB->ICSR = (1 << SCB_ICSRREG_PENDSVSET);
+	}
+	else if (SLEEP_IsOnExit())
+	{
+		SLEEP_WakeMain();
+	}
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- DEFER_Init
+ *
+ * @brief 		- Empties the queue and selects the consumer
+ *
+ * @param[in]	- mode: @DEFER_MODE
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- PendSV gets the lowest priority of the plan, so the deferred work never delays an ISR
+*/
+void DEFER_Init (uint8_t mode)
+{
+	Mode = DEFER_MODE_OFF;
+
+	for (uint32_t i = 0; i < DEFER_QUEUE_SIZE; ++i)
+	{
+		Ring[i].seq = i;
+	}
+	Head = 0;
+	Tail = 0;
+	Dropped = 0;
+	HighWater = 0;
+
+	if (DEFER_MODE_PENDSV == mode)
+	{
+		NVIC_SetSystemPriority(NVIC_EXC_PENDSV, NVIC_PLAN_PREEMPT_BACKGROUND, 0xff);
+	}
+
+	ATOMIC_BARRIER();
+	Mode = mode;
+}
+
+/*!
+ * @fn			- DEFER_Post
+ *
+ * @brief 		- Queues a function call
+ *
+ * @param[in]	- func: function to be run outside interrupt context
+ * @param[in]	- *p_Context: first argument of func
+ * @param[in]	- arg: second argument of func (event code, length, ...)
+ *
+ * @return 		- SET: queued, RESET: queue full or not initialized (the caller may run it directly)
+ *
+ * @note		- Callable from any priority level, never masks interrupts
+*/
+uint8_t DEFER_Post (DEFER_Func_t func, void *p_Context, uint32_t arg)
+{
+	uint32_t pos;
+	DEFER_Item_t *p_Item;
+
+	if (DEFER_MODE_OFF == Mode)
+	{
+		return RESET;
+	}
+
+	// 1. Reserve a slot
+	while (1)
+	{
+		pos = Head;
+		p_Item = &Ring[pos & (DEFER_QUEUE_SIZE - 1)];
+
+		if (p_Item->seq == pos)
+		{
+			if (ATOMIC_CAS32(&Head, pos, pos + 1))
+			{
+				break;
+			}
+		}
+		else if (Head == pos)
+		{
+			// Slot not consumed yet: full
+			ATOMIC_FetchAdd(&Dropped, 1);
+			return RESET;
+		}
+		else
+		{
+			// A preempting producer took the slot meanwhile: retry
+		}
+	}
+
+	// 2. Fill and publish
+	p_Item->func = func;
+	p_Item->p_Context = p_Context;
+	p_Item->arg = arg;
+	ATOMIC_BARRIER();
+	p_Item->seq = pos + 1;
+
+	// 3. Statistics (approximate under preemption) and consumer wake-up
+	uint16_t level = (uint16_t)(pos + 1 - Tail);
+	HighWater = (level > HighWater) ? level : HighWater;
+
+	PendConsumer();
+
+	return SET;
+}
+
+/*!
+ * @fn			- DEFER_Process
+ *
+ * @brief 		- Runs the published items in order
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Number of items run
+ *
+ * @note		- Single consumer: PendSV_Handler in PendSV mode, the main loop in poll mode
+*/
+uint16_t DEFER_Process (void)
+{
+	uint16_t count = 0;
+
+	while (1)
+	{
+		DEFER_Item_t *p_Item = &Ring[Tail & (DEFER_QUEUE_SIZE - 1)];
+
+		if (p_Item->seq != (Tail + 1))
+		{
+			break;		// Empty, or the producer of this slot has been preempted
+		}
+
+		DEFER_Func_t func = p_Item->func;
+		void *p_Context = p_Item->p_Context;
+		uint32_t arg = p_Item->arg;
+
+		// Release the slot before the call, so the callee can post again
+		ATOMIC_BARRIER();
+		p_Item->seq = Tail + DEFER_QUEUE_SIZE;
+		Tail++;
+
+		func(p_Context, arg);
+		count++;
+	}
+
+	return count;
+}
+
+/*!
+ * @fn			- DEFER_IsEmpty
+ *
+ * @brief 		- Checks whether any item is waiting
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- SET: nothing queued
+ *
+ * @note		- Exact from the consumer context: a producer interrupted between reserve and publish has
+ * 				  always returned before the consumer runs again
+*/
+uint8_t DEFER_IsEmpty (void)
+{
+	return (Head == Tail) ? SET : RESET;
+}
+
+/*!
+ * @fn			- DEFER_GetMode
+ *
+ * @brief 		- Consumer selected by DEFER_Init
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- @DEFER_MODE
+ *
+ * @note		- Lets a temporary owner of the queue (the event loop) hand it back
+*/
+uint8_t DEFER_GetMode (void)
+{
+	return Mode;
+}
+
+/*!
+ * @fn			- DEFER_GetDropped
+ *
+ * @brief 		- Number of posts refused because the queue was full
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Dropped post count
+ *
+ * @note		- none
+*/
+uint32_t DEFER_GetDropped (void)
+{
+	return Dropped;
+}
+
+/*!
+ * @fn			- DEFER_GetHighWater
+ *
+ * @brief 		- Highest queue level seen since DEFER_Init
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Items
+ *
+ * @note		- Use it to size DEFER_QUEUE_SIZE
+*/
+uint16_t DEFER_GetHighWater (void)
+{
+	return HighWater;
+}
+
+
+// === Exception Handler ===
+//
+/*!
+ * @fn			- PendSV_Handler
+ *
+ * @brief 		- Consumer of the PendSV mode
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void PendSV_Handler (void)
+{
+	if (DEFER_MODE_PENDSV == Mode)
+	{
+		DEFER_Process();
+	}
+}
+
+/*** EOF ***/
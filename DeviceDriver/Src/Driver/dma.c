@@ -0,0 +1,757 @@
+/** @file dma.c
+*
+* @brief DMA stream driver: stream arbitration, configuration (FIFO, bursts, double buffer), start / stop,
+* 		 flag and interrupt handling.
+*
+*/
+
+#include <stddef.h>
+#include "dma.h"
+#include "vector.h"
+#include "atomic.h"
+
+
+// === Constant Definitions ===
+//
+#define DMA_NUM_STREAMS			8
+#define DMA_FIFO_BYTES			16		// Depth of the stream FIFO
+#define DMA_SLOT_NONE			0xFF
+
+
+// === Private Variables ===
+//
+/*
+ * DMA descriptor table, indexed by controller number: DMA2 follows DMA1 at 0x400
+ */
+static const PERIPH_Desc_t DmaDesc[] =
+{
+	PERIPH_DESC(DMA1_BASE, AHB1ENR, AHB1RSTR, 21, IRQ_NO_NONE, 1),
+	PERIPH_DESC(DMA2_BASE, AHB1ENR, AHB1RSTR, 22, IRQ_NO_NONE, 2),
+};
+
+/*
+ * Stream interrupt numbers, DMA1 stream 7 and DMA2 streams 5-7 are out of line
+ */
+static const uint8_t DmaIrq[][DMA_NUM_STREAMS] =
+{
+	{ IRQ_NO_DMA1_STREAM0, IRQ_NO_DMA1_STREAM1, IRQ_NO_DMA1_STREAM2, IRQ_NO_DMA1_STREAM3,
+	  IRQ_NO_DMA1_STREAM4, IRQ_NO_DMA1_STREAM5, IRQ_NO_DMA1_STREAM6, IRQ_NO_DMA1_STREAM7 },
+	{ IRQ_NO_DMA2_STREAM0, IRQ_NO_DMA2_STREAM1, IRQ_NO_DMA2_STREAM2, IRQ_NO_DMA2_STREAM3,
+	  IRQ_NO_DMA2_STREAM4, IRQ_NO_DMA2_STREAM5, IRQ_NO_DMA2_STREAM6, IRQ_NO_DMA2_STREAM7 },
+};
+
+/*
+ * Stream owners, indexed by controller * 8 + stream: handle address, 0 while the stream is free
+ */
+static volatile uint32_t Owner[(sizeof(DmaDesc) / sizeof(*DmaDesc)) * DMA_NUM_STREAMS];
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- DmaDescriptor
+ *
+ * @brief 		- Looks up the descriptor of the DMA controller by address arithmetic
+ *
+ * @param[in]	- *p_DMA: base address of the DMA controller
+ * @param[out]	- none
+ *
+ * @return 		- Descriptor, NULL if the address is not a DMA controller
+ *
+ * @note		- none
+*/
+static inline const PERIPH_Desc_t *DmaDescriptor (DMA_RegDef_t *p_DMA)
+{
+	uint32_t index = ((uint32_t)p_DMA - DMA1_BASE) >> 10;
+
+	if ((index < (sizeof(DmaDesc) / sizeof(*DmaDesc))) && (DmaDesc[index].baseAddr == (uint32_t)p_DMA))
+	{
+		return &DmaDesc[index];
+	}
+
+	return NULL;
+}
+
+/*!
+ * @fn			- DmaSlot
+ *
+ * @brief 		- Index of the stream in the owner table
+ *
+ * @param[in]	- *p_DMA: base address of the DMA controller
+ * @param[in]	- stream: @DMA_STREAM
+ * @param[out]	- none
+ *
+ * @return 		- Owner index, DMA_SLOT_NONE for an unknown controller or stream
+ *
+ * @note		- none
+*/
+static uint8_t DmaSlot (DMA_RegDef_t *p_DMA, uint8_t stream)
+{
+	const PERIPH_Desc_t *p_Desc = DmaDescriptor(p_DMA);
+
+	if ((NULL == p_Desc) || (stream >= DMA_NUM_STREAMS))
+	{
+		return DMA_SLOT_NONE;
+	}
+
+	return (uint8_t)((p_Desc - DmaDesc) * DMA_NUM_STREAMS + stream);
+}
+
+/*!
+ * @fn			- DmaCheckConfig
+ *
+ * @brief 		- Checks the FIFO threshold, burst and data size combination of the configuration
+ *
+ * @param[in]	- *p_DmaHandle: DMA base address + stream + configuration settings
+ * @param[out]	- none
+ *
+ * @return 		- @DMA_STATUS
+ *
+ * @note		- RM0390 9.3.11: a memory burst (beats * MSIZE) must divide the FIFO threshold level,
+ * 				  no burst may exceed the FIFO. Memory-to-memory runs on DMA2 only, never in
+ * 				  direct or circular mode.
+*/
+static uint8_t DmaCheckConfig (DMA_Handle_t *p_DmaHandle)
+{
+	const DMA_Config_t *p_Config = &p_DmaHandle->DmaConfig;
+	uint32_t memBurstBytes = (p_Config->memBurst ? (2U << p_Config->memBurst) : 1U) << p_Config->memSize;
+	uint32_t periphBurstBytes = (p_Config->periphBurst ? (2U << p_Config->periphBurst) : 1U) << p_Config->periphSize;
+
+	if ((p_Config->fifoThreshold > DMA_FIFO_FULL) || (p_Config->memSize > DMA_SIZE_WORD) || (p_Config->periphSize > DMA_SIZE_WORD))
+	{
+		return DMA_ERR_CONFIG;
+	}
+
+	if (DMA_DIR_M2M == p_Config->direction)
+	{
+		if ((DMA2 != p_DmaHandle->p_DMAx) || (DMA_FIFO_DIRECT == p_Config->fifoThreshold) || (ENABLE == p_Config->circular))
+		{
+			return DMA_ERR_CONFIG;
+		}
+	}
+
+	if (DMA_FIFO_DIRECT == p_Config->fifoThreshold)
+	{
+		// Direct mode: single transfers of PSIZE, the memory side follows
+		return (p_Config->memBurst || p_Config->periphBurst) ? DMA_ERR_CONFIG : DMA_OK;
+	}
+
+	if ((memBurstBytes > DMA_FIFO_BYTES) || (periphBurstBytes > DMA_FIFO_BYTES))
+	{
+		return DMA_ERR_CONFIG;
+	}
+
+	if ((p_Config->fifoThreshold * (DMA_FIFO_BYTES / 4)) % memBurstBytes)
+	{
+		return DMA_ERR_CONFIG;
+	}
+
+	return DMA_OK;
+}
+
+/*!
+ * @fn			- DMA_IRQDispatch
+ *
+ * @brief 		- Vector table entry of a bound stream interrupt
+ *
+ * @param[in]	- *p_Context: pointer to the DMA Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+_RAMFUNC static void DMA_IRQDispatch (void *p_Context)
+{
+	DMA_IRQHandling((DMA_Handle_t *)p_Context);
+}
+
+/*!
+ * @fn			- FlagShift
+ *
+ * @brief 		- Bit position of the stream's flag field inside LISR/HISR (LIFCR/HIFCR)
+ *
+ * @param[in]	- stream: @DMA_STREAM
+ * @param[out]	- none
+ *
+ * @return 		- Bit shift: 0, 6, 16 or 22
+ *
+ * @note		- Streams 0-3 use the low registers, 4-7 the high registers with the same layout
+*/
+static inline uint8_t FlagShift (uint8_t stream)
+{
+	static const uint8_t shift[4] = { 0, 6, 16, 22 };
+
+	return shift[stream & 0x3];
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- DMA_PeriClockControl
+ *
+ * @brief 		- Enables or disables the peripheral clock for the given DMA controller
+ *
+ * @param[in]	- *p_DMA: base address of the DMA controller
+ * @param[in]	- enable: ENABLE or DISABLE macros
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void DMA_PeriClockControl (DMA_RegDef_t *p_DMA, uint8_t enable)
+{
+	PERIPH_ClockControl(DmaDescriptor(p_DMA), enable);
+}
+
+/*!
+ * @fn			- DMA_Init
+ *
+ * @brief 		- Claims and configures a DMA stream (the stream is left disabled)
+ *
+ * @param[in]	- *p_DmaHandle: DMA base address + stream + configuration settings
+ * @param[out]	- none
+ *
+ * @return 		- @DMA_STATUS
+ *
+ * @note		- The stream is requested for the handle first, see DMA_Request: calling DMA_Init again
+ * 				  on the same handle takes no further clock reference. DMA_Release gives the stream back.
+*/
+uint8_t DMA_Init (DMA_Handle_t *p_DmaHandle)
+{
+	DMA_Config_t *p_Config = &p_DmaHandle->DmaConfig;
+	DMA_Stream_RegDef_t *p_Stream;
+	uint32_t configReg = 0;
+	uint8_t status;
+
+	status = DmaCheckConfig(p_DmaHandle);
+	if (DMA_OK != status)
+	{
+		return status;
+	}
+
+	// 0. Own the stream, enables the DMA controller clock on the first request
+	status = DMA_Request(p_DmaHandle);
+	if (DMA_OK != status)
+	{
+		return status;
+	}
+
+	p_Stream = DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+
+	// 1. The stream must be disabled before it can be configured
+	DMA_Stop(p_DmaHandle);
+
+	// 2. Request channel, direction and priority
+	configReg |= (p_Config->channel & 0x7) << DMA_SxCRREG_CHSEL;
+	configReg |= (p_Config->direction & 0x3) << DMA_SxCRREG_DIR;
+	configReg |= (p_Config->priority & 0x3) << DMA_SxCRREG_PL;
+
+	// 3. Data sizes and address increment
+	configReg |= (p_Config->periphSize & 0x3) << DMA_SxCRREG_PSIZE;
+	configReg |= (p_Config->memSize & 0x3) << DMA_SxCRREG_MSIZE;
+	configReg |= (p_Config->periphInc & 1) << DMA_SxCRREG_PINC;
+	configReg |= (p_Config->memInc & 1) << DMA_SxCRREG_MINC;
+
+	// 4. Circular mode
+	configReg |= (p_Config->circular & 1) << DMA_SxCRREG_CIRC;
+
+	// 5. Bursts, FIFO mode only
+	configReg |= (p_Config->memBurst & 0x3) << DMA_SxCRREG_MBURST;
+	configReg |= (p_Config->periphBurst & 0x3) << DMA_SxCRREG_PBURST;
+
+	// === Save config in DMA SxCR register ===
+	p_Stream->CR = configReg;
+
+	// 6. Direct mode, or FIFO with its threshold
+	if (DMA_FIFO_DIRECT == p_Config->fifoThreshold)
+	{
+		p_Stream->FCR = 0;
+	}
+	else
+	{
+		p_Stream->FCR = (1 << DMA_SxFCRREG_DMDIS) | (((p_Config->fifoThreshold - 1) & 0x3) << DMA_SxFCRREG_FTH);
+	}
+
+	return DMA_OK;
+}
+
+/*!
+ * @fn			- DMA_Start
+ *
+ * @brief 		- Loads the addresses and the item count and enables the stream
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[in]	- periphAddr: peripheral port address (source address in memory-to-memory mode)
+ * @param[in]	- memAddr: memory port address
+ * @param[in]	- len: number of data items (in peripheral data size units)
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void DMA_Start (DMA_Handle_t *p_DmaHandle, uint32_t periphAddr, uint32_t memAddr, uint16_t len)
+{
+	DMA_Stream_RegDef_t *p_Stream = DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+
+	// 1. Clear the stale flags, otherwise the stream can not be enabled
+	DMA_ClearFlags(p_DmaHandle->p_DMAx, p_DmaHandle->stream, DMA_FLAG_ALL);
+
+	// 2. Addresses and length
+	p_Stream->PAR = periphAddr;
+	p_Stream->M0AR = memAddr;
+	p_Stream->NDTR = len;
+
+	// 3. Single buffer, left over by DMA_StartDoubleBuffer otherwise
+	p_Stream->CR &= ~((1 << DMA_SxCRREG_DBM) | (1 << DMA_SxCRREG_CT));
+
+	// 4. Enable the stream
+	p_Stream->CR |= (1 << DMA_SxCRREG_EN);
+}
+
+/*!
+ * @fn			- DMA_Stop
+ *
+ * @brief 		- Disables the stream and waits until the ongoing transfer is aborted
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void DMA_Stop (DMA_Handle_t *p_DmaHandle)
+{
+	DMA_Stream_RegDef_t *p_Stream = DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+
+	p_Stream->CR &= ~(1 << DMA_SxCRREG_EN);
+	while (p_Stream->CR & (1 << DMA_SxCRREG_EN));		// EN reads back 1 until the current beat is over
+}
+
+/*!
+ * @fn			- DMA_IsBusy
+ *
+ * @brief 		- Checks whether the stream is still transferring
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[out]	- none
+ *
+ * @return 		- SET: stream enabled, RESET: stream idle (finished or stopped)
+ *
+ * @note		- EN is cleared by hardware at the end of a non-circular transfer
+*/
+uint8_t DMA_IsBusy (DMA_Handle_t *p_DmaHandle)
+{
+	if (DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream)->CR & (1 << DMA_SxCRREG_EN))
+	{
+		return SET;
+	}
+
+	return RESET;
+}
+
+/*!
+ * @fn			- DMA_GetCount
+ *
+ * @brief 		- Data items left in the running transfer
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[out]	- none
+ *
+ * @return 		- NDTR
+ *
+ * @note		- In circular mode NDTR is reloaded at the end of each round, so the buffer position
+ * 				  of the next item is the buffer length minus the count
+*/
+uint16_t DMA_GetCount (DMA_Handle_t *p_DmaHandle)
+{
+	return (uint16_t)DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream)->NDTR;
+}
+
+/*!
+ * @fn			- DMA_InterruptControl
+ *
+ * @brief 		- Enables or disables interrupts of the stream
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[in]	- interrupts: @DMA_IT bit mask
+ * @param[in]	- enable: ENABLE or DISABLE macros
+ *
+ * @return 		- none
+ *
+ * @note		- Call it between DMA_Init and DMA_Start. The NVIC side stays with the user of the stream.
+*/
+void DMA_InterruptControl (DMA_Handle_t *p_DmaHandle, uint8_t interrupts, uint8_t enable)
+{
+	DMA_Stream_RegDef_t *p_Stream = DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+	uint32_t mask = interrupts & (DMA_IT_DME | DMA_IT_TE | DMA_IT_HT | DMA_IT_TC);
+
+	if (ENABLE == enable)
+	{
+		p_Stream->CR |= mask;
+	}
+	else
+	{
+		p_Stream->CR &= ~mask;
+	}
+}
+
+/*!
+ * @fn			- DMA_Request
+ *
+ * @brief 		- Claims the stream of the handle
+ *
+ * @param[in]	- *p_DmaHandle: DMA base address + stream
+ * @param[out]	- none
+ *
+ * @return 		- @DMA_STATUS, DMA_ERR_BUSY while another handle owns the stream
+ *
+ * @note		- Lock free, may be called from any context. The first claim takes a reference on the
+ * 				  DMA controller clock, a repeated claim by the owner is a no-op.
+*/
+uint8_t DMA_Request (DMA_Handle_t *p_DmaHandle)
+{
+	uint8_t slot = DmaSlot(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+
+	if (DMA_SLOT_NONE == slot)
+	{
+		return DMA_ERR_PARAM;
+	}
+
+	if (ATOMIC_CAS32(&Owner[slot], 0, (uint32_t)p_DmaHandle))
+	{
+		DMA_PeriClockControl(p_DmaHandle->p_DMAx, ENABLE);
+		return DMA_OK;
+	}
+
+	return ((uint32_t)p_DmaHandle == Owner[slot]) ? DMA_OK : DMA_ERR_BUSY;
+}
+
+/*!
+ * @fn			- DMA_Allocate
+ *
+ * @brief 		- Claims the first free stream of a list of request routes
+ *
+ * @param[in]	- *p_DmaHandle: DMA Handler, p_DMAx, stream and DmaConfig.channel are filled in
+ * @param[in]	- *p_Routes: routes of the request in order of preference (RM0390 tables 28 and 29)
+ * @param[in]	- count: number of routes, entries without controller are skipped
+ *
+ * @return 		- @DMA_STATUS, DMA_ERR_BUSY if every route is taken
+ *
+ * @note		- Only claims the stream, DMA_Init configures it. The handle keeps a listed route
+ * 				  it already owns, even when a preferred one is free again.
+*/
+uint8_t DMA_Allocate (DMA_Handle_t *p_DmaHandle, const DMA_Route_t *p_Routes, uint8_t count)
+{
+	uint8_t status = DMA_ERR_PARAM;
+
+	// 1. A route the handle already owns
+	for (uint8_t i = 0; i < count; ++i)
+	{
+		uint8_t slot = DmaSlot(p_Routes[i].p_DMAx, p_Routes[i].stream);
+
+		if ((DMA_SLOT_NONE != slot) && ((uint32_t)p_DmaHandle == Owner[slot]))
+		{
+			p_DmaHandle->p_DMAx = p_Routes[i].p_DMAx;
+			p_DmaHandle->stream = p_Routes[i].stream;
+			p_DmaHandle->DmaConfig.channel = p_Routes[i].channel;
+			return DMA_OK;
+		}
+	}
+
+	// 2. The first free one
+	for (uint8_t i = 0; i < count; ++i)
+	{
+		if (NULL == p_Routes[i].p_DMAx)
+		{
+			continue;
+		}
+
+		p_DmaHandle->p_DMAx = p_Routes[i].p_DMAx;
+		p_DmaHandle->stream = p_Routes[i].stream;
+
+		status = DMA_Request(p_DmaHandle);
+		if (DMA_OK == status)
+		{
+			p_DmaHandle->DmaConfig.channel = p_Routes[i].channel;
+			return DMA_OK;
+		}
+	}
+
+	return status;
+}
+
+/*!
+ * @fn			- DMA_Release
+ *
+ * @brief 		- Stops the stream and gives it back
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Stream interrupts are disabled and the controller clock reference dropped. Nothing is
+ * 				  done if the handle does not own the stream. A vector bound by DMA_IRQBind stays bound.
+*/
+void DMA_Release (DMA_Handle_t *p_DmaHandle)
+{
+	uint8_t slot = DmaSlot(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+
+	if ((DMA_SLOT_NONE == slot) || ((uint32_t)p_DmaHandle != Owner[slot]))
+	{
+		return;
+	}
+
+	DMA_Stop(p_DmaHandle);
+	DMA_InterruptControl(p_DmaHandle, DMA_IT_DME | DMA_IT_TE | DMA_IT_HT | DMA_IT_TC, DISABLE);
+	DMA_ClearFlags(p_DmaHandle->p_DMAx, p_DmaHandle->stream, DMA_FLAG_ALL);
+
+	Owner[slot] = 0;
+	DMA_PeriClockControl(p_DmaHandle->p_DMAx, DISABLE);
+}
+
+/*!
+ * @fn			- DMA_GetOwner
+ *
+ * @brief 		- Handle owning a stream
+ *
+ * @param[in]	- *p_DMA: base address of the DMA controller
+ * @param[in]	- stream: @DMA_STREAM
+ * @param[out]	- none
+ *
+ * @return 		- Owner, NULL for a free stream or an unknown controller
+ *
+ * @note		- For diagnostics: the answer may be stale by the time it is used
+*/
+DMA_Handle_t *DMA_GetOwner (DMA_RegDef_t *p_DMA, uint8_t stream)
+{
+	uint8_t slot = DmaSlot(p_DMA, stream);
+
+	return (DMA_SLOT_NONE == slot) ? NULL : (DMA_Handle_t *)Owner[slot];
+}
+
+/*!
+ * @fn			- DMA_StartDoubleBuffer
+ *
+ * @brief 		- Starts the stream in double buffer mode, alternating between two memory buffers
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[in]	- periphAddr: peripheral port address
+ * @param[in]	- mem0Addr: first memory target
+ * @param[in]	- mem1Addr: second memory target
+ * @param[in]	- len: number of data items per buffer
+ *
+ * @return 		- none
+ *
+ * @note		- Double buffer mode implies circular mode and is not available memory-to-memory.
+ * 				  DMA_EVENT_FULL marks each switch of the target, see DMA_SetNextBuffer.
+*/
+void DMA_StartDoubleBuffer (DMA_Handle_t *p_DmaHandle, uint32_t periphAddr, uint32_t mem0Addr, uint32_t mem1Addr, uint16_t len)
+{
+	DMA_Stream_RegDef_t *p_Stream = DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+
+	// 1. Clear the stale flags, otherwise the stream can not be enabled
+	DMA_ClearFlags(p_DmaHandle->p_DMAx, p_DmaHandle->stream, DMA_FLAG_ALL);
+
+	// 2. Addresses and length
+	p_Stream->PAR = periphAddr;
+	p_Stream->M0AR = mem0Addr;
+	p_Stream->M1AR = mem1Addr;
+	p_Stream->NDTR = len;
+
+	// 3. Double buffer mode, the first round goes to memory 0
+	p_Stream->CR = (p_Stream->CR & ~(1 << DMA_SxCRREG_CT)) | (1 << DMA_SxCRREG_DBM);
+
+	// 4. Enable the stream
+	p_Stream->CR |= (1 << DMA_SxCRREG_EN);
+}
+
+/*!
+ * @fn			- DMA_SetNextBuffer
+ *
+ * @brief 		- Replaces the memory target the stream is not using
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[in]	- memAddr: new buffer, taken over at the next switch of the target
+ *
+ * @return 		- none
+ *
+ * @note		- Call it from the DMA_EVENT_FULL callback, a whole round ahead of the next switch:
+ * 				  writing the address of the active target raises a transfer error
+*/
+void DMA_SetNextBuffer (DMA_Handle_t *p_DmaHandle, uint32_t memAddr)
+{
+	DMA_Stream_RegDef_t *p_Stream = DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+
+	if (p_Stream->CR & (1 << DMA_SxCRREG_CT))
+	{
+		p_Stream->M0AR = memAddr;
+	}
+	else
+	{
+		p_Stream->M1AR = memAddr;
+	}
+}
+
+/*!
+ * @fn			- DMA_GetCurrentTarget
+ *
+ * @brief 		- Memory target the stream is transferring to / from in double buffer mode
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[out]	- none
+ *
+ * @return 		- 0: memory 0 (M0AR), 1: memory 1 (M1AR)
+ *
+ * @note		- The other buffer is the one completed by the last DMA_EVENT_FULL
+*/
+uint8_t DMA_GetCurrentTarget (DMA_Handle_t *p_DmaHandle)
+{
+	return (DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream)->CR >> DMA_SxCRREG_CT) & 1;
+}
+
+/*!
+ * @fn			- DMA_GetFlags
+ *
+ * @brief 		- Reads the interrupt flags of the stream
+ *
+ * @param[in]	- *p_DMA: base address of the DMA controller
+ * @param[in]	- stream: @DMA_STREAM
+ * @param[out]	- none
+ *
+ * @return 		- DMA_FLAG_xxx bit mask
+ *
+ * @note		- none
+*/
+uint8_t DMA_GetFlags (DMA_RegDef_t *p_DMA, uint8_t stream)
+{
+	uint32_t isr = (stream < DMA_STREAM_4) ? p_DMA->LISR : p_DMA->HISR;
+
+	return (uint8_t)((isr >> FlagShift(stream)) & DMA_FLAG_ALL);
+}
+
+/*!
+ * @fn			- DMA_ClearFlags
+ *
+ * @brief 		- Clears the selected interrupt flags of the stream
+ *
+ * @param[in]	- *p_DMA: base address of the DMA controller
+ * @param[in]	- stream: @DMA_STREAM
+ * @param[in]	- flags: DMA_FLAG_xxx bit mask
+ *
+ * @return 		- none
+ *
+ * @note		- The flag clear registers are write-1-to-clear, no read-modify-write is needed
+*/
+void DMA_ClearFlags (DMA_RegDef_t *p_DMA, uint8_t stream, uint8_t flags)
+{
+	uint32_t clear = (uint32_t)(flags & DMA_FLAG_ALL) << FlagShift(stream);
+
+	if (stream < DMA_STREAM_4)
+	{
+		p_DMA->LIFCR = clear;
+	}
+	else
+	{
+		p_DMA->HIFCR = clear;
+	}
+}
+
+/*!
+ * @fn			- DMA_IRQNumber
+ *
+ * @brief 		- NVIC interrupt number of a stream
+ *
+ * @param[in]	- *p_DMA: base address of the DMA controller
+ * @param[in]	- stream: @DMA_STREAM
+ * @param[out]	- none
+ *
+ * @return 		- IRQ number, IRQ_NO_NONE for an unknown controller or stream
+ *
+ * @note		- none
+*/
+uint8_t DMA_IRQNumber (DMA_RegDef_t *p_DMA, uint8_t stream)
+{
+	uint8_t slot = DmaSlot(p_DMA, stream);
+
+	return (DMA_SLOT_NONE == slot) ? IRQ_NO_NONE : DmaIrq[slot / DMA_NUM_STREAMS][slot % DMA_NUM_STREAMS];
+}
+
+/*!
+ * @fn			- DMA_IRQHandling
+ *
+ * @brief 		- Stream Interrupt Request Handler: clears the flags and calls the handle's callback
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Events come in the order error, half, full. Half and full are only reported while
+ * 				  their interrupt is enabled, a FIFO error only with FEIE set by the owner.
+*/
+_RAMFUNC void DMA_IRQHandling (DMA_Handle_t *p_DmaHandle)
+{
+	DMA_Stream_RegDef_t *p_Stream = DMA_STREAM(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+	uint32_t configReg = p_Stream->CR;
+	uint8_t flags = DMA_GetFlags(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+
+	DMA_ClearFlags(p_DmaHandle->p_DMAx, p_DmaHandle->stream, flags);
+
+	if (NULL == p_DmaHandle->callback)
+	{
+		return;
+	}
+
+	if ((flags & DMA_FLAG_TEIF) ||
+		((flags & DMA_FLAG_DMEIF) && (configReg & DMA_IT_DME)) ||
+		((flags & DMA_FLAG_FEIF) && (p_Stream->FCR & (1 << DMA_SxFCRREG_FEIE))))
+	{
+		p_DmaHandle->callback(p_DmaHandle->p_Context, DMA_EVENT_ERROR);
+	}
+	if ((flags & DMA_FLAG_HTIF) && (configReg & DMA_IT_HT))
+	{
+		p_DmaHandle->callback(p_DmaHandle->p_Context, DMA_EVENT_HALF);
+	}
+	if ((flags & DMA_FLAG_TCIF) && (configReg & DMA_IT_TC))
+	{
+		p_DmaHandle->callback(p_DmaHandle->p_Context, DMA_EVENT_FULL);
+	}
+}
+
+/*!
+ * @fn			- DMA_IRQBind
+ *
+ * @brief 		- Binds the handle to the stream IRQ in the SRAM vector table
+ *
+ * @param[in]	- *p_DmaHandle: pointer to the DMA Handler
+ * @param[in]	- enable: ENABLE binds, DISABLE restores the link-time handler
+ *
+ * @return 		- none
+ *
+ * @note		- NVIC enable and priority stay with the owner, see DMA_IRQNumber
+*/
+void DMA_IRQBind (DMA_Handle_t *p_DmaHandle, uint8_t enable)
+{
+	uint8_t IRQNumber = DMA_IRQNumber(p_DmaHandle->p_DMAx, p_DmaHandle->stream);
+
+	if (IRQ_NO_NONE == IRQNumber)
+	{
+		return;
+	}
+
+	if (ENABLE == enable)
+	{
+		VECTOR_Register(IRQNumber, DMA_IRQDispatch, p_DmaHandle);
+	}
+	else
+	{
+		VECTOR_Unregister(IRQNumber);
+	}
+}
+
+/*** EOF ***/
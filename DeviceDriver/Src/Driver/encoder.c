@@ -0,0 +1,236 @@
+/** @file encoder.c
+*
+* @brief Table-driven EXTI quadrature encoder decoder.
+*
+* Both channels interrupt on both edges. Each interrupt reads the two pins with a single
+* GPIO_ReadPort and looks up the 16-entry (previous state, new state) transition table.
+*
+*/
+
+#include <stddef.h>
+#include "encoder.h"
+
+
+// === Private Variables ===
+//
+#define ENC_ILLEGAL			2		// Transition table marker: both channels changed
+
+/*
+ * Index: (previous AB << 2) | new AB
+ * Forward sequence (A leads): 00 -> 10 -> 11 -> 01 -> 00
+ */
+static const int8_t EncoderTable[16] =
+{
+	//  00			01			 10			  11		<= new AB
+		0,			-1,			 +1,		  ENC_ILLEGAL,	// previous 00
+		+1,			0,			 ENC_ILLEGAL, -1,			// previous 01
+		-1,			ENC_ILLEGAL, 0,			  +1,			// previous 10
+		ENC_ILLEGAL, +1,		 -1,		  0,			// previous 11
+};
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- ReadState
+ *
+ * @brief 		- Reads both channels with one port access
+ *
+ * @param[in]	- *p_EncHandle: pointer to the encoder handle
+ * @param[out]	- none
+ *
+ * @return 		- (A << 1) | B
+ *
+ * @note		- none
+*/
+static inline uint8_t ReadState (ENCODER_Handle_t *p_EncHandle)
+{
+	uint16_t port = GPIO_ReadPort(p_EncHandle->p_GPIOx);
+
+	return (uint8_t)((((port >> p_EncHandle->pinA) & 1) << 1) | ((port >> p_EncHandle->pinB) & 1));
+}
+
+/*!
+ * @fn			- EdgeCallback
+ *
+ * @brief 		- EXTI callback of both channels: decodes the transition
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[in]	- *p_Context: pointer to the encoder handle
+ *
+ * @return 		- none
+ *
+ * @note		- If both lines are pending, the second call sees no change and returns early
+*/
+static void EdgeCallback (uint8_t line, void *p_Context)
+{
+	ENCODER_Handle_t *p_EncHandle = (ENCODER_Handle_t *)p_Context;
+	uint32_t now = DWT_CYCCNT();
+	uint8_t state = ReadState(p_EncHandle);
+	int8_t step = EncoderTable[(p_EncHandle->state << 2) | state];
+
+	p_EncHandle->state = state;
+
+	if (ENC_ILLEGAL == step)
+	{
+		p_EncHandle->illegal++;
+	}
+	else if (step)
+	{
+		p_EncHandle->position += step;
+		p_EncHandle->direction = step;
+		p_EncHandle->edgePeriod = now - p_EncHandle->edgeStamp;
+		p_EncHandle->edgeStamp = now;
+	}
+	else
+	{
+		// NOP
+	}
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- ENCODER_Init
+ *
+ * @brief 		- Configures both channels as EXTI inputs on both edges and starts decoding
+ *
+ * @param[in]	- *p_EncHandle: port, pins and pull configuration
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The EXTI vector priorities are left to the application
+*/
+void ENCODER_Init (ENCODER_Handle_t *p_EncHandle)
+{
+	GPIO_Handle_t EncPin;
+
+	DWT_CYCCNT_EN();
+
+	// 1. Channels: interrupt on falling and rising edges
+	EncPin.p_GPIOx = p_EncHandle->p_GPIOx;
+	EncPin.pinConfig.pinMode = GPIO_MODE_IT_FRT;
+	EncPin.pinConfig.pinPuPdControl = p_EncHandle->pinPuPdControl;
+	EncPin.pinConfig.pinSpeed = GPIO_OP_SPEED_LOW;
+
+	EncPin.pinConfig.pinNumber = p_EncHandle->pinA;
+	GPIO_Init(&EncPin);
+	EncPin.pinConfig.pinNumber = p_EncHandle->pinB;
+	GPIO_Init(&EncPin);
+
+	// 2. Initial state
+	ENCODER_Reset(p_EncHandle);
+
+	// 3. Hook both lines
+	EXTI_RegisterCallback(p_EncHandle->pinA, EdgeCallback, p_EncHandle);
+	EXTI_RegisterCallback(p_EncHandle->pinB, EdgeCallback, p_EncHandle);
+}
+
+/*!
+ * @fn			- ENCODER_DeInit
+ *
+ * @brief 		- Stops decoding
+ *
+ * @param[in]	- *p_EncHandle: pointer to the encoder handle
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void ENCODER_DeInit (ENCODER_Handle_t *p_EncHandle)
+{
+	EXTI_UnregisterCallback(p_EncHandle->pinA);
+	EXTI_UnregisterCallback(p_EncHandle->pinB);
+}
+
+/*!
+ * @fn			- ENCODER_Reset
+ *
+ * @brief 		- Clears the position, the statistics and resynchronizes the state
+ *
+ * @param[in]	- *p_EncHandle: pointer to the encoder handle
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void ENCODER_Reset (ENCODER_Handle_t *p_EncHandle)
+{
+	p_EncHandle->state = ReadState(p_EncHandle);
+	p_EncHandle->position = 0;
+	p_EncHandle->illegal = 0;
+	p_EncHandle->direction = 0;
+	p_EncHandle->edgePeriod = UINT32_MAX;
+	p_EncHandle->edgeStamp = DWT_CYCCNT();
+}
+
+/*!
+ * @fn			- ENCODER_GetPosition
+ *
+ * @brief 		- Current position in quadrature counts
+ *
+ * @param[in]	- *p_EncHandle: pointer to the encoder handle
+ * @param[out]	- none
+ *
+ * @return 		- Position
+ *
+ * @note		- none
+*/
+int32_t ENCODER_GetPosition (ENCODER_Handle_t *p_EncHandle)
+{
+	return p_EncHandle->position;
+}
+
+/*!
+ * @fn			- ENCODER_GetVelocity
+ *
+ * @brief 		- Velocity from the period of the last two edges
+ *
+ * @param[in]	- *p_EncHandle: pointer to the encoder handle
+ * @param[in]	- cpuHz: DWT cycle counter frequency (HCLK)
+ *
+ * @return 		- Signed quadrature counts per second
+ *
+ * @note		- If the time since the last edge exceeds the last period it is used instead,
+ * 				  so the velocity decays towards 0 when the shaft stops
+*/
+int32_t ENCODER_GetVelocity (ENCODER_Handle_t *p_EncHandle, uint32_t cpuHz)
+{
+	uint32_t period = p_EncHandle->edgePeriod;
+	uint32_t idle = DWT_CYCCNT() - p_EncHandle->edgeStamp;
+
+	if (idle > period)
+	{
+		period = idle;
+	}
+
+	if ((0 == period) || (UINT32_MAX == period))
+	{
+		return 0;
+	}
+
+	return p_EncHandle->direction * (int32_t)(cpuHz / period);
+}
+
+/*!
+ * @fn			- ENCODER_GetIllegalCount
+ *
+ * @brief 		- Number of illegal transitions (edges lost because of interrupt latency)
+ *
+ * @param[in]	- *p_EncHandle: pointer to the encoder handle
+ * @param[out]	- none
+ *
+ * @return 		- Illegal transition count
+ *
+ * @note		- none
+*/
+uint32_t ENCODER_GetIllegalCount (ENCODER_Handle_t *p_EncHandle)
+{
+	return p_EncHandle->illegal;
+}
+
+/*** EOF ***/
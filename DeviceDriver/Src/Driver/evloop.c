@@ -0,0 +1,533 @@
+/** @file evloop.c
+*
+* @brief Run-to-completion cooperative event loop.
+*
+* Events are posted from any context into the deferred-work queue (poll mode) and run in thread mode,
+* one at a time, to completion. Software timers are kept in a list sorted by deadline; only the nearest
+* deadline is programmed into the compare channel of a free-running 32-bit timer, so there is no tick
+* interrupt while idle. With nothing to do the loop sleeps in WFI. The time spent asleep is measured on
+* the same timebase, which gives the CPU load.
+*
+*/
+
+#include <stddef.h>
+#include "evloop.h"
+#include "nvic.h"
+#include "atomic.h"
+#include "timebase.h"
+#include "sleep.h"
+#include "clock.h"
+#include "pclk.h"
+
+
+// === Private Variables ===
+//
+static EVLOOP_Timer_t *p_TimerList;			// Sorted by deadline, thread mode only
+static volatile uint8_t Running;
+static uint32_t LoadStart;					// Timebase tick of the last load reset
+static uint32_t IdleTicks;					// Ticks spent in WFI since LoadStart
+static CLOCK_Notifier_t ClockNotifier;
+static uint8_t Ready;						// SET between EVLOOP_Init and EVLOOP_DeInit: clock reference and notifier held
+static uint8_t DeferMode;					// @DEFER_MODE before EVLOOP_Init, restored by EVLOOP_DeInit
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- IsDue
+ *
+ * @brief 		- Wrap-safe deadline check
+ *
+ * @param[in]	- deadline: timebase tick
+ * @param[in]	- now: timebase tick
+ *
+ * @return 		- SET if the deadline has been reached
+ *
+ * @note		- Valid as long as no delay exceeds EVLOOP_MAX_DELAY
+*/
+static inline uint8_t IsDue (uint32_t deadline, uint32_t now)
+{
+	return ((int32_t)(deadline - now) <= 0) ? SET : RESET;
+}
+
+/*!
+ * @fn			- TimerLink
+ *
+ * @brief 		- Inserts the timer into the sorted list
+ *
+ * @param[in]	- *p_Timer: timer with the deadline already set
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Timers with equal deadlines fire in the order they were started
+*/
+static void TimerLink (EVLOOP_Timer_t *p_Timer)
+{
+	EVLOOP_Timer_t **pp_Link = &p_TimerList;
+
+	while ((NULL != *pp_Link) && IsDue((*pp_Link)->deadline, p_Timer->deadline))
+	{
+		pp_Link = &(*pp_Link)->p_Next;
+	}
+
+	p_Timer->p_Next = *pp_Link;
+	*pp_Link = p_Timer;
+	p_Timer->active = SET;
+}
+
+/*!
+ * @fn			- TimerUnlink
+ *
+ * @brief 		- Removes the timer from the list
+ *
+ * @param[in]	- *p_Timer: timer
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- No effect on an inactive timer
+*/
+static void TimerUnlink (EVLOOP_Timer_t *p_Timer)
+{
+	EVLOOP_Timer_t **pp_Link = &p_TimerList;
+
+	while (NULL != *pp_Link)
+	{
+		if (*pp_Link == p_Timer)
+		{
+			*pp_Link = p_Timer->p_Next;
+			break;
+		}
+		pp_Link = &(*pp_Link)->p_Next;
+	}
+
+	p_Timer->p_Next = NULL;
+	p_Timer->active = RESET;
+}
+
+/*!
+ * @fn			- RunTimers
+ *
+ * @brief 		- Runs every expired timer, re-arms the periodic ones
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- A periodic timer keeps its phase: the next deadline is counted from the previous one
+*/
+static void RunTimers (void)
+{
+	while ((NULL != p_TimerList) && IsDue(p_TimerList->deadline, EVLOOP_Now()))
+	{
+		EVLOOP_Timer_t *p_Timer = p_TimerList;
+
+		TimerUnlink(p_Timer);
+		if (p_Timer->period)
+		{
+			p_Timer->deadline += p_Timer->period;
+			TimerLink(p_Timer);
+		}
+
+		p_Timer->handler(p_Timer->p_Context);
+	}
+}
+
+/*!
+ * @fn			- Idle
+ *
+ * @brief 		- Programs the nearest deadline and sleeps until the next interrupt
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The checks and WFI run with PRIMASK set: an interrupt arriving in between stays pending
+ * 				  and makes WFI return at once, so no wake-up is lost. The ISR runs after PRIMASK is
+ * 				  cleared, and its time is counted as busy. SysTick is suspended during the sleep and
+ * 				  the millisecond count is advanced by the time measured on the loop timebase.
+*/
+static void Idle (void)
+{
+	uint32_t primask = ATOMIC_IrqDisable();
+
+	// 1. Arm the compare for the nearest deadline, or leave the timebase silent
+	if (NULL != p_TimerList)
+	{
+		EVLOOP_TIM->CCR[0] = p_TimerList->deadline;
+		EVLOOP_TIM->SR = ~(1 << TIM_SRREG_CC1IF);
+		EVLOOP_TIM->DIER |= (1 << TIM_DIERREG_CC1IE);
+	}
+	else
+	{
+		EVLOOP_TIM->DIER &= ~(1 << TIM_DIERREG_CC1IE);
+	}
+
+	// 2. Sleep, unless something became ready meanwhile
+	uint32_t now = EVLOOP_Now();
+	if (Running && DEFER_IsEmpty() && ((NULL == p_TimerList) || !IsDue(p_TimerList->deadline, now)))
+	{
+		// The 1 ms SysTick would wake the core every tick: the timebase sleeps with the loop
+		uint8_t tickSuspended = TIMEBASE_SuspendTick();
+
+		SLEEP_WaitForInterrupt();
+		uint32_t slept = EVLOOP_Now() - now;
+		IdleTicks += slept;
+
+		if (tickSuspended)
+		{
+			TIMEBASE_ResumeTick(slept / EVLOOP_US(1));
+		}
+	}
+
+	ATOMIC_IrqRestore(primask);
+}
+
+
+/*!
+ * @fn			- ClockNotify
+ *
+ * @brief 		- Keeps the timebase at EVLOOP_TICK_HZ across clock switches
+ *
+ * @param[in]	- *p_Context: unused
+ * @param[in]	- event: @CLOCK_EVENT
+ * @param[in]	- *p_Freq: running frequencies
+ *
+ * @return 		- none
+ *
+ * @note		- PSC is only loaded by an update event, which also clears the counter: the count is
+ * 				  saved and written back, so EVLOOP_Now and the armed deadline stay valid. The loop time
+ * 				  drifts by the part of the switch spent at the intermediate clocks.
+*/
+static void ClockNotify (void *p_Context, uint8_t event, const CLOCK_Freq_t *p_Freq)
+{
+	(void)p_Context;
+
+	if (CLOCK_EVENT_POST_CHANGE != event)
+	{
+		return;
+	}
+
+	uint32_t count = EVLOOP_TIM->CNT;
+	EVLOOP_TIM->PSC = (p_Freq->timclk1Hz / EVLOOP_TICK_HZ) - 1;
+	EVLOOP_TIM->EGR = (1 << TIM_EGRREG_UG);
+	EVLOOP_TIM->CNT = count;
+	EVLOOP_TIM->SR = ~(1 << TIM_SRREG_UIF);
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- EVLOOP_Init
+ *
+ * @brief 		- Starts the timebase and switches the deferred-work queue to poll mode
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Deferred driver callbacks (e.g. SPI events) run in the loop from now on.
+ * 				  The tick follows the APB1 timer clock through CLOCK_Switch.
+ * 				  Drops every started timer. The TIM2 clock reference is taken by the first call
+ * 				  only, see EVLOOP_DeInit.
+*/
+void EVLOOP_Init (void)
+{
+	p_TimerList = NULL;
+	Running = RESET;
+
+	if (!Ready)
+	{
+		DeferMode = DEFER_GetMode();
+	}
+	DEFER_Init(DEFER_MODE_POLL);
+
+	// Free-running up-counter, compare channel 1 in frozen mode (interrupt only)
+	if (!Ready)
+	{
+		PCLK_Control(&RCC->APB1ENR, RCC_APB1ENRREG_TIM2EN, ENABLE);
+	}
+	EVLOOP_TIM->CR1 = 0;
+	EVLOOP_TIM->DIER = 0;
+	EVLOOP_TIM->CCMR1 = 0;
+	EVLOOP_TIM->PSC = (CLOCK_GetTimerClk1() / EVLOOP_TICK_HZ) - 1;
+	EVLOOP_TIM->ARR = 0xFFFFFFFF;
+	EVLOOP_TIM->EGR = (1 << TIM_EGRREG_UG);			// Load PSC
+	EVLOOP_TIM->SR = 0;
+	EVLOOP_TIM->CR1 = (1 << TIM_CR1REG_CEN);
+
+	// The timebase only wakes the core: lowest level of the plan
+	NVIC_SetPriority(EVLOOP_TIM_IRQ, NVIC_PLAN_PREEMPT_BACKGROUND, 0);
+	IRQInterruptConfig(EVLOOP_TIM_IRQ, ENABLE);
+
+	if (!Ready)
+	{
+		CLOCK_NotifierRegister(&ClockNotifier, ClockNotify, NULL);
+		Ready = SET;
+	}
+
+	EVLOOP_ResetLoad();
+}
+
+/*!
+ * @fn			- EVLOOP_DeInit
+ *
+ * @brief 		- Stops the timebase and gives its timer back
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Call it after EVLOOP_Run returned. Drops every started timer and the TIM2 clock
+ * 				  reference. The deferred-work queue is drained and handed back in the mode it had
+ * 				  before EVLOOP_Init.
+*/
+void EVLOOP_DeInit (void)
+{
+	uint32_t primask;
+
+	if (!Ready)
+	{
+		return;
+	}
+
+	IRQInterruptConfig(EVLOOP_TIM_IRQ, DISABLE);
+	EVLOOP_TIM->CR1 = 0;
+	EVLOOP_TIM->DIER = 0;
+	EVLOOP_TIM->SR = 0;
+
+	CLOCK_NotifierUnregister(&ClockNotifier);
+	PCLK_Control(&RCC->APB1ENR, RCC_APB1ENRREG_TIM2EN, DISABLE);
+
+	// Nobody polls the queue from now on: run what is left, then give it back to its consumer with
+	// no post slipping in between (DEFER_Init empties the ring)
+	for (;;)
+	{
+		DEFER_Process();
+
+		primask = ATOMIC_IrqDisable();
+		if (DEFER_IsEmpty())
+		{
+			break;
+		}
+		ATOMIC_IrqRestore(primask);
+	}
+	DEFER_Init(DeferMode);
+	ATOMIC_IrqRestore(primask);
+
+	p_TimerList = NULL;
+	Ready = RESET;
+}
+
+/*!
+ * @fn			- EVLOOP_Run
+ *
+ * @brief 		- Dispatches events and timers until EVLOOP_Stop
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Thread mode only. Handlers must not block: a long job is split into events or timer steps.
+*/
+void EVLOOP_Run (void)
+{
+	Running = SET;
+
+	while (Running)
+	{
+		DEFER_Process();
+		RunTimers();
+		Idle();
+	}
+}
+
+/*!
+ * @fn			- EVLOOP_Stop
+ *
+ * @brief 		- Makes EVLOOP_Run return after the running handler
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Callable from handlers and ISRs. The started timers are kept.
+*/
+void EVLOOP_Stop (void)
+{
+	Running = RESET;
+}
+
+/*!
+ * @fn			- EVLOOP_Post
+ *
+ * @brief 		- Queues an event for the loop
+ *
+ * @param[in]	- func: event handler
+ * @param[in]	- *p_Context: first argument of func
+ * @param[in]	- arg: second argument of func
+ *
+ * @return 		- SET: queued, RESET: queue full
+ *
+ * @note		- Callable from any context, lock-free
+*/
+uint8_t EVLOOP_Post (DEFER_Func_t func, void *p_Context, uint32_t arg)
+{
+	return DEFER_Post(func, p_Context, arg);
+}
+
+/*!
+ * @fn			- EVLOOP_TimerInit
+ *
+ * @brief 		- Binds the handler to a timer
+ *
+ * @param[in]	- *p_Timer: timer, owned by the caller
+ * @param[in]	- handler: called from the loop at expiry
+ * @param[in]	- *p_Context: argument of handler
+ *
+ * @return 		- none
+ *
+ * @note		- The timer must not be running
+*/
+void EVLOOP_TimerInit (EVLOOP_Timer_t *p_Timer, EVLOOP_TimerFunc_t handler, void *p_Context)
+{
+	p_Timer->handler = handler;
+	p_Timer->p_Context = p_Context;
+	p_Timer->period = 0;
+	p_Timer->active = RESET;
+	p_Timer->p_Next = NULL;
+}
+
+/*!
+ * @fn			- EVLOOP_TimerStart
+ *
+ * @brief 		- (Re)starts a timer
+ *
+ * @param[in]	- *p_Timer: initialized timer
+ * @param[in]	- delay: ticks to the first expiry (EVLOOP_MS / EVLOOP_US), up to EVLOOP_MAX_DELAY
+ * @param[in]	- period: ticks between the later expiries, 0: one-shot
+ *
+ * @return 		- none
+ *
+ * @note		- Thread mode only (loop handlers or before EVLOOP_Run). ISRs post an event instead.
+*/
+void EVLOOP_TimerStart (EVLOOP_Timer_t *p_Timer, uint32_t delay, uint32_t period)
+{
+	if (p_Timer->active)
+	{
+		TimerUnlink(p_Timer);
+	}
+
+	p_Timer->deadline = EVLOOP_Now() + delay;
+	p_Timer->period = period;
+	TimerLink(p_Timer);
+}
+
+/*!
+ * @fn			- EVLOOP_TimerStop
+ *
+ * @brief 		- Stops a timer
+ *
+ * @param[in]	- *p_Timer: timer
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Thread mode only. Safe from the handler of the timer itself.
+*/
+void EVLOOP_TimerStop (EVLOOP_Timer_t *p_Timer)
+{
+	if (p_Timer->active)
+	{
+		TimerUnlink(p_Timer);
+	}
+}
+
+/*!
+ * @fn			- EVLOOP_Now
+ *
+ * @brief 		- Reads the timebase
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Ticks (EVLOOP_TICK_HZ)
+ *
+ * @note		- none
+*/
+uint32_t EVLOOP_Now (void)
+{
+	return EVLOOP_TIM->CNT;
+}
+
+/*!
+ * @fn			- EVLOOP_GetLoad
+ *
+ * @brief 		- CPU load since the last EVLOOP_ResetLoad
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Busy time in 0.1 % units (0 - 1000)
+ *
+ * @note		- Busy is everything outside WFI: handlers, ISRs and the loop itself
+*/
+uint16_t EVLOOP_GetLoad (void)
+{
+	uint32_t total = EVLOOP_Now() - LoadStart;
+
+	if (!total)
+	{
+		return 0;
+	}
+
+	return (uint16_t)(((uint64_t)(total - IdleTicks) * 1000) / total);
+}
+
+/*!
+ * @fn			- EVLOOP_ResetLoad
+ *
+ * @brief 		- Starts a new CPU load measurement window
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The window must stay below the timebase wrap (~71 minutes)
+*/
+void EVLOOP_ResetLoad (void)
+{
+	LoadStart = EVLOOP_Now();
+	IdleTicks = 0;
+}
+
+
+// === Interrupt Handler ===
+//
+/*!
+ * @fn			- TIM2_IRQHandler
+ *
+ * @brief 		- Timebase compare: wakes the loop
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The expired timers are run by the loop, not here
+*/
+void TIM2_IRQHandler (void)
+{
+	EVLOOP_TIM->SR = ~(1 << TIM_SRREG_CC1IF);
+}
+
+/*** EOF ***/
@@ -0,0 +1,318 @@
+/** @file exti.c
+*
+* @brief EXTI dispatch manager: per-line callbacks and a single-entry scan of all pending lines.
+*
+* The manager owns the EXTI interrupt vectors. Every vector scans PR & IMR with count-leading-zeros,
+* so the shared EXTI9_5 / EXTI15_10 entries service all of their pending lines at once.
+*
+*/
+
+#include "exti.h"
+#include "irqprof.h"
+
+
+// === Private Variables ===
+//
+typedef struct EXTI_Slot
+{
+	EXTI_Callback_t callback;
+	void *p_Context;
+} EXTI_Slot_t;
+
+static EXTI_Slot_t ExtiTable[EXTI_NUM_LINES];
+
+static const uint8_t ExtiIRQ[EXTI_NUM_LINES] =
+{
+	IRQ_NO_EXTI0, IRQ_NO_EXTI1, IRQ_NO_EXTI2, IRQ_NO_EXTI3, IRQ_NO_EXTI4,
+	IRQ_NO_EXTI9_5, IRQ_NO_EXTI9_5, IRQ_NO_EXTI9_5, IRQ_NO_EXTI9_5, IRQ_NO_EXTI9_5,
+	IRQ_NO_EXTI15_10, IRQ_NO_EXTI15_10, IRQ_NO_EXTI15_10, IRQ_NO_EXTI15_10, IRQ_NO_EXTI15_10, IRQ_NO_EXTI15_10,
+	IRQ_NO_PVD,				// 16: PVD output
+	IRQ_NO_RTC_ALARM,		// 17: RTC alarm
+	IRQ_NO_OTG_FS_WKUP,		// 18: USB OTG FS wakeup
+	IRQ_NO_NONE,			// 19: not connected on F446
+	IRQ_NO_OTG_HS_WKUP,		// 20: USB OTG HS wakeup
+	IRQ_NO_TAMP_STAMP,		// 21: RTC tamper and timestamp
+	IRQ_NO_RTC_WKUP,		// 22: RTC wakeup
+};
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- EXTI_RegisterCallback
+ *
+ * @brief 		- Registers the callback of an EXTI line and enables its interrupt
+ *
+ * @param[in]	- line: EXTI line number (GPIO pin number for lines 0-15)
+ * @param[in]	- callback: called from the EXTI vector after the pending bit is cleared
+ * @param[in]	- *p_Context: passed to the callback unchanged
+ *
+ * @return 		- none
+ *
+ * @note		- The trigger edge and the port selection are configured by GPIO_Init (GPIO_MODE_IT_xx).
+ * 				  The NVIC priority is left to the application.
+*/
+void EXTI_RegisterCallback (uint8_t line, EXTI_Callback_t callback, void *p_Context)
+{
+	if (line >= EXTI_NUM_LINES)
+	{
+		return;
+	}
+
+	// 1. Publish the context before the callback becomes visible to the ISR
+	ExtiTable[line].p_Context = p_Context;
+	ExtiTable[line].callback = callback;
+
+	// 2. Unmask the line and enable the vector
+	EXTI_LineControl(line, ENABLE);
+	if (IRQ_NO_NONE != ExtiIRQ[line])
+	{
+		IRQInterruptConfig(ExtiIRQ[line], ENABLE);
+	}
+}
+
+/*!
+ * @fn			- EXTI_UnregisterCallback
+ *
+ * @brief 		- Masks the EXTI line and removes its callback
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The NVIC vector stays enabled, it may serve other lines
+*/
+void EXTI_UnregisterCallback (uint8_t line)
+{
+	if (line >= EXTI_NUM_LINES)
+	{
+		return;
+	}
+
+	EXTI_LineControl(line, DISABLE);
+	ExtiTable[line].callback = NULL;
+	ExtiTable[line].p_Context = NULL;
+}
+
+/*!
+ * @fn			- EXTI_IRQNumber
+ *
+ * @brief 		- NVIC interrupt number serving the EXTI line
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[out]	- none
+ *
+ * @return 		- IRQ number, IRQ_NO_NONE if the line has no vector
+ *
+ * @note		- none
+*/
+uint8_t EXTI_IRQNumber (uint8_t line)
+{
+	return (line < EXTI_NUM_LINES) ? ExtiIRQ[line] : IRQ_NO_NONE;
+}
+
+/*!
+ * @fn			- EXTI_LineControl
+ *
+ * @brief 		- Masks or unmasks the interrupt of an EXTI line
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[in]	- enable: ENABLE or DISABLE macros
+ *
+ * @return 		- none
+ *
+ * @note		- A stale pending bit is cleared before unmasking. IMR is updated through the
+ * 				  bit-band alias: callers of any priority (e.g. a debounce ISR masking its line while
+ * 				  the main loop unmasks another) never lose each other's update.
+*/
+void EXTI_LineControl (uint8_t line, uint8_t enable)
+{
+	if (ENABLE == enable)
+	{
+		EXTI->PR = EXTI_LINE_BIT(line);
+		BITBAND_PERIPH(&EXTI->IMR, line) = 1;
+	}
+	else
+	{
+		BITBAND_PERIPH(&EXTI->IMR, line) = 0;
+	}
+}
+
+/*!
+ * @fn			- EXTI_SoftwareTrigger
+ *
+ * @brief 		- Raises the interrupt of the selected lines from software
+ *
+ * @param[in]	- lineMask: EXTI_LINE_BIT(x) bit mask
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- SWIER bits are cleared by hardware when the PR bit is cleared.
+ * 				  The request is stamped for the pending latency of the profiler.
+*/
+void EXTI_SoftwareTrigger (uint32_t lineMask)
+{
+#if IRQ_PROFILE_ENABLE
+	for (uint32_t lines = lineMask & (EXTI_LINE_BIT(EXTI_NUM_LINES) - 1); lines; lines &= lines - 1)
+	{
+		uint8_t IRQNumber = EXTI_IRQNumber(__builtin_ctz(lines));
+		if (IRQ_NO_NONE != IRQNumber)
+		{
+			IRQPROF_MARK_PENDING(IRQNumber);
+		}
+	}
+#endif
+
+	EXTI->SWIER = lineMask;
+}
+
+/*!
+ * @fn			- EXTI_IRQHandling
+ *
+ * @brief 		- Services every pending and unmasked line of the given set
+ *
+ * @param[in]	- lineMask: lines served by the calling vector (@EXTI_VECTOR_MASK)
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- PR is write-1-to-clear: the serviced lines are cleared by a plain write, so lines
+ * 				  becoming pending meanwhile are not lost. The highest line number is served first.
+ * 				  Placed in SRAM: no flash wait states in the shared dispatch path.
+*/
+_RAMFUNC void EXTI_IRQHandling (uint32_t lineMask)
+{
+	uint32_t pending = EXTI->PR & EXTI->IMR & lineMask;
+
+	while (pending)
+	{
+		// 1. Acknowledge the whole batch with a single write
+		EXTI->PR = pending;
+
+		// 2. Dispatch: CLZ yields the highest pending line in one instruction
+		while (pending)
+		{
+			uint8_t line = 31 - __builtin_clz(pending);
+			pending &= ~EXTI_LINE_BIT(line);
+
+			if (ExtiTable[line].callback)
+			{
+				ExtiTable[line].callback(line, ExtiTable[line].p_Context);
+			}
+		}
+
+		// 3. Pick up the edges arrived during the callbacks without a new exception entry
+		pending = EXTI->PR & EXTI->IMR & lineMask;
+	}
+}
+
+
+// === EXTI Interrupt Vectors ===
+//
+/*!
+ * @fn			- EXTIx_IRQHandler
+ *
+ * @brief 		- ISR Handlers of the EXTI vectors, each one serves its own line set
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The profiler hooks are empty unless IRQ_PROFILE_ENABLE is set. The vectors of lines
+ * 				  16-22 are owned here as well: EXTI_RegisterCallback enables them.
+*/
+void EXTI0_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_EXTI0);
+	EXTI_IRQHandling(EXTI_MASK_EXTI0);
+	IRQPROF_EXIT(IRQ_NO_EXTI0);
+}
+
+void EXTI1_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_EXTI1);
+	EXTI_IRQHandling(EXTI_MASK_EXTI1);
+	IRQPROF_EXIT(IRQ_NO_EXTI1);
+}
+
+void EXTI2_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_EXTI2);
+	EXTI_IRQHandling(EXTI_MASK_EXTI2);
+	IRQPROF_EXIT(IRQ_NO_EXTI2);
+}
+
+void EXTI3_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_EXTI3);
+	EXTI_IRQHandling(EXTI_MASK_EXTI3);
+	IRQPROF_EXIT(IRQ_NO_EXTI3);
+}
+
+void EXTI4_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_EXTI4);
+	EXTI_IRQHandling(EXTI_MASK_EXTI4);
+	IRQPROF_EXIT(IRQ_NO_EXTI4);
+}
+
+void EXTI9_5_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_EXTI9_5);
+	EXTI_IRQHandling(EXTI_MASK_EXTI9_5);
+	IRQPROF_EXIT(IRQ_NO_EXTI9_5);
+}
+
+void EXTI15_10_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_EXTI15_10);
+	EXTI_IRQHandling(EXTI_MASK_EXTI15_10);
+	IRQPROF_EXIT(IRQ_NO_EXTI15_10);
+}
+
+void PVD_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_PVD);
+	EXTI_IRQHandling(EXTI_MASK_PVD);
+	IRQPROF_EXIT(IRQ_NO_PVD);
+}
+
+void RTC_Alarm_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_RTC_ALARM);
+	EXTI_IRQHandling(EXTI_MASK_RTC_ALARM);
+	IRQPROF_EXIT(IRQ_NO_RTC_ALARM);
+}
+
+void OTG_FS_WKUP_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_OTG_FS_WKUP);
+	EXTI_IRQHandling(EXTI_MASK_OTG_FS_WKUP);
+	IRQPROF_EXIT(IRQ_NO_OTG_FS_WKUP);
+}
+
+void OTG_HS_WKUP_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_OTG_HS_WKUP);
+	EXTI_IRQHandling(EXTI_MASK_OTG_HS_WKUP);
+	IRQPROF_EXIT(IRQ_NO_OTG_HS_WKUP);
+}
+
+void TAMP_STAMP_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_TAMP_STAMP);
+	EXTI_IRQHandling(EXTI_MASK_TAMP_STAMP);
+	IRQPROF_EXIT(IRQ_NO_TAMP_STAMP);
+}
+
+void RTC_WKUP_IRQHandler (void)
+{
+	IRQPROF_ENTER(IRQ_NO_RTC_WKUP);
+	EXTI_IRQHandling(EXTI_MASK_RTC_WKUP);
+	IRQPROF_EXIT(IRQ_NO_RTC_WKUP);
+}
+
+/*** EOF ***/
@@ -4,11 +4,64 @@
 *
 */
 
+#include <stddef.h>
 #include "gpio.h"
+#include "atomic.h"
+#include "pclk.h"
+
+
+// === Private Variables ===
+//
+#define GPIO_MASK_LEVEL			NVIC_PLAN_PREEMPT_UI	// Port configuration is only changed by thread code and UI handlers
+
+/*
+ * GPIO descriptor table, indexed by port code: the ports are 0x400 apart from GPIOA
+ */
+static const PERIPH_Desc_t GpioDesc[] =
+{
+	PERIPH_DESC(GPIOA_BASE, AHB1ENR, AHB1RSTR, 0, IRQ_NO_NONE, 0),
+	PERIPH_DESC(GPIOB_BASE, AHB1ENR, AHB1RSTR, 1, IRQ_NO_NONE, 1),
+	PERIPH_DESC(GPIOC_BASE, AHB1ENR, AHB1RSTR, 2, IRQ_NO_NONE, 2),
+	PERIPH_DESC(GPIOD_BASE, AHB1ENR, AHB1RSTR, 3, IRQ_NO_NONE, 3),
+	PERIPH_DESC(GPIOE_BASE, AHB1ENR, AHB1RSTR, 4, IRQ_NO_NONE, 4),
+	PERIPH_DESC(GPIOF_BASE, AHB1ENR, AHB1RSTR, 5, IRQ_NO_NONE, 5),
+	PERIPH_DESC(GPIOG_BASE, AHB1ENR, AHB1RSTR, 6, IRQ_NO_NONE, 6),
+	PERIPH_DESC(GPIOH_BASE, AHB1ENR, AHB1RSTR, 7, IRQ_NO_NONE, 7),
+};
+
+#define GPIO_NUM_PORTS			(sizeof(GpioDesc) / sizeof(*GpioDesc))
+
+static uint16_t PinUsed[GPIO_NUM_PORTS];		// Pins configured by GPIO_Init: one port clock reference each
+static uint16_t ExtiUsed[GPIO_NUM_PORTS];		// Configured pins routed to their EXTI line
+static uint8_t SyscfgHeld;						// SET while an EXTI pin holds the SYSCFG clock reference
 
 
 // === Protected Functions ===
 //
+/*!
+ * @fn			- GpioDescriptor
+ *
+ * @brief 		- Looks up the descriptor of the GPIO port by address arithmetic
+ *
+ * @param[in]	- *p_GPIO: base address of the GPIO peripheral
+ * @param[out]	- none
+ *
+ * @return 		- Descriptor, NULL if the address is not a GPIO port
+ *
+ * @note		- none
+*/
+static inline const PERIPH_Desc_t *GpioDescriptor (GPIO_RegDef_t *p_GPIO)
+{
+	uint32_t index = ((uint32_t)p_GPIO - GPIOA_BASE) >> 10;
+
+	if ((index < (sizeof(GpioDesc) / sizeof(*GpioDesc))) && (GpioDesc[index].baseAddr == (uint32_t)p_GPIO))
+	{
+		return &GpioDesc[index];
+	}
+
+	return NULL;
+}
+
 /*!
  * @fn			- PortCode
  *
@@ -23,13 +76,41 @@
 */
 static inline uint8_t PortCode (GPIO_RegDef_t *p_GPIO)
 {
-	return (GPIOA == p_GPIO) ? 0 :
-		   (GPIOB == p_GPIO) ? 1 :
-		   (GPIOC == p_GPIO) ? 2 :
-		   (GPIOD == p_GPIO) ? 3 :
-		   (GPIOE == p_GPIO) ? 4 :
-		   (GPIOE == p_GPIO) ? 5 :
-		   (GPIOG == p_GPIO) ? 6 : 7;
+	const PERIPH_Desc_t *p_Desc = GpioDescriptor(p_GPIO);
+
+	return p_Desc ? p_Desc->code : 0;
+}
+
+/*!
+ * @fn			- SyscfgUpdate
+ *
+ * @brief 		- Holds the SYSCFG clock reference while at least one EXTI pin is configured
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Caller holds the GPIO mask
+*/
+static void SyscfgUpdate (void)
+{
+	uint8_t used = RESET;
+
+	for (uint8_t port = 0; port < GPIO_NUM_PORTS; ++port)
+	{
+		if (ExtiUsed[port])
+		{
+			used = SET;
+			break;
+		}
+	}
+
+	if (used != SyscfgHeld)
+	{
+		PCLK_Control(&RCC->APB2ENR, RCC_APB2ENRREG_SYSCFGEN, used ? ENABLE : DISABLE);
+		SyscfgHeld = used;
+	}
 }
 
 
@@ -50,85 +131,7 @@ static inline uint8_t PortCode (GPIO_RegDef_t *p_GPIO)
 */
 void GPIO_PeriClockControl (GPIO_RegDef_t *p_GPIO, uint8_t enable)
 {
-	if (enable)
-	{
-
-		if (GPIOA == p_GPIO)
-		{
-			GPIOA_PCLK_EN();
-		}
-		else if (GPIOB == p_GPIO)
-		{
-			GPIOB_PCLK_EN();
-		}
-		else if (GPIOC == p_GPIO)
-		{
-			GPIOC_PCLK_EN();
-		}
-		else if (GPIOD == p_GPIO)
-		{
-			GPIOD_PCLK_EN();
-		}
-		else if (GPIOE == p_GPIO)
-		{
-			GPIOE_PCLK_EN();
-		}
-		else if (GPIOF == p_GPIO)
-		{
-			GPIOF_PCLK_EN();
-		}
-		else if (GPIOG == p_GPIO)
-		{
-			GPIOG_PCLK_EN();
-		}
-		else if (GPIOH == p_GPIO)
-		{
-			GPIOH_PCLK_EN();
-		}
-		else
-		{
-			// NOP
-		}
-	}
-	else
-	{
-		if (GPIOA == p_GPIO)
-		{
-			GPIOA_PCLK_DI();
-		}
-		else if (GPIOB == p_GPIO)
-		{
-			GPIOB_PCLK_DI();
-		}
-		else if (GPIOC == p_GPIO)
-		{
-			GPIOC_PCLK_DI();
-		}
-		else if (GPIOD == p_GPIO)
-		{
-			GPIOD_PCLK_DI();
-		}
-		else if (GPIOE == p_GPIO)
-		{
-			GPIOE_PCLK_DI();
-		}
-		else if (GPIOF == p_GPIO)
-		{
-			GPIOF_PCLK_DI();
-		}
-		else if (GPIOG == p_GPIO)
-		{
-			GPIOG_PCLK_DI();
-		}
-		else if (GPIOH == p_GPIO)
-		{
-			GPIOH_PCLK_DI();
-		}
-		else
-		{
-			// NOP
-		}
-	}
+	PERIPH_ClockControl(GpioDescriptor(p_GPIO), enable);
 }
 
 /*!
@@ -145,13 +148,30 @@ void GPIO_PeriClockControl (GPIO_RegDef_t *p_GPIO, uint8_t enable)
 */
 void GPIO_Init (GPIO_Handle_t *p_GPIOhandle)
 {
+	const PERIPH_Desc_t *p_Desc = GpioDescriptor(p_GPIOhandle->p_GPIOx);
+	uint16_t pinMask = (uint16_t)(1u << p_GPIOhandle->pinConfig.pinNumber);
+	uint8_t port;
 	uint32_t temp = 0;
+	uint32_t basepri;
+
+	if (!p_Desc)
+	{
+		return;
+	}
+	port = (uint8_t)(p_Desc - GpioDesc);
+
+	// Port registers are shared by all pins: no handler touching GPIO may run between read and write
+	basepri = ATOMIC_MaskEnter(GPIO_MASK_LEVEL);
 
-	// 0. Enable GPIO Periphery Clock
-	GPIO_PeriClockControl(p_GPIOhandle->p_GPIOx, ENABLE);
+	// 0. Enable GPIO Periphery Clock: one reference per configured pin, a re-initialised pin keeps its own
+	if (!(PinUsed[port] & pinMask))
+	{
+		PERIPH_ClockControl(p_Desc, ENABLE);
+		PinUsed[port] |= pinMask;
+	}
 
 	// 1. Mode
-	if (p_GPIOhandle->pinConfig.pinMode < GPIO_MODE_IT_FT)
+	if (p_GPIOhandle->pinConfig.pinMode <= GPIO_MODE_ANALOG)
 	{
 		// Non-Interrupt mode
 		temp = ~(0x3 <<  (p_GPIOhandle->pinConfig.pinNumber << 1));									// Clearing the bits to be set
@@ -160,31 +180,40 @@ void GPIO_Init (GPIO_Handle_t *p_GPIOhandle)
 		temp = p_GPIOhandle->pinConfig.pinMode << (p_GPIOhandle->pinConfig.pinNumber << 1);			// Setting the bits
 		p_GPIOhandle->p_GPIOx->MODER |= temp;
 
+		// The pin leaves its EXTI line
+		if (ExtiUsed[port] & pinMask)
+		{
+			BITBAND_PERIPH(&EXTI->IMR, p_GPIOhandle->pinConfig.pinNumber) = 0;
+			ExtiUsed[port] &= ~pinMask;
+			SyscfgUpdate();
+		}
 	}
 	else
 	{
-		// Interrupt mode
+		// Interrupt mode: the pin is an input
+		p_GPIOhandle->p_GPIOx->MODER &= ~(0x3 << (p_GPIOhandle->pinConfig.pinNumber << 1));
+
 		switch (p_GPIOhandle->pinConfig.pinMode)
 		{
 			case GPIO_MODE_IT_RT:
 			{
 				// 1. Configure the rising edge trigger selection register RTSR
-				EXTI->RTSR |= (1 << p_GPIOhandle->pinConfig.pinNumber);				// Set RTSR
-				EXTI->FTSR &= ~(1 << p_GPIOhandle->pinConfig.pinNumber);			// Clear FTSR
+				BITBAND_PERIPH(&EXTI->RTSR, p_GPIOhandle->pinConfig.pinNumber) = 1;	// Set RTSR
+				BITBAND_PERIPH(&EXTI->FTSR, p_GPIOhandle->pinConfig.pinNumber) = 0;	// Clear FTSR
 				break;
 			}
 			case GPIO_MODE_IT_FT:
 			{
 				// 1. Configure the falling edge trigger selection register FTSR
-				EXTI->FTSR |= (1 << p_GPIOhandle->pinConfig.pinNumber);				// Set FTSR
-				EXTI->RTSR &= ~(1 << p_GPIOhandle->pinConfig.pinNumber);			// Clear RTSR
+				BITBAND_PERIPH(&EXTI->FTSR, p_GPIOhandle->pinConfig.pinNumber) = 1;	// Set FTSR
+				BITBAND_PERIPH(&EXTI->RTSR, p_GPIOhandle->pinConfig.pinNumber) = 0;	// Clear RTSR
 				break;
 			}
 			case GPIO_MODE_IT_FRT:
 			{
 				// 1. Configure both rising and falling edge trigger selection registers
-				EXTI->RTSR |= (1 << p_GPIOhandle->pinConfig.pinNumber);				// Set RTSR
-				EXTI->FTSR |= (1 << p_GPIOhandle->pinConfig.pinNumber);				// Set FTSR
+				BITBAND_PERIPH(&EXTI->RTSR, p_GPIOhandle->pinConfig.pinNumber) = 1;	// Set RTSR
+				BITBAND_PERIPH(&EXTI->FTSR, p_GPIOhandle->pinConfig.pinNumber) = 1;	// Set FTSR
 				break;
 			}
 			default:
@@ -197,11 +226,17 @@ void GPIO_Init (GPIO_Handle_t *p_GPIOhandle)
 		// 2. Configure the GPIO port selection in SYSCFG_EXTICR (Enable IT at EXTI peripheral site)
 		uint8_t extiRegSelect = p_GPIOhandle->pinConfig.pinNumber / 4;
 		uint8_t extiRegSection = (p_GPIOhandle->pinConfig.pinNumber % 4) * 4;
-		SYSCFG_PCLK_EN();
-		SYSCFG->EXTICR[extiRegSelect] = PortCode(p_GPIOhandle->p_GPIOx) << extiRegSection;
+		for (uint8_t other = 0; other < GPIO_NUM_PORTS; ++other)
+		{
+			ExtiUsed[other] &= ~pinMask;													// The line moves to this port
+		}
+		ExtiUsed[port] |= pinMask;
+		SyscfgUpdate();
+		SYSCFG->EXTICR[extiRegSelect] &= ~(0xf << extiRegSection);								// Keep the other lines of the register
+		SYSCFG->EXTICR[extiRegSelect] |= PortCode(p_GPIOhandle->p_GPIOx) << extiRegSection;
 
 		// 3. Enable the EXTI interrupt delivery using IMR (Interrupt Mask Register)
-		EXTI->IMR |= (1 << p_GPIOhandle->pinConfig.pinNumber);
+		BITBAND_PERIPH(&EXTI->IMR, p_GPIOhandle->pinConfig.pinNumber) = 1;
 
 	}
 
@@ -222,7 +257,7 @@ void GPIO_Init (GPIO_Handle_t *p_GPIOhandle)
 	// 4. Output type => Set just in case of OutPut Mode
 	if (GPIO_MODE_OUT == p_GPIOhandle->pinConfig.pinMode)
 	{
-		temp = ~(0x3 <<  (p_GPIOhandle->pinConfig.pinNumber << 1));											// Clearing the bits to be set
+		temp = ~(0x1 << p_GPIOhandle->pinConfig.pinNumber);													// Clearing the bit to be set (1 bit field)
 		p_GPIOhandle->p_GPIOx->OTYPER &= temp;
 		temp = 0;
 		temp = p_GPIOhandle->pinConfig.pinOPType << p_GPIOhandle->pinConfig.pinNumber;						// Setting the bits
@@ -239,6 +274,8 @@ void GPIO_Init (GPIO_Handle_t *p_GPIOhandle)
 		temp = p_GPIOhandle->pinConfig.pinAltFunMode << ((p_GPIOhandle->pinConfig.pinNumber % 8) << 2); 	// Clearing the bits to be set
 		p_GPIOhandle->p_GPIOx->AFR[afrRegSelect] |= temp;
 	}
+
+	ATOMIC_MaskExit(basepri);
 }
 
 /*!
@@ -251,50 +288,49 @@ void GPIO_Init (GPIO_Handle_t *p_GPIOhandle)
  *
  * @return 		- none
  *
- * @note		- none
+ * @note		- Drops the reference of every pin configured by GPIO_Init and masks their EXTI lines.
+ * 				  The port is reset and gated unless another driver still holds a reference.
 */
 void GPIO_DeInit (GPIO_RegDef_t *p_GPIO)
 {
-	// Reset the RCC register regarding the designated GPIO periphery
-	if (GPIOA == p_GPIO)
-	{
-		GPIOA_REG_RESET();
-	}
-	else if (GPIOB == p_GPIO)
-	{
-		GPIOB_REG_RESET();
-	}
-	else if (GPIOC == p_GPIO)
-	{
-		GPIOC_REG_RESET();
-	}
-	else if (GPIOD == p_GPIO)
-	{
-		GPIOD_REG_RESET();
-	}
-	else if (GPIOE == p_GPIO)
-	{
-		GPIOE_REG_RESET();
-	}
-	else if (GPIOF == p_GPIO)
+	const PERIPH_Desc_t *p_Desc = GpioDescriptor(p_GPIO);
+	uint8_t port, pins = 0;
+	uint32_t basepri;
+
+	if (!p_Desc)
 	{
-		GPIOF_REG_RESET();
+		return;
 	}
-	else if (GPIOG == p_GPIO)
+	port = (uint8_t)(p_Desc - GpioDesc);
+
+	basepri = ATOMIC_MaskEnter(GPIO_MASK_LEVEL);
+
+	// 1. EXTI lines of the port
+	for (uint8_t pin = 0; pin < 16; ++pin)
 	{
-		GPIOG_REG_RESET();
+		if (ExtiUsed[port] & (1u << pin))
+		{
+			BITBAND_PERIPH(&EXTI->IMR, pin) = 0;
+		}
+		pins += (PinUsed[port] >> pin) & 1;
 	}
-	else if (GPIOH == p_GPIO)
+	ExtiUsed[port] = 0;
+	SyscfgUpdate();
+
+	// 2. Reset the RCC register regarding the designated GPIO periphery, unless another driver still uses the port
+	if (pins && (PCLK_GetCount(p_Desc->p_ClkEnReg, p_Desc->clkEnBit) <= pins))
 	{
-		GPIOH_REG_RESET();
+		PERIPH_Reset(p_Desc);
 	}
-	else
+
+	// 3. Disable GPIO Periphery Clock: the references of the configured pins
+	while (pins--)
 	{
-		// NOP
+		PERIPH_ClockControl(p_Desc, DISABLE);
 	}
+	PinUsed[port] = 0;
 
-	// Disable GPIO Periphery Clock
-	GPIO_PeriClockControl(p_GPIO, DISABLE);
+	ATOMIC_MaskExit(basepri);
 }
 
 /*!
@@ -350,17 +386,17 @@ uint16_t GPIO_ReadPort (GPIO_RegDef_t *p_GPIO)
  *
  * @return 		- none
  *
- * @note		- none
+ * @note		- BSRR: single store, the other pins of the port can not be overwritten by a preempted ODR update
 */
 void GPIO_WritePin (GPIO_RegDef_t *p_GPIO, uint8_t pinNumber, uint8_t value)
 {
 	if (SET == (value & 0x01))
 	{
-		p_GPIO->ODR |= (1 << pinNumber);		// Set pin
+		p_GPIO->BSRR = (1 << pinNumber);			// Set pin
 	}
 	else
 	{
-		p_GPIO->ODR &= ~(1 << pinNumber);		// Clear pin
+		p_GPIO->BSRR = (1 << (pinNumber + 16));	// Clear pin
 	}
 }
 
@@ -393,13 +429,104 @@ void GPIO_WritePort (GPIO_RegDef_t *p_GPIO, uint16_t value)
  *
  * @return 		- none
  *
- * @note		- none
+ * @note		- BSRR based, the other pins of the port are never written
 */
 void GPIO_TogglePin (GPIO_RegDef_t *p_GPIO, uint8_t pinNumber)
 {
-	p_GPIO->ODR ^= (1 << pinNumber);
+	uint32_t pin = (1 << pinNumber);
+
+	// Set if low, reset if high: only the selected pin is written
+	p_GPIO->BSRR = (p_GPIO->ODR & pin) ? (pin << 16) : pin;
+}
+
+/*!
+ * @fn			- GPIO_SnapshotSave
+ *
+ * @brief 		- Saves the configuration and output registers of the selected ports
+ *
+ * @param[out]	- *p_Snapshot: array of snapshots, p_GPIOx of each entry selects the port
+ * @param[in]	- count: number of snapshots in the array
+ *
+ * @return 		- none
+ *
+ * @note		- The port clocks must be enabled
+*/
+void GPIO_SnapshotSave (GPIO_Snapshot_t *p_Snapshot, uint8_t count)
+{
+	while (count --> 0)
+	{
+		GPIO_RegDef_t *p_GPIO = p_Snapshot->p_GPIOx;
+
+		p_Snapshot->MODER = p_GPIO->MODER;
+		p_Snapshot->OTYPER = p_GPIO->OTYPER;
+		p_Snapshot->OSPEEDR = p_GPIO->OSPEEDR;
+		p_Snapshot->PUPDR = p_GPIO->PUPDR;
+		p_Snapshot->ODR = p_GPIO->ODR;
+		p_Snapshot->AFR[0] = p_GPIO->AFR[0];
+		p_Snapshot->AFR[1] = p_GPIO->AFR[1];
+		p_Snapshot++;
+	}
+}
+
+/*!
+ * @fn			- GPIO_SnapshotRestore
+ *
+ * @brief 		- Restores the ports saved by GPIO_SnapshotSave with plain register stores
+ *
+ * @param[in]	- *p_Snapshot: array of snapshots
+ * @param[in]	- count: number of snapshots in the array
+ *
+ * @return 		- none
+ *
+ * @note		- MODER is written last, so a pin turns back into an output / AF pin with its
+ * 				  level, type, pull and function already in place (no glitch)
+*/
+void GPIO_SnapshotRestore (const GPIO_Snapshot_t *p_Snapshot, uint8_t count)
+{
+	while (count --> 0)
+	{
+		GPIO_RegDef_t *p_GPIO = p_Snapshot->p_GPIOx;
+
+		p_GPIO->ODR = p_Snapshot->ODR;
+		p_GPIO->OTYPER = p_Snapshot->OTYPER;
+		p_GPIO->OSPEEDR = p_Snapshot->OSPEEDR;
+		p_GPIO->PUPDR = p_Snapshot->PUPDR;
+		p_GPIO->AFR[0] = p_Snapshot->AFR[0];
+		p_GPIO->AFR[1] = p_Snapshot->AFR[1];
+		p_GPIO->MODER = p_Snapshot->MODER;
+		p_Snapshot++;
+	}
 }
 
+/*!
+ * @fn			- GPIO_SetPortAnalog
+ *
+ * @brief 		- Switches the pins of the port to analog mode without pull-up / pull-down
+ *
+ * @param[in]	- *p_GPIO: base address of the GPIO peripheral
+ * @param[in]	- keepMask: pins left untouched (wake-up inputs, SWD PA13/PA14, ...)
+ *
+ * @return 		- none
+ *
+ * @note		- Analog mode disconnects the Schmitt trigger, this is the lowest current pin state
+*/
+void GPIO_SetPortAnalog (GPIO_RegDef_t *p_GPIO, uint16_t keepMask)
+{
+	uint32_t keep2 = 0;		// keepMask spread to the 2 bit fields
+
+	for (uint8_t pin = 0; pin < 16; ++pin)
+	{
+		if (keepMask & (1 << pin))
+		{
+			keep2 |= (0x3u << (pin << 1));
+		}
+	}
+
+	uint32_t basepri = ATOMIC_MaskEnter(GPIO_MASK_LEVEL);
+	p_GPIO->PUPDR &= keep2;
+	p_GPIO->MODER |= ~keep2;
+	ATOMIC_MaskExit(basepri);
+}
 
 /*!
  * @fn			- GPIO_IRQHandling
@@ -418,7 +545,7 @@ void GPIO_IRQHandling (uint8_t pinNumber)
 	// 1. Clear the EXTI PR pending register corresponding to the pin number
 	if (EXTI->PR & (1 << pinNumber) )
 	{
-		EXTI->PR |= (1 << pinNumber);	// Clearing the pending register
+		EXTI->PR = (1 << pinNumber);	// Write-1-to-clear: "|=" would clear every pending line
 	}
 }
 
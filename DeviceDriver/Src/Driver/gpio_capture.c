@@ -0,0 +1,227 @@
+/** @file gpio_capture.c
+*
+* @brief Run-length-compressed GPIO port capture (on-target logic analyzer).
+*
+* The port is polled as fast as the core can read IDR, and only the transitions are stored as
+* (DWT cycle delta, new value) records, so a mostly idle bus fits into a small SRAM ring.
+*
+*/
+
+#include <stddef.h>
+#include "gpio_capture.h"
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- PushRecord
+ *
+ * @brief 		- Stores a record in the ring according to the full-ring policy
+ *
+ * @param[in]	- *p_Capture: pointer to the capture descriptor
+ * @param[in]	- value: port value
+ * @param[in]	- delta: cycles since the previous record
+ *
+ * @return 		- SET: record stored, RESET: ring full in STOP mode (capture must end)
+ *
+ * @note		- Kept inline, it is called from the sampling loop
+*/
+static inline uint8_t PushRecord (GPIO_Capture_t *p_Capture, uint16_t value, uint16_t delta)
+{
+	if (p_Capture->count == p_Capture->size)
+	{
+		p_Capture->overflow = SET;
+		if (GPIO_CAPTURE_MODE_STOP == p_Capture->mode)
+		{
+			return RESET;
+		}
+	}
+	else
+	{
+		p_Capture->count++;
+	}
+
+	p_Capture->p_Ring[p_Capture->head].value = value;
+	p_Capture->p_Ring[p_Capture->head].delta = delta;
+	p_Capture->head = (p_Capture->head + 1) & (p_Capture->size - 1);
+
+	return SET;
+}
+
+/*!
+ * @fn			- ITM_SendWord
+ *
+ * @brief 		- Writes a 32 bit word to an ITM stimulus port
+ *
+ * @param[in]	- itmPort: stimulus port number
+ * @param[in]	- word: data to be sent
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Blocks while the stimulus FIFO is full
+*/
+static void ITM_SendWord (uint8_t itmPort, uint32_t word)
+{
+	while (!(ITM->PORT[itmPort] & 1));
+	ITM->PORT[itmPort] = word;
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- GPIO_Capture_Init
+ *
+ * @brief 		- Empties the ring and starts the DWT cycle counter
+ *
+ * @param[in]	- *p_Capture: port, pin mask, mode and ring buffer filled in by the caller
+ * @param[out]	- none
+ *
+ * @return 		- @GPIO_CAPTURE_STATUS
+ *
+ * @note		- The port must already be configured as input. The ring index is masked with
+ * 				  size - 1, so only GPIO_CAPTURE_OK allows GPIO_Capture_Run.
+*/
+uint8_t GPIO_Capture_Init (GPIO_Capture_t *p_Capture)
+{
+	if ((NULL == p_Capture->p_Ring) || (0 == p_Capture->size) || (p_Capture->size & (p_Capture->size - 1)))
+	{
+		return GPIO_CAPTURE_ERR_RING;
+	}
+
+	p_Capture->head = 0;
+	p_Capture->count = 0;
+	p_Capture->overflow = RESET;
+	p_Capture->samples = 0;
+	p_Capture->cycles = 0;
+
+	DWT_CYCCNT_EN();
+
+	return GPIO_CAPTURE_OK;
+}
+
+/*!
+ * @fn			- GPIO_Capture_Run
+ *
+ * @brief 		- Samples the port continuously and records the transitions
+ *
+ * @param[in]	- *p_Capture: pointer to the capture descriptor
+ * @param[in]	- durationCycles: capture window in CPU cycles
+ * @param[out]	- none
+ *
+ * @return 		- Number of records in the ring
+ *
+ * @note		- Blocking. The first record is the initial port value with zero delta.
+ * 				  samples / cycles gives the achieved sampling rate, (samples * 2) / (records * 4)
+ * 				  the compression ratio against a raw 16 bit sample dump.
+*/
+uint16_t GPIO_Capture_Run (GPIO_Capture_t *p_Capture, uint32_t durationCycles)
+{
+	volatile uint32_t *p_IDR = &p_Capture->p_GPIOx->IDR;		// GPIO_ReadPort() without the call overhead
+	const uint16_t pinMask = p_Capture->pinMask;
+	uint32_t samples = 1;
+
+	uint32_t start = DWT_CYCCNT();
+	uint32_t last = start;
+	uint32_t now = start;
+	uint16_t value = (uint16_t)*p_IDR & pinMask;
+
+	if (PushRecord(p_Capture, value, 0))
+	{
+		while ((now - start) < durationCycles)
+		{
+			// 1. Timestamp and sample
+			now = DWT_CYCCNT();
+			uint16_t sample = (uint16_t)*p_IDR & pinMask;
+			samples++;
+
+			if (sample == value)
+			{
+				continue;
+			}
+
+			// 2. Transition: split long idle periods, then store the new value
+			uint32_t delta = now - last;
+			uint8_t stored = SET;
+			while (stored && (delta > GPIO_CAPTURE_DELTA_MAX))
+			{
+				stored = PushRecord(p_Capture, value, GPIO_CAPTURE_DELTA_MAX);
+				delta -= GPIO_CAPTURE_DELTA_MAX;
+			}
+
+			if (!stored || !PushRecord(p_Capture, sample, (uint16_t)delta))
+			{
+				break;
+			}
+
+			value = sample;
+			last = now;
+		}
+	}
+
+	p_Capture->samples = samples;
+	p_Capture->cycles = now - start;
+
+	return p_Capture->count;
+}
+
+/*!
+ * @fn			- GPIO_Capture_GetRecord
+ *
+ * @brief 		- Reads a record from the ring, the oldest one has index 0
+ *
+ * @param[in]	- *p_Capture: pointer to the capture descriptor
+ * @param[in]	- index: record index
+ * @param[out]	- *p_Record: the record
+ *
+ * @return 		- SET: valid record, RESET: index out of range
+ *
+ * @note		- none
+*/
+uint8_t GPIO_Capture_GetRecord (GPIO_Capture_t *p_Capture, uint16_t index, GPIO_CaptureRecord_t *p_Record)
+{
+	if (index >= p_Capture->count)
+	{
+		return RESET;
+	}
+
+	uint16_t tail = (p_Capture->head - p_Capture->count) & (p_Capture->size - 1);
+	*p_Record = p_Capture->p_Ring[(tail + index) & (p_Capture->size - 1)];
+
+	return SET;
+}
+
+/*!
+ * @fn			- GPIO_Capture_DumpITM
+ *
+ * @brief 		- Sends the ring over an ITM stimulus port, oldest record first
+ *
+ * @param[in]	- *p_Capture: pointer to the capture descriptor
+ * @param[in]	- itmPort: stimulus port, GPIO_CAPTURE_ITM_PORT by default
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Format: header word (GPIO_CAPTURE_ITM_SYNC << 16 | count), cycle count word,
+ * 				  then one word per record: (delta << 16) | value
+*/
+void GPIO_Capture_DumpITM (GPIO_Capture_t *p_Capture, uint8_t itmPort)
+{
+	GPIO_CaptureRecord_t record;
+
+	// Enable the ITM and the stimulus port
+	COREDEBUG->DEMCR |= (1 << COREDEBUG_DEMCRREG_TRCENA);
+	ITM->TCR |= (1 << ITM_TCRREG_ITMENA);
+	ITM->TER |= (1 << itmPort);
+
+	ITM_SendWord(itmPort, ((uint32_t)GPIO_CAPTURE_ITM_SYNC << 16) | p_Capture->count);
+	ITM_SendWord(itmPort, p_Capture->cycles);
+
+	for (uint16_t i = 0; GPIO_Capture_GetRecord(p_Capture, i, &record); ++i)
+	{
+		ITM_SendWord(itmPort, ((uint32_t)record.delta << 16) | record.value);
+	}
+}
+
+/*** EOF ***/
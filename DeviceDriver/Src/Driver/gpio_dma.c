@@ -0,0 +1,325 @@
+/** @file gpio_dma.c
+*
+* @brief Timer-paced DMA pattern generator and sampler on GPIO ports.
+*
+* The timer update event raises a DMA request on every period, so the port is written / read
+* at a cycle-exact rate without any CPU involvement.
+*
+*/
+
+#include "gpio_dma.h"
+#include "pclk.h"
+
+
+// === Private Variables ===
+//
+static DMA_Handle_t DmaPattern =
+{
+	.p_DMAx 				= DMA2,
+	.stream 				= GPIO_DMA_PATTERN_STREAM,
+	.DmaConfig.channel		= GPIO_DMA_PATTERN_CHANNEL,
+	.DmaConfig.direction	= DMA_DIR_M2P,
+	.DmaConfig.periphInc	= DISABLE,
+	.DmaConfig.memInc		= ENABLE,
+	.DmaConfig.periphSize	= DMA_SIZE_WORD,
+	.DmaConfig.memSize		= DMA_SIZE_WORD,
+	.DmaConfig.priority		= DMA_PRIORITY_VHIGH,
+};
+
+static DMA_Handle_t DmaSample =
+{
+	.p_DMAx 				= DMA2,
+	.stream 				= GPIO_DMA_SAMPLE_STREAM,
+	.DmaConfig.channel		= GPIO_DMA_SAMPLE_CHANNEL,
+	.DmaConfig.direction	= DMA_DIR_P2M,
+	.DmaConfig.periphInc	= DISABLE,
+	.DmaConfig.memInc		= ENABLE,
+	.DmaConfig.periphSize	= DMA_SIZE_HALFWORD,
+	.DmaConfig.memSize		= DMA_SIZE_HALFWORD,
+	.DmaConfig.priority		= DMA_PRIORITY_VHIGH,
+};
+
+static uint16_t SampleLen;
+static uint8_t PatternTimClk;		// SET while the TIM1 clock reference is held
+static uint8_t SampleTimClk;		// SET while the TIM8 clock reference is held
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- TimerPaceStart
+ *
+ * @brief 		- Starts the timer with an update DMA request on every period
+ *
+ * @param[in]	- *p_TIM: base address of the timer
+ * @param[in]	- period: number of timer input clock cycles between two DMA requests (>= GPIO_DMA_PERIOD_MIN)
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- TIM1 and TIM8 are clocked from APB2 (x2 if the APB2 prescaler is not 1)
+ * 				  The smallest prescaler that brings ARR into 16 bits is taken, so the period is exact
+ * 				  up to 65536 cycles and rounded down to a multiple of (PSC + 1) above that
+*/
+static void TimerPaceStart (TIM_RegDef_t *p_TIM, uint32_t period)
+{
+	uint16_t prescaler = (uint16_t)((period - 1) >> 16);		// ceil(period / 65536) - 1
+	uint16_t reload = (uint16_t)((period / ((uint32_t)prescaler + 1)) - 1);	// <= 65535 by choice of PSC
+
+	p_TIM->CR1 = 0;
+	p_TIM->DIER = 0;
+	p_TIM->PSC = prescaler;
+	p_TIM->ARR = reload;
+	p_TIM->CNT = 0;
+
+	// Load the prescaler with an update event before the DMA request is enabled
+	p_TIM->EGR = (1 << TIM_EGRREG_UG);
+	p_TIM->SR = 0;
+
+	p_TIM->DIER = (1 << TIM_DIERREG_UDE);
+	p_TIM->CR1 = (1 << TIM_CR1REG_CEN);
+}
+
+/*!
+ * @fn			- TimerPaceStop
+ *
+ * @brief 		- Stops the pacing timer and its DMA request
+ *
+ * @param[in]	- *p_TIM: base address of the timer
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void TimerPaceStop (TIM_RegDef_t *p_TIM)
+{
+	p_TIM->CR1 &= ~(1 << TIM_CR1REG_CEN);
+	p_TIM->DIER = 0;
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- GPIO_DMA_BuildPattern
+ *
+ * @brief 		- Converts port values into BSRR words
+ *
+ * @param[out]	- *p_Bsrr: BSRR word buffer (len items)
+ * @param[in]	- *p_Values: port output values (len items)
+ * @param[in]	- len: number of pattern steps
+ * @param[in]	- pinMask: pins driven by the pattern, the other pins of the port are untouched
+ *
+ * @return 		- none
+ *
+ * @note		- Each word both sets and resets the masked pins, so a step is a single bus write
+*/
+void GPIO_DMA_BuildPattern (uint32_t *p_Bsrr, const uint16_t *p_Values, uint16_t len, uint16_t pinMask)
+{
+	while (len --> 0)
+	{
+		*p_Bsrr++ = GPIO_DMA_BSRR(*p_Values, pinMask);
+		p_Values++;
+	}
+}
+
+/*!
+ * @fn			- GPIO_DMA_PatternStart
+ *
+ * @brief 		- Streams a BSRR pattern to the port at a fixed rate
+ *
+ * @param[in]	- *p_GPIO: base address of the GPIO peripheral
+ * @param[in]	- *p_Bsrr: pattern built by GPIO_DMA_BuildPattern
+ * @param[in]	- len: number of pattern steps
+ * @param[in]	- period: timer input clock cycles per step (>= GPIO_DMA_PERIOD_MIN)
+ * @param[in]	- circular: ENABLE repeats the pattern until GPIO_DMA_PatternStop
+ *
+ * @return 		- @DMA_STATUS, DMA_ERR_BUSY if another driver owns the stream, DMA_ERR_PARAM if the
+ * 				  period cannot be paced
+ *
+ * @note		- The pins must be configured as outputs beforehand
+ * 				  Pair it with GPIO_DMA_PatternStop, which releases the stream and the timer clock
+*/
+uint8_t GPIO_DMA_PatternStart (GPIO_RegDef_t *p_GPIO, const uint32_t *p_Bsrr, uint16_t len, uint32_t period, uint8_t circular)
+{
+	uint8_t status;
+
+	if (period < GPIO_DMA_PERIOD_MIN)
+	{
+		return DMA_ERR_PARAM;
+	}
+
+	// 1. Claim and configure the stream
+	TimerPaceStop(GPIO_DMA_PATTERN_TIM);
+	DmaPattern.DmaConfig.circular = circular;
+	status = DMA_Init(&DmaPattern);
+	if (DMA_OK != status)
+	{
+		return status;
+	}
+
+	// 2. Arm the stream: memory -> BSRR
+	DMA_Start(&DmaPattern, (uint32_t)&p_GPIO->BSRR, (uint32_t)p_Bsrr, len);
+
+	// 3. Start pacing: one timer clock reference across restarts
+	if (!PatternTimClk)
+	{
+		PCLK_Control(&RCC->APB2ENR, RCC_APB2ENRREG_TIM1EN, ENABLE);
+		PatternTimClk = SET;
+	}
+	TimerPaceStart(GPIO_DMA_PATTERN_TIM, period);
+
+	return DMA_OK;
+}
+
+/*!
+ * @fn			- GPIO_DMA_PatternStop
+ *
+ * @brief 		- Stops the pattern generator, the port keeps the last written value
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void GPIO_DMA_PatternStop (void)
+{
+	TimerPaceStop(GPIO_DMA_PATTERN_TIM);
+	DMA_Release(&DmaPattern);
+	if (PatternTimClk)
+	{
+		PCLK_Control(&RCC->APB2ENR, RCC_APB2ENRREG_TIM1EN, DISABLE);
+		PatternTimClk = RESET;
+	}
+}
+
+/*!
+ * @fn			- GPIO_DMA_PatternIsBusy
+ *
+ * @brief 		- Checks whether the pattern is still being output
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- SET or RESET
+ *
+ * @note		- none
+*/
+uint8_t GPIO_DMA_PatternIsBusy (void)
+{
+	return DMA_IsBusy(&DmaPattern);
+}
+
+/*!
+ * @fn			- GPIO_DMA_SampleStart
+ *
+ * @brief 		- Samples the port input into memory at a fixed rate
+ *
+ * @param[in]	- *p_GPIO: base address of the GPIO peripheral
+ * @param[out]	- *p_Samples: sample buffer (len items)
+ * @param[in]	- len: number of samples
+ * @param[in]	- period: timer input clock cycles per sample (>= GPIO_DMA_PERIOD_MIN)
+ * @param[in]	- circular: ENABLE keeps overwriting the buffer until GPIO_DMA_SampleStop
+ *
+ * @return 		- @DMA_STATUS, DMA_ERR_BUSY if another driver owns the stream, DMA_ERR_PARAM if the
+ * 				  period cannot be paced
+ *
+ * @note		- Pair it with GPIO_DMA_SampleStop, which releases the stream and the timer clock
+*/
+uint8_t GPIO_DMA_SampleStart (GPIO_RegDef_t *p_GPIO, uint16_t *p_Samples, uint16_t len, uint32_t period, uint8_t circular)
+{
+	uint8_t status;
+
+	if (period < GPIO_DMA_PERIOD_MIN)
+	{
+		return DMA_ERR_PARAM;
+	}
+
+	// 1. Claim and configure the stream
+	TimerPaceStop(GPIO_DMA_SAMPLE_TIM);
+	DmaSample.DmaConfig.circular = circular;
+	status = DMA_Init(&DmaSample);
+	if (DMA_OK != status)
+	{
+		return status;
+	}
+
+	// 2. Arm the stream: IDR -> memory
+	SampleLen = len;
+	DMA_Start(&DmaSample, (uint32_t)&p_GPIO->IDR, (uint32_t)p_Samples, len);
+
+	// 3. Start pacing: one timer clock reference across restarts
+	if (!SampleTimClk)
+	{
+		PCLK_Control(&RCC->APB2ENR, RCC_APB2ENRREG_TIM8EN, ENABLE);
+		SampleTimClk = SET;
+	}
+	TimerPaceStart(GPIO_DMA_SAMPLE_TIM, period);
+
+	return DMA_OK;
+}
+
+/*!
+ * @fn			- GPIO_DMA_SampleStop
+ *
+ * @brief 		- Stops the sampler
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void GPIO_DMA_SampleStop (void)
+{
+	TimerPaceStop(GPIO_DMA_SAMPLE_TIM);
+	DMA_Release(&DmaSample);
+	if (SampleTimClk)
+	{
+		PCLK_Control(&RCC->APB2ENR, RCC_APB2ENRREG_TIM8EN, DISABLE);
+		SampleTimClk = RESET;
+	}
+}
+
+/*!
+ * @fn			- GPIO_DMA_SampleIsBusy
+ *
+ * @brief 		- Checks whether the sampler is still capturing
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- SET or RESET
+ *
+ * @note		- none
+*/
+uint8_t GPIO_DMA_SampleIsBusy (void)
+{
+	return DMA_IsBusy(&DmaSample);
+}
+
+/*!
+ * @fn			- GPIO_DMA_SampleCount
+ *
+ * @brief 		- Number of samples written into the current buffer round
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Write index of the sampler
+ *
+ * @note		- In circular mode this is the position of the next sample to be overwritten.
+ * 				  Read it before GPIO_DMA_SampleStop gives the stream back.
+*/
+uint16_t GPIO_DMA_SampleCount (void)
+{
+	DMA_Stream_RegDef_t *p_Stream = DMA_STREAM(DmaSample.p_DMAx, DmaSample.stream);
+
+	return SampleLen - (uint16_t)p_Stream->NDTR;
+}
+
+/*** EOF ***/
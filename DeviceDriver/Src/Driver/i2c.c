@@ -0,0 +1,1312 @@
+/** @file i2c.c
+*
+* @brief I2C master driver: interrupt state machine, repeated start, DMA for long transfers.
+*
+* A transaction is an optional write phase followed by an optional read phase. Both run in one bus
+* ownership: the read address follows the last written byte with a repeated START, so a register read
+* needs no STOP in between. The event interrupt walks SB, ADDR, TXE, RXNE and BTF; the closing of a
+* read follows the RM0390 sequences for one, two and more bytes, ACK and STOP being set before the
+* hardware shifts in the last byte. Phases of at least I2C_Config_t::dmaThreshold bytes hand the data to
+* a DMA stream: the write ends on BTF, the read on the transfer complete interrupt of the RX stream with
+* LAST set, so the last byte is NACKed by hardware. CCR and TRISE are computed from the live PCLK1.
+*
+* A batch is a list of such transactions (segments), for any mix of device addresses. The ISR loads
+* the next segment itself and ends the running one with a repeated START instead of a STOP: the bus
+* stays owned from the first START to the last STOP and the thread is not involved in between. A
+* NACKed segment (absent sensor) is recorded and the batch goes on, a lost bus ends it.
+*
+*/
+
+#include <stddef.h>
+#include "i2c.h"
+#include "vector.h"
+#include "atomic.h"
+#include "defer.h"
+#include "nvic.h"
+#include "timebase.h"
+
+
+// === Type Definitions ===
+//
+typedef struct I2C_Map
+{
+	PERIPH_Desc_t Desc;				// IRQNumber: event interrupt, the error interrupt follows it
+	DMA_Route_t rxRoutes[2];		// In order of preference, see DMA_Allocate
+	DMA_Route_t txRoutes[2];
+} I2C_Map_t;
+
+
+// === Private Variables ===
+//
+/*
+ * I2C descriptor and DMA request mapping (RM0390 table 28)
+ * 	I2C1 TX prefers DMA1 stream 7 because stream 6 is the USART2 TX stream (console).
+ * 	I2C2 and I2C3 RX both prefer DMA1 stream 2: the second one to claim it falls back to stream 3 (I2C2)
+ * 	or to stream 1 channel 1 (I2C3, shared with USART3 RX).
+ */
+static const I2C_Map_t I2cMap[] =
+{
+	{ PERIPH_DESC(I2C1_BASE, APB1ENR, APB1RSTR, 21, IRQ_NO_I2C1_EV, 1),
+	  { DMA_ROUTE(DMA1, 0, 1), DMA_ROUTE(DMA1, 5, 1) }, { DMA_ROUTE(DMA1, 7, 1), DMA_ROUTE(DMA1, 6, 1) } },
+	{ PERIPH_DESC(I2C2_BASE, APB1ENR, APB1RSTR, 22, IRQ_NO_I2C2_EV, 2),
+	  { DMA_ROUTE(DMA1, 2, 7), DMA_ROUTE(DMA1, 3, 7) }, { DMA_ROUTE(DMA1, 7, 7), DMA_ROUTE_NONE } },
+	{ PERIPH_DESC(I2C3_BASE, APB1ENR, APB1RSTR, 23, IRQ_NO_I2C3_EV, 3),
+	  { DMA_ROUTE(DMA1, 2, 3), DMA_ROUTE(DMA1, 1, 1) }, { DMA_ROUTE(DMA1, 4, 3), DMA_ROUTE_NONE } },
+};
+
+static uint8_t ClockHeld;				// I2cMap index bits: I2C_Init holds the clock reference of the interface
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- I2cMapping
+ *
+ * @brief 		- Looks up the descriptor and DMA mapping of the I2C interface
+ *
+ * @param[in]	- *p_I2C: base address of the I2C peripheral
+ * @param[out]	- none
+ *
+ * @return 		- Mapping, NULL if the address is not an I2C interface
+ *
+ * @note		- The interfaces sit 1 KB apart on APB1
+*/
+static inline const I2C_Map_t *I2cMapping (I2C_RegDef_t *p_I2C)
+{
+	uint32_t index = ((uint32_t)p_I2C - I2C1_BASE) >> 10;
+
+	if ((index < (sizeof(I2cMap) / sizeof(*I2cMap))) && (I2cMap[index].Desc.baseAddr == (uint32_t)p_I2C))
+	{
+		return &I2cMap[index];
+	}
+
+	return NULL;
+}
+
+/*!
+ * @fn			- I2cTiming
+ *
+ * @brief 		- Computes CCR and TRISE for an SCL speed
+ *
+ * @param[in]	- pclkHz: PCLK1
+ * @param[in]	- *p_Config: SCL speed and fast mode duty
+ * @param[out]	- *p_Ccr: CCR word, mode and duty bits included
+ * @param[out]	- *p_Trise: TRISE word
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- The divider is rounded up: the bus never runs faster than asked. Standard mode
+ * 				  needs 2 MHz of PCLK1 and 1000 ns of rise time, fast mode 4 MHz and 300 ns.
+*/
+static uint8_t I2cTiming (uint32_t pclkHz, const I2C_Config_t *p_Config, uint32_t *p_Ccr, uint32_t *p_Trise)
+{
+	uint32_t freqMHz = pclkHz / 1000000U;
+	uint32_t speed = p_Config->sclSpeed;
+	uint32_t ccr;
+
+	if ((0 == speed) || (speed > I2C_SCL_SPEED_FM) || (freqMHz > 50))
+	{
+		return I2C_ERR_SPEED;
+	}
+
+	if (speed <= I2C_SCL_SPEED_SM)
+	{
+		if (freqMHz < 2)
+		{
+			return I2C_ERR_SPEED;
+		}
+
+		ccr = (pclkHz + (2 * speed) - 1) / (2 * speed);				// Thigh = Tlow = CCR * Tpclk
+		if (ccr < 4)
+		{
+			ccr = 4;
+		}
+		*p_Trise = freqMHz + 1;
+	}
+	else
+	{
+		uint32_t parts = (I2C_FM_DUTY_16_9 == p_Config->fmDuty) ? 25 : 3;
+
+		if (freqMHz < 4)
+		{
+			return I2C_ERR_SPEED;
+		}
+
+		ccr = (pclkHz + (parts * speed) - 1) / (parts * speed);		// Tlow + Thigh = parts * CCR * Tpclk
+		if (ccr < 1)
+		{
+			ccr = 1;
+		}
+		*p_Trise = ((freqMHz * 300) / 1000) + 1;
+	}
+
+	if (ccr > 0xFFF)
+	{
+		return I2C_ERR_SPEED;
+	}
+
+	if (speed > I2C_SCL_SPEED_SM)
+	{
+		ccr |= (1 << I2C_CCRREG_FS);
+		ccr |= (uint32_t)((I2C_FM_DUTY_16_9 == p_Config->fmDuty) ? 1 : 0) << I2C_CCRREG_DUTY;
+	}
+
+	*p_Ccr = ccr;
+
+	return I2C_OK;
+}
+
+/*!
+ * @fn			- I2cSetTiming
+ *
+ * @brief 		- Programs FREQ, CCR and TRISE for the configured SCL speed at the current PCLK1
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- CCR and TRISE can only change with PE cleared: the interface is disabled around the
+ * 				  update. The bus must be idle.
+*/
+static uint8_t I2cSetTiming (I2C_Handle_t *p_I2cHandle)
+{
+	I2C_RegDef_t *p_I2Cx = p_I2cHandle->p_I2Cx;
+	uint32_t pclkHz = CLOCK_GetPclk1();
+	uint32_t ccr;
+	uint32_t trise;
+	uint8_t status;
+
+	status = I2cTiming(pclkHz, &p_I2cHandle->I2cConfig, &ccr, &trise);
+	if (I2C_OK != status)
+	{
+		return status;
+	}
+
+	p_I2Cx->CR1 &= ~(1 << I2C_CR1REG_PE);
+	p_I2Cx->CR2 = (p_I2Cx->CR2 & ~0x3FU) | ((pclkHz / 1000000U) << I2C_CR2REG_FREQ);
+	p_I2Cx->CCR = ccr;
+	p_I2Cx->TRISE = trise;
+	p_I2Cx->CR1 |= (1 << I2C_CR1REG_PE);
+
+	return I2C_OK;
+}
+
+/*!
+ * @fn			- I2C_ClockNotify
+ *
+ * @brief 		- Clock switch notification of a tracked I2C handle
+ *
+ * @param[in]	- *p_Context: pointer to the I2C Handler
+ * @param[in]	- event: @CLOCK_EVENT
+ * @param[in]	- *p_Freq: unused, PCLK1 is read back after the switch
+ *
+ * @return 		- none
+ *
+ * @note		- Before the switch new transactions are refused and the running one is given
+ * 				  I2C_RETIME_TIMEOUT_US to release the bus
+*/
+static void I2C_ClockNotify (void *p_Context, uint8_t event, const CLOCK_Freq_t *p_Freq)
+{
+	I2C_Handle_t *p_I2cHandle = (I2C_Handle_t *)p_Context;
+	(void)p_Freq;
+
+	if (CLOCK_EVENT_PRE_CHANGE == event)
+	{
+		TIMEBASE_Timeout_t timeout;
+
+		p_I2cHandle->Hold = SET;
+		TIMEBASE_TimeoutStart(&timeout, I2C_RETIME_TIMEOUT_US);
+		while (((I2C_ST_READY != p_I2cHandle->State) || (p_I2cHandle->p_I2Cx->SR2 & (1 << I2C_SR2REG_BUSY))) &&
+				!TIMEBASE_TimeoutExpired(&timeout));
+		return;
+	}
+
+	// Out of reach at the new clock: the old dividers stay, SCL is off until a faster profile
+	(void)I2cSetTiming(p_I2cHandle);
+
+	p_I2cHandle->Hold = RESET;
+}
+
+/*!
+ * @fn			- I2C_EvDispatch
+ *
+ * @brief 		- Vector table entry of the event interrupt of a bound handle
+ *
+ * @param[in]	- *p_Context: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+_RAMFUNC static void I2C_EvDispatch (void *p_Context)
+{
+	I2C_EV_IRQHandling((I2C_Handle_t *)p_Context);
+}
+
+/*!
+ * @fn			- I2C_ErDispatch
+ *
+ * @brief 		- Vector table entry of the error interrupt of a bound handle
+ *
+ * @param[in]	- *p_Context: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+_RAMFUNC static void I2C_ErDispatch (void *p_Context)
+{
+	I2C_ER_IRQHandling((I2C_Handle_t *)p_Context);
+}
+
+/*!
+ * @fn			- I2C_DeferredEvent
+ *
+ * @brief 		- Runs the application callback of a deferred event outside interrupt context
+ *
+ * @param[in]	- *p_Context: pointer to the I2C Handler
+ * @param[in]	- arg: @I2C_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void I2C_DeferredEvent (void *p_Context, uint32_t arg)
+{
+	I2C_API_EventCallback((I2C_Handle_t *)p_Context, (uint8_t)arg);
+}
+
+/*!
+ * @fn			- I2C_RaiseEvent
+ *
+ * @brief 		- Raises an application event from the ISR
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- appEvent: @I2C_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- Events of the fastEvents mask run in the ISR. The others are posted to the deferred-work
+ * 				  queue; if it is not running or full, the callback runs in the ISR so no event is lost.
+*/
+_RAMFUNC static void I2C_RaiseEvent (I2C_Handle_t *p_I2cHandle, uint8_t appEvent)
+{
+	if ((p_I2cHandle->fastEvents & I2C_EVENT_MASK(appEvent)) ||
+		!DEFER_Post(I2C_DeferredEvent, p_I2cHandle, appEvent))
+	{
+		I2C_API_EventCallback(p_I2cHandle, appEvent);
+	}
+}
+
+/*!
+ * @fn			- I2C_UseDma
+ *
+ * @brief 		- Checks whether a phase of the given length goes through its DMA stream
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- len: bytes of the phase
+ *
+ * @return 		- SET or RESET
+ *
+ * @note		- A DMA read needs two bytes at least: LAST NACKs the final one, ACK the others
+*/
+_RAMFUNC static uint8_t I2C_UseDma (I2C_Handle_t *p_I2cHandle, uint16_t len)
+{
+	uint8_t threshold = p_I2cHandle->I2cConfig.dmaThreshold;
+
+	return ((0 != threshold) && (len >= threshold) && (len >= 2)) ? SET : RESET;
+}
+
+/*!
+ * @fn			- I2C_HasNext
+ *
+ * @brief 		- Checks whether another segment of a batch follows the running one
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- SET or RESET
+ *
+ * @note		- none
+*/
+_RAMFUNC static uint8_t I2C_HasNext (I2C_Handle_t *p_I2cHandle)
+{
+	return ((NULL != p_I2cHandle->p_Batch) && ((p_I2cHandle->BatchIndex + 1) < p_I2cHandle->BatchCount)) ? SET : RESET;
+}
+
+/*!
+ * @fn			- I2C_EndBit
+ *
+ * @brief 		- CR1 bit which ends the running segment
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- START for a segment followed by another one of the batch, STOP otherwise
+ *
+ * @note		- none
+*/
+_RAMFUNC static uint32_t I2C_EndBit (I2C_Handle_t *p_I2cHandle)
+{
+	return I2C_HasNext(p_I2cHandle) ? (1 << I2C_CR1REG_START) : (1 << I2C_CR1REG_STOP);
+}
+
+/*!
+ * @fn			- I2C_Load
+ *
+ * @brief 		- Loads a transaction into the state machine
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- devAddr: 7 bit device address
+ * @param[in]	- *p_TxBuffer: write phase
+ * @param[in]	- txLen: bytes to write
+ * @param[in]	- *p_RxBuffer: read phase
+ * @param[in]	- rxLen: bytes to read
+ *
+ * @return 		- none
+ *
+ * @note		- CR1 is not touched: the START of a chained segment may be pending in it, and the
+ * 				  hardware clears START and STOP on its own
+*/
+_RAMFUNC static void I2C_Load (I2C_Handle_t *p_I2cHandle, uint8_t devAddr, const uint8_t *p_TxBuffer, uint16_t txLen, uint8_t *p_RxBuffer, uint16_t rxLen)
+{
+	p_I2cHandle->devAddr = devAddr;
+	p_I2cHandle->p_TxBuffer = p_TxBuffer;
+	p_I2cHandle->TxLen = txLen;
+	p_I2cHandle->p_RxBuffer = p_RxBuffer;
+	p_I2cHandle->RxLen = rxLen;
+	p_I2cHandle->phase = ((0 != txLen) || (0 == rxLen)) ? I2C_PHASE_ADDR_W : I2C_PHASE_ADDR_R;
+	p_I2cHandle->dmaPhase = RESET;
+}
+
+/*!
+ * @fn			- I2C_Close
+ *
+ * @brief 		- Ends the running segment: chains the next one of a batch or releases the interface
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- result: @I2C_STATUS
+ *
+ * @return 		- none
+ *
+ * @note		- The end condition of I2C_EndBit is already requested by the caller. The event follows
+ * 				  the release, so the callback can start the next transaction or batch.
+*/
+_RAMFUNC static void I2C_Close (I2C_Handle_t *p_I2cHandle, uint8_t result)
+{
+	I2C_RegDef_t *p_I2Cx = p_I2cHandle->p_I2Cx;
+	I2C_Segment_t *p_Batch = p_I2cHandle->p_Batch;
+	I2C_BatchDoneFunc_t batchDone = p_I2cHandle->batchDone;
+	void *p_BatchContext = p_I2cHandle->p_BatchContext;
+
+	// 1. The data phase is over either way
+	p_I2Cx->CR2 &= ~((1 << I2C_CR2REG_ITBUFEN) | (1 << I2C_CR2REG_DMAEN) | (1 << I2C_CR2REG_LAST));
+	p_I2cHandle->dmaPhase = RESET;
+	p_I2cHandle->Result = result;
+
+	if (NULL != p_Batch)
+	{
+		// 2. Record the segment, chain the next one behind the repeated START
+		p_Batch[p_I2cHandle->BatchIndex].result = result;
+		if (I2C_OK != result)
+		{
+			p_I2cHandle->BatchFailed++;
+		}
+
+		if (I2C_HasNext(p_I2cHandle) && ((I2C_OK == result) || (I2C_ERR_NACK == result)))
+		{
+			I2C_Segment_t *p_Next = &p_Batch[++p_I2cHandle->BatchIndex];
+
+			I2C_Load(p_I2cHandle, p_Next->devAddr, p_Next->p_TxBuffer, p_Next->txLen, p_Next->p_RxBuffer, p_Next->rxLen);
+			return;
+		}
+
+		// 3. The bus is lost: the rest of the list is not run
+		for (uint8_t i = p_I2cHandle->BatchIndex + 1; i < p_I2cHandle->BatchCount; ++i)
+		{
+			p_Batch[i].result = I2C_ERR_SKIPPED;
+			p_I2cHandle->BatchFailed++;
+		}
+	}
+
+	// 4. Release the interface
+	p_I2Cx->CR2 &= ~((1 << I2C_CR2REG_ITEVTEN) | (1 << I2C_CR2REG_ITERREN));
+	p_I2cHandle->p_Batch = NULL;
+
+	ATOMIC_BARRIER();
+	p_I2cHandle->State = I2C_ST_READY;									// Release last
+
+	if (NULL != p_Batch)
+	{
+		if (NULL != batchDone)
+		{
+			batchDone(p_BatchContext, p_Batch, p_I2cHandle->BatchFailed);
+		}
+		else
+		{
+			I2C_RaiseEvent(p_I2cHandle, I2C_EVENT_BATCH_CMPLT);
+		}
+	}
+	else if (I2C_OK == result)
+	{
+		I2C_RaiseEvent(p_I2cHandle, I2C_EVENT_CMPLT);
+	}
+	else
+	{
+		I2C_RaiseEvent(p_I2cHandle, (I2C_ERR_NACK == result) ? I2C_EVENT_NACK : I2C_EVENT_ERROR);
+	}
+}
+
+/*!
+ * @fn			- I2C_WriteDone
+ *
+ * @brief 		- Follows the last written byte with the read phase or with the end of the segment
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Called on BTF: SCL is stretched, the repeated START goes out without a STOP
+*/
+_RAMFUNC static void I2C_WriteDone (I2C_Handle_t *p_I2cHandle)
+{
+	I2C_RegDef_t *p_I2Cx = p_I2cHandle->p_I2Cx;
+
+	if (p_I2cHandle->dmaPhase)
+	{
+		p_I2Cx->CR2 &= ~(1 << I2C_CR2REG_DMAEN);
+		p_I2cHandle->dmaPhase = RESET;
+	}
+
+	if (0 != p_I2cHandle->RxLen)
+	{
+		p_I2cHandle->phase = I2C_PHASE_ADDR_R;
+		p_I2Cx->CR1 |= (1 << I2C_CR1REG_START);
+		return;
+	}
+
+	p_I2Cx->CR1 |= I2C_EndBit(p_I2cHandle);
+	I2C_Close(p_I2cHandle, I2C_OK);
+}
+
+/*!
+ * @fn			- I2C_AddrDone
+ *
+ * @brief 		- Prepares the data phase and clears ADDR
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- SCL is stretched until ADDR is cleared by the SR2 read: the ACK, POS and STOP settings
+ * 				  of a one or two byte read must be in place before it. The one byte sequence runs
+ * 				  with interrupts disabled so no higher level handler can delay the STOP into the byte.
+ * 				  ACK is set here rather than with the START: a chained START may still be pending.
+*/
+_RAMFUNC static void I2C_AddrDone (I2C_Handle_t *p_I2cHandle)
+{
+	I2C_RegDef_t *p_I2Cx = p_I2cHandle->p_I2Cx;
+	uint32_t primask;
+
+	if (I2C_PHASE_ADDR_W == p_I2cHandle->phase)
+	{
+		p_I2cHandle->phase = I2C_PHASE_WRITE;
+
+		if (I2C_UseDma(p_I2cHandle, p_I2cHandle->TxLen))
+		{
+			DMA_Start(&p_I2cHandle->TxDma, (uint32_t)&p_I2Cx->DR, (uint32_t)p_I2cHandle->p_TxBuffer, p_I2cHandle->TxLen);
+			p_I2cHandle->TxLen = 0;
+			p_I2cHandle->dmaPhase = SET;
+			p_I2Cx->CR2 |= (1 << I2C_CR2REG_DMAEN);
+		}
+		else if (0 != p_I2cHandle->TxLen)
+		{
+			p_I2Cx->CR2 |= (1 << I2C_CR2REG_ITBUFEN);
+		}
+
+		(void)p_I2Cx->SR2;
+
+		// Address probe: nothing to write, the STOP follows the ACK
+		if ((0 == p_I2cHandle->TxLen) && !p_I2cHandle->dmaPhase)
+		{
+			I2C_WriteDone(p_I2cHandle);
+		}
+		return;
+	}
+
+	p_I2cHandle->phase = I2C_PHASE_READ;
+
+	if (I2C_UseDma(p_I2cHandle, p_I2cHandle->RxLen))
+	{
+		DMA_Start(&p_I2cHandle->RxDma, (uint32_t)&p_I2Cx->DR, (uint32_t)p_I2cHandle->p_RxBuffer, p_I2cHandle->RxLen);
+		p_I2cHandle->dmaPhase = SET;
+		p_I2Cx->CR1 |= (1 << I2C_CR1REG_ACK);
+		p_I2Cx->CR2 = (p_I2Cx->CR2 & ~(1 << I2C_CR2REG_ITBUFEN)) | (1 << I2C_CR2REG_DMAEN) | (1 << I2C_CR2REG_LAST);
+		(void)p_I2Cx->SR2;
+	}
+	else if (1 == p_I2cHandle->RxLen)
+	{
+		primask = ATOMIC_IrqDisable();
+		p_I2Cx->CR1 &= ~(1 << I2C_CR1REG_ACK);
+		(void)p_I2Cx->SR2;
+		p_I2Cx->CR1 |= I2C_EndBit(p_I2cHandle);
+		ATOMIC_IrqRestore(primask);
+		p_I2Cx->CR2 |= (1 << I2C_CR2REG_ITBUFEN);					// RXNE takes the byte
+	}
+	else if (2 == p_I2cHandle->RxLen)
+	{
+		p_I2Cx->CR1 = (p_I2Cx->CR1 & ~(1 << I2C_CR1REG_ACK)) | (1 << I2C_CR1REG_POS);	// NACK the second byte
+		p_I2Cx->CR2 &= ~(1 << I2C_CR2REG_ITBUFEN);					// BTF takes both
+		(void)p_I2Cx->SR2;
+	}
+	else
+	{
+		p_I2Cx->CR1 |= (1 << I2C_CR1REG_ACK);
+		if (3 == p_I2cHandle->RxLen)
+		{
+			p_I2Cx->CR2 &= ~(1 << I2C_CR2REG_ITBUFEN);
+		}
+		else
+		{
+			p_I2Cx->CR2 |= (1 << I2C_CR2REG_ITBUFEN);
+		}
+		(void)p_I2Cx->SR2;
+	}
+}
+
+/*!
+ * @fn			- I2C_Start
+ *
+ * @brief 		- Loads the first transaction into the handle and requests the START
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler, claimed
+ * @param[in]	- devAddr: 7 bit device address
+ * @param[in]	- *p_TxBuffer: write phase
+ * @param[in]	- txLen: bytes to write
+ * @param[in]	- *p_RxBuffer: read phase
+ * @param[in]	- rxLen: bytes to read
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- A STOP of the previous transaction is still on its way for a few SCL periods:
+ * 				  START may only be requested once the STOP bit has been cleared by hardware
+*/
+static uint8_t I2C_Start (I2C_Handle_t *p_I2cHandle, uint8_t devAddr, const uint8_t *p_TxBuffer, uint16_t txLen, uint8_t *p_RxBuffer, uint16_t rxLen)
+{
+	I2C_RegDef_t *p_I2Cx = p_I2cHandle->p_I2Cx;
+
+	if (!TIMEBASE_WaitBits(&p_I2Cx->CR1, (1 << I2C_CR1REG_STOP), 0, I2C_STOP_TIMEOUT_US))
+	{
+		p_I2cHandle->p_Batch = NULL;
+		p_I2cHandle->State = I2C_ST_READY;
+		return I2C_ERR_BUS;
+	}
+
+	I2C_Load(p_I2cHandle, devAddr, p_TxBuffer, txLen, p_RxBuffer, rxLen);
+	p_I2cHandle->Result = I2C_OK;
+
+	p_I2Cx->CR2 |= (1 << I2C_CR2REG_ITEVTEN) | (1 << I2C_CR2REG_ITERREN);
+	p_I2Cx->CR1 = (p_I2Cx->CR1 & ~(1 << I2C_CR1REG_POS)) | (1 << I2C_CR1REG_ACK) | (1 << I2C_CR1REG_START);
+
+	return I2C_OK;
+}
+
+/*!
+ * @fn			- I2C_RxDmaEvent
+ *
+ * @brief 		- RX stream callback: end of a DMA read and transfer error
+ *
+ * @param[in]	- *p_Context: pointer to the I2C Handler
+ * @param[in]	- event: @DMA_EVENT
+ *
+ * @return 		- none
+ *
+ * @note		- With LAST set the interface has already NACKed the final byte: the STOP (or the chained
+ * 				  START) closes it
+*/
+_RAMFUNC static void I2C_RxDmaEvent (void *p_Context, uint8_t event)
+{
+	I2C_Handle_t *p_I2cHandle = (I2C_Handle_t *)p_Context;
+
+	p_I2cHandle->IrqCount++;
+
+	if ((I2C_ST_READY == p_I2cHandle->State) || (I2C_PHASE_READ != p_I2cHandle->phase) || !p_I2cHandle->dmaPhase)
+	{
+		return;
+	}
+
+	if (DMA_EVENT_ERROR == event)
+	{
+		p_I2cHandle->ErrorFlags |= I2C_ERROR_DMA;
+		p_I2cHandle->p_I2Cx->CR1 |= (1 << I2C_CR1REG_STOP);
+		I2C_Close(p_I2cHandle, I2C_ERR_BUS);
+	}
+	else if (DMA_EVENT_FULL == event)
+	{
+		p_I2cHandle->p_I2Cx->CR1 |= I2C_EndBit(p_I2cHandle);
+		p_I2cHandle->RxLen = 0;
+		I2C_Close(p_I2cHandle, I2C_OK);
+	}
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- I2C_PeriClockControl
+ *
+ * @brief 		- Enables or disables the peripheral clock for the given I2C interface
+ *
+ * @param[in]	- *p_I2C: base address of the I2C peripheral
+ * @param[in]	- enable: ENABLE or DISABLE macros
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void I2C_PeriClockControl (I2C_RegDef_t *p_I2C, uint8_t enable)
+{
+	const I2C_Map_t *p_Map = I2cMapping(p_I2C);
+
+	PERIPH_ClockControl(p_Map ? &p_Map->Desc : NULL, enable);
+}
+
+/*!
+ * @fn			- I2C_Init
+ *
+ * @brief 		- Initialization of the I2C interface as master and of its DMA streams
+ *
+ * @param[in]	- *p_I2cHandle: I2C base address + configuration settings
+ * @param[out]	- none
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- SCL and SDA must be configured as open-drain alternate function beforehand. The
+ * 				  software reset releases an interface left busy by an interrupted transaction.
+*/
+uint8_t I2C_Init (I2C_Handle_t *p_I2cHandle)
+{
+	I2C_RegDef_t *p_I2Cx = p_I2cHandle->p_I2Cx;
+	const I2C_Map_t *p_Map = I2cMapping(p_I2Cx);
+	uint8_t status;
+
+	if (NULL == p_Map)
+	{
+		return I2C_ERR_PARAM;
+	}
+
+	// 0. Enable I2C Periphery Clock: one reference per interface, a re-init keeps it
+	if (!(ClockHeld & (1u << (p_Map - I2cMap))))
+	{
+		I2C_PeriClockControl(p_I2Cx, ENABLE);
+		ClockHeld |= (uint8_t)(1u << (p_Map - I2cMap));
+	}
+
+	// 1. Software reset
+	p_I2Cx->CR1 = (1 << I2C_CR1REG_SWRST);
+	p_I2Cx->CR1 = 0;
+
+	// 2. Own address register: bit 14 must be kept at 1 by software
+	p_I2Cx->OAR1 = (1 << 14);
+
+	// 3. FREQ, CCR and TRISE from the current PCLK1, interface enabled
+	status = I2cSetTiming(p_I2cHandle);
+	if (I2C_OK != status)
+	{
+		return status;
+	}
+
+	// 4. DMA streams: the first free route of the request mapping, direct mode. The streams of a
+	// previous init are given back first, the copy below would otherwise lose the TX one.
+	DMA_Release(&p_I2cHandle->RxDma);
+	DMA_Release(&p_I2cHandle->TxDma);
+
+	p_I2cHandle->RxDma.DmaConfig 				= (DMA_Config_t){ 0 };
+	p_I2cHandle->RxDma.DmaConfig.direction 		= DMA_DIR_P2M;
+	p_I2cHandle->RxDma.DmaConfig.periphInc 		= DISABLE;
+	p_I2cHandle->RxDma.DmaConfig.memInc 		= ENABLE;
+	p_I2cHandle->RxDma.DmaConfig.periphSize 	= DMA_SIZE_BYTE;
+	p_I2cHandle->RxDma.DmaConfig.memSize 		= DMA_SIZE_BYTE;
+	p_I2cHandle->RxDma.DmaConfig.circular 		= DISABLE;
+	p_I2cHandle->RxDma.DmaConfig.priority 		= DMA_PRIORITY_MEDIUM;		// A byte every 22 us at 400 kHz
+	p_I2cHandle->RxDma.callback 				= I2C_RxDmaEvent;
+	p_I2cHandle->RxDma.p_Context 				= p_I2cHandle;
+
+	p_I2cHandle->TxDma = p_I2cHandle->RxDma;
+	p_I2cHandle->TxDma.DmaConfig.direction 		= DMA_DIR_M2P;
+	p_I2cHandle->TxDma.callback 				= NULL;
+
+	if (0 != p_I2cHandle->I2cConfig.dmaThreshold)
+	{
+		if ((DMA_OK != DMA_Allocate(&p_I2cHandle->RxDma, p_Map->rxRoutes, 2)) || (DMA_OK != DMA_Init(&p_I2cHandle->RxDma)) ||
+			(DMA_OK != DMA_Allocate(&p_I2cHandle->TxDma, p_Map->txRoutes, 2)) || (DMA_OK != DMA_Init(&p_I2cHandle->TxDma)))
+		{
+			DMA_Release(&p_I2cHandle->RxDma);
+			DMA_Release(&p_I2cHandle->TxDma);
+			return I2C_ERR_DMA;
+		}
+		DMA_InterruptControl(&p_I2cHandle->RxDma, DMA_IT_TC | DMA_IT_TE, ENABLE);
+	}
+
+	// 5. Software state
+	p_I2cHandle->State = I2C_ST_READY;
+	p_I2cHandle->Hold = RESET;
+	p_I2cHandle->Result = I2C_OK;
+	p_I2cHandle->ErrorFlags = 0;
+	p_I2cHandle->IrqCount = 0;
+
+	return I2C_OK;
+}
+
+/*!
+ * @fn			- I2C_DeInit
+ *
+ * @brief 		- Stops the DMA streams and resets the I2C registers
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The DMA streams and the clock reference taken by I2C_Init are released as well
+*/
+void I2C_DeInit (I2C_Handle_t *p_I2cHandle)
+{
+	const I2C_Map_t *p_Map = I2cMapping(p_I2cHandle->p_I2Cx);
+
+	if (NULL == p_Map)
+	{
+		return;
+	}
+
+	I2C_ClockTrack(p_I2cHandle, DISABLE);
+
+	if (0 != p_I2cHandle->I2cConfig.dmaThreshold)
+	{
+		DMA_Release(&p_I2cHandle->RxDma);
+		DMA_Release(&p_I2cHandle->TxDma);
+	}
+
+	// Reset the RCC register regarding the designated I2C periphery
+	PERIPH_Reset(&p_Map->Desc);
+
+	// Disable the I2C periphery clock
+	if (ClockHeld & (1u << (p_Map - I2cMap)))
+	{
+		I2C_PeriClockControl(p_I2cHandle->p_I2Cx, DISABLE);
+		ClockHeld &= (uint8_t)~(1u << (p_Map - I2cMap));
+	}
+}
+
+/*!
+ * @fn			- I2C_IRQNumber
+ *
+ * @brief 		- NVIC interrupt number of an interrupt line of the I2C interface
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler, after I2C_Init for I2C_IRQ_RX_DMA
+ * @param[in]	- line: @I2C_IRQ
+ *
+ * @return 		- IRQ number, IRQ_NO_NONE for an unknown address or line, or for I2C_IRQ_RX_DMA without DMA
+ *
+ * @note		- Give the three lines the same preemption level: they share the state machine.
+ * 				  The RX stream is the one allocated by I2C_Init.
+*/
+uint8_t I2C_IRQNumber (I2C_Handle_t *p_I2cHandle, uint8_t line)
+{
+	const I2C_Map_t *p_Map = I2cMapping(p_I2cHandle->p_I2Cx);
+
+	if (NULL == p_Map)
+	{
+		return IRQ_NO_NONE;
+	}
+
+	switch (line)
+	{
+		case I2C_IRQ_EV:		return p_Map->Desc.IRQNumber;
+		case I2C_IRQ_ER:		return p_Map->Desc.IRQNumber + 1;		// EV / ER pairs in the vector table
+		case I2C_IRQ_RX_DMA:	return p_I2cHandle->I2cConfig.dmaThreshold ? DMA_IRQNumber(p_I2cHandle->RxDma.p_DMAx, p_I2cHandle->RxDma.stream) : IRQ_NO_NONE;
+		default:				return IRQ_NO_NONE;
+	}
+}
+
+/*!
+ * @fn			- I2C_GetSclSpeed
+ *
+ * @brief 		- SCL frequency of the I2C interface as programmed in CCR
+ *
+ * @param[in]	- *p_I2C: base address of the I2C peripheral
+ * @param[out]	- none
+ *
+ * @return 		- Hz, 0 for an unknown address or an empty CCR
+ *
+ * @note		- Nominal value: the rise time of the bus stretches the high period on top of it
+*/
+uint32_t I2C_GetSclSpeed (I2C_RegDef_t *p_I2C)
+{
+	uint32_t ccrReg = p_I2C->CCR;
+	uint32_t ccr = ccrReg & 0xFFF;
+	uint32_t parts;
+
+	if ((NULL == I2cMapping(p_I2C)) || (0 == ccr))
+	{
+		return 0;
+	}
+
+	if (ccrReg & (1 << I2C_CCRREG_FS))
+	{
+		parts = (ccrReg & (1 << I2C_CCRREG_DUTY)) ? 25 : 3;
+	}
+	else
+	{
+		parts = 2;
+	}
+
+	return CLOCK_GetPclk1() / (parts * ccr);
+}
+
+/*!
+ * @fn			- I2C_ClockTrack
+ *
+ * @brief 		- Keeps the configured SCL speed across clock switches
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler, initialized
+ * @param[in]	- enable: ENABLE registers the handle at the clock driver, DISABLE removes it
+ *
+ * @return 		- none
+ *
+ * @note		- The handle must stay valid while tracked
+*/
+void I2C_ClockTrack (I2C_Handle_t *p_I2cHandle, uint8_t enable)
+{
+	if (DISABLE == enable)
+	{
+		CLOCK_NotifierUnregister(&p_I2cHandle->clockNotifier);
+		return;
+	}
+
+	CLOCK_NotifierRegister(&p_I2cHandle->clockNotifier, I2C_ClockNotify, p_I2cHandle);
+}
+
+/*!
+ * @fn			- I2C_MasterTransferIT
+ *
+ * @brief 		- Starts a write, a read or a write-then-read transaction
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- devAddr: 7 bit device address
+ * @param[in]	- *p_TxBuffer: bytes to write (e.g. register address), untouched until the event
+ * @param[in]	- txLen: bytes to write, 0: read only
+ * @param[out]	- *p_RxBuffer: destination of the read phase, valid once I2C_EVENT_CMPLT is raised
+ * @param[in]	- rxLen: bytes to read, 0: write only
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- Non-blocking. With both lengths set the read follows the write with a repeated
+ * 				  START. Both lengths 0 probe the address. One of @I2C_API_EVENTS ends every started
+ * 				  transaction, the result is kept in I2C_Handle_t::Result.
+*/
+uint8_t I2C_MasterTransferIT (I2C_Handle_t *p_I2cHandle, uint8_t devAddr, const uint8_t *p_TxBuffer, uint16_t txLen, uint8_t *p_RxBuffer, uint16_t rxLen)
+{
+	if (((0 != txLen) && (NULL == p_TxBuffer)) || ((0 != rxLen) && (NULL == p_RxBuffer)) || (devAddr > 0x7F))
+	{
+		return I2C_ERR_PARAM;
+	}
+
+	// 0. A clock switch is moving SCL
+	if (p_I2cHandle->Hold)
+	{
+		return I2C_ERR_BUSY;
+	}
+
+	// 1. Claim the interface: only one caller can move it out of READY
+	if (!ATOMIC_CAS8(&p_I2cHandle->State, I2C_ST_READY, I2C_ST_BUSY))
+	{
+		return I2C_ERR_BUSY;
+	}
+
+	// 2. The ISR takes it from the START condition
+	p_I2cHandle->p_Batch = NULL;
+	return I2C_Start(p_I2cHandle, devAddr, p_TxBuffer, txLen, p_RxBuffer, rxLen);
+}
+
+/*!
+ * @fn			- I2C_MasterTransfer
+ *
+ * @brief 		- Runs a transaction and waits for its end
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- devAddr: 7 bit device address
+ * @param[in]	- *p_TxBuffer: bytes to write
+ * @param[in]	- txLen: bytes to write, 0: read only
+ * @param[out]	- *p_RxBuffer: destination of the read phase
+ * @param[in]	- rxLen: bytes to read, 0: write only
+ * @param[in]	- timeoutUs: upper bound of the wait
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- Thread mode, the I2C interrupts enabled. Still interrupt or DMA driven: only the caller
+ * 				  waits. A timed out transaction is aborted before returning.
+*/
+uint8_t I2C_MasterTransfer (I2C_Handle_t *p_I2cHandle, uint8_t devAddr, const uint8_t *p_TxBuffer, uint16_t txLen, uint8_t *p_RxBuffer, uint16_t rxLen, uint32_t timeoutUs)
+{
+	TIMEBASE_Timeout_t timeout;
+	uint8_t status;
+
+	TIMEBASE_TimeoutStart(&timeout, timeoutUs);
+
+	status = I2C_MasterTransferIT(p_I2cHandle, devAddr, p_TxBuffer, txLen, p_RxBuffer, rxLen);
+	if (I2C_OK != status)
+	{
+		return status;
+	}
+
+	while (I2C_ST_READY != p_I2cHandle->State)
+	{
+		if (TIMEBASE_TimeoutExpired(&timeout))
+		{
+			I2C_Abort(p_I2cHandle);
+			return I2C_ERR_TIMEOUT;
+		}
+	}
+
+	return p_I2cHandle->Result;
+}
+
+/*!
+ * @fn			- I2C_MemRead
+ *
+ * @brief 		- Reads registers of a device with an 8 bit register address
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- devAddr: 7 bit device address
+ * @param[in]	- regAddr: first register
+ * @param[out]	- *p_RxBuffer: register contents
+ * @param[in]	- len: bytes to read
+ * @param[in]	- timeoutUs: upper bound of the wait
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- Register address write and read joined by a repeated START
+*/
+uint8_t I2C_MemRead (I2C_Handle_t *p_I2cHandle, uint8_t devAddr, uint8_t regAddr, uint8_t *p_RxBuffer, uint16_t len, uint32_t timeoutUs)
+{
+	if (0 == len)
+	{
+		return I2C_ERR_PARAM;
+	}
+
+	return I2C_MasterTransfer(p_I2cHandle, devAddr, &regAddr, 1, p_RxBuffer, len, timeoutUs);
+}
+
+/*!
+ * @fn			- I2C_BatchStartIT
+ *
+ * @brief 		- Starts a list of transactions run back to back by the ISR
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- *p_Segments: transactions, any mix of device addresses, untouched until the end
+ * @param[in]	- count: number of segments
+ * @param[in]	- doneFunc: called in the ISR after the last segment, NULL raises I2C_EVENT_BATCH_CMPLT
+ * @param[in]	- *p_Context: argument of doneFunc
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- Non-blocking. Segments are joined by repeated STARTs: one START and one STOP for the
+ * 				  whole list. Each segment gets its own result; a NACK does not stop the batch, an error
+ * 				  which loses the bus marks the remaining segments I2C_ERR_SKIPPED. doneFunc may start
+ * 				  the next batch.
+*/
+uint8_t I2C_BatchStartIT (I2C_Handle_t *p_I2cHandle, I2C_Segment_t *p_Segments, uint8_t count, I2C_BatchDoneFunc_t doneFunc, void *p_Context)
+{
+	if ((NULL == p_Segments) || (0 == count))
+	{
+		return I2C_ERR_PARAM;
+	}
+
+	for (uint8_t i = 0; i < count; ++i)
+	{
+		I2C_Segment_t *p_Segment = &p_Segments[i];
+
+		if (((0 != p_Segment->txLen) && (NULL == p_Segment->p_TxBuffer)) ||
+			((0 != p_Segment->rxLen) && (NULL == p_Segment->p_RxBuffer)) || (p_Segment->devAddr > 0x7F))
+		{
+			return I2C_ERR_PARAM;
+		}
+		p_Segment->result = I2C_ERR_SKIPPED;
+	}
+
+	// 0. A clock switch is moving SCL
+	if (p_I2cHandle->Hold)
+	{
+		return I2C_ERR_BUSY;
+	}
+
+	// 1. Claim the interface: only one caller can move it out of READY
+	if (!ATOMIC_CAS8(&p_I2cHandle->State, I2C_ST_READY, I2C_ST_BUSY))
+	{
+		return I2C_ERR_BUSY;
+	}
+
+	// 2. The ISR walks the list from the first START condition
+	p_I2cHandle->p_Batch = p_Segments;
+	p_I2cHandle->BatchCount = count;
+	p_I2cHandle->BatchIndex = 0;
+	p_I2cHandle->BatchFailed = 0;
+	p_I2cHandle->batchDone = doneFunc;
+	p_I2cHandle->p_BatchContext = p_Context;
+
+	return I2C_Start(p_I2cHandle, p_Segments->devAddr, p_Segments->p_TxBuffer, p_Segments->txLen, p_Segments->p_RxBuffer, p_Segments->rxLen);
+}
+
+/*!
+ * @fn			- I2C_Abort
+ *
+ * @brief 		- Stops a running transaction with a STOP condition
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- No event is raised. Runs with the data level masked so the ISR can not complete the
+ * 				  transaction at the same time.
+*/
+void I2C_Abort (I2C_Handle_t *p_I2cHandle)
+{
+	I2C_RegDef_t *p_I2Cx = p_I2cHandle->p_I2Cx;
+	uint32_t basepri = ATOMIC_MaskEnter(NVIC_PLAN_PREEMPT_DATA);
+
+	if (I2C_ST_READY != p_I2cHandle->State)
+	{
+		p_I2Cx->CR2 &= ~((1 << I2C_CR2REG_ITEVTEN) | (1 << I2C_CR2REG_ITBUFEN) | (1 << I2C_CR2REG_ITERREN) |
+						 (1 << I2C_CR2REG_DMAEN) | (1 << I2C_CR2REG_LAST));
+		if (p_I2cHandle->dmaPhase)
+		{
+			DMA_Stop(&p_I2cHandle->RxDma);
+			DMA_Stop(&p_I2cHandle->TxDma);
+			p_I2cHandle->dmaPhase = RESET;
+		}
+		p_I2Cx->CR1 = (p_I2Cx->CR1 & ~((1 << I2C_CR1REG_POS) | (1 << I2C_CR1REG_ACK))) | (1 << I2C_CR1REG_STOP);
+		p_I2cHandle->Result = I2C_ERR_TIMEOUT;
+		p_I2cHandle->p_Batch = NULL;
+		ATOMIC_BARRIER();
+		p_I2cHandle->State = I2C_ST_READY;
+	}
+
+	ATOMIC_MaskExit(basepri);
+}
+
+/*!
+ * @fn			- I2C_EV_IRQHandling
+ *
+ * @brief 		- I2C Event Interrupt Request Handler
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Placed in SRAM together with the event handlers: no flash wait states in the ISR.
+ * 				  BTF is level triggered: while a stream lags behind the bus it fires again until the
+ * 				  next DMA access, those entries return without action.
+*/
+_RAMFUNC void I2C_EV_IRQHandling (I2C_Handle_t *p_I2cHandle)
+{
+	I2C_RegDef_t *p_I2Cx = p_I2cHandle->p_I2Cx;
+	uint32_t status = p_I2Cx->SR1;
+	uint32_t control = p_I2Cx->CR2;
+
+	p_I2cHandle->IrqCount++;
+
+	if (I2C_ST_READY == p_I2cHandle->State)
+	{
+		return;
+	}
+
+	// 1. START on the line: the address write clears SB. A chained START can rise before the last
+	//	  byte of the previous segment is taken: SB stays set until the next segment is loaded.
+	if ((status & I2C_FLAG_SB) && (p_I2cHandle->phase <= I2C_PHASE_ADDR_R))
+	{
+		p_I2Cx->DR = (uint32_t)(p_I2cHandle->devAddr << 1) | ((I2C_PHASE_ADDR_R == p_I2cHandle->phase) ? 1 : 0);
+		return;
+	}
+
+	// 2. Address acknowledged
+	if (status & I2C_FLAG_ADDR)
+	{
+		I2C_AddrDone(p_I2cHandle);
+		return;
+	}
+
+	// 3. Write phase: TXE feeds the data register, BTF ends the phase
+	if (I2C_PHASE_WRITE == p_I2cHandle->phase)
+	{
+		if ((status & I2C_FLAG_TXE) && (control & (1 << I2C_CR2REG_ITBUFEN)) && (0 != p_I2cHandle->TxLen))
+		{
+			p_I2Cx->DR = *p_I2cHandle->p_TxBuffer++;
+			if (0 == --p_I2cHandle->TxLen)
+			{
+				p_I2Cx->CR2 = control & ~(1 << I2C_CR2REG_ITBUFEN);		// Wait for BTF
+			}
+		}
+		else if ((status & I2C_FLAG_BTF) && (0 == p_I2cHandle->TxLen) &&
+				 (!p_I2cHandle->dmaPhase || !DMA_IsBusy(&p_I2cHandle->TxDma)))
+		{
+			I2C_WriteDone(p_I2cHandle);
+		}
+		return;
+	}
+
+	// 4. Read phase, interrupt driven (the stream ends a DMA read)
+	if ((I2C_PHASE_READ != p_I2cHandle->phase) || p_I2cHandle->dmaPhase)
+	{
+		return;
+	}
+
+	if ((status & I2C_FLAG_RXNE) && (control & (1 << I2C_CR2REG_ITBUFEN)))
+	{
+		*p_I2cHandle->p_RxBuffer++ = (uint8_t)p_I2Cx->DR;
+		p_I2cHandle->RxLen--;
+
+		if (0 == p_I2cHandle->RxLen)
+		{
+			I2C_Close(p_I2cHandle, I2C_OK);								// One byte read, end set on ADDR
+		}
+		else if (3 == p_I2cHandle->RxLen)
+		{
+			p_I2Cx->CR2 = control & ~(1 << I2C_CR2REG_ITBUFEN);		// Last three bytes on BTF
+		}
+	}
+	else if (status & I2C_FLAG_BTF)
+	{
+		if (3 == p_I2cHandle->RxLen)
+		{
+			// N-2 in DR, N-1 in the shift register: NACK the last byte
+			p_I2Cx->CR1 &= ~(1 << I2C_CR1REG_ACK);
+			*p_I2cHandle->p_RxBuffer++ = (uint8_t)p_I2Cx->DR;
+			p_I2cHandle->RxLen--;
+		}
+		else if (2 == p_I2cHandle->RxLen)
+		{
+			// N-1 in DR, N in the shift register, SCL stretched
+			p_I2Cx->CR1 = (p_I2Cx->CR1 & ~(1 << I2C_CR1REG_POS)) | I2C_EndBit(p_I2cHandle);
+			*p_I2cHandle->p_RxBuffer++ = (uint8_t)p_I2Cx->DR;
+			*p_I2cHandle->p_RxBuffer++ = (uint8_t)p_I2Cx->DR;
+			p_I2cHandle->RxLen = 0;
+			I2C_Close(p_I2cHandle, I2C_OK);
+		}
+	}
+}
+
+/*!
+ * @fn			- I2C_ER_IRQHandling
+ *
+ * @brief 		- I2C Error Interrupt Request Handler
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- A NACK ends the transaction with a STOP, or with the repeated START of the next segment of
+ * 				  a batch. Arbitration lost leaves the bus to the other master, no STOP is sent.
+*/
+_RAMFUNC void I2C_ER_IRQHandling (I2C_Handle_t *p_I2cHandle)
+{
+	I2C_RegDef_t *p_I2Cx = p_I2cHandle->p_I2Cx;
+	uint32_t errors = p_I2Cx->SR1 & I2C_FLAG_ERRORS;
+
+	p_I2cHandle->IrqCount++;
+
+	// 1. Clear the error flags (write 0, the other bits are read only)
+	p_I2Cx->SR1 = ~errors & 0xFFFF;
+	p_I2cHandle->ErrorFlags |= (uint16_t)errors;
+
+	if ((0 == errors) || (I2C_ST_READY == p_I2cHandle->State))
+	{
+		return;
+	}
+
+	// 2. Stop the stream of the phase
+	if (p_I2cHandle->dmaPhase)
+	{
+		DMA_Stop((I2C_PHASE_READ == p_I2cHandle->phase) ? &p_I2cHandle->RxDma : &p_I2cHandle->TxDma);
+	}
+
+	// 3. End the transaction
+	if (I2C_FLAG_AF == errors)
+	{
+		p_I2Cx->CR1 = (p_I2Cx->CR1 & ~(1 << I2C_CR1REG_POS)) | I2C_EndBit(p_I2cHandle);
+	}
+	else if (!(errors & I2C_FLAG_ARLO))
+	{
+		p_I2Cx->CR1 = (p_I2Cx->CR1 & ~(1 << I2C_CR1REG_POS)) | (1 << I2C_CR1REG_STOP);
+	}
+
+	I2C_Close(p_I2cHandle, (errors == I2C_FLAG_AF) ? I2C_ERR_NACK : I2C_ERR_BUS);
+}
+
+/*!
+ * @fn			- I2C_IRQBind
+ *
+ * @brief 		- Binds the handle to the event, error and RX stream IRQs in the SRAM vector table
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- enable: ENABLE binds, DISABLE restores the link-time handlers
+ *
+ * @return 		- none
+ *
+ * @note		- NVIC enable and priority stay with the application, see I2C_IRQNumber
+*/
+void I2C_IRQBind (I2C_Handle_t *p_I2cHandle, uint8_t enable)
+{
+	uint8_t evIRQNumber = I2C_IRQNumber(p_I2cHandle, I2C_IRQ_EV);
+	uint8_t erIRQNumber = I2C_IRQNumber(p_I2cHandle, I2C_IRQ_ER);
+
+	if (IRQ_NO_NONE == evIRQNumber)
+	{
+		return;
+	}
+
+	if (ENABLE == enable)
+	{
+		VECTOR_Register(evIRQNumber, I2C_EvDispatch, p_I2cHandle);
+		VECTOR_Register(erIRQNumber, I2C_ErDispatch, p_I2cHandle);
+	}
+	else
+	{
+		VECTOR_Unregister(evIRQNumber);
+		VECTOR_Unregister(erIRQNumber);
+	}
+
+	if (0 != p_I2cHandle->I2cConfig.dmaThreshold)
+	{
+		DMA_IRQBind(&p_I2cHandle->RxDma, enable);
+	}
+}
+
+/*!
+ * @fn			- I2C_API_EventCallback
+ *
+ * @brief 		- Callback to API regarding I2C event
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- appEvent: @I2C_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- WEAK, must override. Runs from the deferred-work queue (PendSV or main loop) unless the
+ * 				  event is in the fastEvents mask of the handle or the queue is not running.
+*/
+_WEAK void I2C_API_EventCallback (I2C_Handle_t *p_I2cHandle, uint8_t appEvent)
+{
+	// WEAK implementation, application must override it
+}
+
+/*** EOF ***/
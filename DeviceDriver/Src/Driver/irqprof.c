@@ -0,0 +1,339 @@
+/** @file irqprof.c
+*
+* @brief Interrupt latency and duration profiler.
+*
+* The hooks timestamp the handler entry and exit with DWT CYCCNT. The pending latency is measured
+* for IRQs whose request is marked by IRQPROF_MarkPending (software triggers mark it automatically).
+* The hooks sit a few instructions after the hardware entry: add the 12 cycle stacking of the core
+* for the absolute figures.
+*
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include "irqprof.h"
+#include "atomic.h"
+
+#if IRQ_PROFILE_ENABLE
+
+// === Private Variables ===
+//
+static IRQPROF_Record_t Records[IRQPROF_MAX_SLOTS];
+static uint8_t SlotOf[NVIC_NUM_IRQS];			// 0: not tracked, otherwise slot + 1
+static volatile uint32_t SlotsUsed;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- StatReset
+ *
+ * @brief 		- Clears a statistics block
+ *
+ * @param[out]	- *p_Stat: statistics block
+ * @param[in]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void StatReset (IRQPROF_Stat_t *p_Stat)
+{
+	p_Stat->count = 0;
+	p_Stat->min = UINT32_MAX;
+	p_Stat->max = 0;
+	p_Stat->sum = 0;
+
+	for (uint8_t bin = 0; bin < IRQPROF_HIST_BINS; ++bin)
+	{
+		p_Stat->hist[bin] = 0;
+	}
+}
+
+/*!
+ * @fn			- StatAdd
+ *
+ * @brief 		- Adds a sample to a statistics block
+ *
+ * @param[out]	- *p_Stat: statistics block
+ * @param[in]	- cycles: sample
+ *
+ * @return 		- none
+ *
+ * @note		- The histogram bin is found with a single CLZ
+*/
+static inline void StatAdd (IRQPROF_Stat_t *p_Stat, uint32_t cycles)
+{
+	uint8_t bin = cycles ? (32 - __builtin_clz(cycles)) : 0;
+
+	if (bin >= IRQPROF_HIST_BINS)
+	{
+		bin = IRQPROF_HIST_BINS - 1;
+	}
+
+	p_Stat->hist[bin]++;
+	p_Stat->count++;
+	p_Stat->sum += cycles;
+	p_Stat->min = (cycles < p_Stat->min) ? cycles : p_Stat->min;
+	p_Stat->max = (cycles > p_Stat->max) ? cycles : p_Stat->max;
+}
+
+/*!
+ * @fn			- Track
+ *
+ * @brief 		- Finds the record of the IRQ, assigns a free slot on the first use
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- Record, NULL if every slot is taken or the IRQ number is out of range
+ *
+ * @note		- An IRQ never preempts itself, different IRQs get different slots by the fetch-add
+*/
+static IRQPROF_Record_t *Track (uint8_t IRQNumber)
+{
+	uint8_t slot;
+
+	if (IRQNumber >= NVIC_NUM_IRQS)
+	{
+		return NULL;
+	}
+
+	slot = SlotOf[IRQNumber];
+	if (!slot)
+	{
+		if (SlotsUsed >= IRQPROF_MAX_SLOTS)
+		{
+			return NULL;
+		}
+
+		uint32_t index = ATOMIC_FetchAdd(&SlotsUsed, 1);
+		if (index >= IRQPROF_MAX_SLOTS)
+		{
+			return NULL;
+		}
+
+		Records[index].IRQNumber = IRQNumber;
+		Records[index].pendMarked = RESET;
+		StatReset(&Records[index].latency);
+		StatReset(&Records[index].duration);
+		slot = index + 1;
+		SlotOf[IRQNumber] = slot;
+	}
+
+	return &Records[slot - 1];
+}
+
+/*!
+ * @fn			- ITM_Print
+ *
+ * @brief 		- Sends a string over an ITM stimulus port
+ *
+ * @param[in]	- itmPort: stimulus port number
+ * @param[in]	- *p_Text: zero terminated string
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void ITM_Print (uint8_t itmPort, const char *p_Text)
+{
+	while (*p_Text)
+	{
+		while (!(ITM->PORT[itmPort] & 1));
+		*(volatile uint8_t *)&ITM->PORT[itmPort] = *p_Text++;
+	}
+}
+
+/*!
+ * @fn			- StatPrint
+ *
+ * @brief 		- Dumps one statistics block
+ *
+ * @param[in]	- itmPort: stimulus port number
+ * @param[in]	- *p_Name: row title
+ * @param[in]	- *p_Stat: statistics block
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void StatPrint (uint8_t itmPort, const char *p_Name, const IRQPROF_Stat_t *p_Stat)
+{
+	char line[96];
+
+	if (!p_Stat->count)
+	{
+		return;
+	}
+
+	snprintf(line, sizeof(line), "   %-8s n %lu, min %lu, mean %lu, max %lu cycles\n", p_Name,
+			 p_Stat->count, p_Stat->min, (uint32_t)(p_Stat->sum / p_Stat->count), p_Stat->max);
+	ITM_Print(itmPort, line);
+
+	for (uint8_t bin = 0; bin < IRQPROF_HIST_BINS; ++bin)
+	{
+		if (p_Stat->hist[bin])
+		{
+			snprintf(line, sizeof(line), "     < %5lu: %lu\n", (1ul << bin), p_Stat->hist[bin]);
+			ITM_Print(itmPort, line);
+		}
+	}
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- IRQPROF_Enter
+ *
+ * @brief 		- Entry hook: stamps the entry and closes the pending latency sample
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Use IRQPROF_ENTER, it is removed when the profiler is disabled
+*/
+_RAMFUNC void IRQPROF_Enter (uint8_t IRQNumber)
+{
+	uint32_t now = DWT_CYCCNT();
+	IRQPROF_Record_t *p_Record = Track(IRQNumber);
+
+	if (NULL == p_Record)
+	{
+		return;
+	}
+
+	p_Record->entryStamp = now;
+
+	if (p_Record->pendMarked)
+	{
+		p_Record->pendMarked = RESET;
+		StatAdd(&p_Record->latency, now - p_Record->pendStamp);
+	}
+}
+
+/*!
+ * @fn			- IRQPROF_Exit
+ *
+ * @brief 		- Exit hook: adds the duration sample
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Use IRQPROF_EXIT, it is removed when the profiler is disabled
+*/
+_RAMFUNC void IRQPROF_Exit (uint8_t IRQNumber)
+{
+	uint32_t now = DWT_CYCCNT();
+	uint8_t slot = (IRQNumber < NVIC_NUM_IRQS) ? SlotOf[IRQNumber] : 0;
+
+	if (slot)
+	{
+		StatAdd(&Records[slot - 1].duration, now - Records[slot - 1].entryStamp);
+	}
+}
+
+/*!
+ * @fn			- IRQPROF_MarkPending
+ *
+ * @brief 		- Stamps the request of the IRQ, call it right before the trigger
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Use IRQPROF_MARK_PENDING. A second mark before the entry restarts the sample.
+*/
+void IRQPROF_MarkPending (uint8_t IRQNumber)
+{
+	IRQPROF_Record_t *p_Record = Track(IRQNumber);
+
+	if (p_Record)
+	{
+		p_Record->pendStamp = DWT_CYCCNT();
+		p_Record->pendMarked = SET;
+	}
+}
+
+/*!
+ * @fn			- IRQPROF_Reset
+ *
+ * @brief 		- Starts DWT CYCCNT and drops every record
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The profiled IRQs must be quiet during the reset
+*/
+void IRQPROF_Reset (void)
+{
+	DWT_CYCCNT_EN();
+
+	for (uint8_t irq = 0; irq < NVIC_NUM_IRQS; ++irq)
+	{
+		SlotOf[irq] = 0;
+	}
+	SlotsUsed = 0;
+}
+
+/*!
+ * @fn			- IRQPROF_Get
+ *
+ * @brief 		- Reads the record of the IRQ
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- Record, NULL if the IRQ has not been profiled
+ *
+ * @note		- none
+*/
+const IRQPROF_Record_t *IRQPROF_Get (uint8_t IRQNumber)
+{
+	uint8_t slot = (IRQNumber < NVIC_NUM_IRQS) ? SlotOf[IRQNumber] : 0;
+
+	return slot ? &Records[slot - 1] : NULL;
+}
+
+/*!
+ * @fn			- IRQPROF_Dump
+ *
+ * @brief 		- Prints the statistics of every profiled IRQ over ITM
+ *
+ * @param[in]	- itmPort: stimulus port, IRQPROF_ITM_PORT by default
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Blocking, call it from thread mode on demand
+*/
+void IRQPROF_Dump (uint8_t itmPort)
+{
+	char line[48];
+	uint32_t used = (SlotsUsed < IRQPROF_MAX_SLOTS) ? SlotsUsed : IRQPROF_MAX_SLOTS;
+
+	// Enable the ITM and the stimulus port
+	COREDEBUG->DEMCR |= (1 << COREDEBUG_DEMCRREG_TRCENA);
+	ITM->TCR |= (1 << ITM_TCRREG_ITMENA);
+	ITM->TER |= (1 << itmPort);
+
+	for (uint8_t slot = 0; slot < used; ++slot)
+	{
+		snprintf(line, sizeof(line), " IRQ %u:\n", Records[slot].IRQNumber);
+		ITM_Print(itmPort, line);
+		StatPrint(itmPort, "latency", &Records[slot].latency);
+		StatPrint(itmPort, "duration", &Records[slot].duration);
+	}
+}
+
+#endif /* IRQ_PROFILE_ENABLE */
+
+/*** EOF ***/
@@ -4,7 +4,9 @@
 *
 */
 
+#include <stddef.h>
 #include "mcu_STM32F446xx.h"
+#include "pclk.h"
 
 
 // === Protected Functions ===
@@ -30,13 +32,13 @@ void IRQInterruptConfig (uint8_t IRQNumber,  uint8_t enable)
 {
 	if (ENABLE == enable)
 	{
-		// Configure ISER (Interrupt Set Enable Register) register
-		NVIC_ISER->reg[IRQNumber / 32] |= (1 << (IRQNumber % 32));
+		// Configure ISER (Interrupt Set Enable Register) register, write-1-to-set
+		NVIC_ISER->reg[IRQNumber / 32] = (1 << (IRQNumber % 32));
 	}
 	else
 	{
-		// Configure ICER (Interrupt Clear Enable Register) register
-		NVIC_ICER->reg[IRQNumber / 32] |= (1 << (IRQNumber % 32));
+		// Configure ICER (Interrupt Clear Enable Register) register, write-1-to-clear: "|=" would disable every enabled IRQ
+		NVIC_ICER->reg[IRQNumber / 32] = (1 << (IRQNumber % 32));
 	}
 }
 
@@ -46,17 +48,62 @@ void IRQInterruptConfig (uint8_t IRQNumber,  uint8_t enable)
  * @brief 		- Sets the priority level of the interrupt
  *
  * @param[in]	- IRQNumber: The number of the interrupt request
- * @param[in]	- IRQPriority: The priority level of the interrupt request
+ * @param[in]	- IRQPriority: The priority level of the interrupt request (NVIC_IRQ_PRI0 - NVIC_IRQ_PRI15)
  * @param[out]	- none
  *
  * @return 		- none
  *
- * @note		- none
+ * @note		- The whole byte of the IRQ is written, so the priority can be raised and lowered.
+ * 				  See nvic.h for the preemption / sub-priority split.
 */
 void IRQPriorityConfig (uint8_t IRQNumber, uint8_t IRQPriority)
 {
-	uint8_t shift = ((IRQNumber % 4) * 8) + (8 - NO_IPR_BITS);
-	NVIC_IPR->reg[IRQNumber / 4] |= (IRQPriority << shift);
+	NVIC_IPR->reg[IRQNumber] = (uint8_t)((IRQPriority & ((1 << NO_IPR_BITS) - 1)) << (8 - NO_IPR_BITS));
+}
+
+/*!
+ * @fn			- PERIPH_ClockControl
+ *
+ * @brief 		- Takes or drops a reference on the peripheral clock described by the descriptor
+ *
+ * @param[in]	- *p_Desc: peripheral descriptor, NULL is ignored
+ * @param[in]	- enable: ENABLE or DISABLE macros
+ *
+ * @return 		- none
+ *
+ * @note		- The clock is gated when the last reference is dropped, see pclk.h
+*/
+void PERIPH_ClockControl (const PERIPH_Desc_t *p_Desc, uint8_t enable)
+{
+	if (!p_Desc)
+	{
+		return;
+	}
+
+	PCLK_Control(p_Desc->p_ClkEnReg, p_Desc->clkEnBit, enable);
+}
+
+/*!
+ * @fn			- PERIPH_Reset
+ *
+ * @brief 		- Pulses the RCC reset bit of the peripheral described by the descriptor
+ *
+ * @param[in]	- *p_Desc: peripheral descriptor, NULL is ignored
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void PERIPH_Reset (const PERIPH_Desc_t *p_Desc)
+{
+	if (!p_Desc)
+	{
+		return;
+	}
+
+	*p_Desc->p_RstReg |= (1u << p_Desc->rstBit);
+	*p_Desc->p_RstReg &= ~(1u << p_Desc->rstBit);
 }
 
 /*** EOF ***/
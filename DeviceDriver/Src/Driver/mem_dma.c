@@ -0,0 +1,909 @@
+/** @file mem_dma.c
+*
+* @brief Memory copy / fill offloaded to a DMA2 stream above a size threshold.
+*
+* Short operations stay on the CPU: an LDM / STM loop moves four words per instruction pair and
+* beats the stream setup and the completion interrupt. From the threshold on the stream moves the
+* 16 byte aligned body of the destination in INC4 word bursts while the CPU does the unaligned head
+* and tail. The FIFO packs byte reads of an unaligned source into word writes, a fill reads one
+* pattern word from a fixed address.
+*
+* One transfer is in flight at a time. An operation meeting a busy stream (or a clock switch) is
+* done by the CPU, so the calls never wait for each other and are safe from any context.
+*
+*/
+
+#include <stddef.h>
+#include "mem_dma.h"
+#include "clock.h"
+#include "atomic.h"
+#include "timebase.h"
+
+
+// === Type Definitions ===
+//
+typedef struct MEM_Unaligned
+{
+	uint32_t word;
+} __attribute__((packed)) MEM_Unaligned_t;		// Single LDR from any address, Cortex-M4 handles the split
+
+
+// === Constant Definitions ===
+//
+/*
+ * Stream configurations, by alignment of the source against the 16 byte aligned destination
+ */
+#define MEM_DMA_MODE_NONE			0
+#define MEM_DMA_MODE_BURST			1		// Source 16 byte aligned: INC4 word bursts on both ports
+#define MEM_DMA_MODE_WORD			2		// Source word aligned: single word reads
+#define MEM_DMA_MODE_BYTE			3		// Unaligned source: single byte reads packed by the FIFO
+#define MEM_DMA_MODE_FILL			4		// Pattern word at a fixed address
+
+#define MEM_DMA_CHUNK_ITEMS			0xFFF0U	// NDTR limit rounded down to whole bursts
+
+
+// === Private Variables ===
+//
+static DMA_Handle_t MemDma;
+static CLOCK_Notifier_t ClockNotifier;
+static uint32_t Threshold = MEM_DMA_THRESHOLD_DEFAULT;
+static uint8_t Ready;						// SET between MEM_DMA_Init and MEM_DMA_DeInit
+static volatile uint8_t Hold;				// SET while a clock switch keeps the stream idle
+static volatile uint8_t Busy;				// Claimed with Running at submission, released by the ISR
+static uint8_t Mode;						// @MEM_DMA_MODE loaded in the stream
+static uint32_t FillWord;					// Source of a fill, stable while Busy
+static uint32_t NextSrc;					// Running transfer, the chunk after the current one
+static uint32_t NextDst;
+static uint32_t Left;						// Bytes not handed to the stream yet
+static MEM_DMA_Token_t Sequence;
+static volatile MEM_DMA_Token_t Running;	// Token of the transfer in flight (or of the last one)
+static volatile MEM_DMA_Token_t Failed;		// Token of the last transfer ended by a stream error
+static MEM_DMA_Stat_t Stat;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- MemCpuCopyWords
+ *
+ * @brief 		- Copies words between aligned buffers, four per LDM / STM pair
+ *
+ * @param[out]	- *p_Dst: word aligned destination
+ * @param[in]	- *p_Src: word aligned source
+ * @param[in]	- words: number of words
+ *
+ * @return 		- none
+ *
+ * @note		- Runs from SRAM: no flash wait state on the loop. r7 is left alone (Thumb frame pointer).
+*/
+_RAMFUNC static void MemCpuCopyWords (uint32_t *p_Dst, const uint32_t *p_Src, uint32_t words)
+{
+	__asm volatile (
+		"	cmp		%[n], #4			\n"
+		"	blo		2f					\n"
+		"1:	ldmia	%[s]!, {r3-r6}		\n"
+		"	stmia	%[d]!, {r3-r6}		\n"
+		"	subs	%[n], %[n], #4		\n"
+		"	cmp		%[n], #4			\n"
+		"	bhs		1b					\n"
+		"2:	cmp		%[n], #0			\n"
+		"	beq		3f					\n"
+		"	ldr		r3, [%[s]], #4		\n"
+		"	str		r3, [%[d]], #4		\n"
+		"	subs	%[n], %[n], #1		\n"
+		"	b		2b					\n"
+		"3:								\n"
+		: [d] "+r" (p_Dst), [s] "+r" (p_Src), [n] "+r" (words)
+		:
+		: "r3", "r4", "r5", "r6", "cc", "memory");
+}
+
+/*!
+ * @fn			- MemCpuFillWords
+ *
+ * @brief 		- Fills an aligned buffer with a word, four per STM
+ *
+ * @param[out]	- *p_Dst: word aligned destination
+ * @param[in]	- word: pattern
+ * @param[in]	- words: number of words
+ *
+ * @return 		- none
+ *
+ * @note		- Runs from SRAM: no flash wait state on the loop
+*/
+_RAMFUNC static void MemCpuFillWords (uint32_t *p_Dst, uint32_t word, uint32_t words)
+{
+	__asm volatile (
+		"	mov		r3, %[w]			\n"
+		"	mov		r4, %[w]			\n"
+		"	mov		r5, %[w]			\n"
+		"	mov		r6, %[w]			\n"
+		"	cmp		%[n], #4			\n"
+		"	blo		2f					\n"
+		"1:	stmia	%[d]!, {r3-r6}		\n"
+		"	subs	%[n], %[n], #4		\n"
+		"	cmp		%[n], #4			\n"
+		"	bhs		1b					\n"
+		"2:	cmp		%[n], #0			\n"
+		"	beq		3f					\n"
+		"	str		r3, [%[d]], #4		\n"
+		"	subs	%[n], %[n], #1		\n"
+		"	b		2b					\n"
+		"3:								\n"
+		: [d] "+r" (p_Dst), [n] "+r" (words)
+		: [w] "r" (word)
+		: "r3", "r4", "r5", "r6", "cc", "memory");
+}
+
+/*!
+ * @fn			- MemCpuCopy
+ *
+ * @brief 		- CPU copy of any alignment
+ *
+ * @param[out]	- *p_Dst: destination
+ * @param[in]	- *p_Src: source
+ * @param[in]	- len: bytes
+ *
+ * @return 		- none
+ *
+ * @note		- The destination is aligned first. An aligned source goes through LDM, an unaligned
+ * 				  one through single unaligned LDRs: still one load per word instead of four.
+*/
+static void MemCpuCopy (uint8_t *p_Dst, const uint8_t *p_Src, uint32_t len)
+{
+	// 1. Bytes up to a word aligned destination
+	while ((len > 0) && ((uint32_t)p_Dst & 0x3))
+	{
+		*p_Dst++ = *p_Src++;
+		len--;
+	}
+
+	// 2. Words
+	if (len >= 4)
+	{
+		uint32_t words = len >> 2;
+
+		if (0 == ((uint32_t)p_Src & 0x3))
+		{
+			MemCpuCopyWords((uint32_t *)p_Dst, (const uint32_t *)p_Src, words);
+		}
+		else
+		{
+			uint32_t *p_Word = (uint32_t *)p_Dst;
+			const MEM_Unaligned_t *p_Unaligned = (const MEM_Unaligned_t *)p_Src;
+
+			for (uint32_t i = 0; i < words; ++i)
+			{
+				p_Word[i] = p_Unaligned[i].word;
+			}
+		}
+
+		p_Dst += words << 2;
+		p_Src += words << 2;
+		len &= 0x3;
+	}
+
+	// 3. Tail
+	while (len--)
+	{
+		*p_Dst++ = *p_Src++;
+	}
+}
+
+/*!
+ * @fn			- MemCpuFill
+ *
+ * @brief 		- CPU fill of any alignment
+ *
+ * @param[out]	- *p_Dst: destination
+ * @param[in]	- value: byte value
+ * @param[in]	- len: bytes
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void MemCpuFill (uint8_t *p_Dst, uint8_t value, uint32_t len)
+{
+	while ((len > 0) && ((uint32_t)p_Dst & 0x3))
+	{
+		*p_Dst++ = value;
+		len--;
+	}
+
+	if (len >= 4)
+	{
+		MemCpuFillWords((uint32_t *)p_Dst, value * 0x01010101U, len >> 2);
+		p_Dst += len & ~0x3U;
+		len &= 0x3;
+	}
+
+	while (len--)
+	{
+		*p_Dst++ = value;
+	}
+}
+
+/*!
+ * @fn			- MemCpu
+ *
+ * @brief 		- CPU copy, or fill when there is no source
+ *
+ * @param[out]	- *p_Dst: destination
+ * @param[in]	- *p_Src: source, NULL for a fill
+ * @param[in]	- value: byte value of a fill
+ * @param[in]	- len: bytes
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void MemCpu (uint8_t *p_Dst, const uint8_t *p_Src, uint8_t value, uint32_t len)
+{
+	if (NULL != p_Src)
+	{
+		MemCpuCopy(p_Dst, p_Src, len);
+	}
+	else
+	{
+		MemCpuFill(p_Dst, value, len);
+	}
+}
+
+/*!
+ * @fn			- MemDmaConfigure
+ *
+ * @brief 		- Loads a stream configuration, unless it is already in place
+ *
+ * @param[in]	- mode: @MEM_DMA_MODE
+ * @param[out]	- none
+ *
+ * @return 		- @DMA_STATUS
+ *
+ * @note		- Low stream priority: the peripheral streams of DMA2 win the arbitration, a copy
+ * 				  only takes the bus cycles they leave
+*/
+static uint8_t MemDmaConfigure (uint8_t mode)
+{
+	DMA_Config_t *p_Config = &MemDma.DmaConfig;
+	uint8_t status;
+
+	if (mode == Mode)
+	{
+		return DMA_OK;
+	}
+
+	p_Config->direction 	= DMA_DIR_M2M;
+	p_Config->periphInc 	= (MEM_DMA_MODE_FILL == mode) ? DISABLE : ENABLE;
+	p_Config->memInc 		= ENABLE;
+	p_Config->periphSize 	= (MEM_DMA_MODE_BYTE == mode) ? DMA_SIZE_BYTE : DMA_SIZE_WORD;
+	p_Config->memSize 		= DMA_SIZE_WORD;
+	p_Config->circular 		= DISABLE;
+	p_Config->priority 		= DMA_PRIORITY_LOW;
+	p_Config->fifoThreshold = DMA_FIFO_FULL;
+	p_Config->periphBurst 	= (MEM_DMA_MODE_BURST == mode) ? DMA_BURST_INC4 : DMA_BURST_SINGLE;
+	p_Config->memBurst 		= DMA_BURST_INC4;
+
+	status = DMA_Init(&MemDma);
+	if (DMA_OK != status)
+	{
+		Mode = MEM_DMA_MODE_NONE;
+		return status;
+	}
+
+	DMA_InterruptControl(&MemDma, DMA_IT_TC | DMA_IT_TE, ENABLE);
+	Mode = mode;
+
+	return DMA_OK;
+}
+
+/*!
+ * @fn			- MemDmaChunk
+ *
+ * @brief 		- Hands the next chunk of the running transfer to the stream
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The state moves on before the stream starts: a short chunk may complete, and
+ * 				  its interrupt look at the state, before DMA_Start returns
+*/
+_RAMFUNC static void MemDmaChunk (void)
+{
+	uint32_t shift = (MEM_DMA_MODE_BYTE == Mode) ? 0 : 2;
+	uint32_t items = Left >> shift;
+	uint32_t src = NextSrc;
+	uint32_t dst = NextDst;
+
+	if (items > MEM_DMA_CHUNK_ITEMS)
+	{
+		items = MEM_DMA_CHUNK_ITEMS;
+	}
+
+	Left -= items << shift;
+	NextDst += items << shift;
+	if (MEM_DMA_MODE_FILL != Mode)
+	{
+		NextSrc += items << shift;
+	}
+
+	DMA_Start(&MemDma, src, dst, (uint16_t)items);
+}
+
+/*!
+ * @fn			- MemDmaEvent
+ *
+ * @brief 		- Stream callback: next chunk, end of the transfer or transfer error
+ *
+ * @param[in]	- *p_Context: unused
+ * @param[in]	- event: @DMA_EVENT
+ *
+ * @return 		- none
+ *
+ * @note		- A transfer error disables the stream: the rest of the transfer is dropped
+*/
+_RAMFUNC static void MemDmaEvent (void *p_Context, uint8_t event)
+{
+	(void)p_Context;
+
+	if (!Busy)
+	{
+		return;
+	}
+
+	if (DMA_EVENT_ERROR == event)
+	{
+		Failed = Running;
+		Stat.errors++;
+		Busy = RESET;
+	}
+	else if (DMA_EVENT_FULL == event)
+	{
+		if (Left)
+		{
+			MemDmaChunk();
+		}
+		else
+		{
+			Busy = RESET;
+		}
+	}
+}
+
+/*!
+ * @fn			- MemDmaAbort
+ *
+ * @brief 		- Stops the transfer in flight
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- With interrupts off: the callback can not chain a chunk behind the stop
+*/
+static void MemDmaAbort (void)
+{
+	uint32_t primask = ATOMIC_IrqDisable();
+
+	if (Busy)
+	{
+		DMA_Stop(&MemDma);
+		DMA_ClearFlags(MemDma.p_DMAx, MemDma.stream, DMA_FLAG_ALL);
+		Failed = Running;
+		Busy = RESET;
+	}
+
+	ATOMIC_IrqRestore(primask);
+}
+
+/*!
+ * @fn			- MemDmaSubmit
+ *
+ * @brief 		- Starts a copy or a fill on the stream, or does it by CPU
+ *
+ * @param[out]	- *p_Dst: destination
+ * @param[in]	- *p_Src: source, NULL for a fill
+ * @param[in]	- value: byte value of a fill
+ * @param[in]	- len: bytes
+ *
+ * @return 		- Token of the stream transfer, MEM_DMA_TOKEN_DONE if the CPU did the work
+ *
+ * @note		- The CPU moves the head up to the 16 byte aligned destination and the tail while
+ * 				  the stream moves the body: the three parts are disjoint
+*/
+static MEM_DMA_Token_t MemDmaSubmit (uint8_t *p_Dst, const uint8_t *p_Src, uint8_t value, uint32_t len)
+{
+	uint32_t head = (0U - (uint32_t)p_Dst) & (MEM_DMA_ALIGN - 1);
+	uint32_t body, src, primask;
+	uint8_t mode;
+	MEM_DMA_Token_t token;
+
+	// 1. Below the threshold, or nothing left for the stream once aligned
+	if ((len < Threshold) || (len < head + MEM_DMA_ALIGN))
+	{
+		MemCpu(p_Dst, p_Src, value, len);
+		Stat.cpuCount++;
+		return MEM_DMA_TOKEN_DONE;
+	}
+
+	// 2. One transfer in flight: the CPU takes over rather than wait. The claim publishes the new
+	// token with it, a set Busy never pairs with the token of a finished transfer.
+	primask = ATOMIC_IrqDisable();
+
+	if (!Ready || Hold || Busy)
+	{
+		ATOMIC_IrqRestore(primask);
+		MemCpu(p_Dst, p_Src, value, len);
+		Stat.fallbacks++;
+		return MEM_DMA_TOKEN_DONE;
+	}
+
+	token = ++Sequence;
+	if (MEM_DMA_TOKEN_DONE == token)
+	{
+		token = ++Sequence;
+	}
+	Running = token;
+	Busy = SET;
+
+	ATOMIC_IrqRestore(primask);
+
+	// 3. Stream configuration from the source alignment
+	body = (len - head) & ~(MEM_DMA_ALIGN - 1);
+	src = (uint32_t)p_Src + head;
+
+	if (NULL == p_Src)
+	{
+		mode = MEM_DMA_MODE_FILL;
+		FillWord = value * 0x01010101U;
+		src = (uint32_t)&FillWord;
+	}
+	else if (0 == (src & (MEM_DMA_ALIGN - 1)))
+	{
+		mode = MEM_DMA_MODE_BURST;
+	}
+	else
+	{
+		mode = (0 == (src & 0x3)) ? MEM_DMA_MODE_WORD : MEM_DMA_MODE_BYTE;
+	}
+
+	if (DMA_OK != MemDmaConfigure(mode))
+	{
+		Busy = RESET;
+		MemCpu(p_Dst, p_Src, value, len);
+		Stat.fallbacks++;
+		return MEM_DMA_TOKEN_DONE;
+	}
+
+	// 4. Start the body, the stream reads what the CPU wrote last
+	NextSrc = src;
+	NextDst = (uint32_t)p_Dst + head;
+	Left = body;
+
+	Stat.dmaCount++;
+
+	__asm volatile ("DMB" ::: "memory");
+	MemDmaChunk();
+
+	// 5. Head and tail on the CPU meanwhile
+	MemCpu(p_Dst, p_Src, value, head);
+	MemCpu(p_Dst + head + body, p_Src ? (p_Src + head + body) : NULL, value, len - head - body);
+
+	return token;
+}
+
+/*!
+ * @fn			- MemDmaMeasure
+ *
+ * @brief 		- Best of three blocking copies at a given threshold
+ *
+ * @param[out]	- *p_Dst: destination
+ * @param[in]	- *p_Src: source
+ * @param[in]	- len: bytes
+ * @param[in]	- threshold: 0 forces the stream, UINT32_MAX the CPU
+ *
+ * @return 		- Core cycles
+ *
+ * @note		- none
+*/
+static uint32_t MemDmaMeasure (void *p_Dst, const void *p_Src, uint32_t len, uint32_t threshold)
+{
+	uint32_t best = UINT32_MAX;
+
+	Threshold = threshold;
+
+	for (uint8_t i = 0; i < 3; ++i)
+	{
+		uint32_t start = DWT_CYCCNT();
+		MEM_DMA_Copy(p_Dst, p_Src, len);
+		uint32_t cycles = DWT_CYCCNT() - start;
+
+		best = (cycles < best) ? cycles : best;
+	}
+
+	return best;
+}
+
+/*!
+ * @fn			- MemDmaClockNotify
+ *
+ * @brief 		- Clock switch notification
+ *
+ * @param[in]	- *p_Context: unused
+ * @param[in]	- event: @CLOCK_EVENT
+ * @param[in]	- *p_Freq: unused
+ *
+ * @return 		- none
+ *
+ * @note		- Before the switch new operations go to the CPU and the running transfer is given
+ * 				  MEM_DMA_RETIME_TIMEOUT_US to end on the old clock
+*/
+static void MemDmaClockNotify (void *p_Context, uint8_t event, const CLOCK_Freq_t *p_Freq)
+{
+	(void)p_Context;
+	(void)p_Freq;
+
+	if (CLOCK_EVENT_PRE_CHANGE == event)
+	{
+		Hold = SET;
+		(void)MEM_DMA_Wait(Running, MEM_DMA_RETIME_TIMEOUT_US);
+		return;
+	}
+
+	Hold = RESET;
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- MEM_DMA_Init
+ *
+ * @brief 		- Allocates a DMA2 stream for the memory operations
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- @MEM_DMA_STATUS
+ *
+ * @note		- The stream interrupt is bound, NVIC enable and priority stay with the application,
+ * 				  see MEM_DMA_IRQNumber. Without the interrupt only the blocking calls and
+ * 				  MEM_DMA_Wait make progress.
+*/
+uint8_t MEM_DMA_Init (void)
+{
+	static const DMA_Route_t routes[] = { DMA_ROUTE(DMA2, 0, 0), DMA_ROUTE(DMA2, 4, 0), DMA_ROUTE(DMA2, 3, 0) };
+
+	if (Ready)
+	{
+		return MEM_DMA_OK;
+	}
+
+	if (DMA_OK != DMA_Allocate(&MemDma, routes, sizeof(routes) / sizeof(*routes)))
+	{
+		return MEM_DMA_ERR_BUSY;
+	}
+
+	MemDma.callback = MemDmaEvent;
+	MemDma.p_Context = NULL;
+	Mode = MEM_DMA_MODE_NONE;
+	Busy = RESET;
+	Hold = RESET;
+
+	DMA_IRQBind(&MemDma, ENABLE);
+	CLOCK_NotifierRegister(&ClockNotifier, MemDmaClockNotify, NULL);
+	Ready = SET;
+
+	return MEM_DMA_OK;
+}
+
+/*!
+ * @fn			- MEM_DMA_DeInit
+ *
+ * @brief 		- Ends the running transfer and gives the stream back
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The operations keep working on the CPU
+*/
+void MEM_DMA_DeInit (void)
+{
+	if (!Ready)
+	{
+		return;
+	}
+
+	Ready = RESET;
+	if (MEM_DMA_OK != MEM_DMA_Wait(Running, MEM_DMA_WAIT_TIMEOUT_US))
+	{
+		MemDmaAbort();
+	}
+
+	CLOCK_NotifierUnregister(&ClockNotifier);
+	DMA_IRQBind(&MemDma, DISABLE);
+	DMA_Release(&MemDma);
+	Mode = MEM_DMA_MODE_NONE;
+}
+
+/*!
+ * @fn			- MEM_DMA_IRQNumber
+ *
+ * @brief 		- NVIC interrupt number of the allocated stream
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- IRQ number, IRQ_NO_NONE before MEM_DMA_Init
+ *
+ * @note		- The interrupt only chains 64 KB chunks and ends the transfer: a background
+ * 				  level is enough unless the callers wait on it
+*/
+uint8_t MEM_DMA_IRQNumber (void)
+{
+	return Ready ? DMA_IRQNumber(MemDma.p_DMAx, MemDma.stream) : IRQ_NO_NONE;
+}
+
+/*!
+ * @fn			- MEM_DMA_SetThreshold
+ *
+ * @brief 		- Sets the length from which the stream takes over
+ *
+ * @param[in]	- bytes: 0 sends everything to the stream, UINT32_MAX nothing
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- MEM_DMA_Calibrate measures it
+*/
+void MEM_DMA_SetThreshold (uint32_t bytes)
+{
+	Threshold = bytes;
+}
+
+/*!
+ * @fn			- MEM_DMA_GetThreshold
+ *
+ * @brief 		- Length from which the stream takes over
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Bytes
+ *
+ * @note		- none
+*/
+uint32_t MEM_DMA_GetThreshold (void)
+{
+	return Threshold;
+}
+
+/*!
+ * @fn			- MEM_DMA_Calibrate
+ *
+ * @brief 		- Measures the CPU / stream crossover of a blocking copy and makes it the threshold
+ *
+ * @param[in]	- *p_Scratch: buffer, halved into source and destination
+ * @param[in]	- size: bytes, the longest copy tried is half of it
+ *
+ * @return 		- New threshold, bytes
+ *
+ * @note		- Lengths double from MEM_DMA_CALIBRATE_MIN until the stream wins, then a bisection
+ * 				  narrows the crossover down to MEM_DMA_ALIGN. Both paths run at the current clock
+ * 				  with aligned buffers: rerun it after a clock switch that changes the flash wait
+ * 				  states. If the stream never wins, the threshold lands beyond the scratch size.
+*/
+uint32_t MEM_DMA_Calibrate (void *p_Scratch, uint32_t size)
+{
+	uint32_t base = ((uint32_t)p_Scratch + MEM_DMA_ALIGN - 1) & ~(MEM_DMA_ALIGN - 1);
+	uint32_t half = ((size - (base - (uint32_t)p_Scratch)) / 2) & ~(MEM_DMA_ALIGN - 1);
+	uint8_t *p_Src = (uint8_t *)base;
+	uint8_t *p_Dst = p_Src + half;
+	uint32_t saved = Threshold;
+	uint32_t lo = 0, hi;
+
+	if (!Ready || (size < 2 * MEM_DMA_ALIGN) || (half < MEM_DMA_CALIBRATE_MIN))
+	{
+		return saved;
+	}
+
+	// 1. Doubling: the first length the stream wins
+	for (hi = MEM_DMA_CALIBRATE_MIN; hi <= half; hi <<= 1)
+	{
+		if (MemDmaMeasure(p_Dst, p_Src, hi, 0) < MemDmaMeasure(p_Dst, p_Src, hi, UINT32_MAX))
+		{
+			break;
+		}
+		lo = hi;
+	}
+
+	// 2. Bisection between the last CPU win and the first stream win
+	while ((hi <= half) && (hi - lo > MEM_DMA_ALIGN))
+	{
+		uint32_t mid = ((lo + hi) / 2) & ~(MEM_DMA_ALIGN - 1);
+
+		if (MemDmaMeasure(p_Dst, p_Src, mid, 0) < MemDmaMeasure(p_Dst, p_Src, mid, UINT32_MAX))
+		{
+			hi = mid;
+		}
+		else
+		{
+			lo = mid;
+		}
+	}
+
+	Threshold = hi;
+
+	return hi;
+}
+
+/*!
+ * @fn			- MEM_DMA_GetStat
+ *
+ * @brief 		- Copies the operation counters
+ *
+ * @param[out]	- *p_Stat: counters since reset
+ * @param[in]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Plain increments: a count may be lost when two contexts finish an operation together
+*/
+void MEM_DMA_GetStat (MEM_DMA_Stat_t *p_Stat)
+{
+	*p_Stat = Stat;
+}
+
+/*!
+ * @fn			- MEM_DMA_Copy
+ *
+ * @brief 		- Copies a buffer, by stream from the threshold on
+ *
+ * @param[out]	- *p_Dst: destination
+ * @param[in]	- *p_Src: source
+ * @param[in]	- len: bytes
+ *
+ * @return 		- p_Dst, as memcpy
+ *
+ * @note		- The buffers must not overlap. Returns with the copy complete: a stream error or
+ * 				  timeout is repaired by a CPU copy.
+*/
+void *MEM_DMA_Copy (void *p_Dst, const void *p_Src, uint32_t len)
+{
+	MEM_DMA_Token_t token = MemDmaSubmit((uint8_t *)p_Dst, (const uint8_t *)p_Src, 0, len);
+
+	if (MEM_DMA_OK != MEM_DMA_Wait(token, MEM_DMA_WAIT_TIMEOUT_US))
+	{
+		MemDmaAbort();
+		Stat.fallbacks++;
+		MemCpuCopy((uint8_t *)p_Dst, (const uint8_t *)p_Src, len);
+	}
+
+	return p_Dst;
+}
+
+/*!
+ * @fn			- MEM_DMA_Set
+ *
+ * @brief 		- Fills a buffer, by stream from the threshold on
+ *
+ * @param[out]	- *p_Dst: destination
+ * @param[in]	- value: byte value
+ * @param[in]	- len: bytes
+ *
+ * @return 		- p_Dst, as memset
+ *
+ * @note		- Returns with the fill complete: a stream error or timeout is repaired by a CPU fill
+*/
+void *MEM_DMA_Set (void *p_Dst, uint8_t value, uint32_t len)
+{
+	MEM_DMA_Token_t token = MemDmaSubmit((uint8_t *)p_Dst, NULL, value, len);
+
+	if (MEM_DMA_OK != MEM_DMA_Wait(token, MEM_DMA_WAIT_TIMEOUT_US))
+	{
+		MemDmaAbort();
+		Stat.fallbacks++;
+		MemCpuFill((uint8_t *)p_Dst, value, len);
+	}
+
+	return p_Dst;
+}
+
+/*!
+ * @fn			- MEM_DMA_CopyAsync
+ *
+ * @brief 		- Starts a copy and returns while the stream moves the data
+ *
+ * @param[out]	- *p_Dst: destination, not to be touched until the token is done
+ * @param[in]	- *p_Src: source, not to be modified until the token is done
+ * @param[in]	- len: bytes
+ *
+ * @return 		- Completion token, MEM_DMA_TOKEN_DONE if the CPU already did the copy
+ *
+ * @note		- See MEM_DMA_IsDone and MEM_DMA_Wait. A stream error leaves the destination
+ * 				  incomplete and is reported by MEM_DMA_Wait.
+*/
+MEM_DMA_Token_t MEM_DMA_CopyAsync (void *p_Dst, const void *p_Src, uint32_t len)
+{
+	return MemDmaSubmit((uint8_t *)p_Dst, (const uint8_t *)p_Src, 0, len);
+}
+
+/*!
+ * @fn			- MEM_DMA_SetAsync
+ *
+ * @brief 		- Starts a fill and returns while the stream writes the buffer
+ *
+ * @param[out]	- *p_Dst: destination, not to be touched until the token is done
+ * @param[in]	- value: byte value
+ * @param[in]	- len: bytes
+ *
+ * @return 		- Completion token, MEM_DMA_TOKEN_DONE if the CPU already did the fill
+ *
+ * @note		- See MEM_DMA_IsDone and MEM_DMA_Wait
+*/
+MEM_DMA_Token_t MEM_DMA_SetAsync (void *p_Dst, uint8_t value, uint32_t len)
+{
+	return MemDmaSubmit((uint8_t *)p_Dst, NULL, value, len);
+}
+
+/*!
+ * @fn			- MEM_DMA_IsDone
+ *
+ * @brief 		- Checks whether the operation of a token has finished
+ *
+ * @param[in]	- token: from MEM_DMA_CopyAsync or MEM_DMA_SetAsync
+ * @param[out]	- none
+ *
+ * @return 		- SET: finished (or failed, see MEM_DMA_Wait), RESET: still running
+ *
+ * @note		- Only the transfer in flight can be pending: any other token is done
+*/
+uint8_t MEM_DMA_IsDone (MEM_DMA_Token_t token)
+{
+	if ((MEM_DMA_TOKEN_DONE == token) || (token != Running) || !Busy)
+	{
+		return SET;
+	}
+
+	return RESET;
+}
+
+/*!
+ * @fn			- MEM_DMA_Wait
+ *
+ * @brief 		- Waits for the operation of a token
+ *
+ * @param[in]	- token: from MEM_DMA_CopyAsync or MEM_DMA_SetAsync
+ * @param[in]	- timeoutUs: upper bound of the wait
+ *
+ * @return 		- @MEM_DMA_STATUS
+ *
+ * @note		- The stream is served here as well, with interrupts off for each poll: the wait
+ * 				  also completes from an interrupt at or above the stream's priority
+*/
+uint8_t MEM_DMA_Wait (MEM_DMA_Token_t token, uint32_t timeoutUs)
+{
+	TIMEBASE_Timeout_t timeout;
+
+	TIMEBASE_TimeoutStart(&timeout, timeoutUs);
+	while (!MEM_DMA_IsDone(token))
+	{
+		uint32_t primask = ATOMIC_IrqDisable();
+		DMA_IRQHandling(&MemDma);
+		ATOMIC_IrqRestore(primask);
+
+		if (TIMEBASE_TimeoutExpired(&timeout))
+		{
+			return MEM_DMA_IsDone(token) ? MEM_DMA_OK : MEM_DMA_ERR_TIMEOUT;
+		}
+	}
+
+	return ((MEM_DMA_TOKEN_DONE != token) && (token == Failed)) ? MEM_DMA_ERR_DMA : MEM_DMA_OK;
+}
+
+/*** EOF ***/
@@ -0,0 +1,370 @@
+/** @file nvic.c
+*
+* @brief Priority-grouped NVIC manager: AIRCR grouping, preemption / sub-priority and pending control.
+*
+* The STM32F446xx implements the upper 4 bits (NO_IPR_BITS) of each 8 bit priority field. AIRCR.PRIGROUP
+* splits these bits into a preemption part (decides nesting) and a sub-priority part (decides the order
+* of pending IRQs with the same preemption level).
+*
+*/
+
+#include "nvic.h"
+#include "irqprof.h"
+
+
+// === Private Variables ===
+//
+/*
+ * Static priority plan: SPI, USART and I2C data ISRs preempt every EXTI/UI handler, the UI lines never preempt each other
+ * 	Every RX stream of the USART and I2C route tables is listed, the fallbacks as well: DMA_Allocate may
+ * 	hand out any of them, and a stream left at level 0 would ignore the DATA critical sections.
+ */
+static const NVIC_PlanEntry_t PriorityPlan[] =
+{
+	{ IRQ_NO_SPI1,		NVIC_PLAN_PREEMPT_DATA,	0 },
+	{ IRQ_NO_SPI2,		NVIC_PLAN_PREEMPT_DATA,	1 },
+	{ IRQ_NO_SPI3,		NVIC_PLAN_PREEMPT_DATA,	2 },
+	{ IRQ_NO_SPI4,		NVIC_PLAN_PREEMPT_DATA,	3 },
+	{ IRQ_NO_USART1,	NVIC_PLAN_PREEMPT_DATA,	0 },
+	{ IRQ_NO_DMA2_STREAM2,	NVIC_PLAN_PREEMPT_DATA,	0 },		// USART1 RX, same level as its USART (USART6 RX fallback)
+	{ IRQ_NO_USART2,	NVIC_PLAN_PREEMPT_DATA,	1 },
+	{ IRQ_NO_DMA1_STREAM5,	NVIC_PLAN_PREEMPT_DATA,	1 },		// USART2 RX, I2C1 RX fallback
+	{ IRQ_NO_USART6,	NVIC_PLAN_PREEMPT_DATA,	2 },
+	{ IRQ_NO_DMA2_STREAM1,	NVIC_PLAN_PREEMPT_DATA,	2 },		// USART6 RX
+	{ IRQ_NO_I2C1_EV,	NVIC_PLAN_PREEMPT_DATA,	3 },
+	{ IRQ_NO_I2C1_ER,	NVIC_PLAN_PREEMPT_DATA,	3 },
+	{ IRQ_NO_DMA1_STREAM0,	NVIC_PLAN_PREEMPT_DATA,	3 },		// I2C1 RX, UART5 RX
+	{ IRQ_NO_I2C2_EV,	NVIC_PLAN_PREEMPT_DATA,	3 },
+	{ IRQ_NO_I2C2_ER,	NVIC_PLAN_PREEMPT_DATA,	3 },
+	{ IRQ_NO_I2C3_EV,	NVIC_PLAN_PREEMPT_DATA,	3 },
+	{ IRQ_NO_I2C3_ER,	NVIC_PLAN_PREEMPT_DATA,	3 },
+	{ IRQ_NO_DMA1_STREAM2,	NVIC_PLAN_PREEMPT_DATA,	3 },		// I2C2 / I2C3 RX, UART4 RX
+	{ IRQ_NO_DMA2_STREAM5,	NVIC_PLAN_PREEMPT_DATA,	0 },		// USART1 RX fallback
+	{ IRQ_NO_DMA1_STREAM1,	NVIC_PLAN_PREEMPT_DATA,	3 },		// I2C3 RX fallback, USART3 RX
+	{ IRQ_NO_DMA1_STREAM3,	NVIC_PLAN_PREEMPT_DATA,	3 },		// I2C2 RX fallback
+	{ IRQ_NO_EXTI0,		NVIC_PLAN_PREEMPT_UI,	0 },
+	{ IRQ_NO_EXTI1,		NVIC_PLAN_PREEMPT_UI,	0 },
+	{ IRQ_NO_EXTI2,		NVIC_PLAN_PREEMPT_UI,	1 },
+	{ IRQ_NO_EXTI3,		NVIC_PLAN_PREEMPT_UI,	1 },
+	{ IRQ_NO_EXTI4,		NVIC_PLAN_PREEMPT_UI,	1 },
+	{ IRQ_NO_EXTI9_5,	NVIC_PLAN_PREEMPT_UI,	2 },
+	{ IRQ_NO_EXTI15_10,	NVIC_PLAN_PREEMPT_UI,	3 },
+};
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- SubBits
+ *
+ * @brief 		- Number of implemented sub-priority bits with the current grouping
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- 0 - NO_IPR_BITS
+ *
+ * @note		- none
+*/
+static inline uint8_t SubBits (void)
+{
+	return NO_IPR_BITS - NVIC_GetPriorityGrouping();
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- NVIC_SetPriorityGrouping
+ *
+ * @brief 		- Splits the priority field into preemption and sub-priority bits (AIRCR.PRIGROUP)
+ *
+ * @param[in]	- preemptBits: @NVIC_PREEMPT_BITS
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Set it once at start-up before any priority: the meaning of the already written
+ * 				  priority fields changes with the grouping
+*/
+void NVIC_SetPriorityGrouping (uint8_t preemptBits)
+{
+	uint32_t reg = SCB->AIRCR;
+
+	if (preemptBits > NO_IPR_BITS)
+	{
+		preemptBits = NO_IPR_BITS;
+	}
+
+	// VECTKEY must be written, otherwise the write is ignored. It reads back as 0xFA05
+	reg &= ~((0xFFFFu << SCB_AIRCRREG_VECTKEY) | (0x7 << SCB_AIRCRREG_PRIGROUP));
+	reg |= (SCB_AIRCR_VECTKEY << SCB_AIRCRREG_VECTKEY) | ((uint32_t)(7 - preemptBits) << SCB_AIRCRREG_PRIGROUP);
+	SCB->AIRCR = reg;
+}
+
+/*!
+ * @fn			- NVIC_GetPriorityGrouping
+ *
+ * @brief 		- Reads back the priority grouping
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- @NVIC_PREEMPT_BITS
+ *
+ * @note		- PRIGROUP values below 3 select the same split as 3 on a 4 bit implementation
+*/
+uint8_t NVIC_GetPriorityGrouping (void)
+{
+	uint8_t prigroup = (SCB->AIRCR >> SCB_AIRCRREG_PRIGROUP) & 0x7;
+
+	return (prigroup < 3) ? NO_IPR_BITS : (7 - prigroup);
+}
+
+/*!
+ * @fn			- NVIC_EncodePriority
+ *
+ * @brief 		- Builds the raw 8 bit priority field with the current grouping
+ *
+ * @param[in]	- preempt: preemption priority, saturated to the available levels
+ * @param[in]	- sub: sub-priority, saturated to the available levels
+ *
+ * @return 		- IPR / SHPR byte value (also the BASEPRI value of the level)
+ *
+ * @note		- none
+*/
+uint8_t NVIC_EncodePriority (uint8_t preempt, uint8_t sub)
+{
+	uint8_t subBits = SubBits();
+	uint8_t preemptMax = (1 << (NO_IPR_BITS - subBits)) - 1;
+	uint8_t subMax = (1 << subBits) - 1;
+
+	if (preempt > preemptMax)
+	{
+		preempt = preemptMax;
+	}
+	if (sub > subMax)
+	{
+		sub = subMax;
+	}
+
+	return (uint8_t)(((preempt << subBits) | sub) << (8 - NO_IPR_BITS));
+}
+
+/*!
+ * @fn			- NVIC_SetPriority
+ *
+ * @brief 		- Sets both parts of the IRQ priority with a single byte write
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[in]	- preempt: preemption priority
+ * @param[in]	- sub: sub-priority
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void NVIC_SetPriority (uint8_t IRQNumber, uint8_t preempt, uint8_t sub)
+{
+	NVIC_IPR->reg[IRQNumber] = NVIC_EncodePriority(preempt, sub);
+}
+
+/*!
+ * @fn			- NVIC_SetPreemptPriority
+ *
+ * @brief 		- Changes the preemption priority, keeps the sub-priority
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[in]	- preempt: preemption priority
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void NVIC_SetPreemptPriority (uint8_t IRQNumber, uint8_t preempt)
+{
+	NVIC_SetPriority(IRQNumber, preempt, NVIC_GetSubPriority(IRQNumber));
+}
+
+/*!
+ * @fn			- NVIC_SetSubPriority
+ *
+ * @brief 		- Changes the sub-priority, keeps the preemption priority
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[in]	- sub: sub-priority
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void NVIC_SetSubPriority (uint8_t IRQNumber, uint8_t sub)
+{
+	NVIC_SetPriority(IRQNumber, NVIC_GetPreemptPriority(IRQNumber), sub);
+}
+
+/*!
+ * @fn			- NVIC_GetPreemptPriority
+ *
+ * @brief 		- Reads the preemption priority of the IRQ
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- Preemption priority with the current grouping
+ *
+ * @note		- none
+*/
+uint8_t NVIC_GetPreemptPriority (uint8_t IRQNumber)
+{
+	return (NVIC_IPR->reg[IRQNumber] >> (8 - NO_IPR_BITS)) >> SubBits();
+}
+
+/*!
+ * @fn			- NVIC_GetSubPriority
+ *
+ * @brief 		- Reads the sub-priority of the IRQ
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- Sub-priority with the current grouping
+ *
+ * @note		- none
+*/
+uint8_t NVIC_GetSubPriority (uint8_t IRQNumber)
+{
+	return (NVIC_IPR->reg[IRQNumber] >> (8 - NO_IPR_BITS)) & ((1 << SubBits()) - 1);
+}
+
+/*!
+ * @fn			- NVIC_SetSystemPriority
+ *
+ * @brief 		- Sets the priority of a configurable system exception (SHPR1-3)
+ *
+ * @param[in]	- exception: @NVIC_SYS_EXCEPTIONS
+ * @param[in]	- preempt: preemption priority
+ * @param[in]	- sub: sub-priority
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void NVIC_SetSystemPriority (uint8_t exception, uint8_t preempt, uint8_t sub)
+{
+	if ((exception >= NVIC_EXC_MEMMANAGE) && (exception <= NVIC_EXC_SYSTICK))
+	{
+		SCB->SHPR[exception - NVIC_EXC_MEMMANAGE] = NVIC_EncodePriority(preempt, sub);
+	}
+}
+
+/*!
+ * @fn			- NVIC_SetPending
+ *
+ * @brief 		- Pends the IRQ by software
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Write-1-to-set, the other bits of the register are not touched.
+ * 				  The request is stamped for the pending latency of the profiler.
+*/
+void NVIC_SetPending (uint8_t IRQNumber)
+{
+	IRQPROF_MARK_PENDING(IRQNumber);
+	NVIC_ISPR->reg[IRQNumber / 32] = (1 << (IRQNumber % 32));
+}
+
+/*!
+ * @fn			- NVIC_ClearPending
+ *
+ * @brief 		- Removes the pending state of the IRQ
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The peripheral flag must be cleared first, otherwise a level IRQ pends again
+*/
+void NVIC_ClearPending (uint8_t IRQNumber)
+{
+	NVIC_ICPR->reg[IRQNumber / 32] = (1 << (IRQNumber % 32));
+}
+
+/*!
+ * @fn			- NVIC_IsPending
+ *
+ * @brief 		- Checks the pending state of the IRQ
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- SET or RESET
+ *
+ * @note		- none
+*/
+uint8_t NVIC_IsPending (uint8_t IRQNumber)
+{
+	return (NVIC_ISPR->reg[IRQNumber / 32] & (1 << (IRQNumber % 32))) ? SET : RESET;
+}
+
+/*!
+ * @fn			- NVIC_IsActive
+ *
+ * @brief 		- Checks whether the handler of the IRQ is running (or preempted)
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- SET or RESET
+ *
+ * @note		- none
+*/
+uint8_t NVIC_IsActive (uint8_t IRQNumber)
+{
+	return (NVIC_IABR->reg[IRQNumber / 32] & (1 << (IRQNumber % 32))) ? SET : RESET;
+}
+
+/*!
+ * @fn			- NVIC_GetActiveIRQ
+ *
+ * @brief 		- IRQ number of the currently executing handler (ICSR.VECTACTIVE)
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- IRQ number, negative for system exceptions, NVIC_NO_ACTIVE in thread mode
+ *
+ * @note		- none
+*/
+int16_t NVIC_GetActiveIRQ (void)
+{
+	return (int16_t)((SCB->ICSR >> SCB_ICSRREG_VECTACTIVE) & 0x1FF) - 16;
+}
+
+/*!
+ * @fn			- NVIC_ApplyPriorityPlan
+ *
+ * @brief 		- Programs the grouping and the priorities of the static priority plan
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The IRQs are not enabled here
+*/
+void NVIC_ApplyPriorityPlan (void)
+{
+	NVIC_SetPriorityGrouping(NVIC_PLAN_PREEMPT_BITS);
+
+	for (uint8_t i = 0; i < (sizeof(PriorityPlan) / sizeof(*PriorityPlan)); ++i)
+	{
+		NVIC_SetPriority(PriorityPlan[i].IRQNumber, PriorityPlan[i].preempt, PriorityPlan[i].sub);
+	}
+}
+
+/*** EOF ***/
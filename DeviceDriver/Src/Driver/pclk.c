@@ -0,0 +1,230 @@
+/** @file pclk.c
+*
+* @brief Reference-counted peripheral clock gating.
+*
+* Every driver takes a reference on the bus clock of its peripheral when it starts using it and drops
+* it when it is done; the clock is gated only when the last user is gone, so a GPIO port shared by
+* several drivers is not switched off under them. The xxxLPENR bits follow the references: after
+* PCLK_Init only the clocks in use, minus the ones excluded with PCLK_SleepControl, run while the core
+* sleeps.
+*
+*/
+
+#include <stddef.h>
+#include "pclk.h"
+#include "atomic.h"
+
+
+// === Private Variables ===
+//
+#define PCLK_MASK_LEVEL			NVIC_PLAN_PREEMPT_DATA	// Drivers take and drop clocks from DATA handlers at most
+
+static uint8_t RefCount[PCLK_NUM_BUS][32];
+static uint32_t SleepOff[PCLK_NUM_BUS];		// Clocks gated in sleep even while referenced
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- BusIndex
+ *
+ * @brief 		- @PCLK_BUS of a clock enable register
+ *
+ * @param[in]	- *p_ClkEnReg: RCC xxxENR register
+ * @param[out]	- none
+ *
+ * @return 		- Index, PCLK_NUM_BUS if the register is not a clock enable register
+ *
+ * @note		- none
+*/
+static inline uint8_t BusIndex (volatile uint32_t *p_ClkEnReg)
+{
+	uint32_t index = (uint32_t)(p_ClkEnReg - &RCC->AHB1ENR);
+
+	return ((index < PCLK_NUM_BUS) && (3 != index)) ? (uint8_t)index : PCLK_NUM_BUS;
+}
+
+/*!
+ * @fn			- UpdateSleep
+ *
+ * @brief 		- Writes the low power enable bit of a clock from its references and its sleep flag
+ *
+ * @param[in]	- *p_ClkEnReg: RCC xxxENR register
+ * @param[in]	- bus: @PCLK_BUS
+ * @param[in]	- bit: bit position
+ *
+ * @return 		- none
+ *
+ * @note		- Caller holds the PCLK_MASK_LEVEL mask
+*/
+static void UpdateSleep (volatile uint32_t *p_ClkEnReg, uint8_t bus, uint8_t bit)
+{
+	uint32_t keep = (PCLK_BUS_AHB1 == bus) ? PCLK_SLEEP_KEEP_AHB1 : 0;
+
+	if ((RefCount[bus][bit] && !(SleepOff[bus] & (1u << bit))) || (keep & (1u << bit)))
+	{
+		*PCLK_LPENR(p_ClkEnReg) |= (1u << bit);
+	}
+	else
+	{
+		*PCLK_LPENR(p_ClkEnReg) &= ~(1u << bit);
+	}
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- PCLK_Init
+ *
+ * @brief 		- Restricts the sleep clocks to the referenced ones
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The LPENR registers reset to all ones. Call it once at start-up: clocks enabled past
+ * 				  the manager (xxx_PCLK_EN macros) keep running while awake, but stop in sleep.
+*/
+void PCLK_Init (void)
+{
+	volatile uint32_t *p_ClkEnReg = &RCC->AHB1ENR;
+	uint32_t basepri = ATOMIC_MaskEnter(PCLK_MASK_LEVEL);
+
+	for (uint8_t bus = 0; bus < PCLK_NUM_BUS; ++bus)
+	{
+		uint32_t lpenr = (PCLK_BUS_AHB1 == bus) ? PCLK_SLEEP_KEEP_AHB1 : 0;
+
+		if (PCLK_NUM_BUS == BusIndex(&p_ClkEnReg[bus]))
+		{
+			continue;
+		}
+
+		for (uint8_t bit = 0; bit < 32; ++bit)
+		{
+			if (RefCount[bus][bit] && !(SleepOff[bus] & (1u << bit)))
+			{
+				lpenr |= (1u << bit);
+			}
+		}
+		*PCLK_LPENR(&p_ClkEnReg[bus]) = lpenr;
+	}
+
+	ATOMIC_MaskExit(basepri);
+}
+
+/*!
+ * @fn			- PCLK_Control
+ *
+ * @brief 		- Takes or drops a reference on a peripheral clock
+ *
+ * @param[in]	- *p_ClkEnReg: RCC xxxENR register (PERIPH_Desc_t::p_ClkEnReg)
+ * @param[in]	- bit: bit position in the register
+ * @param[in]	- enable: ENABLE takes a reference, DISABLE drops one
+ *
+ * @return 		- References left
+ *
+ * @note		- The first reference enables the clock, the last one gates it. Dropping a reference
+ * 				  which was never taken is ignored. A count which reached PCLK_COUNT_MAX sticks: the
+ * 				  uncounted users are unknown, the clock stays on for good. Callable from ISRs up to
+ * 				  the DATA preemption level: the update masks BASEPRI, CRITICAL handlers keep running.
+*/
+uint8_t PCLK_Control (volatile uint32_t *p_ClkEnReg, uint8_t bit, uint8_t enable)
+{
+	uint8_t bus = BusIndex(p_ClkEnReg);
+	uint8_t count;
+
+	if ((PCLK_NUM_BUS == bus) || (bit > 31))
+	{
+		return 0;
+	}
+
+	uint32_t basepri = ATOMIC_MaskEnter(PCLK_MASK_LEVEL);
+
+	if (ENABLE == enable)
+	{
+		if (RefCount[bus][bit] < PCLK_COUNT_MAX)
+		{
+			RefCount[bus][bit]++;
+		}
+		if (1 == RefCount[bus][bit])
+		{
+			*p_ClkEnReg |= (1u << bit);
+			(void)*p_ClkEnReg;							// The clock is on once the write has landed
+		}
+	}
+	else if (RefCount[bus][bit] && (RefCount[bus][bit] < PCLK_COUNT_MAX))
+	{
+		RefCount[bus][bit]--;
+		if (0 == RefCount[bus][bit])
+		{
+			*p_ClkEnReg &= ~(1u << bit);
+		}
+	}
+	UpdateSleep(p_ClkEnReg, bus, bit);
+	count = RefCount[bus][bit];
+
+	ATOMIC_MaskExit(basepri);
+
+	return count;
+}
+
+/*!
+ * @fn			- PCLK_SleepControl
+ *
+ * @brief 		- Selects whether a referenced clock keeps running while the core sleeps
+ *
+ * @param[in]	- *p_ClkEnReg: RCC xxxENR register
+ * @param[in]	- bit: bit position in the register
+ * @param[in]	- enable: ENABLE (default) runs it in sleep, DISABLE gates it in sleep
+ *
+ * @return 		- none
+ *
+ * @note		- For peripherals with nothing to do until the core is awake again, e.g. a GPIO port
+ * 				  of outputs (the pins hold their level) or an SPI master without DMA
+*/
+void PCLK_SleepControl (volatile uint32_t *p_ClkEnReg, uint8_t bit, uint8_t enable)
+{
+	uint8_t bus = BusIndex(p_ClkEnReg);
+
+	if ((PCLK_NUM_BUS == bus) || (bit > 31))
+	{
+		return;
+	}
+
+	uint32_t basepri = ATOMIC_MaskEnter(PCLK_MASK_LEVEL);
+
+	if (ENABLE == enable)
+	{
+		SleepOff[bus] &= ~(1u << bit);
+	}
+	else
+	{
+		SleepOff[bus] |= (1u << bit);
+	}
+	UpdateSleep(p_ClkEnReg, bus, bit);
+
+	ATOMIC_MaskExit(basepri);
+}
+
+/*!
+ * @fn			- PCLK_GetCount
+ *
+ * @brief 		- References held on a peripheral clock
+ *
+ * @param[in]	- *p_ClkEnReg: RCC xxxENR register
+ * @param[in]	- bit: bit position in the register
+ *
+ * @return 		- References
+ *
+ * @note		- none
+*/
+uint8_t PCLK_GetCount (volatile uint32_t *p_ClkEnReg, uint8_t bit)
+{
+	uint8_t bus = BusIndex(p_ClkEnReg);
+
+	return ((PCLK_NUM_BUS == bus) || (bit > 31)) ? 0 : RefCount[bus][bit];
+}
+
+/*** EOF ***/
@@ -0,0 +1,139 @@
+/** @file sleep.c
+*
+* @brief Core sleep (WFI / WFE / sleep-on-exit) idle integration.
+*
+* Sleep mode only gates the core clock: the peripherals, DMA and the NVIC keep running, and any
+* enabled interrupt wakes the core. With sleep-on-exit the core goes back to sleep straight from the
+* exception return, skipping the unstacking and the thread code, so a purely interrupt-driven firmware
+* (EXTI callbacks, SPI events deferred to PendSV) never runs its main loop. An ISR which has work for
+* the thread calls SLEEP_WakeMain.
+*
+*/
+
+#include "sleep.h"
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- SLEEP_WaitForInterrupt
+ *
+ * @brief 		- Sleeps until an interrupt is pending
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Call it with PRIMASK set after checking the wake-up condition: the pending interrupt
+ * 				  still ends WFI, and its handler runs once PRIMASK is cleared.
+*/
+void SLEEP_WaitForInterrupt (void)
+{
+	__asm volatile ("DSB\n\tWFI" ::: "memory");
+}
+
+/*!
+ * @fn			- SLEEP_WaitForEvent
+ *
+ * @brief 		- Sleeps until an event (SEV, interrupt entry or, with SEVONPEND, a new pending IRQ)
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Returns at once if the event register is already set, and clears it. Use it in a loop
+ * 				  which re-checks its condition.
+*/
+void SLEEP_WaitForEvent (void)
+{
+	__asm volatile ("DSB\n\tWFE" ::: "memory");
+}
+
+/*!
+ * @fn			- SLEEP_EventOnPend
+ *
+ * @brief 		- Turns every newly pending interrupt into a wake-up event
+ *
+ * @param[in]	- enable: ENABLE or DISABLE
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Lets WFE wake on interrupts which are disabled in the NVIC or masked by PRIMASK/BASEPRI
+*/
+void SLEEP_EventOnPend (uint8_t enable)
+{
+	if (ENABLE == enable)
+	{
+		SCB->SCR |= (1 << SCB_SCRREG_SEVONPEND);
+	}
+	else
+	{
+		SCB->SCR &= ~(1 << SCB_SCRREG_SEVONPEND);
+	}
+}
+
+/*!
+ * @fn			- SLEEP_OnExit
+ *
+ * @brief 		- Parks thread mode in sleep-on-exit until an ISR calls SLEEP_WakeMain
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- WFE instead of WFI closes the race with an ISR waking main between setting the bit and
+ * 				  sleeping: SLEEP_WakeMain also signals an event, so WFE falls through and the loop sees
+ * 				  the cleared bit.
+*/
+void SLEEP_OnExit (void)
+{
+	SCB->SCR |= (1 << SCB_SCRREG_SLEEPONEXIT);
+	__asm volatile ("DSB" ::: "memory");
+
+	while (SCB->SCR & (1 << SCB_SCRREG_SLEEPONEXIT))
+	{
+		__asm volatile ("WFE" ::: "memory");
+	}
+}
+
+/*!
+ * @fn			- SLEEP_WakeMain
+ *
+ * @brief 		- Makes the running handler return to thread mode instead of sleeping
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Called from ISRs. The SCR read-modify-write is safe: every writer of SLEEPONEXIT
+ * 				  only clears it, except SLEEP_OnExit in thread mode.
+*/
+void SLEEP_WakeMain (void)
+{
+	SCB->SCR &= ~(1 << SCB_SCRREG_SLEEPONEXIT);
+	__asm volatile ("DSB\n\tSEV" ::: "memory");
+}
+
+/*!
+ * @fn			- SLEEP_IsOnExit
+ *
+ * @brief 		- Checks whether the thread is parked in sleep-on-exit
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- SET or RESET
+ *
+ * @note		- none
+*/
+uint8_t SLEEP_IsOnExit (void)
+{
+	return (SCB->SCR & (1 << SCB_SCRREG_SLEEPONEXIT)) ? SET : RESET;
+}
+
+/*** EOF ***/
@@ -6,9 +6,51 @@
 
 #include <stddef.h>
 #include "spi.h"
+#include "vector.h"
+#include "atomic.h"
+#include "defer.h"
+#include "timebase.h"
+
+// === Private Variables ===
+//
+/*
+ * SPI descriptor table, indexed by SPI_DESC_INDEX(): address bits 11:10 are unique per instance
+ * 	SPI1: 0x40013000 -> 0, SPI4: 0x40013400 -> 1, SPI2: 0x40003800 -> 2, SPI3: 0x40003C00 -> 3
+ */
+#define SPI_DESC_INDEX(p_SPI)		(((uint32_t)(p_SPI) >> 10) & 0x3)
+
+static const PERIPH_Desc_t SpiDesc[] =
+{
+	PERIPH_DESC(SPI1_BASE, APB2ENR, APB2RSTR, 12, IRQ_NO_SPI1, 1),
+	PERIPH_DESC(SPI4_BASE, APB2ENR, APB2RSTR, 13, IRQ_NO_SPI4, 4),
+	PERIPH_DESC(SPI2_BASE, APB1ENR, APB1RSTR, 14, IRQ_NO_SPI2, 2),
+	PERIPH_DESC(SPI3_BASE, APB1ENR, APB1RSTR, 15, IRQ_NO_SPI3, 3),
+};
+
+static uint8_t ClockHeld;				// SPI_DESC_INDEX() bits: SPI_Init holds the clock reference of the interface
+
 
 // === Protected Functions ===
 //
+/*!
+ * @fn			- SpiDescriptor
+ *
+ * @brief 		- Looks up the descriptor of the SPI interface by address arithmetic
+ *
+ * @param[in]	- *p_SPI: base address of the SPI peripheral
+ * @param[out]	- none
+ *
+ * @return 		- Descriptor, NULL if the address is not an SPI interface
+ *
+ * @note		- none
+*/
+static inline const PERIPH_Desc_t *SpiDescriptor (SPI_RegDef_t *p_SPI)
+{
+	const PERIPH_Desc_t *p_Desc = &SpiDesc[SPI_DESC_INDEX(p_SPI)];
+
+	return (p_Desc->baseAddr == (uint32_t)p_SPI) ? p_Desc : NULL;
+}
+
 /*!
  * @fn			- SPI_GetFlagStatus
  *
@@ -32,6 +74,102 @@ uint8_t static inline SPI_GetFlagStatus (SPI_RegDef_t *p_SPIx, uint32_t flagType
 	return FLAG_RESET;
 }
 
+/*!
+ * @fn			- SPI_ClockNotify
+ *
+ * @brief 		- Clock switch notification of a tracked SPI handle
+ *
+ * @param[in]	- *p_Context: pointer to the SPI Handler
+ * @param[in]	- event: @CLOCK_EVENT
+ * @param[in]	- *p_Freq: unused, the bus clock is looked up through the descriptor
+ *
+ * @return 		- none
+ *
+ * @note		- Before the switch the running IT transfer and the last frame are given
+ * 				  SPI_RETIME_TIMEOUT_US to end. BR must not change while SPE is set, so the interface is
+ * 				  disabled around the update and restored.
+*/
+static void SPI_ClockNotify (void *p_Context, uint8_t event, const CLOCK_Freq_t *p_Freq)
+{
+	SPI_Handle_t *p_SpiHandle = (SPI_Handle_t *)p_Context;
+	SPI_RegDef_t *p_SPIx = p_SpiHandle->p_SPIx;
+	(void)p_Freq;
+
+	if (CLOCK_EVENT_PRE_CHANGE == event)
+	{
+		TIMEBASE_Timeout_t timeout;
+
+		TIMEBASE_TimeoutStart(&timeout, SPI_RETIME_TIMEOUT_US);
+		while (((SPI_ST_READY != p_SpiHandle->TxState) || (SPI_ST_READY != p_SpiHandle->RxState) ||
+				(p_SPIx->SR & SPI_FLAG_BUSY)) && !TIMEBASE_TimeoutExpired(&timeout));
+		return;
+	}
+
+	uint32_t configReg = p_SPIx->CR1;
+	uint8_t speed = SPI_SpeedFor(p_SPIx, p_SpiHandle->maxSclkHz);
+
+	p_SPIx->CR1 = configReg & ~(1 << SPI_CR1REG_SPE);
+	p_SPIx->CR1 = (configReg & ~((1 << SPI_CR1REG_SPE) | (0x7 << SPI_CR1REG_BR))) | (speed << SPI_CR1REG_BR);
+	p_SPIx->CR1 = (configReg & ~(0x7 << SPI_CR1REG_BR)) | (speed << SPI_CR1REG_BR);
+	p_SpiHandle->SpiConfig.sclkSpeed = speed;
+}
+
+/*!
+ * @fn			- SPI_IRQDispatch
+ *
+ * @brief 		- Vector table entry of a bound SPI handle
+ *
+ * @param[in]	- *p_Context: pointer to the SPI Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+_RAMFUNC static void SPI_IRQDispatch (void *p_Context)
+{
+	SPI_IRQHandling((SPI_Handle_t *)p_Context);
+}
+
+/*!
+ * @fn			- SPI_DeferredEvent
+ *
+ * @brief 		- Runs the application callback of a deferred event outside interrupt context
+ *
+ * @param[in]	- *p_Context: pointer to the SPI Handler
+ * @param[in]	- arg: @SPI_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void SPI_DeferredEvent (void *p_Context, uint32_t arg)
+{
+	SPI_API_EventCallback((SPI_Handle_t *)p_Context, (uint8_t)arg);
+}
+
+/*!
+ * @fn			- SPI_RaiseEvent
+ *
+ * @brief 		- Raises an application event from the ISR
+ *
+ * @param[in]	- *p_SpiHandle: pointer to the SPI Handler
+ * @param[in]	- appEvent: @SPI_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- Events of the fastEvents mask run in the ISR. The others are posted to the deferred-work
+ * 				  queue; if it is not running or full, the callback runs in the ISR so no event is lost.
+*/
+_RAMFUNC static void SPI_RaiseEvent (SPI_Handle_t *p_SpiHandle, uint8_t appEvent)
+{
+	if ((p_SpiHandle->fastEvents & SPI_EVENT_MASK(appEvent)) ||
+		!DEFER_Post(SPI_DeferredEvent, p_SpiHandle, appEvent))
+	{
+		SPI_API_EventCallback(p_SpiHandle, appEvent);
+	}
+}
+
 /*!
  * @fn			- SPI_TXE_InterruptHandler
  *
@@ -44,7 +182,7 @@ uint8_t static inline SPI_GetFlagStatus (SPI_RegDef_t *p_SPIx, uint32_t flagType
  *
  * @note		- none
 */
-static void SPI_TXE_InterruptHandler (SPI_Handle_t *p_SpiHandle)
+_RAMFUNC static void SPI_TXE_InterruptHandler (SPI_Handle_t *p_SpiHandle)
 {
 	// Check the DFF bit CR1
 	if (p_SpiHandle->p_SPIx->CR1 & (1 << SPI_CR1REG_DFF))
@@ -73,7 +211,7 @@ static void SPI_TXE_InterruptHandler (SPI_Handle_t *p_SpiHandle)
 	if (!p_SpiHandle->TxLen)
 	{
 		SPI_CloseTransmission(p_SpiHandle);
-		SPI_API_EventCallback(p_SpiHandle, SPI_EVENT_TX_CMPLT);	// Raise API callback event
+		SPI_RaiseEvent(p_SpiHandle, SPI_EVENT_TX_CMPLT);			// Raise API callback event
 	}
 }
 
@@ -89,7 +227,7 @@ static void SPI_TXE_InterruptHandler (SPI_Handle_t *p_SpiHandle)
  *
  * @note		- none
 */
-static void SPI_RXNE_InterruptHandler (SPI_Handle_t *p_SpiHandle)
+_RAMFUNC static void SPI_RXNE_InterruptHandler (SPI_Handle_t *p_SpiHandle)
 {
 	// Check the DFF bit CR1
 	if (p_SpiHandle->p_SPIx->CR1 & (1 << SPI_CR1REG_DFF))
@@ -118,7 +256,7 @@ static void SPI_RXNE_InterruptHandler (SPI_Handle_t *p_SpiHandle)
 	if (!p_SpiHandle->RxLen)
 	{
 		SPI_CloseReception(p_SpiHandle);
-		SPI_API_EventCallback(p_SpiHandle, SPI_EVENT_RX_CMPLT);	// Raise API callback event
+		SPI_RaiseEvent(p_SpiHandle, SPI_EVENT_RX_CMPLT);			// Raise API callback event
 	}
 }
 
@@ -134,7 +272,7 @@ static void SPI_RXNE_InterruptHandler (SPI_Handle_t *p_SpiHandle)
  *
  * @note		- none
 */
-static void SPI_OVR_InterruptHandler (SPI_Handle_t *p_SpiHandle)
+_RAMFUNC static void SPI_OVR_InterruptHandler (SPI_Handle_t *p_SpiHandle)
 {
 	// 1. Clear the OVR flag
 	if (p_SpiHandle->TxState != SPI_ST_BUSY_TX)
@@ -143,7 +281,7 @@ static void SPI_OVR_InterruptHandler (SPI_Handle_t *p_SpiHandle)
 	}
 
 	// 2. Inform API about the hanfling success
-	SPI_API_EventCallback(p_SpiHandle, SPI_EVENT_OVR_CMPLT);	// Raise API callback event
+	SPI_RaiseEvent(p_SpiHandle, SPI_EVENT_OVR_CMPLT);			// Raise API callback event
 }
 
 
@@ -164,52 +302,7 @@ static void SPI_OVR_InterruptHandler (SPI_Handle_t *p_SpiHandle)
 */
 void SPI_PeriClockControl (SPI_RegDef_t *p_SPI, uint8_t enable)
 {
-	if (enable)
-	{
-		if (SPI1 == p_SPI)
-		{
-			SPI1_PCLK_EN();
-		}
-		else if (SPI2 == p_SPI)
-		{
-			SPI2_PCLK_EN();
-		}
-		else if (SPI3 == p_SPI)
-		{
-			SPI3_PCLK_EN();
-		}
-		else if (SPI4 == p_SPI)
-		{
-			SPI4_PCLK_EN();
-		}
-		else
-		{
-			// NOP
-		}
-	}
-	else
-	{
-		if (SPI1 == p_SPI)
-		{
-			SPI1_PCLK_DI();
-		}
-		else if (SPI2 == p_SPI)
-		{
-			SPI2_PCLK_DI();
-		}
-		else if (SPI3 == p_SPI)
-		{
-			SPI3_PCLK_DI();
-		}
-		else if (SPI4 == p_SPI)
-		{
-			SPI4_PCLK_DI();
-		}
-		else
-		{
-			// NOP
-		}
-	}
+	PERIPH_ClockControl(SpiDescriptor(p_SPI), enable);
 }
 
 /*!
@@ -227,9 +320,14 @@ void SPI_PeriClockControl (SPI_RegDef_t *p_SPI, uint8_t enable)
 void SPI_Init (SPI_Handle_t *p_SPIhandle)
 {
 	uint32_t configReg = 0;
+	uint8_t held = (uint8_t)(1u << SPI_DESC_INDEX(p_SPIhandle->p_SPIx));
 
-	// 0. Enable SPI Periphery Clock
-	SPI_PeriClockControl(p_SPIhandle->p_SPIx, ENABLE);
+	// 0. Enable SPI Periphery Clock: one reference per interface, a re-init keeps it
+	if (!(ClockHeld & held) && SpiDescriptor(p_SPIhandle->p_SPIx))
+	{
+		SPI_PeriClockControl(p_SPIhandle->p_SPIx, ENABLE);
+		ClockHeld |= held;
+	}
 
 	// 1. Configure Device Mode (Master / Slave)
 	configReg |= (p_SPIhandle->SpiConfig.deviceMode & 1) << SPI_CR1REG_MSTR;
@@ -290,34 +388,118 @@ void SPI_Init (SPI_Handle_t *p_SPIhandle)
  *
  * @return 		- none
  *
- * @note		- none
+ * @note		- Drops the clock reference taken by SPI_Init
 */
 void SPI_DeInit (SPI_RegDef_t *p_SPI)
 {
+	uint8_t held = (uint8_t)(1u << SPI_DESC_INDEX(p_SPI));
+
 	// Reset the RCC register regarding the designated SPI periphery
-	if (SPI1 == p_SPI)
-	{
-		SPI1_REG_RESET();
-	}
-	else if (SPI2 == p_SPI)
+	PERIPH_Reset(SpiDescriptor(p_SPI));
+
+	// Disable the SPI periphery clock
+	if (ClockHeld & held)
 	{
-		SPI2_REG_RESET();
+		SPI_PeriClockControl(p_SPI, DISABLE);
+		ClockHeld &= ~held;
 	}
-	else if (SPI3 == p_SPI)
+}
+
+/*!
+ * @fn			- SPI_IRQNumber
+ *
+ * @brief 		- NVIC interrupt number of the SPI interface
+ *
+ * @param[in]	- *p_SPI: base address of the SPI peripheral
+ * @param[out]	- none
+ *
+ * @return 		- IRQ number, IRQ_NO_NONE for an unknown address
+ *
+ * @note		- none
+*/
+uint8_t SPI_IRQNumber (SPI_RegDef_t *p_SPI)
+{
+	const PERIPH_Desc_t *p_Desc = SpiDescriptor(p_SPI);
+
+	return p_Desc ? p_Desc->IRQNumber : IRQ_NO_NONE;
+}
+
+/*!
+ * @fn			- SPI_SpeedFor
+ *
+ * @brief 		- Fastest baud rate prescaler which keeps SCLK at or below a limit
+ *
+ * @param[in]	- *p_SPI: base address of the SPI peripheral
+ * @param[in]	- maxSclkHz: highest SCLK the slave accepts
+ * @param[out]	- none
+ *
+ * @return 		- @SPI_SPEED, SPI_SPEED_DIV256 if even that is too fast
+ *
+ * @note		- Uses the current APB clock of the interface: call it again after a clock change
+*/
+uint8_t SPI_SpeedFor (SPI_RegDef_t *p_SPI, uint32_t maxSclkHz)
+{
+	const PERIPH_Desc_t *p_Desc = SpiDescriptor(p_SPI);
+	uint32_t pclkHz = p_Desc ? CLOCK_GetBusClock(p_Desc->p_ClkEnReg) : 0;
+	uint8_t speed = SPI_SPEED_DIV2;
+
+	while ((speed < SPI_SPEED_DIV256) && ((pclkHz >> (speed + 1)) > maxSclkHz))
 	{
-		SPI3_REG_RESET();
+		speed++;
 	}
-	else if (SPI4 == p_SPI)
+
+	return speed;
+}
+
+/*!
+ * @fn			- SPI_GetSclkHz
+ *
+ * @brief 		- Serial clock of the SPI interface as configured in CR1
+ *
+ * @param[in]	- *p_SPI: base address of the SPI peripheral
+ * @param[out]	- none
+ *
+ * @return 		- Hz, 0 for an unknown address
+ *
+ * @note		- Master mode only
+*/
+uint32_t SPI_GetSclkHz (SPI_RegDef_t *p_SPI)
+{
+	const PERIPH_Desc_t *p_Desc = SpiDescriptor(p_SPI);
+
+	if (NULL == p_Desc)
 	{
-		SPI4_REG_RESET();
+		return 0;
 	}
-	else
+
+	return CLOCK_GetBusClock(p_Desc->p_ClkEnReg) >> (((p_SPI->CR1 >> SPI_CR1REG_BR) & 0x7) + 1);
+}
+
+/*!
+ * @fn			- SPI_ClockTrack
+ *
+ * @brief 		- Keeps the SCLK of a master below a limit across clock switches
+ *
+ * @param[in]	- *p_SpiHandle: pointer to the SPI Handler, initialized
+ * @param[in]	- maxSclkHz: highest SCLK the slave accepts
+ * @param[in]	- enable: ENABLE registers the handle at the clock driver, DISABLE removes it
+ *
+ * @return 		- none
+ *
+ * @note		- The handle must stay valid while tracked. The prescaler is applied at once, then
+ * 				  recomputed after every CLOCK_Switch.
+*/
+void SPI_ClockTrack (SPI_Handle_t *p_SpiHandle, uint32_t maxSclkHz, uint8_t enable)
+{
+	if (DISABLE == enable)
 	{
-		// NOP
+		CLOCK_NotifierUnregister(&p_SpiHandle->clockNotifier);
+		return;
 	}
 
-	// Disable the SPI periphery clock
-	SPI_PeriClockControl(p_SPI, DISABLE);
+	p_SpiHandle->maxSclkHz = maxSclkHz;
+	CLOCK_NotifierRegister(&p_SpiHandle->clockNotifier, SPI_ClockNotify, p_SpiHandle);
+	SPI_ClockNotify(p_SpiHandle, CLOCK_EVENT_POST_CHANGE, NULL);
 }
 
 /*!
@@ -427,28 +609,28 @@ void SPI_ReceiveData (SPI_RegDef_t *p_SPI, uint8_t *p_RxBuffer, uint32_t len)
  * @param[out]	- *p_TxBuffer: Pointer to the Tx buffer to be written
  * @param[in]	- len: Number of Bytes to be transmitted
  *
- * @return 		- state: SPI Tx state
+ * @return 		- state: SPI_ST_READY if the transfer is started, otherwise the busy state
  *
- * @note		- This function is blocking call, polling type at Tx flag waiting
+ * @note		- Non-blocking. Safe against the ISR and against callers of other priority levels.
 */
 uint8_t SPI_SendDataIT (SPI_Handle_t *p_SpiHandle, uint8_t *p_TxBuffer, uint32_t len)
 {
-	uint8_t state = p_SpiHandle->TxState;
-
-	if (state != SPI_ST_BUSY_TX)
+	// 1. Claim the transmitter: only one caller can move it out of READY
+	if (!ATOMIC_CAS8(&p_SpiHandle->TxState, SPI_ST_READY, SPI_ST_BUSY_TX))
 	{
-		// 1. Save the Tx buffer address and the len in global variable
-		p_SpiHandle->p_TxBuffer = p_TxBuffer;
-		p_SpiHandle->TxLen = len;
+		return p_SpiHandle->TxState;
+	}
 
-		// 2. Set SPI state Busy in transmission so lock the SPI peripheral
-		p_SpiHandle->TxState = SPI_ST_BUSY_TX;
+	// 2. Save the Tx buffer address and the len, TXEIE is still off so the ISR can not see them half written
+	p_SpiHandle->p_TxBuffer = p_TxBuffer;
+	p_SpiHandle->TxLen = len;
+	ATOMIC_BARRIER();
 
-		// 3. Enable the TXEIE control bit to get interrupt whenever the TXE flag is set in SR
-		p_SpiHandle->p_SPIx->CR2 |= (1 << SPI_CR2REG_TXEIE);
-	}
+	// 3. Enable the TXEIE control bit to get interrupt whenever the TXE flag is set in SR.
+	//	  Bit-band store: the ISR clearing RXNEIE of the same register can not be lost
+	BITBAND_PERIPH(&p_SpiHandle->p_SPIx->CR2, SPI_CR2REG_TXEIE) = 1;
 
-	return state;
+	return SPI_ST_READY;
 }
 
 /*!
@@ -460,28 +642,27 @@ uint8_t SPI_SendDataIT (SPI_Handle_t *p_SpiHandle, uint8_t *p_TxBuffer, uint32_t
  * @param[out]	- *p_RxBuffer Pointer to the Rx buffer to be read
  * @param[in]	- len: Number of Bytes to be received
  *
- * @return 		- state: SPI Rx state
+ * @return 		- state: SPI_ST_READY if the reception is started, otherwise the busy state
  *
- * @note		- none
+ * @note		- Non-blocking. Safe against the ISR and against callers of other priority levels.
 */
 uint8_t SPI_ReceiveDataIT (SPI_Handle_t *p_SpiHandle, uint8_t *p_RxBuffer, uint32_t len)
 {
-	uint8_t state = p_SpiHandle->RxState;
-
-	if (state != SPI_ST_BUSY_RX)
+	// 1. Claim the receiver: only one caller can move it out of READY
+	if (!ATOMIC_CAS8(&p_SpiHandle->RxState, SPI_ST_READY, SPI_ST_BUSY_RX))
 	{
-		// 1. Save the Tx buffer address and the len in global variable
-		p_SpiHandle->p_RxBuffer = p_RxBuffer;
-		p_SpiHandle->RxLen = len;
+		return p_SpiHandle->RxState;
+	}
 
-		// 2. Set SPI state Busy in transmission so lock the SPI peripheral
-		p_SpiHandle->RxState = SPI_ST_BUSY_RX;
+	// 2. Save the Rx buffer address and the len, RXNEIE is still off so the ISR can not see them half written
+	p_SpiHandle->p_RxBuffer = p_RxBuffer;
+	p_SpiHandle->RxLen = len;
+	ATOMIC_BARRIER();
 
-		// 3. Enable the TXEIE control bit to get interrupt whenever the TXE flag is set in SR
-		p_SpiHandle->p_SPIx->CR2 |= (1 << SPI_CR2REG_RXNEIE);
-	}
+	// 3. Enable the RXNEIE control bit to get interrupt whenever the RXNE flag is set in SR (bit-band store)
+	BITBAND_PERIPH(&p_SpiHandle->p_SPIx->CR2, SPI_CR2REG_RXNEIE) = 1;
 
-	return state;
+	return SPI_ST_READY;
 }
 
 /*!
@@ -489,14 +670,14 @@ uint8_t SPI_ReceiveDataIT (SPI_Handle_t *p_SpiHandle, uint8_t *p_RxBuffer, uint3
  *
  * @brief 		- SPI Interrupt Request Handler
  *
- * @param[in]	-
+ * @param[in]	- *p_SpiHandle: pointer to the SPI Handler
  * @param[out]	- none
  *
  * @return 		- none
  *
- * @note		- none
+ * @note		- Placed in SRAM together with the event handlers: no flash wait states in the ISR
 */
-void SPI_IRQHandling (SPI_Handle_t *p_SpiHandle)
+_RAMFUNC void SPI_IRQHandling (SPI_Handle_t *p_SpiHandle)
 {
 	// 1. Check for TXE flag
 	uint8_t eventFlag = p_SpiHandle->p_SPIx->SR & SPI_FLAG_TXE;
@@ -529,6 +710,38 @@ void SPI_IRQHandling (SPI_Handle_t *p_SpiHandle)
 	 */
 }
 
+/*!
+ * @fn			- SPI_IRQBind
+ *
+ * @brief 		- Binds the handle to the IRQ of its SPI instance in the SRAM vector table
+ *
+ * @param[in]	- *p_SpiHandle: pointer to the SPI Handler
+ * @param[in]	- enable: ENABLE binds, DISABLE restores the link-time SPIx_IRQHandler
+ *
+ * @return 		- none
+ *
+ * @note		- Replaces the SPIx_IRQHandler trampolines on a global handle. NVIC enable and
+ * 				  priority stay with the application.
+*/
+void SPI_IRQBind (SPI_Handle_t *p_SpiHandle, uint8_t enable)
+{
+	uint8_t IRQNumber = SPI_IRQNumber(p_SpiHandle->p_SPIx);
+
+	if (IRQ_NO_NONE == IRQNumber)
+	{
+		return;
+	}
+
+	if (ENABLE == enable)
+	{
+		VECTOR_Register(IRQNumber, SPI_IRQDispatch, p_SpiHandle);
+	}
+	else
+	{
+		VECTOR_Unregister(IRQNumber);
+	}
+}
+
 // Other APIs
 //
 /*!
@@ -570,10 +783,11 @@ void SPI_PeripheralControl (SPI_RegDef_t *p_SPIx, uint8_t control)
 */
 void SPI_CloseTransmission (SPI_Handle_t *p_SpiHandle)
 {
-	p_SpiHandle->p_SPIx->CR2 &= ~(1 << SPI_CR2REG_TXEIE);		// Disable Tx interrupt
+	BITBAND_PERIPH(&p_SpiHandle->p_SPIx->CR2, SPI_CR2REG_TXEIE) = 0;		// Disable Tx interrupt
 	p_SpiHandle->p_TxBuffer = NULL;
 	p_SpiHandle->TxLen = 0;
-	p_SpiHandle->TxState = SPI_ST_READY;
+	ATOMIC_BARRIER();
+	p_SpiHandle->TxState = SPI_ST_READY;										// Release last
 
 }
 
@@ -591,10 +805,11 @@ void SPI_CloseTransmission (SPI_Handle_t *p_SpiHandle)
 */
 void SPI_CloseReception (SPI_Handle_t *p_SpiHandle)
 {
-	p_SpiHandle->p_SPIx->CR2 &= ~(1 << SPI_CR2REG_RXNEIE);		// Disable Rx interrupt
+	BITBAND_PERIPH(&p_SpiHandle->p_SPIx->CR2, SPI_CR2REG_RXNEIE) = 0;		// Disable Rx interrupt
 	p_SpiHandle->p_RxBuffer = NULL;
 	p_SpiHandle->RxLen = 0;
-	p_SpiHandle->RxState = SPI_ST_READY;
+	ATOMIC_BARRIER();
+	p_SpiHandle->RxState = SPI_ST_READY;										// Release last
 }
 
 /*!
@@ -626,7 +841,8 @@ void SPI_ClearOvrFlag (SPI_RegDef_t *p_Spi)
  *
  * @return 		- none
  *
- * @note		- WEAK, must override
+ * @note		- WEAK, must override. Runs from the deferred-work queue (PendSV or main loop) unless the
+ * 				  event is in the fastEvents mask of the handle or the queue is not running.
 */
 _WEAK void SPI_API_EventCallback(SPI_Handle_t *p_SpiHandle, uint8_t appEvent)
 {
@@ -0,0 +1,359 @@
+/** @file timebase.c
+*
+* @brief SysTick millisecond timebase and DWT cycle delays.
+*
+* SysTick interrupts once per millisecond and extends a 64-bit counter, which never wraps in practice.
+* Short delays and driver timeouts count DWT CYCCNT cycles instead, scaled from the HCLK frequency
+* handed over by the clock configuration, so they do not depend on the optimization level.
+*
+*/
+
+#include "timebase.h"
+#include "nvic.h"
+
+
+// === Private Variables ===
+//
+static volatile uint64_t Milliseconds;
+static uint32_t HclkHz = TIMEBASE_HCLK_RESET;
+static uint32_t CyclesPerUs = TIMEBASE_HCLK_RESET / 1000000U;
+static uint32_t SuspendedUs;				// Sub-millisecond part carried between suspended periods
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- UsToCycles
+ *
+ * @brief 		- Converts microseconds to core cycles at the current HCLK
+ *
+ * @param[in]	- us: microseconds
+ * @param[out]	- none
+ *
+ * @return 		- Cycles, saturated at TIMEBASE_MAX_CYCLES
+ *
+ * @note		- none
+*/
+static uint32_t UsToCycles (uint32_t us)
+{
+	uint64_t cycles = (uint64_t)us * CyclesPerUs;
+
+	return (cycles > TIMEBASE_MAX_CYCLES) ? TIMEBASE_MAX_CYCLES : (uint32_t)cycles;
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- TIMEBASE_Init
+ *
+ * @brief 		- Starts the cycle counter and the 1 ms SysTick
+ *
+ * @param[in]	- hclkHz: core clock, TIMEBASE_HCLK_RESET after reset
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- SysTick gets the top level of the priority plan: its handler is a single increment,
+ * 				  and a masked tick would make the millisecond count late
+*/
+void TIMEBASE_Init (uint32_t hclkHz)
+{
+	DWT_CYCCNT_EN();
+
+	Milliseconds = 0;
+	SuspendedUs = 0;
+	NVIC_SetSystemPriority(NVIC_EXC_SYSTICK, NVIC_PLAN_PREEMPT_CRITICAL, 0);
+	TIMEBASE_SetClock(hclkHz);
+}
+
+/*!
+ * @fn			- TIMEBASE_SetClock
+ *
+ * @brief 		- Rescales SysTick and the cycle helpers to a new HCLK
+ *
+ * @param[in]	- hclkHz: core clock
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Call it after every clock change. The running tick restarts, so at most one
+ * 				  millisecond is stretched.
+*/
+void TIMEBASE_SetClock (uint32_t hclkHz)
+{
+	uint32_t reload = (hclkHz / TIMEBASE_TICK_HZ) - 1;
+
+	if ((0 == hclkHz) || (reload > SYSTICK_LOAD_MAX))
+	{
+		return;
+	}
+
+	HclkHz = hclkHz;
+	CyclesPerUs = (hclkHz < 1000000U) ? 1 : (hclkHz / 1000000U);		// Below 1 MHz one cycle per us: delays stretch, never return early
+
+	SYSTICK->CTRL = 0;
+	SYSTICK->LOAD = reload;
+	SYSTICK->VAL = 0;
+	SYSTICK->CTRL = (1 << SYSTICK_CTRLREG_CLKSOURCE) | (1 << SYSTICK_CTRLREG_TICKINT) | (1 << SYSTICK_CTRLREG_ENABLE);
+}
+
+/*!
+ * @fn			- TIMEBASE_GetClock
+ *
+ * @brief 		- HCLK used by the timebase
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Hz
+ *
+ * @note		- none
+*/
+uint32_t TIMEBASE_GetClock (void)
+{
+	return HclkHz;
+}
+
+/*!
+ * @fn			- TIMEBASE_GetMs
+ *
+ * @brief 		- Milliseconds since TIMEBASE_Init
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Milliseconds
+ *
+ * @note		- The two words are read until a tick does not split them
+*/
+uint64_t TIMEBASE_GetMs (void)
+{
+	uint64_t first, second;
+
+	do
+	{
+		first = Milliseconds;
+		second = Milliseconds;
+	} while (first != second);
+
+	return first;
+}
+
+/*!
+ * @fn			- TIMEBASE_GetMs32
+ *
+ * @brief 		- Low word of the millisecond counter
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- Milliseconds, wraps after ~49 days
+ *
+ * @note		- Single load, usable as DEBOUNCE_GetTick_t
+*/
+uint32_t TIMEBASE_GetMs32 (void)
+{
+	return (uint32_t)Milliseconds;
+}
+
+/*!
+ * @fn			- TIMEBASE_DelayMs
+ *
+ * @brief 		- Blocking delay on the SysTick count
+ *
+ * @param[in]	- ms: milliseconds
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Lasts at least ms (the current, partial tick is not counted).
+ * 				  Prefer an event loop timer where blocking is not acceptable.
+*/
+void TIMEBASE_DelayMs (uint32_t ms)
+{
+	uint32_t start = TIMEBASE_GetMs32();
+
+	while ((TIMEBASE_GetMs32() - start) <= ms);
+}
+
+/*!
+ * @fn			- TIMEBASE_DelayUs
+ *
+ * @brief 		- Blocking delay on the cycle counter
+ *
+ * @param[in]	- us: microseconds
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Longer delays are split into TIMEBASE_MAX_CYCLES chunks
+*/
+void TIMEBASE_DelayUs (uint32_t us)
+{
+	uint64_t cycles = (uint64_t)us * CyclesPerUs;
+
+	while (cycles > TIMEBASE_MAX_CYCLES)
+	{
+		TIMEBASE_DelayCycles(TIMEBASE_MAX_CYCLES);
+		cycles -= TIMEBASE_MAX_CYCLES;
+	}
+	TIMEBASE_DelayCycles((uint32_t)cycles);
+}
+
+/*!
+ * @fn			- TIMEBASE_DelayCycles
+ *
+ * @brief 		- Blocking delay of core cycles
+ *
+ * @param[in]	- cycles: up to TIMEBASE_MAX_CYCLES
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Interrupts extend the delay, they do not shorten it
+*/
+void TIMEBASE_DelayCycles (uint32_t cycles)
+{
+	uint32_t start = DWT_CYCCNT();
+
+	while ((DWT_CYCCNT() - start) < cycles);
+}
+
+/*!
+ * @fn			- TIMEBASE_TimeoutStart
+ *
+ * @brief 		- Starts a timeout
+ *
+ * @param[out]	- *p_Timeout: timeout, owned by the caller
+ * @param[in]	- us: microseconds, saturated at TIMEBASE_MAX_CYCLES
+ *
+ * @return 		- none
+ *
+ * @note		- Meant for bounded register polls in drivers (11 s at 180 MHz)
+*/
+void TIMEBASE_TimeoutStart (TIMEBASE_Timeout_t *p_Timeout, uint32_t us)
+{
+	p_Timeout->start = DWT_CYCCNT();
+	p_Timeout->span = UsToCycles(us);
+}
+
+/*!
+ * @fn			- TIMEBASE_TimeoutExpired
+ *
+ * @brief 		- Checks a timeout
+ *
+ * @param[in]	- *p_Timeout: started timeout
+ * @param[out]	- none
+ *
+ * @return 		- SET if expired
+ *
+ * @note		- none
+*/
+uint8_t TIMEBASE_TimeoutExpired (const TIMEBASE_Timeout_t *p_Timeout)
+{
+	return ((DWT_CYCCNT() - p_Timeout->start) >= p_Timeout->span) ? SET : RESET;
+}
+
+/*!
+ * @fn			- TIMEBASE_WaitBits
+ *
+ * @brief 		- Polls a register until the masked bits read the expected value
+ *
+ * @param[in]	- *p_Reg: register
+ * @param[in]	- mask: bits to check
+ * @param[in]	- value: expected value of the masked bits
+ * @param[in]	- timeoutUs: upper bound of the wait
+ *
+ * @return 		- SET: reached, RESET: timed out
+ *
+ * @note		- The register is checked once more after the expiry, so a preempted caller does not
+ * 				  report a timeout for a condition that became true meanwhile
+*/
+uint8_t TIMEBASE_WaitBits (volatile uint32_t *p_Reg, uint32_t mask, uint32_t value, uint32_t timeoutUs)
+{
+	TIMEBASE_Timeout_t timeout;
+
+	TIMEBASE_TimeoutStart(&timeout, timeoutUs);
+
+	while ((*p_Reg & mask) != value)
+	{
+		if (TIMEBASE_TimeoutExpired(&timeout))
+		{
+			return ((*p_Reg & mask) == value) ? SET : RESET;
+		}
+	}
+
+	return SET;
+}
+
+/*!
+ * @fn			- TIMEBASE_SuspendTick
+ *
+ * @brief 		- Stops the SysTick interrupt for a tickless sleep
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- SET if the tick was running and has been suspended
+ *
+ * @note		- Call it with interrupts masked, right before WFI. The elapsed part of the current
+ * 				  tick is kept and added back by TIMEBASE_ResumeTick. A tick that expired just before
+ * 				  stays pending and is counted by the handler once the interrupts are unmasked.
+*/
+uint8_t TIMEBASE_SuspendTick (void)
+{
+	if (!(SYSTICK->CTRL & (1 << SYSTICK_CTRLREG_ENABLE)))
+	{
+		return RESET;
+	}
+
+	SYSTICK->CTRL &= ~(1 << SYSTICK_CTRLREG_ENABLE);
+	SuspendedUs += (uint32_t)(((uint64_t)(SYSTICK->LOAD - SYSTICK->VAL) * 1000000U) / HclkHz);
+
+	return SET;
+}
+
+/*!
+ * @fn			- TIMEBASE_ResumeTick
+ *
+ * @brief 		- Accounts the sleep measured by another timer and restarts SysTick
+ *
+ * @param[in]	- sleptUs: time spent with the tick suspended
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Only after a successful TIMEBASE_SuspendTick, still with interrupts masked
+*/
+void TIMEBASE_ResumeTick (uint32_t sleptUs)
+{
+	SuspendedUs += sleptUs;
+	Milliseconds += SuspendedUs / 1000U;
+	SuspendedUs %= 1000U;
+
+	SYSTICK->VAL = 0;
+	SYSTICK->CTRL |= (1 << SYSTICK_CTRLREG_ENABLE);
+}
+
+
+// === Exception Handler ===
+//
+/*!
+ * @fn			- SysTick_Handler
+ *
+ * @brief 		- Millisecond tick
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void SysTick_Handler (void)
+{
+	Milliseconds++;
+}
+
+/*** EOF ***/
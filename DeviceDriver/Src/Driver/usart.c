@@ -0,0 +1,939 @@
+/** @file usart.c
+*
+* @brief USART driver: circular DMA reception with idle-line detection, DMA transmission.
+*
+* The receiver never interrupts per byte: the RX stream writes a circular ring, and the interrupts of
+* the idle line, the half ring and the full ring only move the write count forward. A packet of any
+* length is therefore announced by the IDLE interrupt after its last byte, and a long stream by one
+* interrupt per half ring. The transmitter hands the whole buffer to the TX stream and the USART TC
+* interrupt reports the end of the last stop bit. BRR is computed from the live APB clock of the
+* interface, and tracked handles are re-timed after a clock switch.
+*
+*/
+
+#include <stddef.h>
+#include "usart.h"
+#include "vector.h"
+#include "atomic.h"
+#include "defer.h"
+#include "timebase.h"
+
+
+// === Type Definitions ===
+//
+typedef struct USART_Map
+{
+	PERIPH_Desc_t Desc;
+	DMA_Route_t rxRoutes[2];		// In order of preference, see DMA_Allocate
+	DMA_Route_t txRoutes[2];
+} USART_Map_t;
+
+
+// === Private Variables ===
+//
+/*
+ * USART descriptor and DMA request mapping (RM0390 tables 28 and 29)
+ * 	USART6 RX prefers DMA2 stream 1 because stream 2 is the first USART1 RX stream
+ */
+static const USART_Map_t UsartMap[] =
+{
+	{ PERIPH_DESC(USART1_BASE, APB2ENR, APB2RSTR,  4, IRQ_NO_USART1, 1),
+	  { DMA_ROUTE(DMA2, 2, 4), DMA_ROUTE(DMA2, 5, 4) }, { DMA_ROUTE(DMA2, 7, 4), DMA_ROUTE_NONE } },
+	{ PERIPH_DESC(USART2_BASE, APB1ENR, APB1RSTR, 17, IRQ_NO_USART2, 2),
+	  { DMA_ROUTE(DMA1, 5, 4), DMA_ROUTE_NONE }, { DMA_ROUTE(DMA1, 6, 4), DMA_ROUTE_NONE } },
+	{ PERIPH_DESC(USART3_BASE, APB1ENR, APB1RSTR, 18, IRQ_NO_USART3, 3),
+	  { DMA_ROUTE(DMA1, 1, 4), DMA_ROUTE_NONE }, { DMA_ROUTE(DMA1, 3, 4), DMA_ROUTE(DMA1, 4, 7) } },
+	{ PERIPH_DESC(UART4_BASE,  APB1ENR, APB1RSTR, 19, IRQ_NO_UART4,  4),
+	  { DMA_ROUTE(DMA1, 2, 4), DMA_ROUTE_NONE }, { DMA_ROUTE(DMA1, 4, 4), DMA_ROUTE_NONE } },
+	{ PERIPH_DESC(UART5_BASE,  APB1ENR, APB1RSTR, 20, IRQ_NO_UART5,  5),
+	  { DMA_ROUTE(DMA1, 0, 4), DMA_ROUTE_NONE }, { DMA_ROUTE(DMA1, 7, 4), DMA_ROUTE_NONE } },
+	{ PERIPH_DESC(USART6_BASE, APB2ENR, APB2RSTR,  5, IRQ_NO_USART6, 6),
+	  { DMA_ROUTE(DMA2, 1, 5), DMA_ROUTE(DMA2, 2, 5) }, { DMA_ROUTE(DMA2, 6, 5), DMA_ROUTE(DMA2, 7, 5) } },
+};
+
+static uint8_t ClockHeld;				// UsartMap index bits: USART_Init holds the clock reference of the interface
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- UsartMapping
+ *
+ * @brief 		- Looks up the descriptor and DMA mapping of the USART interface
+ *
+ * @param[in]	- *p_USART: base address of the USART peripheral
+ * @param[out]	- none
+ *
+ * @return 		- Mapping, NULL if the address is not a USART interface
+ *
+ * @note		- The base addresses are scattered over both APB buses: linear search over six entries
+*/
+static const USART_Map_t *UsartMapping (USART_RegDef_t *p_USART)
+{
+	for (uint8_t i = 0; i < (sizeof(UsartMap) / sizeof(*UsartMap)); ++i)
+	{
+		if (UsartMap[i].Desc.baseAddr == (uint32_t)p_USART)
+		{
+			return &UsartMap[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*!
+ * @fn			- UsartBaudReg
+ *
+ * @brief 		- Computes BRR and the oversampling mode for a baud rate
+ *
+ * @param[in]	- pclkHz: APB clock of the interface
+ * @param[in]	- baudRate: bits per second
+ * @param[out]	- *p_Brr: BRR word
+ * @param[out]	- *p_Over8: SET if oversampling by 8 is needed
+ *
+ * @return 		- @USART_STATUS
+ *
+ * @note		- Oversampling by 16 tolerates more clock deviation and is kept up to PCLK / 16.
+ * 				  The divider is rounded to the nearest 1/16 (1/8) step: with OVER8 the fraction has
+ * 				  three bits and the mantissa moves one bit up.
+*/
+static uint8_t UsartBaudReg (uint32_t pclkHz, uint32_t baudRate, uint32_t *p_Brr, uint8_t *p_Over8)
+{
+	uint32_t div;
+
+	if ((0 == baudRate) || ((pclkHz / 8) < baudRate))
+	{
+		return USART_ERR_BAUD;
+	}
+
+	*p_Over8 = ((pclkHz / 16) < baudRate) ? SET : RESET;
+	div = (pclkHz + (baudRate / 2)) / baudRate;			// USARTDIV * 16 (OVER16) or * 8 (OVER8)
+
+	if (div > 0xFFFF)
+	{
+		return USART_ERR_BAUD;
+	}
+
+	*p_Brr = *p_Over8 ? (((div & ~0x7U) << 1) | (div & 0x7)) : div;
+
+	return USART_OK;
+}
+
+/*!
+ * @fn			- UsartSetBaud
+ *
+ * @brief 		- Programs OVER8 and BRR for the configured baud rate at the current bus clock
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[out]	- none
+ *
+ * @return 		- @USART_STATUS
+ *
+ * @note		- OVER8 can only change with UE cleared, so the interface is disabled around the
+ * 				  update and restored. A frame on the line at that moment is cut.
+*/
+static uint8_t UsartSetBaud (USART_Handle_t *p_UsartHandle)
+{
+	USART_RegDef_t *p_USARTx = p_UsartHandle->p_USARTx;
+	const USART_Map_t *p_Map = UsartMapping(p_USARTx);
+	uint32_t configReg = p_USARTx->CR1;
+	uint32_t brr;
+	uint8_t over8;
+	uint8_t status;
+
+	if (NULL == p_Map)
+	{
+		return USART_ERR_PARAM;
+	}
+
+	status = UsartBaudReg(CLOCK_GetBusClock(p_Map->Desc.p_ClkEnReg), p_UsartHandle->UsartConfig.baudRate, &brr, &over8);
+	if (USART_OK != status)
+	{
+		return status;
+	}
+
+	p_USARTx->CR1 = configReg & ~(1 << USART_CR1REG_UE);
+	p_USARTx->BRR = brr;
+	configReg &= ~(1 << USART_CR1REG_OVER8);
+	configReg |= (uint32_t)over8 << USART_CR1REG_OVER8;
+	p_USARTx->CR1 = configReg;
+
+	return USART_OK;
+}
+
+/*!
+ * @fn			- USART_ClockNotify
+ *
+ * @brief 		- Clock switch notification of a tracked USART handle
+ *
+ * @param[in]	- *p_Context: pointer to the USART Handler
+ * @param[in]	- event: @CLOCK_EVENT
+ * @param[in]	- *p_Freq: unused, the bus clock is looked up through the descriptor
+ *
+ * @return 		- none
+ *
+ * @note		- Before the switch new transmissions are held and the running one is given
+ * 				  USART_RETIME_TIMEOUT_US to leave the shift register; after it a txDone owner is called to
+ * 				  restart its queue. The RX stream keeps running: bytes arriving during the switch itself
+ * 				  are sampled with the old divider and usually show up as framing errors.
+*/
+static void USART_ClockNotify (void *p_Context, uint8_t event, const CLOCK_Freq_t *p_Freq)
+{
+	USART_Handle_t *p_UsartHandle = (USART_Handle_t *)p_Context;
+	(void)p_Freq;
+
+	if (CLOCK_EVENT_PRE_CHANGE == event)
+	{
+		TIMEBASE_Timeout_t timeout;
+
+		p_UsartHandle->TxHold = SET;
+		TIMEBASE_TimeoutStart(&timeout, USART_RETIME_TIMEOUT_US);
+		while (((USART_ST_READY != p_UsartHandle->TxState) || !(p_UsartHandle->p_USARTx->SR & USART_FLAG_TC)) &&
+				!TIMEBASE_TimeoutExpired(&timeout));
+		return;
+	}
+
+	// Out of reach at the new clock: the old divider stays, the rate is off until a faster profile
+	(void)UsartSetBaud(p_UsartHandle);
+
+	p_UsartHandle->TxHold = RESET;
+	if (NULL != p_UsartHandle->txDone)
+	{
+		p_UsartHandle->txDone(p_UsartHandle->p_TxDoneContext);
+	}
+}
+
+/*!
+ * @fn			- USART_IRQDispatch
+ *
+ * @brief 		- Vector table entry of the USART interrupt of a bound handle
+ *
+ * @param[in]	- *p_Context: pointer to the USART Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+_RAMFUNC static void USART_IRQDispatch (void *p_Context)
+{
+	USART_IRQHandling((USART_Handle_t *)p_Context);
+}
+
+/*!
+ * @fn			- USART_DeferredEvent
+ *
+ * @brief 		- Runs the application callback of a deferred event outside interrupt context
+ *
+ * @param[in]	- *p_Context: pointer to the USART Handler
+ * @param[in]	- arg: @USART_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void USART_DeferredEvent (void *p_Context, uint32_t arg)
+{
+	USART_API_EventCallback((USART_Handle_t *)p_Context, (uint8_t)arg);
+}
+
+/*!
+ * @fn			- USART_RaiseEvent
+ *
+ * @brief 		- Raises an application event from the ISR
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[in]	- appEvent: @USART_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- Events of the fastEvents mask run in the ISR. The others are posted to the deferred-work
+ * 				  queue; if it is not running or full, the callback runs in the ISR so no event is lost.
+*/
+_RAMFUNC static void USART_RaiseEvent (USART_Handle_t *p_UsartHandle, uint8_t appEvent)
+{
+	if ((p_UsartHandle->fastEvents & USART_EVENT_MASK(appEvent)) ||
+		!DEFER_Post(USART_DeferredEvent, p_UsartHandle, appEvent))
+	{
+		USART_API_EventCallback(p_UsartHandle, appEvent);
+	}
+}
+
+/*!
+ * @fn			- USART_RxUpdate
+ *
+ * @brief 		- Moves the write count of the ring up to the current DMA position
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Called by the USART and the RX stream interrupts, which must share one preemption
+ * 				  level. The half and full ring interrupts guarantee an update per half ring, so the
+ * 				  position can not wrap unnoticed between two updates.
+*/
+_RAMFUNC static void USART_RxUpdate (USART_Handle_t *p_UsartHandle)
+{
+	DMA_Stream_RegDef_t *p_Stream = DMA_STREAM(p_UsartHandle->RxDma.p_DMAx, p_UsartHandle->RxDma.stream);
+	uint16_t mask = p_UsartHandle->RxSize - 1;
+	uint16_t pos = (p_UsartHandle->RxSize - (uint16_t)p_Stream->NDTR) & mask;	// NDTR reads 0 for a moment before the reload
+	uint16_t received = (pos - p_UsartHandle->RxPos) & mask;
+
+	if (0 == received)
+	{
+		return;
+	}
+
+	p_UsartHandle->RxPos = pos;
+	p_UsartHandle->RxWritten += received;
+
+	if ((p_UsartHandle->RxWritten - p_UsartHandle->RxRead) > p_UsartHandle->RxSize)
+	{
+		USART_RaiseEvent(p_UsartHandle, USART_EVENT_RX_OVERRUN);
+	}
+	USART_RaiseEvent(p_UsartHandle, USART_EVENT_RX_DATA);
+}
+
+/*!
+ * @fn			- USART_RxDmaEvent
+ *
+ * @brief 		- RX stream callback: half ring, full ring and transfer error
+ *
+ * @param[in]	- *p_Context: pointer to the USART Handler
+ * @param[in]	- event: @DMA_EVENT
+ *
+ * @return 		- none
+ *
+ * @note		- A transfer error disables the stream: reception stays stopped until USART_RxStart
+*/
+_RAMFUNC static void USART_RxDmaEvent (void *p_Context, uint8_t event)
+{
+	USART_Handle_t *p_UsartHandle = (USART_Handle_t *)p_Context;
+
+	p_UsartHandle->IrqCount++;
+
+	USART_RxUpdate(p_UsartHandle);
+
+	if (DMA_EVENT_ERROR == event)
+	{
+		p_UsartHandle->ErrorFlags |= USART_ERROR_DMA;
+		USART_RaiseEvent(p_UsartHandle, USART_EVENT_ERROR);
+	}
+}
+
+/*!
+ * @fn			- USART_CloseTransmission
+ *
+ * @brief 		- Releases the transmitter after the last stop bit
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+_RAMFUNC static void USART_CloseTransmission (USART_Handle_t *p_UsartHandle)
+{
+	BITBAND_PERIPH(&p_UsartHandle->p_USARTx->CR1, USART_CR1REG_TCIE) = 0;		// Disable TC interrupt
+	ATOMIC_BARRIER();
+	p_UsartHandle->TxState = USART_ST_READY;									// Release last
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- USART_PeriClockControl
+ *
+ * @brief 		- Enables or disables the peripheral clock for the given USART interface
+ *
+ * @param[in]	- *p_USART: base address of the USART peripheral
+ * @param[in]	- enable: ENABLE or DISABLE macros
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void USART_PeriClockControl (USART_RegDef_t *p_USART, uint8_t enable)
+{
+	const USART_Map_t *p_Map = UsartMapping(p_USART);
+
+	PERIPH_ClockControl(p_Map ? &p_Map->Desc : NULL, enable);
+}
+
+/*!
+ * @fn			- USART_Init
+ *
+ * @brief 		- Initialization of the USART interface and of its DMA streams
+ *
+ * @param[in]	- *p_UsartHandle: USART base address + configuration settings
+ * @param[out]	- none
+ *
+ * @return 		- @USART_STATUS
+ *
+ * @note		- The interface is enabled, DMA requests on. Reception starts with USART_RxStart.
+*/
+uint8_t USART_Init (USART_Handle_t *p_UsartHandle)
+{
+	USART_RegDef_t *p_USARTx = p_UsartHandle->p_USARTx;
+	const USART_Map_t *p_Map = UsartMapping(p_USARTx);
+	USART_Config_t *p_Config = &p_UsartHandle->UsartConfig;
+	uint32_t configReg = 0;
+	uint8_t status;
+
+	if (NULL == p_Map)
+	{
+		return USART_ERR_PARAM;
+	}
+
+	// 0. Enable USART Periphery Clock: one reference per interface, a re-init keeps it
+	if (!(ClockHeld & (1u << (p_Map - UsartMap))))
+	{
+		USART_PeriClockControl(p_USARTx, ENABLE);
+		ClockHeld |= (uint8_t)(1u << (p_Map - UsartMap));
+	}
+	p_USARTx->CR1 = 0;
+
+	// 1. Directions
+	if (p_Config->mode & USART_MODE_TX)
+	{
+		configReg |= (1 << USART_CR1REG_TE);
+	}
+	if (p_Config->mode & USART_MODE_RX)
+	{
+		configReg |= (1 << USART_CR1REG_RE);
+	}
+
+	// 2. Word length and parity
+	configReg |= (p_Config->wordLength & 1) << USART_CR1REG_M;
+	if (USART_PARITY_NONE != p_Config->parity)
+	{
+		configReg |= (1 << USART_CR1REG_PCE);
+		configReg |= ((USART_PARITY_ODD == p_Config->parity) ? 1 : 0) << USART_CR1REG_PS;
+	}
+
+	// === Save config in USART CR1 register, UE still off ===
+	p_USARTx->CR1 = configReg;
+
+	// 3. Stop bits
+	p_USARTx->CR2 = (p_Config->stopBits & 0x3) << USART_CR2REG_STOP;
+
+	// 4. DMA requests, and error interrupts of the DMA reception
+	p_USARTx->CR3 = (1 << USART_CR3REG_DMAR) | (1 << USART_CR3REG_DMAT) | (1 << USART_CR3REG_EIE);
+
+	// 5. Baud rate from the current bus clock
+	status = UsartSetBaud(p_UsartHandle);
+	if (USART_OK != status)
+	{
+		return status;
+	}
+
+	// 6. DMA streams: the first free route of the request mapping, direct mode. The streams of a
+	// previous init are given back first, the copy below would otherwise lose the TX one.
+	DMA_Release(&p_UsartHandle->RxDma);
+	DMA_Release(&p_UsartHandle->TxDma);
+
+	p_UsartHandle->RxDma.DmaConfig 				= (DMA_Config_t){ 0 };
+	p_UsartHandle->RxDma.DmaConfig.direction 	= DMA_DIR_P2M;
+	p_UsartHandle->RxDma.DmaConfig.periphInc 	= DISABLE;
+	p_UsartHandle->RxDma.DmaConfig.memInc 		= ENABLE;
+	p_UsartHandle->RxDma.DmaConfig.periphSize 	= DMA_SIZE_BYTE;
+	p_UsartHandle->RxDma.DmaConfig.memSize 		= DMA_SIZE_BYTE;
+	p_UsartHandle->RxDma.DmaConfig.circular 	= ENABLE;
+	p_UsartHandle->RxDma.DmaConfig.priority 	= DMA_PRIORITY_HIGH;		// An RX request must never wait a byte time
+	p_UsartHandle->RxDma.callback 				= USART_RxDmaEvent;
+	p_UsartHandle->RxDma.p_Context 				= p_UsartHandle;
+
+	p_UsartHandle->TxDma = p_UsartHandle->RxDma;
+	p_UsartHandle->TxDma.DmaConfig.direction 	= DMA_DIR_M2P;
+	p_UsartHandle->TxDma.DmaConfig.circular 	= DISABLE;
+	p_UsartHandle->TxDma.DmaConfig.priority 	= DMA_PRIORITY_MEDIUM;
+	p_UsartHandle->TxDma.callback 				= NULL;
+
+	if (p_Config->mode & USART_MODE_RX)
+	{
+		if ((DMA_OK != DMA_Allocate(&p_UsartHandle->RxDma, p_Map->rxRoutes, 2)) || (DMA_OK != DMA_Init(&p_UsartHandle->RxDma)))
+		{
+			DMA_Release(&p_UsartHandle->RxDma);
+			return USART_ERR_DMA;
+		}
+	}
+	if (p_Config->mode & USART_MODE_TX)
+	{
+		if ((DMA_OK != DMA_Allocate(&p_UsartHandle->TxDma, p_Map->txRoutes, 2)) || (DMA_OK != DMA_Init(&p_UsartHandle->TxDma)))
+		{
+			DMA_Release(&p_UsartHandle->TxDma);
+			DMA_Release(&p_UsartHandle->RxDma);
+			return USART_ERR_DMA;
+		}
+	}
+
+	// 7. Software state
+	p_UsartHandle->p_RxBuffer = NULL;
+	p_UsartHandle->RxSize = 0;
+	p_UsartHandle->TxState = USART_ST_READY;
+	p_UsartHandle->TxHold = RESET;
+	p_UsartHandle->ErrorFlags = 0;
+	p_UsartHandle->IrqCount = 0;
+
+	// 8. Enable the interface
+	p_USARTx->CR1 |= (1 << USART_CR1REG_UE);
+
+	return USART_OK;
+}
+
+/*!
+ * @fn			- USART_DeInit
+ *
+ * @brief 		- Stops the DMA streams and resets the USART registers
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The DMA streams and the clock reference taken by USART_Init are released as well
+*/
+void USART_DeInit (USART_Handle_t *p_UsartHandle)
+{
+	const USART_Map_t *p_Map = UsartMapping(p_UsartHandle->p_USARTx);
+
+	if (NULL == p_Map)
+	{
+		return;
+	}
+
+	USART_ClockTrack(p_UsartHandle, DISABLE);
+
+	if (p_UsartHandle->UsartConfig.mode & USART_MODE_RX)
+	{
+		DMA_Release(&p_UsartHandle->RxDma);
+	}
+	if (p_UsartHandle->UsartConfig.mode & USART_MODE_TX)
+	{
+		DMA_Release(&p_UsartHandle->TxDma);
+	}
+
+	// Reset the RCC register regarding the designated USART periphery
+	PERIPH_Reset(&p_Map->Desc);
+
+	// Disable the USART periphery clock
+	if (ClockHeld & (1u << (p_Map - UsartMap)))
+	{
+		USART_PeriClockControl(p_UsartHandle->p_USARTx, DISABLE);
+		ClockHeld &= (uint8_t)~(1u << (p_Map - UsartMap));
+	}
+}
+
+/*!
+ * @fn			- USART_IRQNumber
+ *
+ * @brief 		- NVIC interrupt number of the USART interface
+ *
+ * @param[in]	- *p_USART: base address of the USART peripheral
+ * @param[out]	- none
+ *
+ * @return 		- IRQ number, IRQ_NO_NONE for an unknown address
+ *
+ * @note		- none
+*/
+uint8_t USART_IRQNumber (USART_RegDef_t *p_USART)
+{
+	const USART_Map_t *p_Map = UsartMapping(p_USART);
+
+	return p_Map ? p_Map->Desc.IRQNumber : IRQ_NO_NONE;
+}
+
+/*!
+ * @fn			- USART_RxDmaIRQNumber
+ *
+ * @brief 		- NVIC interrupt number of the RX stream allocated to the USART interface
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler, after USART_Init
+ * @param[out]	- none
+ *
+ * @return 		- IRQ number, IRQ_NO_NONE without reception
+ *
+ * @note		- Give it the preemption level of USART_IRQNumber. The stream depends on the routes
+ * 				  left free by the other DMA users at USART_Init time.
+*/
+uint8_t USART_RxDmaIRQNumber (USART_Handle_t *p_UsartHandle)
+{
+	if (!(p_UsartHandle->UsartConfig.mode & USART_MODE_RX))
+	{
+		return IRQ_NO_NONE;
+	}
+
+	return DMA_IRQNumber(p_UsartHandle->RxDma.p_DMAx, p_UsartHandle->RxDma.stream);
+}
+
+/*!
+ * @fn			- USART_GetBaudRate
+ *
+ * @brief 		- Baud rate of the USART interface as programmed in BRR
+ *
+ * @param[in]	- *p_USART: base address of the USART peripheral
+ * @param[out]	- none
+ *
+ * @return 		- Bits per second, 0 for an unknown address or an empty BRR
+ *
+ * @note		- Shows the rounding error against the requested rate
+*/
+uint32_t USART_GetBaudRate (USART_RegDef_t *p_USART)
+{
+	const USART_Map_t *p_Map = UsartMapping(p_USART);
+	uint32_t brr = p_USART->BRR & 0xFFFF;
+	uint32_t div;
+
+	if (NULL == p_Map)
+	{
+		return 0;
+	}
+
+	div = (p_USART->CR1 & (1 << USART_CR1REG_OVER8)) ? (((brr & ~0xFU) >> 1) | (brr & 0x7)) : brr;
+
+	return div ? (CLOCK_GetBusClock(p_Map->Desc.p_ClkEnReg) / div) : 0;
+}
+
+/*!
+ * @fn			- USART_ClockTrack
+ *
+ * @brief 		- Keeps the configured baud rate across clock switches
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler, initialized
+ * @param[in]	- enable: ENABLE registers the handle at the clock driver, DISABLE removes it
+ *
+ * @return 		- none
+ *
+ * @note		- The handle must stay valid while tracked
+*/
+void USART_ClockTrack (USART_Handle_t *p_UsartHandle, uint8_t enable)
+{
+	if (DISABLE == enable)
+	{
+		CLOCK_NotifierUnregister(&p_UsartHandle->clockNotifier);
+		return;
+	}
+
+	CLOCK_NotifierRegister(&p_UsartHandle->clockNotifier, USART_ClockNotify, p_UsartHandle);
+}
+
+/*!
+ * @fn			- USART_SendData
+ *
+ * @brief 		- Sending data on Tx
+ *
+ * @param[in]	- *p_USART: base address of the USART peripheral
+ * @param[in]	- *p_TxBuffer: Pointer to the Tx buffer to be written
+ * @param[in]	- len: Number of Bytes to be transmitted
+ *
+ * @return 		- none
+ *
+ * @note		- This function is blocking call, polling type at TXE and, at the end, at TC.
+ * 				  Do not mix it with a running USART_SendDataDMA.
+*/
+void USART_SendData (USART_RegDef_t *p_USART, const uint8_t *p_TxBuffer, uint32_t len)
+{
+	while (len --> 0)
+	{
+		while (!(p_USART->SR & USART_FLAG_TXE));
+		p_USART->DR = *p_TxBuffer++;
+	}
+
+	while (!(p_USART->SR & USART_FLAG_TC));
+}
+
+/*!
+ * @fn			- USART_SendDataDMA
+ *
+ * @brief 		- Sending data on Tx via the TX stream
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[in]	- *p_TxBuffer: Pointer to the Tx buffer, untouched until USART_EVENT_TX_CMPLT
+ * @param[in]	- len: Number of Bytes to be transmitted
+ *
+ * @return 		- state: USART_ST_READY if the transfer is started, otherwise the busy state
+ *
+ * @note		- Non-blocking. Safe against the ISR and against callers of other priority levels.
+ * 				  USART_EVENT_TX_CMPLT (or the txDone owner) follows once the last stop bit is on the line.
+*/
+uint8_t USART_SendDataDMA (USART_Handle_t *p_UsartHandle, const uint8_t *p_TxBuffer, uint16_t len)
+{
+	USART_RegDef_t *p_USARTx = p_UsartHandle->p_USARTx;
+
+	if (0 == len)
+	{
+		return USART_ST_READY;
+	}
+
+	// 0. A clock switch is moving the baud rate
+	if (p_UsartHandle->TxHold)
+	{
+		return USART_ST_HELD;
+	}
+
+	// 1. Claim the transmitter: only one caller can move it out of READY
+	if (!ATOMIC_CAS8(&p_UsartHandle->TxState, USART_ST_READY, USART_ST_BUSY_TX))
+	{
+		return p_UsartHandle->TxState;
+	}
+
+	// 2. Clear TC (write 0, the other rc_w0 bits ignore the 1s) and hand the buffer to the stream
+	p_USARTx->SR = ~USART_FLAG_TC;
+	DMA_Start(&p_UsartHandle->TxDma, (uint32_t)&p_USARTx->DR, (uint32_t)p_TxBuffer, len);
+
+	// 3. Enable the TCIE control bit, the ISR releases the transmitter (bit-band store)
+	BITBAND_PERIPH(&p_USARTx->CR1, USART_CR1REG_TCIE) = 1;
+
+	return USART_ST_READY;
+}
+
+/*!
+ * @fn			- USART_RxStart
+ *
+ * @brief 		- Starts the circular DMA reception into a ring
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[in]	- *p_RxBuffer: ring, owned by the driver until USART_RxStop
+ * @param[in]	- size: ring size, power of two
+ *
+ * @return 		- @USART_STATUS
+ *
+ * @note		- Size the ring for at least two interrupt latencies of data: the half ring
+ * 				  interrupt must be served before the DMA reaches the unread half
+*/
+uint8_t USART_RxStart (USART_Handle_t *p_UsartHandle, uint8_t *p_RxBuffer, uint16_t size)
+{
+	USART_RegDef_t *p_USARTx = p_UsartHandle->p_USARTx;
+
+	if (!(p_UsartHandle->UsartConfig.mode & USART_MODE_RX) || (NULL == p_RxBuffer) || (size < 2) || (size & (size - 1)))
+	{
+		return USART_ERR_PARAM;
+	}
+
+	USART_RxStop(p_UsartHandle);
+
+	p_UsartHandle->p_RxBuffer = p_RxBuffer;
+	p_UsartHandle->RxSize = size;
+	p_UsartHandle->RxPos = 0;
+	p_UsartHandle->RxWritten = 0;
+	p_UsartHandle->RxRead = 0;
+	p_UsartHandle->RxDropped = 0;
+
+	// 1. Stale byte and flags of a previous reception
+	(void)p_USARTx->SR;
+	(void)p_USARTx->DR;
+
+	// 2. Half and full ring interrupts bound the latency of a long stream, TE stops it
+	DMA_InterruptControl(&p_UsartHandle->RxDma, DMA_IT_HT | DMA_IT_TC | DMA_IT_TE, ENABLE);
+	DMA_Start(&p_UsartHandle->RxDma, (uint32_t)&p_USARTx->DR, (uint32_t)p_RxBuffer, size);
+
+	// 3. Idle line ends a packet (bit-band store)
+	BITBAND_PERIPH(&p_USARTx->CR1, USART_CR1REG_IDLEIE) = 1;
+
+	return USART_OK;
+}
+
+/*!
+ * @fn			- USART_RxStop
+ *
+ * @brief 		- Stops the circular DMA reception
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Bytes already in the ring stay readable
+*/
+void USART_RxStop (USART_Handle_t *p_UsartHandle)
+{
+	BITBAND_PERIPH(&p_UsartHandle->p_USARTx->CR1, USART_CR1REG_IDLEIE) = 0;
+	DMA_Stop(&p_UsartHandle->RxDma);
+	DMA_InterruptControl(&p_UsartHandle->RxDma, DMA_IT_HT | DMA_IT_TC | DMA_IT_TE, DISABLE);
+}
+
+/*!
+ * @fn			- USART_RxAvailable
+ *
+ * @brief 		- Bytes received and not read yet
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[out]	- none
+ *
+ * @return 		- Bytes, up to the ring size
+ *
+ * @note		- Counts up to the last USART or RX stream interrupt, not to the live DMA position
+*/
+uint32_t USART_RxAvailable (USART_Handle_t *p_UsartHandle)
+{
+	uint32_t available = p_UsartHandle->RxWritten - p_UsartHandle->RxRead;
+
+	return (available > p_UsartHandle->RxSize) ? p_UsartHandle->RxSize : available;
+}
+
+/*!
+ * @fn			- USART_Read
+ *
+ * @brief 		- Copies received bytes out of the ring
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[out]	- *p_Buffer: destination
+ * @param[in]	- len: size of the destination
+ *
+ * @return 		- Bytes copied
+ *
+ * @note		- Single reader, thread mode or one callback context. After an overrun the read
+ * 				  position jumps to the oldest byte still in the ring and RxDropped counts the loss.
+*/
+uint32_t USART_Read (USART_Handle_t *p_UsartHandle, uint8_t *p_Buffer, uint32_t len)
+{
+	uint32_t written = p_UsartHandle->RxWritten;
+	uint32_t read = p_UsartHandle->RxRead;
+	uint32_t mask = p_UsartHandle->RxSize - 1;
+	uint32_t count;
+
+	if ((written - read) > p_UsartHandle->RxSize)
+	{
+		p_UsartHandle->RxDropped += (written - read) - p_UsartHandle->RxSize;
+		read = written - p_UsartHandle->RxSize;
+	}
+
+	count = written - read;
+	if (count > len)
+	{
+		count = len;
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		p_Buffer[i] = p_UsartHandle->p_RxBuffer[(read + i) & mask];
+	}
+
+	ATOMIC_BARRIER();
+	p_UsartHandle->RxRead = read + count;
+
+	return count;
+}
+
+/*!
+ * @fn			- USART_IRQHandling
+ *
+ * @brief 		- USART Interrupt Request Handler
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Placed in SRAM together with the event handlers: no flash wait states in the ISR
+*/
+_RAMFUNC void USART_IRQHandling (USART_Handle_t *p_UsartHandle)
+{
+	USART_RegDef_t *p_USARTx = p_UsartHandle->p_USARTx;
+	uint32_t status = p_USARTx->SR;
+	uint32_t control = p_USARTx->CR1;
+	uint8_t idle = ((status & USART_FLAG_IDLE) && (control & (1 << USART_CR1REG_IDLEIE))) ? SET : RESET;
+
+	p_UsartHandle->IrqCount++;
+
+	// 1. Idle line and line errors: the SR read above and this DR read clear them together.
+	//	  The DMA has already taken the last byte, RXNE is clear by now.
+	if (idle || (status & USART_FLAG_ERRORS))
+	{
+		(void)p_USARTx->DR;
+
+		if (status & USART_FLAG_ERRORS)
+		{
+			p_UsartHandle->ErrorFlags |= status & USART_FLAG_ERRORS;
+			USART_RaiseEvent(p_UsartHandle, USART_EVENT_ERROR);
+		}
+
+		if (idle)
+		{
+			USART_RxUpdate(p_UsartHandle);
+		}
+	}
+
+	// 2. Transmission complete: final only once the stream has handed over the last byte,
+	//	  a DMA falling behind the line lets TC rise between two bytes
+	if ((status & USART_FLAG_TC) && (control & (1 << USART_CR1REG_TCIE)))
+	{
+		if (DMA_STREAM(p_UsartHandle->TxDma.p_DMAx, p_UsartHandle->TxDma.stream)->CR & (1 << DMA_SxCRREG_EN))
+		{
+			p_USARTx->SR = ~USART_FLAG_TC;
+		}
+		else
+		{
+			USART_CloseTransmission(p_UsartHandle);
+			if (NULL != p_UsartHandle->txDone)
+			{
+				p_UsartHandle->txDone(p_UsartHandle->p_TxDoneContext);	// Owner chains its next transfer
+			}
+			else
+			{
+				USART_RaiseEvent(p_UsartHandle, USART_EVENT_TX_CMPLT);	// Raise API callback event
+			}
+		}
+	}
+}
+
+/*!
+ * @fn			- USART_IRQBind
+ *
+ * @brief 		- Binds the handle to the USART and RX stream IRQs in the SRAM vector table
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[in]	- enable: ENABLE binds, DISABLE restores the link-time handlers
+ *
+ * @return 		- none
+ *
+ * @note		- NVIC enable and priority stay with the application, see USART_IRQNumber and
+ * 				  USART_RxDmaIRQNumber
+*/
+void USART_IRQBind (USART_Handle_t *p_UsartHandle, uint8_t enable)
+{
+	uint8_t IRQNumber = USART_IRQNumber(p_UsartHandle->p_USARTx);
+
+	if (IRQ_NO_NONE == IRQNumber)
+	{
+		return;
+	}
+
+	if (ENABLE == enable)
+	{
+		VECTOR_Register(IRQNumber, USART_IRQDispatch, p_UsartHandle);
+	}
+	else
+	{
+		VECTOR_Unregister(IRQNumber);
+	}
+
+	if (p_UsartHandle->UsartConfig.mode & USART_MODE_RX)
+	{
+		DMA_IRQBind(&p_UsartHandle->RxDma, enable);
+	}
+}
+
+/*!
+ * @fn			- USART_API_EventCallback
+ *
+ * @brief 		- Callback to API regarding USART event
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[in]	- appEvent: @USART_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- WEAK, must override. Runs from the deferred-work queue (PendSV or main loop) unless the
+ * 				  event is in the fastEvents mask of the handle or the queue is not running.
+*/
+_WEAK void USART_API_EventCallback (USART_Handle_t *p_UsartHandle, uint8_t appEvent)
+{
+	// WEAK implementation, application must override it
+}
+
+/*** EOF ***/
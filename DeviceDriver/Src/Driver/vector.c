@@ -0,0 +1,203 @@
+/** @file vector.c
+*
+* @brief SRAM vector table with runtime ISR registration.
+*
+* VECTOR_Init copies the link-time (flash) table into SRAM and points VTOR at the copy. Entries can then
+* be replaced at runtime either by a plain handler (VECTOR_SetRaw) or by a handler + context pair
+* (VECTOR_Register). The latter goes through a common RAM-resident dispatcher which finds the slot of
+* the active IRQ from IPSR, so a driver can bind its own handle without a global trampoline.
+*
+*/
+
+#include <stddef.h>
+#include "vector.h"
+#include "irqprof.h"
+
+
+// === Private Variables ===
+//
+typedef struct VECTOR_Slot
+{
+	VECTOR_Handler_t handler;
+	void *p_Context;
+} VECTOR_Slot_t;
+
+static VECTOR_Raw_t RamTable[VECTOR_NUM_ENTRIES] __attribute__((aligned(VECTOR_ALIGN)));
+static VECTOR_Slot_t Slots[NVIC_NUM_IRQS];
+static const VECTOR_Raw_t *p_FlashTable;			// Table active before relocation
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- Dispatch
+ *
+ * @brief 		- Common entry of the registered IRQs: calls the handler of the active IRQ with its context
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- IPSR holds the exception number of the running handler (IRQ number + 16).
+ * 				  Every registered handler is profiled here when IRQ_PROFILE_ENABLE is set.
+*/
+_RAMFUNC static void Dispatch (void)
+{
+	uint32_t ipsr;
+
+	__asm volatile ("MRS %0, ipsr" : "=r" (ipsr));
+
+	const VECTOR_Slot_t *p_Slot = &Slots[ipsr - VECTOR_NUM_CORE];
+	IRQPROF_ENTER(ipsr - VECTOR_NUM_CORE);
+	p_Slot->handler(p_Slot->p_Context);
+	IRQPROF_EXIT(ipsr - VECTOR_NUM_CORE);
+}
+
+
+// === Public APIs ===
+//
+/*!
+ * @fn			- VECTOR_Init
+ *
+ * @brief 		- Copies the active vector table to SRAM and relocates VTOR
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Interrupts are masked during the switch. Calling it again has no effect.
+*/
+void VECTOR_Init (void)
+{
+	uint32_t primask;
+
+	if (VECTOR_IsRelocated())
+	{
+		return;
+	}
+
+	__asm volatile ("MRS %0, primask\n\tCPSID i" : "=r" (primask) :: "memory");
+
+	// 1. Copy the link-time table (VTOR is 0 after reset: flash aliased at 0x0)
+	p_FlashTable = (const VECTOR_Raw_t *)SCB->VTOR;
+	for (uint8_t i = 0; i < VECTOR_NUM_ENTRIES; ++i)
+	{
+		RamTable[i] = p_FlashTable[i];
+		if (i >= VECTOR_NUM_CORE)
+		{
+			Slots[i - VECTOR_NUM_CORE].handler = NULL;
+		}
+	}
+
+	// 2. Relocate: the table must be visible before the next exception entry
+	SCB->VTOR = (uint32_t)RamTable;
+	__asm volatile ("DSB\n\tISB" ::: "memory");
+
+	__asm volatile ("MSR primask, %0" :: "r" (primask) : "memory");
+}
+
+/*!
+ * @fn			- VECTOR_IsRelocated
+ *
+ * @brief 		- Checks whether the SRAM table is active
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- SET or RESET
+ *
+ * @note		- none
+*/
+uint8_t VECTOR_IsRelocated (void)
+{
+	return (SCB->VTOR == (uint32_t)RamTable) ? SET : RESET;
+}
+
+/*!
+ * @fn			- VECTOR_SetRaw
+ *
+ * @brief 		- Installs a plain handler directly into the vector table
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[in]	- handler: handler function, _RAMFUNC placed for the shortest entry
+ *
+ * @return 		- none
+ *
+ * @note		- Shortest path, no context. The table is relocated on the first use.
+*/
+void VECTOR_SetRaw (uint8_t IRQNumber, VECTOR_Raw_t handler)
+{
+	if (IRQNumber >= NVIC_NUM_IRQS)
+	{
+		return;
+	}
+
+	VECTOR_Init();
+
+	Slots[IRQNumber].handler = NULL;
+	RamTable[VECTOR_NUM_CORE + IRQNumber] = handler;
+	__asm volatile ("DSB" ::: "memory");
+}
+
+/*!
+ * @fn			- VECTOR_Register
+ *
+ * @brief 		- Binds a handler + context pair to the IRQ
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[in]	- handler: called with p_Context from the IRQ
+ * @param[in]	- *p_Context: driver instance (handle), passed back untouched
+ *
+ * @return 		- none
+ *
+ * @note		- The slot is filled before the table entry points to the dispatcher, so a pending
+ * 				  IRQ never sees a half written pair. The table is relocated on the first use.
+*/
+void VECTOR_Register (uint8_t IRQNumber, VECTOR_Handler_t handler, void *p_Context)
+{
+	if ((IRQNumber >= NVIC_NUM_IRQS) || (NULL == handler))
+	{
+		return;
+	}
+
+	VECTOR_Init();
+
+	// 1. Redirect to the original entry while the pair is updated
+	RamTable[VECTOR_NUM_CORE + IRQNumber] = p_FlashTable[VECTOR_NUM_CORE + IRQNumber];
+	__asm volatile ("DSB" ::: "memory");
+
+	// 2. Pair, then the dispatcher
+	Slots[IRQNumber].p_Context = p_Context;
+	Slots[IRQNumber].handler = handler;
+	__asm volatile ("DSB" ::: "memory");
+	RamTable[VECTOR_NUM_CORE + IRQNumber] = Dispatch;
+	__asm volatile ("DSB" ::: "memory");
+}
+
+/*!
+ * @fn			- VECTOR_Unregister
+ *
+ * @brief 		- Restores the link-time handler of the IRQ
+ *
+ * @param[in]	- IRQNumber: The number of the interrupt request
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void VECTOR_Unregister (uint8_t IRQNumber)
+{
+	if ((IRQNumber >= NVIC_NUM_IRQS) || !VECTOR_IsRelocated())
+	{
+		return;
+	}
+
+	RamTable[VECTOR_NUM_CORE + IRQNumber] = p_FlashTable[VECTOR_NUM_CORE + IRQNumber];
+	__asm volatile ("DSB" ::: "memory");
+	Slots[IRQNumber].handler = NULL;
+}
+
+/*** EOF ***/
@@ -9,6 +9,15 @@
 
 #include "gpio_test.h"
 #include "spi_test.h"
+#include "exti_test.h"
+#include "irq_test.h"
+#include "clock_test.h"
+#include "usart_test.h"
+#include "i2c_test.h"
+#include "dma_test.h"
+#include "timebase.h"
+#include "clock.h"
+#include "pclk.h"
 
 extern void initialise_monitor_handles(void);
 
@@ -18,18 +27,50 @@ int main(void)
 
 	printf(" >> STM32 system is started.\n");
 
+	// 1 ms SysTick and the cycle counter for the delays of the test flows
+	TIMEBASE_Init(CLOCK_GetHclk());
+
+	// Only the clocks taken by the drivers run in sleep from now on
+	PCLK_Init();
+
 	SPI_Test_SendData(20);
 #if 0
 	SPI_Test_SendDataIT(20);
 	SPI_Test_ReceiveData (20);
 	SPI_Test_SendData(20);
+	SPI_Test_DeferredEvents(100);
+	SPI_Test_SendDataEvLoop(20);
 	GPIO_Test_ClockOut();
 	GPIO_Test_LedToggleNoIT(20);
+	GPIO_Test_LedToggleEvLoop(20);
 	GPIO_Test_LedToggleByButton();
 	GPIO_Test_LedToggleByButtonIT();
+	GPIO_Test_DmaPatternAndSample(16);
+	GPIO_Test_CaptureBenchmark(160);
+	GPIO_Test_SnapshotRestore();
+	EXTI_Test_DispatchLatency(100);
+	EXTI_Test_PriorityPlan();
+	EXTI_Test_Debounce();
+	EXTI_Test_EncoderBenchmark();
+	IRQ_Test_VectorEntry(100);
+	IRQ_Test_Atomics();
+	IRQ_Test_Profiler(100);
+	IRQ_Test_SleepWakeLatency(100);
+	CLOCK_Test_Profiles();
+	CLOCK_Test_Switching(10);
+	CLOCK_Test_Gating();
+	USART_Test_LoopbackBenchmark(16);
+	USART_Test_ConsoleLatency();
+	I2C_Test_EepromBenchmark(64);
+	I2C_Test_BatchPoll(64);
+	DMA_Test_Arbitration();
+	DMA_Test_BurstBandwidth(16);
+	DMA_Test_MemCrossover(16);
 #endif
 
-	while (1);
+	// Nothing left to run: sleep in the idle loop instead of spinning
+	EVLOOP_Init();
+	EVLOOP_Run();
 
 	return 0;
 }
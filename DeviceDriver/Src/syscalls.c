@@ -56,6 +56,8 @@
 #include <sys/time.h>
 #include <sys/times.h>
 
+#include "console.h"
+
 #define SWD_DEBUG
 
 #ifdef SWD_DEBUG
@@ -135,6 +137,13 @@ __attribute__((weak)) int _write(int file, char *ptr, int len)
 {
 	int DataIdx;
 
+	// Buffered USART console: queue and return, a full buffer follows the console policy
+	if (CONSOLE_IsAttached())
+	{
+		CONSOLE_Write((const uint8_t *)ptr, (uint32_t)len);
+		return len;
+	}
+
 	for (DataIdx = 0; DataIdx < len; DataIdx++)
 	{
 #	ifdef SWD_DEBUG
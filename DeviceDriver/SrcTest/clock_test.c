@@ -0,0 +1,340 @@
+/** @file clock_test.c
+*
+* @brief Clock tree configuration test flows.
+*
+*/
+
+#include "clock_test.h"
+
+
+// === Private Variables ===
+//
+static const CLOCK_Profile_t Profile200 =				// Over the limit: must be refused by the plan
+{
+	.p_Name = "HSI PLL 200 MHz",
+	.source = CLOCK_SOURCE_HSI,
+	.usePll = SET,
+	.pllM = 8,
+	.pllN = 200,
+	.pllP = 2,
+	.pllQ = 8,
+	.ahbDiv = 1,
+	.apb1Div = 4,
+	.apb2Div = 2,
+	.flashAccel = ENABLE,
+};
+
+static SPI_Handle_t SpiTracked;							// Registered at the clock driver: static
+static CLOCK_Notifier_t TestNotifier;
+static CLOCK_Freq_t TargetFreq;							// Handed over by the last PRE event
+static uint16_t PreCount, PostCount, PostMismatch;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- PrintPlan
+ *
+ * @brief 		- Prints the register words and frequencies planned for a profile
+ *
+ * @param[in]	- *p_Profile: clock profile
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- No register access, the same output is expected off-target
+*/
+static void PrintPlan (const CLOCK_Profile_t *p_Profile)
+{
+	CLOCK_Plan_t plan;
+	uint8_t status = CLOCK_Plan(p_Profile, &plan);
+
+	printf(" >> %-16s status %u", p_Profile->p_Name, status);
+	if (CLOCK_OK == status)
+	{
+		printf(", SYSCLK %lu, HCLK %lu, PCLK1 %lu, PCLK2 %lu Hz\n", plan.sysclkHz, plan.hclkHz, plan.pclk1Hz, plan.pclk2Hz);
+		printf("    PLLCFGR 0x%08lx, CFGR 0x%08lx, ACR 0x%08lx, VOS %u, over-drive %u\n",
+			   plan.pllcfgr, plan.cfgr, plan.acr, plan.vos, plan.overdrive);
+	}
+	else
+	{
+		printf("\n");
+	}
+}
+
+/*!
+ * @fn			- CheckDecoded
+ *
+ * @brief 		- Compares the frequencies decoded from RCC with the plan of the applied profile
+ *
+ * @param[in]	- *p_Profile: applied clock profile
+ * @param[out]	- none
+ *
+ * @return 		- SET if every bus clock matches
+ *
+ * @note		- none
+*/
+static uint8_t CheckDecoded (const CLOCK_Profile_t *p_Profile)
+{
+	CLOCK_Plan_t plan;
+	CLOCK_Freq_t freq;
+
+	CLOCK_Plan(p_Profile, &plan);
+	CLOCK_GetFrequencies(&freq);
+
+	if ((plan.sysclkHz == freq.sysclkHz) && (plan.hclkHz == freq.hclkHz) &&
+		(plan.pclk1Hz == freq.pclk1Hz) && (plan.pclk2Hz == freq.pclk2Hz))
+	{
+		return SET;
+	}
+
+	printf(" >> %-16s decoded SYSCLK %lu, HCLK %lu, PCLK1 %lu, PCLK2 %lu Hz: mismatch\n", p_Profile->p_Name,
+		   freq.sysclkHz, freq.hclkHz, freq.pclk1Hz, freq.pclk2Hz);
+
+	return RESET;
+}
+
+/*!
+ * @fn			- TestNotify
+ *
+ * @brief 		- Counts the switch notifications and checks that POST delivers the PRE target
+ *
+ * @param[in]	- *p_Context: unused
+ * @param[in]	- event: @CLOCK_EVENT
+ * @param[in]	- *p_Freq: target (PRE) or running (POST) frequencies
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void TestNotify (void *p_Context, uint8_t event, const CLOCK_Freq_t *p_Freq)
+{
+	(void)p_Context;
+
+	if (CLOCK_EVENT_PRE_CHANGE == event)
+	{
+		TargetFreq = *p_Freq;
+		PreCount++;
+	}
+	else
+	{
+		PostCount++;
+		if ((TargetFreq.hclkHz != p_Freq->hclkHz) || (TargetFreq.pclk1Hz != p_Freq->pclk1Hz) ||
+			(TargetFreq.pclk2Hz != p_Freq->pclk2Hz) || (TargetFreq.timclk1Hz != p_Freq->timclk1Hz))
+		{
+			PostMismatch++;
+		}
+	}
+}
+
+/*!
+ * @fn			- Workload
+ *
+ * @brief 		- Flash bound reference work: bitwise CRC-32 over a constant table
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- CRC, printed so the work cannot be optimized out
+ *
+ * @note		- Code and table are fetched from flash, the accelerator makes the difference
+*/
+static uint32_t Workload (void)
+{
+	static const uint32_t Table[256] = { [0] = 0x12345678, [17] = 0xCAFEBABE, [255] = 0xDEADBEEF };
+	uint32_t crc = 0xFFFFFFFF;
+
+	for (uint16_t i = 0; i < NUM_OF(Table); ++i)
+	{
+		crc ^= Table[i];
+		for (uint8_t bit = 0; bit < 32; ++bit)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+
+	return ~crc;
+}
+
+
+// === Public API Functions ===
+//
+/*!
+ * @fn			- CLOCK_Test_Profiles
+ *
+ * @brief 		- Plans the built-in profiles, then runs a flash bound workload at 16 MHz and at 180 MHz
+ * 				  with and without the flash accelerator
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Every applied profile is checked against the frequencies decoded from RCC.
+ * 				  Returns on the HSI 16 MHz reset clock, which the other test flows expect
+*/
+void CLOCK_Test_Profiles (void)
+{
+	printf(" >> Clock profile test.\n");
+
+	// 1. Plans
+	const CLOCK_Profile_t *profiles[] = { &CLOCK_Profile_HSI16, &CLOCK_Profile_HSI180, &CLOCK_Profile_HSE180, &Profile200 };
+	for (uint8_t i = 0; i < NUM_OF(profiles); ++i)
+	{
+		PrintPlan(profiles[i]);
+	}
+
+	// 2. Workload on each clock
+	CLOCK_Profile_t noAccel16 = CLOCK_Profile_HSI16;
+	CLOCK_Profile_t noAccel180 = CLOCK_Profile_HSI180;
+	noAccel16.flashAccel = DISABLE;
+	noAccel180.flashAccel = DISABLE;
+
+	const CLOCK_Profile_t *runs[] = { &noAccel16, &CLOCK_Profile_HSI16, &noAccel180, &CLOCK_Profile_HSI180 };
+	for (uint8_t i = 0; i < NUM_OF(runs); ++i)
+	{
+		uint8_t status = CLOCK_Configure(runs[i]);
+		if (CLOCK_OK != status)
+		{
+			CLOCK_Configure(&CLOCK_Profile_HSI16);
+			printf(" >> %s failed: status %u\n", runs[i]->p_Name, status);
+			continue;
+		}
+
+		uint32_t start = DWT_CYCCNT();
+		uint32_t crc = Workload();
+		uint32_t cycles = DWT_CYCCNT() - start;
+
+		// printf runs on the new clock, the numbers are taken before
+		printf(" >> %-16s accel %u: %lu cycles, %lu us (crc 0x%08lx), TIMCLK1 %lu Hz\n", runs[i]->p_Name,
+			   runs[i]->flashAccel, cycles, cycles / (CLOCK_GetHclk() / 1000000), crc, CLOCK_GetTimerClk1());
+		CheckDecoded(runs[i]);
+	}
+
+	CLOCK_Configure(&CLOCK_Profile_HSI16);
+
+	printf(" >> Clock profile test is finished.\n");
+}
+
+/*!
+ * @fn			- CLOCK_Test_Switching
+ *
+ * @brief 		- Cycles through the performance, balanced and low power profiles with a tracked SPI1
+ *
+ * @param[in]	- cycle: number of rounds over the three profiles
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- SPI1 is only configured, not wired: its SCLK is read back from CR1 and the bus clock.
+ * 				  Returns on the low power profile.
+*/
+void CLOCK_Test_Switching (uint16_t cycle)
+{
+	const CLOCK_Profile_t *profiles[] = { CLOCK_PROFILE_PERFORMANCE, CLOCK_PROFILE_BALANCED, CLOCK_PROFILE_LOW_POWER };
+	CLOCK_SwitchStat_t stat;
+
+	printf(" >> Clock switching test.\n");
+
+	SpiTracked.p_SPIx = SPI1;
+	SpiTracked.SpiConfig.deviceMode = SPI_DEVMODE_MASTER;
+	SpiTracked.SpiConfig.busConfig = SPI_BUSCONFIG_FD;
+	SpiTracked.SpiConfig.sclkSpeed = SPI_SPEED_DIV2;
+	SpiTracked.SpiConfig.dff = SPI_DFFMODE_8BIT;
+	SpiTracked.SpiConfig.cpol = SPI_CPOLMODE_LOW;
+	SpiTracked.SpiConfig.cpha = SPI_CPHAMODE_LEAD;
+	SpiTracked.SpiConfig.ssm = SPI_SSMMODE_EN;
+	SpiTracked.SpiConfig.ssi = SPI_SSIMODE_EN;
+	SpiTracked.SpiConfig.ssoe = SPI_SSOEMODE_DI;
+	SpiTracked.TxState = SPI_ST_READY;
+	SpiTracked.RxState = SPI_ST_READY;
+	SPI_Init(&SpiTracked);
+	SPI_ClockTrack(&SpiTracked, CLOCK_TEST_SCLK_MAX_HZ, ENABLE);
+
+	PreCount = 0;
+	PostCount = 0;
+	PostMismatch = 0;
+	CLOCK_NotifierRegister(&TestNotifier, TestNotify, NULL);
+
+	while (cycle)
+	{
+		for (uint8_t i = 0; i < NUM_OF(profiles); ++i)
+		{
+			uint8_t status = CLOCK_Switch(profiles[i]);
+			uint32_t crc = Workload();
+
+			CLOCK_GetSwitchStat(&stat);
+			printf(" >> %-16s status %u: switch %lu us (clock tree %lu us), SCLK %lu Hz (crc 0x%08lx)\n",
+				   profiles[i]->p_Name, status, stat.lastUs, stat.lastApplyUs, SPI_GetSclkHz(SPI1), crc);
+		}
+		cycle--;
+	}
+
+	CLOCK_Switch(CLOCK_PROFILE_LOW_POWER);
+	CLOCK_NotifierUnregister(&TestNotifier);
+	SPI_ClockTrack(&SpiTracked, 0, DISABLE);
+	SPI_DeInit(SPI1);
+
+	CLOCK_GetSwitchStat(&stat);
+	printf(" >> %lu switches, max %lu us, notifications PRE %u POST %u, target mismatches %u\n",
+		   stat.count, stat.maxUs, PreCount, PostCount, PostMismatch);
+	printf(" >> Clock switching test is finished.\n");
+}
+
+/*!
+ * @fn			- CLOCK_Test_Gating
+ *
+ * @brief 		- Shares GPIOB between two users and follows its clock and sleep clock bits
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- GPIOB is not used by the other test flows
+*/
+void CLOCK_Test_Gating (void)
+{
+	volatile uint32_t *p_ClkEnReg = &RCC->AHB1ENR;
+	const uint8_t bit = 1;												// GPIOBEN
+	GPIO_Handle_t gpioHandle;
+
+	printf(" >> Clock gating test.\n");
+
+	gpioHandle.p_GPIOx = GPIOB;
+	gpioHandle.pinConfig.pinMode = GPIO_MODE_IN;
+	gpioHandle.pinConfig.pinSpeed = GPIO_OP_SPEED_LOW;
+	gpioHandle.pinConfig.pinPuPdControl = GPIO_PIN_PU;
+	gpioHandle.pinConfig.pinOPType = GPIO_OP_TYPE_PP;
+	gpioHandle.pinConfig.pinAltFunMode = 0;
+
+	// 1. Two users of the port: two pins (one re-initialised) and another driver
+	gpioHandle.pinConfig.pinNumber = GPIO_PIN_NO_0;
+	GPIO_Init(&gpioHandle);
+	GPIO_Init(&gpioHandle);
+	gpioHandle.pinConfig.pinNumber = GPIO_PIN_NO_1;
+	GPIO_Init(&gpioHandle);
+	GPIO_PeriClockControl(GPIOB, ENABLE);
+	printf(" >> Two users: refs %u (expected 3), EN %lu, LPEN %lu\n", PCLK_GetCount(p_ClkEnReg, bit),
+		   (*p_ClkEnReg >> bit) & 1, (*PCLK_LPENR(p_ClkEnReg) >> bit) & 1);
+
+	// 2. Not needed while asleep
+	PCLK_SleepControl(p_ClkEnReg, bit, DISABLE);
+	printf(" >> Sleep off: EN %lu, LPEN %lu\n", (*p_ClkEnReg >> bit) & 1, (*PCLK_LPENR(p_ClkEnReg) >> bit) & 1);
+	PCLK_SleepControl(p_ClkEnReg, bit, ENABLE);
+
+	// 3. The pins leave: clock and pull-ups stay for the other driver
+	GPIO_DeInit(GPIOB);
+	printf(" >> One user: refs %u (expected 1), EN %lu, PUPDR 0x%08lx\n", PCLK_GetCount(p_ClkEnReg, bit),
+		   (*p_ClkEnReg >> bit) & 1, GPIOB->PUPDR);
+
+	// 4. The last user leaves: gated awake and asleep
+	GPIO_PeriClockControl(GPIOB, DISABLE);
+	printf(" >> No user: refs %u, EN %lu, LPEN %lu\n", PCLK_GetCount(p_ClkEnReg, bit),
+		   (*p_ClkEnReg >> bit) & 1, (*PCLK_LPENR(p_ClkEnReg) >> bit) & 1);
+
+	printf(" >> AHB1LPENR 0x%08lx, APB1LPENR 0x%08lx, APB2LPENR 0x%08lx\n", RCC->AHB1LPENR, RCC->APB1LPENR, RCC->APB2LPENR);
+	printf(" >> Clock gating test is finished.\n");
+}
+
+/*** EOF ***/
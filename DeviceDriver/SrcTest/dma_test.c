@@ -0,0 +1,399 @@
+/** @file dma_test.c
+*
+* @brief DMA stream arbitration, memory-to-memory bandwidth and CPU / DMA crossover test flows.
+*
+*/
+
+#include "dma_test.h"
+
+
+// === Private Variables ===
+//
+static DMA_Handle_t CopyDma;							// Bound to the vector table: static
+static uint32_t SrcBlock[DMA_TEST_BLOCK_SIZE / 4];
+static uint32_t DstBlock[DMA_TEST_BLOCK_SIZE / 4];
+static volatile uint16_t FullEvents, ErrorEvents;
+static uint8_t Failures;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- CopyDone
+ *
+ * @brief 		- Stream callback of the memory-to-memory transfers
+ *
+ * @param[in]	- *p_Context: unused
+ * @param[in]	- event: @DMA_EVENT
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void CopyDone (void *p_Context, uint8_t event)
+{
+	if (DMA_EVENT_FULL == event)
+	{
+		FullEvents++;
+	}
+	else if (DMA_EVENT_ERROR == event)
+	{
+		ErrorEvents++;
+	}
+}
+
+/*!
+ * @fn			- Expect
+ *
+ * @brief 		- Prints one check of the arbitration test
+ *
+ * @param[in]	- *p_Name: check description
+ * @param[in]	- status: @DMA_STATUS returned
+ * @param[in]	- expected: @DMA_STATUS required
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void Expect (const char *p_Name, uint8_t status, uint8_t expected)
+{
+	if (status != expected)
+	{
+		Failures++;
+	}
+
+	printf(" >> %-36s status %u, expected %u: %s\n", p_Name, status, expected, (status == expected) ? "ok" : "FAILED");
+}
+
+/*!
+ * @fn			- TimeCopy
+ *
+ * @brief 		- Average cycles of a blocking MEM_DMA_Copy at a given threshold, checked against the source
+ *
+ * @param[in]	- offset: source byte offset into SrcBlock, 0 for aligned
+ * @param[in]	- len: bytes
+ * @param[in]	- threshold: 0 forces the stream, UINT32_MAX the CPU
+ * @param[in]	- cycle: number of copies
+ *
+ * @return 		- Core cycles per copy
+ *
+ * @note		- Failures counts the copies with a wrong byte
+*/
+static uint32_t TimeCopy (uint8_t offset, uint32_t len, uint32_t threshold, uint16_t cycle)
+{
+	const uint8_t *p_Src = (const uint8_t *)SrcBlock + offset;
+	uint8_t *p_Dst = (uint8_t *)DstBlock;
+	uint32_t cycles = 0;
+
+	MEM_DMA_SetThreshold(threshold);
+
+	for (uint16_t round = 0; round < cycle; ++round)
+	{
+		MEM_DMA_Set(p_Dst, 0, len);
+
+		uint32_t start = DWT_CYCCNT();
+		MEM_DMA_Copy(p_Dst, p_Src, len);
+		cycles += DWT_CYCCNT() - start;
+
+		for (uint32_t i = 0; i < len; ++i)
+		{
+			if (p_Dst[i] != p_Src[i])
+			{
+				Failures++;
+				break;
+			}
+		}
+	}
+
+	return cycles / (cycle ? cycle : 1);
+}
+
+
+// === Public API Functions ===
+//
+/*!
+ * @fn			- DMA_Test_Arbitration
+ *
+ * @brief 		- Checks stream ownership, route fallback and the FIFO / burst configuration rules
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Runs on DMA2 streams 3 and 4, which no driver of this project routes to
+*/
+void DMA_Test_Arbitration (void)
+{
+	const DMA_Route_t routes[] = { DMA_ROUTE(DMA2, 3, 0), DMA_ROUTE(DMA2, 4, 0) };
+	DMA_Handle_t first = { .p_DMAx = DMA2, .stream = DMA_STREAM_3 };
+	DMA_Handle_t second = { .p_DMAx = DMA2, .stream = DMA_STREAM_3 };
+	DMA_Handle_t third = { 0 };
+
+	printf(" $ Executing DMA Arbitration Test...\n");
+
+	Failures = 0;
+
+	// 1. Ownership: the owner may claim again, another handle may not
+	Expect("First claim", DMA_Request(&first), DMA_OK);
+	Expect("Repeated claim by the owner", DMA_Request(&first), DMA_OK);
+	Expect("Claim of an owned stream", DMA_Request(&second), DMA_ERR_BUSY);
+	Expect("Owner lookup", (&first == DMA_GetOwner(DMA2, DMA_STREAM_3)) ? DMA_OK : DMA_ERR_PARAM, DMA_OK);
+
+	// 2. Routes: the first free one wins, none left fails
+	Expect("Allocation falls back to stream 4", DMA_Allocate(&second, routes, NUM_OF(routes)), DMA_OK);
+	Expect("Second handle on stream 4", (DMA_STREAM_4 == second.stream) ? DMA_OK : DMA_ERR_PARAM, DMA_OK);
+	Expect("Allocation with every route taken", DMA_Allocate(&third, routes, NUM_OF(routes)), DMA_ERR_BUSY);
+	Expect("Unknown stream", DMA_Request(&(DMA_Handle_t){ .p_DMAx = DMA2, .stream = 8 }), DMA_ERR_PARAM);
+
+	// 3. Configuration rules: a refused configuration leaves the stream untouched
+	first.DmaConfig = (DMA_Config_t){ .direction = DMA_DIR_M2M, .memInc = ENABLE, .periphInc = ENABLE };
+	Expect("Memory-to-memory in direct mode", DMA_Init(&first), DMA_ERR_CONFIG);
+
+	first.DmaConfig.fifoThreshold = DMA_FIFO_3_4;
+	first.DmaConfig.memSize = DMA_SIZE_HALFWORD;
+	first.DmaConfig.memBurst = DMA_BURST_INC4;
+	Expect("8 B bursts at a 12 B threshold", DMA_Init(&first), DMA_ERR_CONFIG);
+
+	first.DmaConfig.memSize = DMA_SIZE_WORD;
+	first.DmaConfig.memBurst = DMA_BURST_INC8;
+	first.DmaConfig.fifoThreshold = DMA_FIFO_FULL;
+	Expect("32 B bursts", DMA_Init(&first), DMA_ERR_CONFIG);
+
+	first.DmaConfig.memBurst = DMA_BURST_INC4;
+	first.DmaConfig.periphSize = DMA_SIZE_WORD;
+	first.DmaConfig.periphBurst = DMA_BURST_INC4;
+	Expect("16 B bursts at a full FIFO", DMA_Init(&first), DMA_OK);
+
+	// 4. Release: the stream is free for the next claim
+	DMA_Release(&first);
+	Expect("Allocation after release", DMA_Allocate(&third, routes, NUM_OF(routes)), DMA_OK);
+
+	DMA_Release(&second);
+	DMA_Release(&third);
+
+	printf(" $ ... Finished DMA Arbitration Test: %u failure(s).\n", Failures);
+}
+
+/*!
+ * @fn			- DMA_Test_BurstBandwidth
+ *
+ * @brief 		- SRAM to SRAM bandwidth of DMA2 for the FIFO threshold / burst combinations
+ *
+ * @param[in]	- cycle: transfers per configuration
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Each transfer is checked against the source and ends on the transfer complete
+ * 				  callback, so the figures include the interrupt entry. Single byte transfers are
+ * 				  the worst case: one AHB read and one write per byte.
+*/
+void DMA_Test_BurstBandwidth (uint16_t cycle)
+{
+	static const struct
+	{
+		const char *p_Name;
+		uint8_t size;
+		uint8_t fifoThreshold;
+		uint8_t burst;
+	} configs[] =
+	{
+		{ "byte, single, FIFO 1/4",		DMA_SIZE_BYTE,		DMA_FIFO_1_4,	DMA_BURST_SINGLE },
+		{ "byte, INC16, FIFO full",		DMA_SIZE_BYTE,		DMA_FIFO_FULL,	DMA_BURST_INC16 },
+		{ "word, single, FIFO 1/2",		DMA_SIZE_WORD,		DMA_FIFO_1_2,	DMA_BURST_SINGLE },
+		{ "word, INC4, FIFO full",		DMA_SIZE_WORD,		DMA_FIFO_FULL,	DMA_BURST_INC4 },
+	};
+	const DMA_Route_t routes[] = { DMA_ROUTE(DMA2, 0, 0), DMA_ROUTE(DMA2, 3, 0), DMA_ROUTE(DMA2, 4, 0) };
+
+	printf(" $ Executing DMA Burst Bandwidth Test...\n");
+
+	CLOCK_Switch(CLOCK_PROFILE_PERFORMANCE);
+
+	for (uint16_t i = 0; i < NUM_OF(SrcBlock); ++i)
+	{
+		SrcBlock[i] = (0x01010101U * i) ^ 0xA5C3E187U;
+	}
+
+	if (DMA_OK != DMA_Allocate(&CopyDma, routes, NUM_OF(routes)))
+	{
+		printf(" $ ... No free DMA2 stream, test skipped.\n");
+		return;
+	}
+
+	CopyDma.callback = CopyDone;
+	DMA_IRQBind(&CopyDma, ENABLE);
+	NVIC_SetPriority(DMA_IRQNumber(CopyDma.p_DMAx, CopyDma.stream), NVIC_PLAN_PREEMPT_DATA, 0);
+	IRQInterruptConfig(DMA_IRQNumber(CopyDma.p_DMAx, CopyDma.stream), ENABLE);
+
+	for (uint8_t c = 0; c < NUM_OF(configs); ++c)
+	{
+		uint32_t cycles = 0, mismatches = 0;
+		uint16_t items = DMA_TEST_BLOCK_SIZE >> configs[c].size;
+		TIMEBASE_Timeout_t timeout;
+
+		CopyDma.DmaConfig = (DMA_Config_t){ 0 };
+		CopyDma.DmaConfig.direction 	= DMA_DIR_M2M;
+		CopyDma.DmaConfig.periphInc 	= ENABLE;
+		CopyDma.DmaConfig.memInc 		= ENABLE;
+		CopyDma.DmaConfig.periphSize 	= configs[c].size;
+		CopyDma.DmaConfig.memSize 		= configs[c].size;
+		CopyDma.DmaConfig.priority 		= DMA_PRIORITY_HIGH;
+		CopyDma.DmaConfig.fifoThreshold = configs[c].fifoThreshold;
+		CopyDma.DmaConfig.memBurst 		= configs[c].burst;
+		CopyDma.DmaConfig.periphBurst 	= configs[c].burst;
+
+		if (DMA_OK != DMA_Init(&CopyDma))
+		{
+			printf(" $ %-24s refused\n", configs[c].p_Name);
+			continue;
+		}
+		DMA_InterruptControl(&CopyDma, DMA_IT_TC | DMA_IT_TE, ENABLE);
+
+		FullEvents = 0;
+		ErrorEvents = 0;
+
+		for (uint16_t round = 0; round < cycle; ++round)
+		{
+			uint16_t done = FullEvents;
+
+			for (uint16_t i = 0; i < NUM_OF(DstBlock); ++i)
+			{
+				DstBlock[i] = 0;
+			}
+
+			uint32_t start = DWT_CYCCNT();
+			DMA_Start(&CopyDma, (uint32_t)SrcBlock, (uint32_t)DstBlock, items);
+
+			TIMEBASE_TimeoutStart(&timeout, DMA_TEST_TIMEOUT_US);
+			while ((done == FullEvents) && !ErrorEvents && !TIMEBASE_TimeoutExpired(&timeout));
+			cycles += DWT_CYCCNT() - start;
+
+			for (uint16_t i = 0; i < NUM_OF(DstBlock); ++i)
+			{
+				mismatches += (DstBlock[i] != SrcBlock[i]);
+			}
+		}
+
+		uint32_t perBlock = cycles / (cycle ? cycle : 1);
+		uint32_t rate = perBlock ? (uint32_t)(((uint64_t)DMA_TEST_BLOCK_SIZE * CLOCK_GetHclk()) / perBlock / 1000U) : 0;
+
+		printf(" $ %-24s %lu cycles per %u B, %lu.%02lu B/cycle, %lu KB/s, %u done, %u errors, %lu mismatches\n",
+			   configs[c].p_Name, perBlock, DMA_TEST_BLOCK_SIZE, (DMA_TEST_BLOCK_SIZE * 100U / (perBlock ? perBlock : 1)) / 100U,
+			   (DMA_TEST_BLOCK_SIZE * 100U / (perBlock ? perBlock : 1)) % 100U, rate, FullEvents, ErrorEvents, mismatches);
+	}
+
+	IRQInterruptConfig(DMA_IRQNumber(CopyDma.p_DMAx, CopyDma.stream), DISABLE);
+	DMA_IRQBind(&CopyDma, DISABLE);
+	DMA_Release(&CopyDma);
+
+	CLOCK_Switch(CLOCK_PROFILE_LOW_POWER);
+
+	printf(" $ ... Finished DMA Burst Bandwidth Test.\n");
+}
+
+/*!
+ * @fn			- DMA_Test_MemCrossover
+ *
+ * @brief 		- CPU / DMA crossover of MEM_DMA_Copy for each clock profile
+ *
+ * @param[in]	- cycle: copies per length and path
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Per profile: both paths over a length table (one unaligned source row), the
+ * 				  threshold found by MEM_DMA_Calibrate and the CPU loop iterations an
+ * 				  asynchronous 4 KB copy leaves free. The flash wait states and the AHB / CPU clock
+ * 				  ratio move the crossover, so the calibrated threshold is kept per profile.
+*/
+void DMA_Test_MemCrossover (uint16_t cycle)
+{
+	static const struct
+	{
+		const char *p_Name;
+		const CLOCK_Profile_t *p_Profile;
+	} profiles[] =
+	{
+		{ "Performance",	CLOCK_PROFILE_PERFORMANCE },
+		{ "Balanced",		CLOCK_PROFILE_BALANCED },
+		{ "Low power",		CLOCK_PROFILE_LOW_POWER },
+	};
+	static const uint16_t lengths[] = { 32, 64, 128, 256, 512, 1024, 4000 };
+	uint32_t thresholds[NUM_OF(profiles)];
+	MEM_DMA_Stat_t stat;
+
+	printf(" $ Executing DMA Memory Crossover Test...\n");
+
+	Failures = 0;
+
+	for (uint16_t i = 0; i < NUM_OF(SrcBlock); ++i)
+	{
+		SrcBlock[i] = (0x01010101U * i) ^ 0x3C5A96F0U;
+	}
+
+	if (MEM_DMA_OK != MEM_DMA_Init())
+	{
+		printf(" $ ... No free DMA2 stream, test skipped.\n");
+		return;
+	}
+
+	NVIC_SetPriority(MEM_DMA_IRQNumber(), NVIC_PLAN_PREEMPT_DATA, 1);
+	IRQInterruptConfig(MEM_DMA_IRQNumber(), ENABLE);
+
+	for (uint8_t p = 0; p < NUM_OF(profiles); ++p)
+	{
+		CLOCK_Switch(profiles[p].p_Profile);
+		printf(" $ %s, HCLK %lu Hz\n", profiles[p].p_Name, CLOCK_GetHclk());
+
+		// 1. Both paths over the length table
+		for (uint8_t l = 0; l < NUM_OF(lengths); ++l)
+		{
+			uint32_t cpu = TimeCopy(0, lengths[l], UINT32_MAX, cycle);
+			uint32_t dma = TimeCopy(0, lengths[l], 0, cycle);
+
+			printf(" >> %4u B: CPU %6lu cycles, DMA %6lu cycles, %s\n", lengths[l], cpu, dma, (dma < cpu) ? "DMA" : "CPU");
+		}
+
+		uint32_t cpu = TimeCopy(1, DMA_TEST_BLOCK_SIZE / 2, UINT32_MAX, cycle);
+		uint32_t dma = TimeCopy(1, DMA_TEST_BLOCK_SIZE / 2, 0, cycle);
+		printf(" >> %4u B, unaligned source: CPU %6lu cycles, DMA %6lu cycles\n", DMA_TEST_BLOCK_SIZE / 2, cpu, dma);
+
+		// 2. Crossover measured by the driver, source half and destination half of DstBlock
+		thresholds[p] = MEM_DMA_Calibrate(DstBlock, sizeof(DstBlock));
+		printf(" >> Calibrated threshold: %lu B\n", thresholds[p]);
+
+		// 3. CPU time left by an asynchronous copy
+		uint32_t spins = 0;
+		MEM_DMA_Set(DstBlock, 0, DMA_TEST_BLOCK_SIZE);
+
+		MEM_DMA_Token_t token = MEM_DMA_CopyAsync(DstBlock, SrcBlock, DMA_TEST_BLOCK_SIZE);
+		while (!MEM_DMA_IsDone(token))
+		{
+			spins++;
+		}
+
+		uint8_t status = MEM_DMA_Wait(token, DMA_TEST_TIMEOUT_US);
+		for (uint16_t i = 0; i < NUM_OF(DstBlock); ++i)
+		{
+			if (DstBlock[i] != SrcBlock[i])
+			{
+				status = MEM_DMA_ERR_DMA;
+				break;
+			}
+		}
+		Expect("Asynchronous 4 KB copy", status, MEM_DMA_OK);
+		printf(" >> %lu CPU loop iterations free during the copy\n", spins);
+	}
+
+	MEM_DMA_GetStat(&stat);
+	printf(" $ Thresholds %lu / %lu / %lu B, %lu DMA, %lu CPU, %lu fallbacks, %lu errors\n", thresholds[0], thresholds[1],
+		   thresholds[2], stat.dmaCount, stat.cpuCount, stat.fallbacks, stat.errors);
+
+	IRQInterruptConfig(MEM_DMA_IRQNumber(), DISABLE);
+	MEM_DMA_DeInit();
+
+	printf(" $ ... Finished DMA Memory Crossover Test: %u failure(s).\n", Failures);
+}
+
+/*** EOF ***/
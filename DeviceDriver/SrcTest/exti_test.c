@@ -0,0 +1,391 @@
+/** @file exti_test.c
+*
+* @brief EXTI dispatch manager test flows.
+*
+*/
+
+#include "exti_test.h"
+
+
+// === Private Variables ===
+//
+static volatile uint32_t TriggerStamp;		// DWT CYCCNT at the software trigger
+static volatile uint32_t EntryStamp[EXTI_NUM_GPIO_LINES];
+static volatile uint16_t ServedLines;
+static volatile uint8_t NestedIn;			// SET if the EXTI1 callback ran while EXTI0 was active
+static GPIO_Handle_t LedHandle;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- LatencyCallback
+ *
+ * @brief 		- Stamps the callback entry of the line
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[in]	- *p_Context: not used
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void LatencyCallback (uint8_t line, void *p_Context)
+{
+	EntryStamp[line] = DWT_CYCCNT();
+	ServedLines |= EXTI_LINE_BIT(line);
+}
+
+/*!
+ * @fn			- TriggerAndWait
+ *
+ * @brief 		- Triggers the lines from software and waits until all of them are served
+ *
+ * @param[in]	- lineMask: lines to be triggered
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void TriggerAndWait (uint32_t lineMask)
+{
+	ServedLines = 0;
+	TriggerStamp = DWT_CYCCNT();
+	EXTI_SoftwareTrigger(lineMask);
+	while (ServedLines != lineMask);
+}
+
+/*!
+ * @fn			- OuterCallback
+ *
+ * @brief 		- EXTI0 callback: raises EXTI1 and gives it time to preempt
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[in]	- *p_Context: not used
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void OuterCallback (uint8_t line, void *p_Context)
+{
+	EXTI_SoftwareTrigger(EXTI_LINE_BIT(1));
+	for (volatile uint16_t i = 0; i < 100; ++i);
+	ServedLines |= EXTI_LINE_BIT(line);
+}
+
+/*!
+ * @fn			- InnerCallback
+ *
+ * @brief 		- EXTI1 callback: records whether it preempted the EXTI0 handler
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[in]	- *p_Context: not used
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void InnerCallback (uint8_t line, void *p_Context)
+{
+	NestedIn = ((IRQ_NO_EXTI1 == NVIC_GetActiveIRQ()) && NVIC_IsActive(IRQ_NO_EXTI0)) ? SET : RESET;
+	ServedLines |= EXTI_LINE_BIT(line);
+}
+
+/*!
+ * @fn			- RaiseOuter
+ *
+ * @brief 		- Triggers EXTI0 only and waits until both EXTI0 and the EXTI1 raised by it are served
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void RaiseOuter (void)
+{
+	ServedLines = 0;
+	NestedIn = RESET;
+	EXTI_SoftwareTrigger(EXTI_LINE_BIT(0));
+	while (ServedLines != (EXTI_LINE_BIT(0) | EXTI_LINE_BIT(1)));
+}
+
+/*!
+ * @fn			- ButtonEvent
+ *
+ * @brief 		- Debounced user button events: press toggles the LED, long press switches it off
+ *
+ * @param[in]	- id: debounce input id
+ * @param[in]	- event: @DEBOUNCE_EVENTS
+ * @param[in]	- *p_Context: not used
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void ButtonEvent (uint8_t id, uint8_t event, void *p_Context)
+{
+	static const char *eventName[] = { "PRESS", "RELEASE", "LONG PRESS" };
+
+	if (DEBOUNCE_EVENT_PRESS == event)
+	{
+		GPIO_TogglePin(LedHandle.p_GPIOx, LedHandle.pinConfig.pinNumber);
+	}
+	else if (DEBOUNCE_EVENT_LONG_PRESS == event)
+	{
+		GPIO_WritePin(LedHandle.p_GPIOx, LedHandle.pinConfig.pinNumber, RESET);
+	}
+	else
+	{
+		// NOP
+	}
+
+	printf(" >> Button %u: %s @ %lu ms\n", id, eventName[event], TIMEBASE_GetMs32());
+}
+
+
+// === Public API Functions ===
+//
+/*!
+ * @fn			- EXTI_Test_DispatchLatency
+ *
+ * @brief 		- Measures the trigger-to-callback latency of every GPIO EXTI line
+ *
+ * @param[in]	- cycle: number of measurements per line
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Lines are raised through SWIER, no pin configuration is needed.
+ * 				  The second part raises EXTI10-15 at once: one EXTI15_10 entry serves all six lines.
+*/
+void EXTI_Test_DispatchLatency (uint16_t cycle)
+{
+	printf(" >> EXTI dispatch latency test.\n");
+
+	DWT_CYCCNT_EN();
+
+	uint8_t vectors[] = { IRQ_NO_EXTI0, IRQ_NO_EXTI1, IRQ_NO_EXTI2, IRQ_NO_EXTI3, IRQ_NO_EXTI4, IRQ_NO_EXTI9_5, IRQ_NO_EXTI15_10 };
+	for (uint8_t i = 0; i < sizeof(vectors); ++i)
+	{
+		IRQPriorityConfig(vectors[i], NVIC_IRQ_PRI15);
+	}
+
+	for (uint8_t line = 0; line < EXTI_NUM_GPIO_LINES; ++line)
+	{
+		EXTI_RegisterCallback(line, LatencyCallback, NULL);
+	}
+
+	// 1. Single line latency
+	for (uint8_t line = 0; line < EXTI_NUM_GPIO_LINES; ++line)
+	{
+		uint32_t min = UINT32_MAX, max = 0, sum = 0;
+
+		for (uint16_t i = 0; i < cycle; ++i)
+		{
+			TriggerAndWait(EXTI_LINE_BIT(line));
+
+			uint32_t latency = EntryStamp[line] - TriggerStamp;
+			min = (latency < min) ? latency : min;
+			max = (latency > max) ? latency : max;
+			sum += latency;
+		}
+
+		printf(" >> Line %2u: min %3lu, max %3lu, avg %3lu cycles\n", line, cycle ? min : 0, max, cycle ? (sum / cycle) : 0);
+	}
+
+	// 2. All lines of the shared EXTI15_10 vector pending at once
+	TriggerAndWait(EXTI_MASK_EXTI15_10);
+	for (uint8_t line = 15; line >= 10; --line)
+	{
+		printf(" >> Batch line %2u: %3lu cycles\n", line, EntryStamp[line] - TriggerStamp);
+	}
+
+	for (uint8_t line = 0; line < EXTI_NUM_GPIO_LINES; ++line)
+	{
+		EXTI_UnregisterCallback(line);
+	}
+
+	printf(" >> EXTI dispatch latency test is finished.\n");
+}
+
+/*!
+ * @fn			- EXTI_Test_PriorityPlan
+ *
+ * @brief 		- Checks the priority grouping: only a lower preemption level nests
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- EXTI0 raises EXTI1 from its callback. Same preemption level with a better sub-priority
+ * 				  must wait, a better preemption level must nest. Priorities are also lowered on the way,
+ * 				  which the former OR-ing IRQPriorityConfig could not do.
+*/
+void EXTI_Test_PriorityPlan (void)
+{
+	printf(" >> NVIC priority plan test.\n");
+
+	NVIC_ApplyPriorityPlan();
+	printf(" >> Grouping: %u preemption bits, SPI1 %u.%u, EXTI0 %u.%u\n", NVIC_GetPriorityGrouping(),
+		   NVIC_GetPreemptPriority(IRQ_NO_SPI1), NVIC_GetSubPriority(IRQ_NO_SPI1),
+		   NVIC_GetPreemptPriority(IRQ_NO_EXTI0), NVIC_GetSubPriority(IRQ_NO_EXTI0));
+
+	EXTI_RegisterCallback(0, OuterCallback, NULL);
+	EXTI_RegisterCallback(1, InnerCallback, NULL);
+
+	// 1. Same preemption level, better sub-priority: no nesting
+	NVIC_SetPriority(IRQ_NO_EXTI0, NVIC_PLAN_PREEMPT_UI, 3);
+	NVIC_SetPriority(IRQ_NO_EXTI1, NVIC_PLAN_PREEMPT_UI, 0);
+	RaiseOuter();
+	printf(" >> Sub-priority only: %s\n", NestedIn ? "NESTED (FAIL)" : "not nested (OK)");
+
+	// 2. Better preemption level: nesting
+	NVIC_SetPreemptPriority(IRQ_NO_EXTI1, NVIC_PLAN_PREEMPT_DATA);
+	RaiseOuter();
+	printf(" >> Preemption level: %s\n", NestedIn ? "nested (OK)" : "NOT NESTED (FAIL)");
+
+	// 3. Lowering the priority again must not leave stale bits behind
+	NVIC_SetPreemptPriority(IRQ_NO_EXTI1, NVIC_PLAN_PREEMPT_BACKGROUND);
+	RaiseOuter();
+	printf(" >> Lowered again: %s\n", NestedIn ? "NESTED (FAIL)" : "not nested (OK)");
+
+	EXTI_UnregisterCallback(0);
+	EXTI_UnregisterCallback(1);
+	NVIC_ApplyPriorityPlan();
+
+	printf(" >> NVIC priority plan test is finished.\n");
+}
+
+/*!
+ * @fn			- EXTI_Test_Debounce
+ *
+ * @brief 		- Debounced user button (PC13): press toggles the LED (PA5), a 1 s press switches it off
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The main loop only calls DEBOUNCE_Process, no busy-wait delays
+*/
+void EXTI_Test_Debounce (void)
+{
+	printf(" >> Debounced user button test.\n");
+
+	// LED
+	LedHandle.p_GPIOx = GPIOA;
+	LedHandle.pinConfig.pinNumber = GPIO_PIN_NO_5;
+	LedHandle.pinConfig.pinMode = GPIO_MODE_OUT;
+	LedHandle.pinConfig.pinOPType = GPIO_OP_TYPE_PP;
+	LedHandle.pinConfig.pinPuPdControl = GPIO_NO_PUPD;
+	LedHandle.pinConfig.pinSpeed = GPIO_OP_SPEED_LOW;
+	GPIO_Init(&LedHandle);
+
+	// Button on both edges
+	GPIO_Handle_t ButtonHandle;
+	ButtonHandle.p_GPIOx = GPIOC;
+	ButtonHandle.pinConfig.pinNumber = GPIO_PIN_NO_13;
+	ButtonHandle.pinConfig.pinMode = GPIO_MODE_IT_FRT;
+	ButtonHandle.pinConfig.pinPuPdControl = GPIO_PIN_PU;
+	ButtonHandle.pinConfig.pinSpeed = GPIO_OP_SPEED_LOW;
+	GPIO_Init(&ButtonHandle);
+	IRQPriorityConfig(IRQ_NO_EXTI15_10, NVIC_IRQ_PRI15);
+
+	DEBOUNCE_Config_t ButtonConfig;
+	ButtonConfig.p_GPIOx = ButtonHandle.p_GPIOx;
+	ButtonConfig.pinNumber = ButtonHandle.pinConfig.pinNumber;
+	ButtonConfig.activeLevel = RESET;						// Nucleo user button pulls PC13 low
+	ButtonConfig.windowMs = 20;
+	ButtonConfig.longPressMs = 1000;
+	ButtonConfig.callback = ButtonEvent;
+	ButtonConfig.p_Context = NULL;
+
+	DEBOUNCE_Init(TIMEBASE_GetMs32);
+	DEBOUNCE_Add(&ButtonConfig);
+
+	while (1)
+	{
+		DEBOUNCE_Process();
+	}
+}
+
+/*!
+ * @fn			- EXTI_Test_EncoderBenchmark
+ *
+ * @brief 		- Finds the maximum edge rate of the EXTI quadrature decoder
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The DMA pattern generator plays a quadrature sequence on PA0 (A) / PA1 (B),
+ * 				  wired back to the encoder inputs: PA0 -> PC0, PA1 -> PC1.
+ * 				  Rates are given for the 16 MHz HSI reset clock.
+*/
+void EXTI_Test_EncoderBenchmark (void)
+{
+	printf(" >> Quadrature encoder edge rate benchmark.\n");
+
+	static const uint16_t quadrature[4] = { 0x0, 0x1, 0x3, 0x2 };		// AB: 00 -> 10 -> 11 -> 01
+	static const uint32_t periods[] = { 1600, 800, 400, 200, 160, 120, 100, 80, 60, 40 };
+	static uint32_t pattern[1024];
+
+	// 1. Generator outputs
+	GPIO_Handle_t PatternPin;
+	PatternPin.p_GPIOx = GPIOA;
+	PatternPin.pinConfig.pinMode = GPIO_MODE_OUT;
+	PatternPin.pinConfig.pinOPType = GPIO_OP_TYPE_PP;
+	PatternPin.pinConfig.pinPuPdControl = GPIO_NO_PUPD;
+	PatternPin.pinConfig.pinSpeed = GPIO_OP_SPEED_HIGH;
+	PatternPin.pinConfig.pinNumber = GPIO_PIN_NO_0;
+	GPIO_Init(&PatternPin);
+	PatternPin.pinConfig.pinNumber = GPIO_PIN_NO_1;
+	GPIO_Init(&PatternPin);
+
+	for (uint16_t i = 0; i < NUM_OF(pattern); ++i)
+	{
+		pattern[i] = GPIO_DMA_BSRR(quadrature[i & 0x3], 0x0003);
+	}
+
+	// 2. Decoder inputs
+	static ENCODER_Handle_t Encoder;
+	Encoder.p_GPIOx = GPIOC;
+	Encoder.pinA = GPIO_PIN_NO_0;
+	Encoder.pinB = GPIO_PIN_NO_1;
+	Encoder.pinPuPdControl = GPIO_NO_PUPD;
+
+	IRQPriorityConfig(IRQ_NO_EXTI0, NVIC_IRQ_PRI0);
+	IRQPriorityConfig(IRQ_NO_EXTI1, NVIC_IRQ_PRI0);
+
+	GPIO_WritePort(GPIOA, 0);
+	ENCODER_Init(&Encoder);
+
+	// 3. Sweep the edge rate
+	for (uint8_t i = 0; i < NUM_OF(periods); ++i)
+	{
+		GPIO_WritePort(GPIOA, 0);
+		ENCODER_Reset(&Encoder);
+
+		GPIO_DMA_PatternStart(GPIOA, pattern, NUM_OF(pattern), periods[i], DISABLE);
+		while (GPIO_DMA_PatternIsBusy());
+		GPIO_DMA_PatternStop();
+
+		int32_t expected = NUM_OF(pattern) - 1;		// The first step keeps 00
+		int32_t position = ENCODER_GetPosition(&Encoder);
+
+		printf(" >> %4lu kEdge/s: position %5ld / %5ld, illegal %lu\n",
+			   16000 / periods[i], position, expected, ENCODER_GetIllegalCount(&Encoder));
+	}
+
+	ENCODER_DeInit(&Encoder);
+
+	printf(" >> Quadrature encoder benchmark is finished.\n");
+}
+
+/*** EOF ***/
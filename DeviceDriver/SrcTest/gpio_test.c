@@ -9,23 +9,6 @@
 
 // === Protected Functions ===
 //
-/*!
- * @fn			- Delay
- *
- * @brief 		- Dummy delay as empty for loop (NOP)
- *
- * @param[in]	- duration: for loop limit
- * @param[out]	- none
- *
- * @return 		- none
- *
- * @note		- none
-*/
-static void Delay (uint32_t duration)
-{
-	for (uint32_t i = 0; i < duration; ++i);
-}
-
 /*!
  * @fn			- ConfigUserLED
  *
@@ -90,6 +73,97 @@ static void ConfigUserButtonIT (GPIO_Handle_t *p_GPIOHandle)
 	p_GPIOHandle->pinConfig.pinSpeed = GPIO_OP_SPEED_LOW;
 }
 
+/*!
+ * @fn			- UserButtonCallback
+ *
+ * @brief 		- EXTI callback of the user button input (PC13)
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[in]	- *p_Context: LED GPIO handle
+ *
+ * @return 		- none
+ *
+ * @note		- Called from EXTI15_10_IRQHandler, the pending bit is already cleared
+*/
+static void UserButtonCallback (uint8_t line, void *p_Context)
+{
+	GPIO_Handle_t *p_Led = (GPIO_Handle_t *)p_Context;
+
+	GPIO_TogglePin(p_Led->p_GPIOx, p_Led->pinConfig.pinNumber);		// Toggle the user LED
+}
+
+typedef struct LedBlink
+{
+	GPIO_Handle_t led;
+	EVLOOP_Timer_t timer;
+	uint8_t remaining;
+} LedBlink_t;
+
+/*!
+ * @fn			- LedBlinkStep
+ *
+ * @brief 		- Event loop timer handler of the LED toggle example
+ *
+ * @param[in]	- *p_Context: LedBlink_t instance
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Stops the loop after the requested number of toggles
+*/
+static void LedBlinkStep (void *p_Context)
+{
+	LedBlink_t *p_Blink = (LedBlink_t *)p_Context;
+
+	GPIO_TogglePin(p_Blink->led.p_GPIOx, p_Blink->led.pinConfig.pinNumber);
+
+	if (!--p_Blink->remaining)
+	{
+		EVLOOP_TimerStop(&p_Blink->timer);
+		EVLOOP_Stop();
+	}
+}
+
+/*!
+ * @fn			- CounterPatternStart
+ *
+ * @brief 		- Outputs a repeating 4 bit binary counter on PA0..PA3 by DMA
+ *
+ * @param[in]	- period: timer clock cycles per counter step
+ * @param[out]	- none
+ *
+ * @return 		- @DMA_STATUS of GPIO_DMA_PatternStart
+ *
+ * @note		- Stop it with GPIO_DMA_PatternStop
+*/
+static uint8_t CounterPatternStart (uint32_t period)
+{
+	static uint16_t values[16];
+	static uint32_t pattern[16];
+
+	GPIO_Handle_t PatternPin;
+	PatternPin.p_GPIOx = GPIOA;
+	PatternPin.pinConfig.pinMode = GPIO_MODE_OUT;
+	PatternPin.pinConfig.pinOPType = GPIO_OP_TYPE_PP;
+	PatternPin.pinConfig.pinPuPdControl = GPIO_NO_PUPD;
+	PatternPin.pinConfig.pinSpeed = GPIO_OP_SPEED_HIGH;
+
+	for (uint8_t pin = GPIO_PIN_NO_0; pin <= GPIO_PIN_NO_3; ++pin)
+	{
+		PatternPin.pinConfig.pinNumber = pin;
+		GPIO_Init(&PatternPin);
+	}
+
+	// Binary counter on the low nibble
+	for (uint16_t i = 0; i < NUM_OF(values); ++i)
+	{
+		values[i] = i;
+	}
+	GPIO_DMA_BuildPattern(pattern, values, NUM_OF(values), 0x000f);
+
+	return GPIO_DMA_PatternStart(GPIOA, pattern, NUM_OF(pattern), period, ENABLE);
+}
+
 
 // === Public API Functions ===
 //
@@ -120,12 +194,49 @@ void GPIO_Test_LedToggleNoIT (uint8_t cycle)
 	for (uint8_t i = 0; i < cycle; ++i)
 	{
 		GPIO_TogglePin(GPIOhandle.p_GPIOx, GPIOhandle.pinConfig.pinNumber);
-		Delay(500000);
+		TIMEBASE_DelayMs(200);
 	}
 
 	printf(" >> LED toggle test is finished.\n");
 }
 
+/*!
+ * @fn			- GPIO_Test_LedToggleEvLoop
+ *
+ * @brief 		- GPIO_Test_LedToggleNoIT ported to the event loop
+ *
+ * @param[in]	- cycle: number of toggles, 250 ms apart
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The core sleeps in WFI between the toggles, the CPU load is printed at the end
+*/
+void GPIO_Test_LedToggleEvLoop (uint8_t cycle)
+{
+	printf(" >> LED toggling from the event loop.\n");
+
+	static LedBlink_t Blink;
+
+	if (!cycle)
+	{
+		return;
+	}
+
+	ConfigUserLED(&Blink.led);
+	GPIO_Init(&Blink.led);
+	Blink.remaining = cycle;
+
+	EVLOOP_Init();
+	EVLOOP_TimerInit(&Blink.timer, LedBlinkStep, &Blink);
+	EVLOOP_TimerStart(&Blink.timer, EVLOOP_MS(250), EVLOOP_MS(250));
+	EVLOOP_Run();
+
+	uint16_t load = EVLOOP_GetLoad();
+	EVLOOP_DeInit();
+	printf(" >> LED toggle test is finished, CPU load %u.%u %%.\n", load / 10, load % 10);
+}
+
 /*!
  * @fn			- GPIO_Test_LedToggleByButton
  *
@@ -160,7 +271,7 @@ void GPIO_Test_LedToggleByButton (void)
 		// Polling input
 		if (BUTTON_PRESSED == GPIO_ReadPin(ButtonHandle.p_GPIOx, ButtonHandle.pinConfig.pinNumber) )
 		{
-			Delay(100000);
+			TIMEBASE_DelayMs(40);
 			if (toggleFlag)
 			{
 				toggleFlag = 0;
@@ -176,7 +287,7 @@ void GPIO_Test_LedToggleByButton (void)
 			// NOP
 		}
 
-		Delay(100000);
+		TIMEBASE_DelayMs(40);
 	}
 }
 
@@ -206,13 +317,17 @@ void GPIO_Test_LedToggleByButtonIT (void)
 	GPIO_Init(&LedHandle);
 	GPIO_Init(&ButtonHandle);
 
+	GPIO_WritePin(LedHandle.p_GPIOx, LedHandle.pinConfig.pinNumber, 0);		// Initialize LED to be switched off
+
 	// IRQ Configuration
 	IRQPriorityConfig(IRQ_NO_EXTI15_10, NVIC_IRQ_PRI15);
-	IRQInterruptConfig(IRQ_NO_EXTI15_10, ENABLE);
+	EXTI_RegisterCallback(ButtonHandle.pinConfig.pinNumber, UserButtonCallback, &LedHandle);
 
-	GPIO_WritePin(LedHandle.p_GPIOx, LedHandle.pinConfig.pinNumber, 0);		// Initialize LED to be switched off
-
-	while (1);
+	// Interrupt driven from here: the core sleeps between the button edges
+	while (1)
+	{
+		SLEEP_OnExit();
+	}
 }
 
 /*!
@@ -243,21 +358,166 @@ void GPIO_Test_ClockOut (void)
 }
 
 /*!
- * @fn			- EXTI15_10_IRQHandler
+ * @fn			- GPIO_Test_DmaPatternAndSample
  *
- * @brief 		- ISR Handler for GPIO user button input (PC13)
+ * @brief 		- Outputs a 4 bit binary counter on PA0..PA3 by DMA and samples it back on the same port
+ *
+ * @param[in]	- period: timer clock cycles per pattern step (16 => 1 MHz at the 16 MHz reset clock)
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- The sampler runs at the same rate, so every step is expected to be captured.
+ * 				  A failed start gives back what was claimed and releases PA0..PA3.
+*/
+void GPIO_Test_DmaPatternAndSample (uint32_t period)
+{
+	printf(" >> DMA pattern generator and sampler test.\n");
+
+	static uint16_t samples[64];
+	uint8_t status;
+
+	status = CounterPatternStart(period);
+	if (DMA_OK != status)
+	{
+		printf(" >> Pattern start failed: status %u\n", status);
+		GPIO_DeInit(GPIOA);
+		return;
+	}
+
+	status = GPIO_DMA_SampleStart(GPIOA, samples, NUM_OF(samples), period, DISABLE);
+	if (DMA_OK != status)
+	{
+		printf(" >> Sampler start failed: status %u\n", status);
+		GPIO_DMA_PatternStop();
+		GPIO_DeInit(GPIOA);
+		return;
+	}
+
+	while (GPIO_DMA_SampleIsBusy());
+	GPIO_DMA_SampleStop();
+	GPIO_DMA_PatternStop();
+
+	for (uint8_t i = 0; i < NUM_OF(samples); ++i)
+	{
+		printf(" >> %2u: 0x%x\n", i, samples[i] & 0x000f);
+	}
+
+	printf(" >> DMA pattern test is finished.\n");
+}
+
+/*!
+ * @fn			- GPIO_Test_CaptureBenchmark
+ *
+ * @brief 		- Captures the DMA generated counter on PA0..PA3 and reports the sampling rate and compression
+ *
+ * @param[in]	- period: timer clock cycles per pattern step
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Rates are printed for the 16 MHz HSI reset clock. The window is sized to the ring:
+ * 				  NUM_OF(ring) - 1 pattern steps. A truncated capture is reported.
+*/
+void GPIO_Test_CaptureBenchmark (uint32_t period)
+{
+	printf(" >> RLE capture benchmark, pattern period: %lu cycles.\n", period);
+
+	static GPIO_CaptureRecord_t ring[1024];
+
+	// One record per counter step: the window the ring holds, the first record being the initial value
+	uint32_t window = period * (NUM_OF(ring) - 1);
+
+	uint8_t status = CounterPatternStart(period);
+	if (DMA_OK != status)
+	{
+		printf(" >> Pattern start failed: status %u\n", status);
+		GPIO_DeInit(GPIOA);
+		return;
+	}
+
+	GPIO_Capture_t Capture;
+	Capture.p_GPIOx = GPIOA;
+	Capture.pinMask = 0x000f;
+	Capture.mode = GPIO_CAPTURE_MODE_STOP;
+	Capture.p_Ring = ring;
+	Capture.size = NUM_OF(ring);
+
+	status = GPIO_Capture_Init(&Capture);
+	if (GPIO_CAPTURE_OK != status)
+	{
+		printf(" >> Capture init failed: status %u\n", status);
+		GPIO_DMA_PatternStop();
+		GPIO_DeInit(GPIOA);
+		return;
+	}
+	uint16_t records = GPIO_Capture_Run(&Capture, window);
+	GPIO_DMA_PatternStop();
+
+	// A zero window or an empty ring leaves nothing to divide by
+	uint32_t rateKHz = Capture.cycles ? (uint32_t)(((uint64_t)Capture.samples * 16000) / Capture.cycles) : 0;
+	uint32_t ratio = records ? (Capture.samples * 2) / ((uint32_t)records * sizeof(GPIO_CaptureRecord_t)) : 0;
+
+	printf(" >> Window: %lu of %lu cycles%s\n", Capture.cycles, window, Capture.overflow ? ", truncated: ring full" : "");
+	printf(" >> Samples: %lu in %lu cycles => %lu kS/s\n", Capture.samples, Capture.cycles, rateKHz);
+	printf(" >> Records: %u (overflow: %u), compression: %lu:1\n", records, Capture.overflow, ratio);
+
+	GPIO_Capture_DumpITM(&Capture, GPIO_CAPTURE_ITM_PORT);
+
+	printf(" >> RLE capture benchmark is finished.\n");
+}
+
+/*!
+ * @fn			- GPIO_Test_SnapshotRestore
+ *
+ * @brief 		- Measures the wake-to-operational time of the snapshot restore against GPIO_Init
  *
  * @param[in]	- none
  * @param[out]	- none
  *
  * @return 		- none
  *
- * @note		- none
+ * @note		- Ports A-C are switched to analog (SWD PA13/PA14 kept) as before entering stop mode
 */
-void EXTI15_10_IRQHandler (void)
+void GPIO_Test_SnapshotRestore (void)
 {
-	GPIO_IRQHandling(GPIO_PIN_NO_13);			// Clearing the pending register from the EXTI
-	GPIO_TogglePin(GPIOA, GPIO_PIN_NO_5);		// Toogle the user LED
+	printf(" >> GPIO snapshot / restore test.\n");
+
+	GPIO_Handle_t LedHandle, ButtonHandle;
+	GPIO_Snapshot_t Snapshot[3] = { { .p_GPIOx = GPIOA }, { .p_GPIOx = GPIOB }, { .p_GPIOx = GPIOC } };
+
+	DWT_CYCCNT_EN();
+
+	// 1. Operational configuration, measured with GPIO_Init
+	ConfigUserLED(&LedHandle);
+	ConfigUserButton(&ButtonHandle);
+
+	uint32_t start = DWT_CYCCNT();
+	GPIO_Init(&LedHandle);
+	GPIO_Init(&ButtonHandle);
+	uint32_t initCycles = DWT_CYCCNT() - start;
+
+	GPIO_WritePin(LedHandle.p_GPIOx, LedHandle.pinConfig.pinNumber, SET);
+
+	// 2. Save and go analog
+	start = DWT_CYCCNT();
+	GPIO_SnapshotSave(Snapshot, NUM_OF(Snapshot));
+	uint32_t saveCycles = DWT_CYCCNT() - start;
+
+	GPIO_SetPortAnalog(GPIOA, (1 << 13) | (1 << 14));
+	GPIO_SetPortAnalog(GPIOB, 0);
+	GPIO_SetPortAnalog(GPIOC, 0);
+
+	// 3. Wake-up: restore
+	start = DWT_CYCCNT();
+	GPIO_SnapshotRestore(Snapshot, NUM_OF(Snapshot));
+	uint32_t restoreCycles = DWT_CYCCNT() - start;
+
+	printf(" >> GPIO_Init (2 pins): %lu cycles\n", initCycles);
+	printf(" >> Snapshot save (3 ports): %lu cycles, restore (3 ports): %lu cycles\n", saveCycles, restoreCycles);
+	printf(" >> LED after restore: %u\n", GPIO_ReadPin(GPIOA, GPIO_PIN_NO_5));
+
+	printf(" >> GPIO snapshot / restore test is finished.\n");
 }
 
 /*** EOF ***/
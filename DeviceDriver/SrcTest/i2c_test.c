@@ -0,0 +1,447 @@
+/** @file i2c_test.c
+*
+* @brief I2C master register read / block read test flows.
+*
+*/
+
+#include "i2c_test.h"
+
+
+// === Private Variables ===
+//
+static I2C_Handle_t I2cHandle;							// Bound to the vector table: static
+static uint8_t RxBlock[I2C_TEST_BLOCK_SIZE];
+static volatile uint16_t CmpltEvents, NackEvents, ErrorEvents;
+static volatile uint8_t BatchDone;
+static volatile uint32_t BatchEnd;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- I2C1_PinInit
+ *
+ * @brief 		- Configures the pinouts of I2C1 interface
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Open drain: the bus needs its external pull-ups (4.7 kOhm at 100 kHz,
+ * 				  2.2 kOhm at 400 kHz), the internal ones only help a short wire
+*/
+static void I2C1_PinInit (void)
+{
+	GPIO_Handle_t I2Cpin;
+
+	I2Cpin.p_GPIOx 						= GPIOB;
+	I2Cpin.pinConfig.pinMode 			= GPIO_MODE_ALTFN;
+	I2Cpin.pinConfig.pinAltFunMode 		= GPIO_AF4;
+	I2Cpin.pinConfig.pinOPType 			= GPIO_OP_TYPE_OD;
+	I2Cpin.pinConfig.pinPuPdControl 	= GPIO_PIN_PU;
+	I2Cpin.pinConfig.pinSpeed			= GPIO_OP_SPEED_HIGH;
+
+	// SCL
+	I2Cpin.pinConfig.pinNumber = GPIO_PIN_NO_8;
+	GPIO_Init(&I2Cpin);
+
+	// SDA
+	I2Cpin.pinConfig.pinNumber = GPIO_PIN_NO_9;
+	GPIO_Init(&I2Cpin);
+}
+
+/*!
+ * @fn			- I2C1_Init
+ *
+ * @brief 		- Configures I2C1 as master with its DMA streams and interrupts
+ *
+ * @param[in]	- sclSpeed: Hz
+ * @param[in]	- dmaThreshold: phases from this length on use DMA, 0: interrupts only
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- Every event runs in the ISR: the flows wait in I2C_MasterTransfer.
+ * 				  A failed init is undone here, the caller only closes after I2C_OK.
+*/
+static uint8_t I2C1_Init (uint32_t sclSpeed, uint8_t dmaThreshold)
+{
+	uint8_t status;
+
+	I2cHandle.p_I2Cx 					= I2C1;
+	I2cHandle.I2cConfig.sclSpeed 		= sclSpeed;
+	I2cHandle.I2cConfig.fmDuty 			= I2C_FM_DUTY_2;
+	I2cHandle.I2cConfig.dmaThreshold 	= dmaThreshold;
+	I2cHandle.fastEvents 				= 0xFF;
+
+	status = I2C_Init(&I2cHandle);
+	if (I2C_OK != status)
+	{
+		I2C_DeInit(&I2cHandle);		// Clock reference, streams and register state of the partial init
+		return status;
+	}
+
+	I2C_IRQBind(&I2cHandle, ENABLE);
+	for (uint8_t line = I2C_IRQ_EV; line <= I2C_IRQ_RX_DMA; ++line)
+	{
+		uint8_t IRQNumber = I2C_IRQNumber(&I2cHandle, line);		// No RX stream without DMA
+
+		if (IRQ_NO_NONE != IRQNumber)
+		{
+			NVIC_SetPriority(IRQNumber, NVIC_PLAN_PREEMPT_DATA, 3);
+			IRQInterruptConfig(IRQNumber, ENABLE);
+		}
+	}
+
+	return I2C_OK;
+}
+
+/*!
+ * @fn			- I2C1_Close
+ *
+ * @brief 		- Releases I2C1, its streams and its interrupts
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void I2C1_Close (void)
+{
+	for (uint8_t line = I2C_IRQ_EV; line <= I2C_IRQ_RX_DMA; ++line)
+	{
+		if (IRQ_NO_NONE != I2C_IRQNumber(&I2cHandle, line))
+		{
+			IRQInterruptConfig(I2C_IRQNumber(&I2cHandle, line), DISABLE);
+		}
+	}
+	I2C_IRQBind(&I2cHandle, DISABLE);
+	I2C_DeInit(&I2cHandle);
+}
+
+/*!
+ * @fn			- EepromRead
+ *
+ * @brief 		- Random / sequential read of the EEPROM
+ *
+ * @param[in]	- memAddr: first byte
+ * @param[out]	- *p_Buffer: data
+ * @param[in]	- len: bytes
+ *
+ * @return 		- @I2C_STATUS
+ *
+ * @note		- Two address bytes written, then the data read after a repeated START
+*/
+static uint8_t EepromRead (uint16_t memAddr, uint8_t *p_Buffer, uint16_t len)
+{
+	uint8_t addr[2] = { (uint8_t)(memAddr >> 8), (uint8_t)memAddr };
+
+	return I2C_MasterTransfer(&I2cHandle, I2C_TEST_EEPROM_ADDR, addr, sizeof(addr), p_Buffer, len, I2C_TEST_TIMEOUT_US);
+}
+
+/*!
+ * @fn			- BatchDoneHook
+ *
+ * @brief 		- End of a polling batch, ISR context
+ *
+ * @param[in]	- *p_Context: unused
+ * @param[in]	- *p_Segments: unused, the flow reads the results itself
+ * @param[in]	- failed: unused
+ *
+ * @return 		- none
+ *
+ * @note		- Stamps the end before the thread gets to run
+*/
+static void BatchDoneHook (void *p_Context, I2C_Segment_t *p_Segments, uint8_t failed)
+{
+	(void)p_Context;
+	(void)p_Segments;
+	(void)failed;
+
+	BatchEnd = DWT_CYCCNT();
+	BatchDone = SET;
+}
+
+/*!
+ * @fn			- CyclesToUs
+ *
+ * @brief 		- Converts core cycles to microseconds at the current HCLK
+ *
+ * @param[in]	- cycles: DWT cycles
+ * @param[out]	- none
+ *
+ * @return 		- Microseconds
+ *
+ * @note		- none
+*/
+static uint32_t CyclesToUs (uint32_t cycles)
+{
+	return cycles / (CLOCK_GetHclk() / 1000000U);
+}
+
+
+// === Public API Functions ===
+//
+/*!
+ * @fn			- I2C_Test_EepromBenchmark
+ *
+ * @brief 		- Register read latency and block read throughput of I2C1 at 100 kHz, 400 kHz and 1 MHz
+ *
+ * @param[in]	- cycle: reads per measurement
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- PIN Alternate Function Mode: AF4
+ * 				  Nucleo F446RE Board, 24xx256 EEPROM at address 0x50 on
+ * 				  	 PB8: I2C1_SCL (CN5 10, D15)
+ * 				  	 PB9: I2C1_SDA (CN5 9, D14)
+ * 				  A random read is 48 bit times on the bus (START, address, two memory address bytes,
+ * 				  repeated START, address, data, STOP), a sequential read 9 bit times per byte.
+ * 				  1 MHz is fast mode plus, which I2C1..3 refuse: it is listed to show the limit.
+*/
+void I2C_Test_EepromBenchmark (uint16_t cycle)
+{
+	const uint32_t speeds[] = { I2C_SCL_SPEED_SM, I2C_SCL_SPEED_FM, 1000000U };
+	const uint8_t thresholds[] = { 0, I2C_TEST_DMA_THRESHOLD };
+
+	printf(" $ Executing I2C EEPROM Benchmark...\n");
+
+	CLOCK_Switch(CLOCK_PROFILE_PERFORMANCE);
+	I2C1_PinInit();
+
+	for (uint8_t s = 0; s < NUM_OF(speeds); ++s)
+	{
+		uint32_t minCycles = UINT32_MAX, maxCycles = 0, sumCycles = 0;
+		uint16_t reads = 0;
+		uint8_t status;
+		uint8_t value;
+
+		// 1. Register read latency: one byte, interrupts only
+		status = I2C1_Init(speeds[s], 0);
+		if (I2C_OK != status)
+		{
+			printf(" $ %lu Hz out of reach of I2C1 (PCLK1 %lu Hz, status %u).\n", speeds[s], CLOCK_GetPclk1(), status);
+			continue;
+		}
+
+		CmpltEvents = 0;
+		NackEvents = 0;
+		ErrorEvents = 0;
+		I2cHandle.IrqCount = 0;
+
+		for (uint16_t round = 0; round < cycle; ++round)
+		{
+			uint32_t start = DWT_CYCCNT();
+			status = EepromRead(round, &value, 1);
+			uint32_t cycles = DWT_CYCCNT() - start;
+
+			if (I2C_OK != status)
+			{
+				break;
+			}
+
+			sumCycles += cycles;
+			minCycles = (cycles < minCycles) ? cycles : minCycles;
+			maxCycles = (cycles > maxCycles) ? cycles : maxCycles;
+			reads++;
+		}
+
+		// Averages over the completed reads: an error ends the loop early
+		uint32_t scl = I2C_GetSclSpeed(I2C1);
+
+		printf(" $ %lu Hz (SCL %lu Hz): register read %lu / %lu / %lu us (min / avg / max), bus %lu us, IRQs %lu per read\n",
+			   speeds[s], scl, CyclesToUs(reads ? minCycles : 0), CyclesToUs(sumCycles / (reads ? reads : 1)), CyclesToUs(maxCycles),
+			   (48U * 1000000U) / scl, I2cHandle.IrqCount / (reads ? reads : 1));
+		printf("   status %u, reads %u of %u, completed %u, NACK %u, errors %u (0x%04x)\n",
+			   status, reads, cycle, CmpltEvents, NackEvents, ErrorEvents, I2cHandle.ErrorFlags);
+
+		I2C1_Close();
+
+		// 2. Block read throughput: interrupt per byte against DMA
+		for (uint8_t t = 0; t < NUM_OF(thresholds); ++t)
+		{
+			uint32_t bytes = 0, cycles = 0;
+
+			if (I2C_OK != I2C1_Init(speeds[s], thresholds[t]))
+			{
+				continue;
+			}
+			I2cHandle.IrqCount = 0;
+
+			for (uint16_t round = 0; round < cycle; ++round)
+			{
+				uint32_t start = DWT_CYCCNT();
+				status = EepromRead(0, RxBlock, sizeof(RxBlock));
+				cycles += DWT_CYCCNT() - start;
+
+				if (I2C_OK != status)
+				{
+					break;
+				}
+				bytes += sizeof(RxBlock);
+			}
+
+			// 9 bits per byte on the line: the efficiency is the payload rate against SCL / 9
+			uint32_t us = CyclesToUs(cycles);
+			uint32_t rate = us ? (uint32_t)(((uint64_t)bytes * 1000000U) / us) : 0;
+			uint32_t efficiency = (uint32_t)(((uint64_t)rate * 1000U) / (scl / 9));
+
+			printf(" $ %lu Hz %s: %lu B in %lu us, %lu B/s, %lu.%lu %% of the line, IRQs %lu (status %u)\n",
+				   speeds[s], thresholds[t] ? "DMA" : "IT ", bytes, us, rate, efficiency / 10, efficiency % 10,
+				   I2cHandle.IrqCount, status);
+
+			I2C1_Close();
+		}
+	}
+
+	CLOCK_Switch(CLOCK_PROFILE_LOW_POWER);
+
+	printf(" $ ... Finished I2C EEPROM Benchmark.\n");
+}
+
+/*!
+ * @fn			- I2C_Test_BatchPoll
+ *
+ * @brief 		- One polling round of several sensors: blocking reads one by one against one batch
+ *
+ * @param[in]	- cycle: polling rounds per variant
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Wiring of I2C_Test_EepromBenchmark, 400 kHz, DMA from I2C_TEST_DMA_THRESHOLD bytes on.
+ * 				  The EEPROM stands in for three sensors at different memory addresses; the IMU at 0x68
+ * 				  is optional and shows that a NACKed segment does not end the batch. The thread
+ * 				  counts its free loop turns while the batch runs.
+*/
+void I2C_Test_BatchPoll (uint16_t cycle)
+{
+	static const uint8_t eepromTemp[2] = { 0x00, 0x00 };
+	static const uint8_t eepromAccel[2] = { 0x00, 0x40 };
+	static const uint8_t eepromLog[2] = { 0x01, 0x00 };
+	static const uint8_t imuAccel[1] = { 0x3B };
+	static uint8_t temp[2], accel[6], imu[14], history[32];
+	I2C_Segment_t segments[] =
+	{
+		{ I2C_TEST_EEPROM_ADDR, I2C_OK, sizeof(eepromTemp), sizeof(temp), eepromTemp, temp },
+		{ I2C_TEST_EEPROM_ADDR, I2C_OK, sizeof(eepromAccel), sizeof(accel), eepromAccel, accel },
+		{ I2C_TEST_IMU_ADDR, I2C_OK, sizeof(imuAccel), sizeof(imu), imuAccel, imu },
+		{ I2C_TEST_EEPROM_ADDR, I2C_OK, sizeof(eepromLog), sizeof(history), eepromLog, history },
+	};
+	uint32_t seqCycles = 0, batchCycles = 0, startCycles = 0, freeTurns = 0, batchIrqs = 0;
+	uint16_t batches = 0;
+
+	printf(" $ Executing I2C Batch Poll Test...\n");
+
+	CLOCK_Switch(CLOCK_PROFILE_PERFORMANCE);
+	I2C1_PinInit();
+
+	if (I2C_OK != I2C1_Init(I2C_SCL_SPEED_FM, I2C_TEST_DMA_THRESHOLD))
+	{
+		printf(" $ 400 kHz out of reach of I2C1 (PCLK1 %lu Hz).\n", CLOCK_GetPclk1());
+		CLOCK_Switch(CLOCK_PROFILE_LOW_POWER);
+		return;
+	}
+
+	// 1. One blocking transaction per sensor: STOP, bus free time and a thread round trip in between
+	for (uint16_t round = 0; round < cycle; ++round)
+	{
+		uint32_t start = DWT_CYCCNT();
+
+		for (uint8_t i = 0; i < NUM_OF(segments); ++i)
+		{
+			segments[i].result = I2C_MasterTransfer(&I2cHandle, segments[i].devAddr, segments[i].p_TxBuffer, segments[i].txLen,
+													segments[i].p_RxBuffer, segments[i].rxLen, I2C_TEST_TIMEOUT_US);
+		}
+		seqCycles += DWT_CYCCNT() - start;
+	}
+
+	printf(" $ One by one: %lu us per round, results", CyclesToUs(seqCycles / (cycle ? cycle : 1)));
+	for (uint8_t i = 0; i < NUM_OF(segments); ++i)
+	{
+		printf(" %u", segments[i].result);
+	}
+	printf("\n");
+
+	// 2. The same reads as one batch: repeated STARTs, the ISR loads each segment
+	I2cHandle.IrqCount = 0;
+
+	for (uint16_t round = 0; round < cycle; ++round)
+	{
+		TIMEBASE_Timeout_t timeout;
+		uint32_t start = DWT_CYCCNT();
+
+		BatchDone = RESET;
+		if (I2C_OK != I2C_BatchStartIT(&I2cHandle, segments, NUM_OF(segments), BatchDoneHook, NULL))
+		{
+			break;
+		}
+		startCycles += DWT_CYCCNT() - start;
+
+		TIMEBASE_TimeoutStart(&timeout, I2C_TEST_TIMEOUT_US);
+		while (!BatchDone && !TIMEBASE_TimeoutExpired(&timeout))
+		{
+			freeTurns++;
+		}
+		if (!BatchDone)
+		{
+			I2C_Abort(&I2cHandle);
+			break;
+		}
+		batchCycles += BatchEnd - start;
+		batches++;
+	}
+	batchIrqs = I2cHandle.IrqCount;
+
+	// Per round over the completed batches: a failed start or a timeout ends the loop early
+	printf(" $ Batch:      %lu us per round, start call %lu cycles, %lu IRQs and %lu free thread turns per round, failed %u, rounds %u of %u, results",
+		   CyclesToUs(batchCycles / (batches ? batches : 1)), startCycles / (batches ? batches : 1), batchIrqs / (batches ? batches : 1),
+		   freeTurns / (batches ? batches : 1), I2cHandle.BatchFailed, batches, cycle);
+	for (uint8_t i = 0; i < NUM_OF(segments); ++i)
+	{
+		printf(" %u", segments[i].result);
+	}
+	printf("\n");
+
+	I2C1_Close();
+	CLOCK_Switch(CLOCK_PROFILE_LOW_POWER);
+
+	printf(" $ ... Finished I2C Batch Poll Test.\n");
+}
+
+/*!
+ * @fn			- I2C_API_EventCallback
+ *
+ * @brief 		- Application callback of the I2C test flows
+ *
+ * @param[in]	- *p_I2cHandle: pointer to the I2C Handler
+ * @param[in]	- appEvent: @I2C_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- Counts only: the flows wait for the result themselves
+*/
+void I2C_API_EventCallback (I2C_Handle_t *p_I2cHandle, uint8_t appEvent)
+{
+	switch (appEvent)
+	{
+		case I2C_EVENT_CMPLT:
+			CmpltEvents++;
+			break;
+		case I2C_EVENT_NACK:
+			NackEvents++;
+			break;
+		case I2C_EVENT_BATCH_CMPLT:
+			BatchEnd = DWT_CYCCNT();
+			BatchDone = SET;
+			break;
+		default:
+			ErrorEvents++;
+			break;
+	}
+}
+
+/*** EOF ***/
@@ -0,0 +1,490 @@
+/** @file irq_test.c
+*
+* @brief Interrupt infrastructure (vector table, NVIC) test flows.
+*
+* The TIM7 vector is used as a software interrupt: it is pended through the NVIC, the timer
+* itself is not clocked. TIM6 is the periodic wake-up source of the sleep tests.
+*
+*/
+
+#include "irq_test.h"
+
+
+// === Private Variables ===
+//
+static volatile uint32_t EntryStamp;		// DWT CYCCNT at the handler entry
+static volatile uint8_t Entered;
+static volatile uint32_t SharedCounter;		// Incremented by thread code and by the TIM7 ISR
+static volatile uint32_t IsrTicks;
+static volatile uint16_t WakeCount;			// TIM6 wake-ups sampled in the current sleep mode
+static uint16_t WakeTarget;
+static uint32_t WakeMin, WakeMax, WakeSum;		// TIM6 ticks from the update event to the handler
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- RamEntry
+ *
+ * @brief 		- Plain handler placed in SRAM
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+_RAMFUNC static void RamEntry (void)
+{
+	EntryStamp = DWT_CYCCNT();
+	Entered = SET;
+}
+
+/*!
+ * @fn			- ContextEntry
+ *
+ * @brief 		- Registered handler: gets its flag through the context
+ *
+ * @param[in]	- *p_Context: pointer to the entry flag
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+_RAMFUNC static void ContextEntry (void *p_Context)
+{
+	EntryStamp = DWT_CYCCNT();
+	*(volatile uint8_t *)p_Context = SET;
+}
+
+#if IRQ_PROFILE_ENABLE
+/*!
+ * @fn			- NopCallback
+ *
+ * @brief 		- Empty EXTI callback
+ *
+ * @param[in]	- line: EXTI line number
+ * @param[in]	- *p_Context: not used
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void NopCallback (uint8_t line, void *p_Context)
+{
+}
+#endif
+
+/*!
+ * @fn			- TickEntry
+ *
+ * @brief 		- TIM7 update handler of the atomics test: increments the shared counter
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+_RAMFUNC static void TickEntry (void)
+{
+	TIM7->SR = ~(1 << TIM_SRREG_UIF);
+	SharedCounter++;
+	IsrTicks++;
+}
+
+/*!
+ * @fn			- CountRace
+ *
+ * @brief 		- Increments the shared counter from thread mode while the TIM7 interrupt does the same
+ *
+ * @param[in]	- atomic: SET uses ATOMIC_FetchAdd, RESET a plain increment
+ * @param[in]	- count: thread mode increments
+ *
+ * @return 		- Lost increments
+ *
+ * @note		- none
+*/
+static uint32_t CountRace (uint8_t atomic, uint32_t count)
+{
+	SharedCounter = 0;
+	IsrTicks = 0;
+	TIM7->CNT = 0;
+	TIM7->CR1 |= (1 << TIM_CR1REG_CEN);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (atomic)
+		{
+			ATOMIC_FetchAdd(&SharedCounter, 1);
+		}
+		else
+		{
+			SharedCounter++;
+		}
+	}
+
+	TIM7->CR1 &= ~(1 << TIM_CR1REG_CEN);
+
+	return (count + IsrTicks) - SharedCounter;
+}
+
+/*!
+ * @fn			- MeasureEntry
+ *
+ * @brief 		- Pends the TIM7 vector and measures the pend-to-handler cycles
+ *
+ * @param[in]	- *p_Name: row title
+ * @param[in]	- cycle: number of measurements
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void MeasureEntry (const char *p_Name, uint16_t cycle)
+{
+	uint32_t min = UINT32_MAX, max = 0, sum = 0;
+
+	for (uint16_t i = 0; i < cycle; ++i)
+	{
+		Entered = RESET;
+		uint32_t stamp = DWT_CYCCNT();
+		NVIC_SetPending(IRQ_NO_TIM7);
+		while (!Entered);
+
+		uint32_t latency = EntryStamp - stamp;
+		min = (latency < min) ? latency : min;
+		max = (latency > max) ? latency : max;
+		sum += latency;
+	}
+
+	printf(" >> %-28s min %3lu, max %3lu, avg %3lu cycles\n", p_Name, min, max, sum / cycle);
+}
+
+
+/*!
+ * @fn			- MeasureWake
+ *
+ * @brief 		- Waits for the TIM6 wake-ups in the given sleep mode and prints the wake-up latency
+ *
+ * @param[in]	- mode: @SLEEP_MODE
+ * @param[in]	- cycle: number of wake-ups
+ *
+ * @return 		- none
+ *
+ * @note		- The latency is the TIM6 count read by the handler: the update event (counter reload)
+ * 				  to the first handler instruction, in timer clock ticks
+*/
+static void MeasureWake (uint8_t mode, uint16_t cycle)
+{
+	const char *modeName[] = { "busy", "WFI", "WFE", "sleep-on-exit" };
+
+	WakeMin = UINT32_MAX;
+	WakeMax = 0;
+	WakeSum = 0;
+	WakeCount = 0;
+	WakeTarget = cycle;
+
+	TIM6->CNT = 0;
+	TIM6->SR = 0;
+	TIM6->CR1 |= (1 << TIM_CR1REG_CEN);
+
+	switch (mode)
+	{
+		case SLEEP_MODE_WFI:
+			while (WakeCount < cycle)
+			{
+				SLEEP_WaitForInterrupt();
+			}
+			break;
+
+		case SLEEP_MODE_WFE:
+			SLEEP_EventOnPend(ENABLE);
+			while (WakeCount < cycle)
+			{
+				SLEEP_WaitForEvent();
+			}
+			SLEEP_EventOnPend(DISABLE);
+			break;
+
+		case SLEEP_MODE_ON_EXIT:
+			SLEEP_OnExit();
+			break;
+
+		default:
+			while (WakeCount < cycle);
+			break;
+	}
+
+	TIM6->CR1 &= ~(1 << TIM_CR1REG_CEN);
+
+	printf(" >> %-13s wake-up latency: min %lu, mean %lu, max %lu ticks\n",
+		   modeName[mode], WakeMin, WakeSum / cycle, WakeMax);
+}
+
+// === Public API Functions ===
+//
+/*!
+ * @fn			- IRQ_Test_VectorEntry
+ *
+ * @brief 		- Compares the entry cycles of the flash table, the SRAM table and the context dispatcher
+ *
+ * @param[in]	- cycle: number of measurements per variant
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- At the 16 MHz reset clock the flash runs with 0 wait states, the difference of the
+ * 				  RAM placed handlers shows up with the PLL clock profiles
+*/
+void IRQ_Test_VectorEntry (uint16_t cycle)
+{
+	printf(" >> Vector table entry test.\n");
+
+	DWT_CYCCNT_EN();
+	NVIC_SetPriority(IRQ_NO_TIM7, NVIC_PLAN_PREEMPT_CRITICAL, 0);
+	IRQInterruptConfig(IRQ_NO_TIM7, ENABLE);
+
+	// 1. Link-time table and handler
+	MeasureEntry("Flash table, flash ISR:", cycle);
+
+	// 2. SRAM table, the entry still points to the flash handler
+	VECTOR_Init();
+	printf(" >> VTOR: 0x%08lx\n", SCB->VTOR);
+	MeasureEntry("SRAM table, flash ISR:", cycle);
+
+	// 3. SRAM table, SRAM handler
+	VECTOR_SetRaw(IRQ_NO_TIM7, RamEntry);
+	MeasureEntry("SRAM table, SRAM ISR:", cycle);
+
+	// 4. Handler + context through the dispatcher
+	VECTOR_Register(IRQ_NO_TIM7, ContextEntry, (void *)&Entered);
+	MeasureEntry("SRAM table, dispatch + ctx:", cycle);
+
+	IRQInterruptConfig(IRQ_NO_TIM7, DISABLE);
+	VECTOR_Unregister(IRQ_NO_TIM7);
+
+	printf(" >> Vector table entry test is finished.\n");
+}
+
+/*!
+ * @fn			- IRQ_Test_Atomics
+ *
+ * @brief 		- Lost updates of plain vs. LDREX/STREX increments, BASEPRI masking per level
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- TIM7 updates every 97 cycles, an odd period so it hits every instruction of the loop
+*/
+void IRQ_Test_Atomics (void)
+{
+	printf(" >> Atomics and BASEPRI test.\n");
+
+	NVIC_ApplyPriorityPlan();
+
+	// 1. Shared counter: plain vs. exclusive monitor increment
+	PCLK_Control(&RCC->APB1ENR, RCC_APB1ENRREG_TIM7EN, ENABLE);
+	TIM7->PSC = 0;
+	TIM7->ARR = 96;
+	TIM7->DIER = (1 << TIM_DIERREG_UIE);
+	VECTOR_SetRaw(IRQ_NO_TIM7, TickEntry);
+	NVIC_SetPriority(IRQ_NO_TIM7, NVIC_PLAN_PREEMPT_DATA, 0);
+	IRQInterruptConfig(IRQ_NO_TIM7, ENABLE);
+
+	uint32_t lost = CountRace(RESET, 100000);
+	printf(" >> Plain increment: %lu lost of %lu ISR ticks\n", lost, IsrTicks);
+	lost = CountRace(SET, 100000);
+	printf(" >> ATOMIC_FetchAdd: %lu lost of %lu ISR ticks\n", lost, IsrTicks);
+
+	TIM7->DIER = 0;
+	TIM7->SR = 0;
+	PCLK_Control(&RCC->APB1ENR, RCC_APB1ENRREG_TIM7EN, DISABLE);
+
+	// 2. BASEPRI at the UI level: the critical level passes, the UI level waits
+	VECTOR_SetRaw(IRQ_NO_TIM7, RamEntry);
+	NVIC_ClearPending(IRQ_NO_TIM7);
+
+	uint8_t levels[] = { NVIC_PLAN_PREEMPT_CRITICAL, NVIC_PLAN_PREEMPT_DATA, NVIC_PLAN_PREEMPT_UI };
+	for (uint8_t i = 0; i < sizeof(levels); ++i)
+	{
+		NVIC_SetPriority(IRQ_NO_TIM7, levels[i], 0);
+		Entered = RESET;
+
+		uint32_t basepri = ATOMIC_MaskEnter(NVIC_PLAN_PREEMPT_UI);
+		NVIC_SetPending(IRQ_NO_TIM7);
+		__asm volatile ("DSB\n\tISB" ::: "memory");
+		uint8_t inside = Entered;
+		ATOMIC_MaskExit(basepri);
+
+		while (!Entered);
+		printf(" >> Preempt level %u inside UI section: %s\n", levels[i], inside ? "served" : "deferred");
+	}
+
+	IRQInterruptConfig(IRQ_NO_TIM7, DISABLE);
+	VECTOR_Unregister(IRQ_NO_TIM7);
+
+	printf(" >> Atomics and BASEPRI test is finished.\n");
+}
+
+/*!
+ * @fn			- IRQ_Test_Profiler
+ *
+ * @brief 		- Profiles the EXTI vectors and a registered handler, then dumps the statistics
+ *
+ * @param[in]	- cycle: number of triggers per IRQ
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Build with -DIRQ_PROFILE_ENABLE=1, the dump goes to the SWV console (ITM port 0)
+*/
+void IRQ_Test_Profiler (uint16_t cycle)
+{
+	printf(" >> IRQ profiler test.\n");
+
+#if IRQ_PROFILE_ENABLE
+	IRQPROF_Reset();
+	NVIC_ApplyPriorityPlan();
+
+	// 1. EXTI vectors through the link-time handlers: lines 0 and 13 (EXTI15_10)
+	EXTI_RegisterCallback(0, NopCallback, NULL);
+	EXTI_RegisterCallback(13, NopCallback, NULL);
+	for (uint16_t i = 0; i < cycle; ++i)
+	{
+		EXTI_SoftwareTrigger(EXTI_LINE_BIT(0));
+		EXTI_SoftwareTrigger(EXTI_LINE_BIT(13));
+	}
+	EXTI_UnregisterCallback(0);
+	EXTI_UnregisterCallback(13);
+
+	// 2. Registered handler through the vector dispatcher
+	NVIC_SetPriority(IRQ_NO_TIM7, NVIC_PLAN_PREEMPT_DATA, 0);
+	IRQInterruptConfig(IRQ_NO_TIM7, ENABLE);
+	VECTOR_Register(IRQ_NO_TIM7, ContextEntry, (void *)&Entered);
+	for (uint16_t i = 0; i < cycle; ++i)
+	{
+		Entered = RESET;
+		NVIC_SetPending(IRQ_NO_TIM7);
+		while (!Entered);
+	}
+	IRQInterruptConfig(IRQ_NO_TIM7, DISABLE);
+	VECTOR_Unregister(IRQ_NO_TIM7);
+
+	IRQPROF_Dump(IRQPROF_ITM_PORT);
+#else
+	printf(" >> Profiler is disabled, build with IRQ_PROFILE_ENABLE=1.\n");
+#endif
+
+	printf(" >> IRQ profiler test is finished.\n");
+}
+
+/*!
+ * @fn			- IRQ_Test_SleepWakeLatency
+ *
+ * @brief 		- Compares the wake-up latency of busy waiting, WFI, WFE and sleep-on-exit
+ *
+ * @param[in]	- cycle: number of wake-ups per mode, 1 ms apart
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- TIM6 runs from the APB1 timer clock without prescaler (16 MHz HSI: 1 tick = 1 cycle).
+ * 				  SysTick is suspended meanwhile, so only TIM6 wakes the core.
+*/
+void IRQ_Test_SleepWakeLatency (uint16_t cycle)
+{
+	printf(" >> Sleep wake-up latency test.\n");
+
+	if (!cycle)
+	{
+		return;
+	}
+
+	PCLK_Control(&RCC->APB1ENR, RCC_APB1ENRREG_TIM6EN, ENABLE);
+	TIM6->CR1 = 0;
+	TIM6->PSC = 0;
+	TIM6->ARR = (CLOCK_GetTimerClk1() / 1000) - 1;
+	TIM6->DIER = (1 << TIM_DIERREG_UIE);
+	NVIC_SetPriority(IRQ_NO_TIM6_DAC, NVIC_PLAN_PREEMPT_UI, 0);
+	IRQInterruptConfig(IRQ_NO_TIM6_DAC, ENABLE);
+
+	uint32_t start = DWT_CYCCNT();
+	uint32_t primask = ATOMIC_IrqDisable();
+	uint8_t tickSuspended = TIMEBASE_SuspendTick();
+	ATOMIC_IrqRestore(primask);
+
+	for (uint8_t mode = SLEEP_MODE_BUSY; mode <= SLEEP_MODE_ON_EXIT; ++mode)
+	{
+		MeasureWake(mode, cycle);
+	}
+
+	primask = ATOMIC_IrqDisable();
+	if (tickSuspended)
+	{
+		TIMEBASE_ResumeTick((DWT_CYCCNT() - start) / (TIMEBASE_GetClock() / 1000000));
+	}
+	ATOMIC_IrqRestore(primask);
+
+	IRQInterruptConfig(IRQ_NO_TIM6_DAC, DISABLE);
+	TIM6->DIER = 0;
+	PCLK_Control(&RCC->APB1ENR, RCC_APB1ENRREG_TIM6EN, DISABLE);
+
+	printf(" >> Sleep wake-up latency test is finished.\n");
+}
+
+/*!
+ * @fn			- TIM7_IRQHandler
+ *
+ * @brief 		- Link-time handler of the software interrupt
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+void TIM7_IRQHandler (void)
+{
+	EntryStamp = DWT_CYCCNT();
+	Entered = SET;
+}
+
+/*!
+ * @fn			- TIM6_DAC_IRQHandler
+ *
+ * @brief 		- Wake-up source of the sleep tests: samples the latency
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Releases the thread parked in sleep-on-exit after the last sample
+*/
+void TIM6_DAC_IRQHandler (void)
+{
+	uint32_t latency = TIM6->CNT;
+
+	TIM6->SR = ~(1 << TIM_SRREG_UIF);
+
+	if (WakeCount < WakeTarget)
+	{
+		WakeMin = (latency < WakeMin) ? latency : WakeMin;
+		WakeMax = (latency > WakeMax) ? latency : WakeMax;
+		WakeSum += latency;
+
+		if (++WakeCount == WakeTarget)
+		{
+			SLEEP_WakeMain();
+		}
+	}
+}
+
+/*** EOF ***/
@@ -9,23 +9,6 @@
 
 // === Protected Functions ===
 //
-/*!
- * @fn			- Delay
- *
- * @brief 		- Dummy delay as empty for loop (NOP)
- *
- * @param[in]	- duration: for loop limit
- * @param[out]	- none
- *
- * @return 		- none
- *
- * @note		- none
-*/
-static void Delay (uint32_t duration)
-{
-	for (uint32_t i = 0; i < duration; ++i);
-}
-
 /*!
  * @fn			- SPI1_PinInit
  *
@@ -128,7 +111,7 @@ static void SPI1_Init (uint8_t ssmControl)
 	SPIHandle.SpiConfig.busConfig  	= SPI_BUSCONFIG_FD;
 
 	SPIHandle.SpiConfig.deviceMode	= SPI_DEVMODE_MASTER;
-	SPIHandle.SpiConfig.sclkSpeed	= SPI_SPEED_DIV8;
+	SPIHandle.SpiConfig.sclkSpeed	= SPI_SpeedFor(SPI1, SPI_TEST_SCLK_MAX_HZ);
 	SPIHandle.SpiConfig.dff 		= SPI_DFFMODE_8BIT;
 	SPIHandle.SpiConfig.cpol 	  	= SPI_CPOLMODE_LOW;
 	SPIHandle.SpiConfig.cpha 	  	= SPI_CPHAMODE_LEAD;
@@ -209,6 +192,7 @@ void SPI_Test_SendData (uint16_t cycle)
 
 	// Initialize SPI
 	SPI1_Init(DISABLE);
+	printf(" $ SCLK: %lu Hz.\n", SPI_GetSclkHz(SPI1));
 
 	// Enable SPI1
 	SPI_PeripheralControl(SPI1, ENABLE);
@@ -218,7 +202,7 @@ void SPI_Test_SendData (uint16_t cycle)
 	while (cycle)
 	{
 		SPI_SendData(SPI1, (uint8_t *)buffer, strlen(buffer));
-		Delay(500000);
+		TIMEBASE_DelayMs(200);
 		printf(" $ Remaining cycle: %u.\n", cycle);
 		cycle--;
 	}
@@ -277,7 +261,7 @@ void SPI_Test_ReceiveData (uint16_t cycle)
 		SPI_ReceiveData(SPI2, &ack, 1);
 		printf(" $ %3u. CMD: %3u, ACK: %3u\n", i++, cmd++, ack);
 
-		Delay(500000);
+		TIMEBASE_DelayMs(200);
 	}
 
 	// Disable SPIs
@@ -289,6 +273,46 @@ void SPI_Test_ReceiveData (uint16_t cycle)
 
 static SPI_Handle_t Spi1HandleIT;
 static SPI_Handle_t Spi2HandleIT;
+static volatile uint16_t EventCount;
+static volatile int16_t EventContext;			// NVIC_GetActiveIRQ() seen by the last callback
+static volatile uint32_t EventStamp;			// DWT CYCCNT at the last callback
+
+typedef struct SpiSendLoop
+{
+	EVLOOP_Timer_t timer;
+	uint16_t remaining;
+	char buffer[16];
+} SpiSendLoop_t;
+
+/*!
+ * @fn			- SpiSendStep
+ *
+ * @brief 		- Event loop timer handler of the SPI send example
+ *
+ * @param[in]	- *p_Context: SpiSendLoop_t instance
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- A period with the previous transfer still running is skipped
+*/
+static void SpiSendStep (void *p_Context)
+{
+	SpiSendLoop_t *p_Loop = (SpiSendLoop_t *)p_Context;
+
+	if (SPI_ST_READY != SPI_SendDataIT(&Spi1HandleIT, (uint8_t *)p_Loop->buffer, strlen(p_Loop->buffer)))
+	{
+		return;
+	}
+
+	printf(" $ Remaining cycle: %u.\n", p_Loop->remaining);
+
+	if (!--p_Loop->remaining)
+	{
+		EVLOOP_TimerStop(&p_Loop->timer);
+		EVLOOP_Stop();
+	}
+}
 
 /*!
  * @fn			- SPI_Test_SendDataIT
@@ -320,8 +344,9 @@ void SPI_Test_SendDataIT (uint16_t cycle)
 	// Initialize SPI
 	SPI1_Init(DISABLE);
 
-	// IRQ Configuration
-	IRQPriorityConfig(IRQ_NO_SPI1, 42);
+	// IRQ Configuration: SPI data level of the priority plan, handle bound in the SRAM vector table
+	NVIC_ApplyPriorityPlan();
+	SPI_IRQBind(&Spi1HandleIT, ENABLE);
 	IRQInterruptConfig(IRQ_NO_SPI1, ENABLE);
 
 	// Enable SPI1 Periphery
@@ -332,7 +357,7 @@ void SPI_Test_SendDataIT (uint16_t cycle)
 	while (cycle)
 	{
 		SPI_SendDataIT(&Spi1HandleIT, (uint8_t *)buffer, strlen(buffer));
-		Delay(500000);
+		TIMEBASE_DelayMs(200);
 		printf(" $ Remaining cycle: %u.\n", cycle);
 		cycle--;
 	}
@@ -378,9 +403,10 @@ void SPI_Test_ReceiveDataIT (void)
 	SPI2_PinInit();					// Initialize GPIOB to SPI2 alternate function mode
 	SPI2_Init();
 
-	// IRQ Configuration
-	IRQPriorityConfig(IRQ_NO_SPI1, 42);
-	IRQPriorityConfig(IRQ_NO_SPI2, 43);
+	// IRQ Configuration: SPI data level of the priority plan, handles bound in the SRAM vector table
+	NVIC_ApplyPriorityPlan();
+	SPI_IRQBind(&Spi1HandleIT, ENABLE);
+	SPI_IRQBind(&Spi2HandleIT, ENABLE);
 	IRQInterruptConfig(IRQ_NO_SPI1, ENABLE);
 	IRQInterruptConfig(IRQ_NO_SPI2, ENABLE);
 
@@ -397,7 +423,7 @@ void SPI_Test_ReceiveDataIT (void)
 	{
 		SPI_SendDataIT(&Spi1HandleIT, p_buffer++, 1);
 		SPI_ReceiveDataIT(&Spi2HandleIT, (uint8_t *)(&receive), 1);
-		Delay(500000);
+		TIMEBASE_DelayMs(200);
 		printf("%c\n", receive);
 	}
 
@@ -409,37 +435,155 @@ void SPI_Test_ReceiveDataIT (void)
 }
 
 /*!
- * @fn			- SPI1_IRQHandler
+ * @fn			- SPI_Test_DeferredEvents
  *
- * @brief 		- ISR Handler for GPIO user button input (PC13)
+ * @brief 		- Runs the SPI1 Tx complete callback in ISR context and deferred to PendSV
  *
- * @param[in]	- none
+ * @param[in]	- cycle: number of transfers per mode
  * @param[out]	- none
  *
  * @return 		- none
  *
- * @note		- none
+ * @note		- Same pinout as SPI_Test_SendDataIT. The callback burns ~2000 cycles of application work:
+ * 				  in ISR context this adds to every SPI1 IRQ, deferred it only delays thread mode.
+ * 				  With IRQ_PROFILE_ENABLE the SPI1 handler duration is printed as well.
 */
-void SPI1_IRQHandler (void)
+void SPI_Test_DeferredEvents (uint16_t cycle)
 {
-	SPI_IRQHandling(&Spi1HandleIT);				// Calling IRQ Handler for SPI1
+	printf(" $ Executing SPI Deferred Event Test...\n");
+
+	DWT_CYCCNT_EN();
+	DEFER_Init(DEFER_MODE_PENDSV);
+
+	Spi1HandleIT.p_SPIx = SPI1;
+	SPI1_PinInit();
+	SPI1_Init(DISABLE);
+
+	NVIC_ApplyPriorityPlan();
+	SPI_IRQBind(&Spi1HandleIT, ENABLE);
+	IRQInterruptConfig(IRQ_NO_SPI1, ENABLE);
+	SPI_PeripheralControl(Spi1HandleIT.p_SPIx, ENABLE);
+
+	uint8_t fastMasks[] = { SPI_EVENT_MASK(SPI_EVENT_TX_CMPLT), 0 };
+	char buffer[] = "HELLO FROM SPI1";
+
+	for (uint8_t mode = 0; mode < sizeof(fastMasks); ++mode)
+	{
+		Spi1HandleIT.fastEvents = fastMasks[mode];
+		EventCount = 0;
+#if IRQ_PROFILE_ENABLE
+		IRQPROF_Reset();
+#endif
+
+		uint32_t latency = 0;
+		for (uint16_t i = 0; i < cycle; ++i)
+		{
+			// The ISR context callback runs before TxState reads READY: stamp before the submission
+			uint16_t count = EventCount;
+			while (SPI_ST_READY != Spi1HandleIT.TxState);
+			uint32_t start = DWT_CYCCNT();
+			while (SPI_ST_READY != SPI_SendDataIT(&Spi1HandleIT, (uint8_t *)buffer, strlen(buffer)));
+			while (count == EventCount);
+			latency += EventStamp - start;
+		}
+
+		printf(" $ %s: callback context %d, submit-to-callback %lu cycles avg\n",
+			   fastMasks[mode] ? "ISR context" : "Deferred   ", EventContext, cycle ? (latency / cycle) : 0);
+#if IRQ_PROFILE_ENABLE
+		const IRQPROF_Record_t *p_Record = IRQPROF_Get(IRQ_NO_SPI1);
+		if (p_Record)
+		{
+			printf(" $ SPI1 ISR duration: min %lu, max %lu cycles\n", p_Record->duration.min, p_Record->duration.max);
+		}
+#endif
+	}
+
+	printf(" $ Deferred queue high water %u, dropped %lu\n", DEFER_GetHighWater(), DEFER_GetDropped());
+
+	SPI_PeripheralControl(Spi1HandleIT.p_SPIx, DISABLE);
+	IRQInterruptConfig(IRQ_NO_SPI1, DISABLE);
+	SPI_IRQBind(&Spi1HandleIT, DISABLE);
+
+	printf(" $ ... Finished SPI Deferred Event Test.\n");
 }
 
 /*!
- * @fn			- SPI2_IRQHandler
+ * @fn			- SPI_Test_SendDataEvLoop
  *
- * @brief 		- ISR Handler for GPIO user button input (PC13)
+ * @brief 		- SPI_Test_SendData ported to the event loop
  *
- * @param[in]	- none
+ * @param[in]	- cycle: Repetition value
  * @param[out]	- none
  *
  * @return 		- none
  *
- * @note		- none
+ * @note		- Same pinout as SPI_Test_SendData. A 100 ms loop timer starts the interrupt driven
+ * 				  transfers, the Tx complete events run in the loop through the deferred-work queue,
+ * 				  and the core sleeps in between. The CPU load is printed at the end.
+*/
+void SPI_Test_SendDataEvLoop (uint16_t cycle)
+{
+	printf(" $ Executing SPI Event Loop Sending Test...\n");
+
+	static SpiSendLoop_t Loop = { .buffer = "HELLO FROM SPI1" };
+
+	if (!cycle)
+	{
+		return;
+	}
+
+	Spi1HandleIT.p_SPIx = SPI1;
+	SPI1_PinInit();
+	SPI1_Init(DISABLE);
+
+	NVIC_ApplyPriorityPlan();
+	SPI_IRQBind(&Spi1HandleIT, ENABLE);
+	IRQInterruptConfig(IRQ_NO_SPI1, ENABLE);
+	SPI_PeripheralControl(Spi1HandleIT.p_SPIx, ENABLE);
+
+	EventCount = 0;
+	Spi1HandleIT.fastEvents = 0;
+	Loop.remaining = cycle;
+
+	EVLOOP_Init();
+	EVLOOP_TimerInit(&Loop.timer, SpiSendStep, &Loop);
+	EVLOOP_TimerStart(&Loop.timer, 0, EVLOOP_MS(100));
+	EVLOOP_Run();
+
+	uint16_t load = EVLOOP_GetLoad();
+
+	// Let the last transfer finish, its event is drained by EVLOOP_DeInit
+	while (SPI_ST_READY != Spi1HandleIT.TxState);
+	EVLOOP_DeInit();
+
+	SPI_PeripheralControl(Spi1HandleIT.p_SPIx, DISABLE);
+	IRQInterruptConfig(IRQ_NO_SPI1, DISABLE);
+	SPI_IRQBind(&Spi1HandleIT, DISABLE);
+
+	printf(" $ Tx complete events: %u, CPU load %u.%u %%.\n", EventCount, load / 10, load % 10);
+	printf(" $ ... Finished SPI Event Loop Sending Test.\n");
+}
+
+/*!
+ * @fn			- SPI_API_EventCallback
+ *
+ * @brief 		- Application callback of the SPI test flows
+ *
+ * @param[in]	- *p_SpiHandle: pointer to the SPI Handler
+ * @param[in]	- appEvent: @SPI_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- Records the execution context, then simulates application work
 */
-void SPI2_IRQHandler (void)
+void SPI_API_EventCallback (SPI_Handle_t *p_SpiHandle, uint8_t appEvent)
 {
-	SPI_IRQHandling(&Spi2HandleIT);				// Calling IRQ Handler for SPI2
+	EventStamp = DWT_CYCCNT();
+	EventContext = NVIC_GetActiveIRQ();
+
+	for (volatile uint16_t i = 0; i < 500; ++i);
+
+	EventCount++;
 }
 
 /*** EOF ***/
@@ -0,0 +1,431 @@
+/** @file usart_test.c
+*
+* @brief USART DMA reception / transmission test flows.
+*
+*/
+
+#include "usart_test.h"
+
+
+// === Private Variables ===
+//
+static USART_Handle_t UsartHandle;						// Bound to the vector table: static
+static USART_Handle_t ConsoleHandle;
+static uint8_t RxRing[USART_TEST_RING_SIZE];
+static uint8_t TxBlock[USART_TEST_BLOCK_SIZE];
+static uint8_t RxChunk[64];
+static volatile uint16_t TxEvents, RxEvents, OverrunEvents, ErrorEvents;
+
+
+// === Protected Functions ===
+//
+/*!
+ * @fn			- USART1_PinInit
+ *
+ * @brief 		- Configures the pinouts of USART1 interface
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void USART1_PinInit (void)
+{
+	GPIO_Handle_t USARTpin;
+
+	USARTpin.p_GPIOx 					= GPIOA;
+	USARTpin.pinConfig.pinMode 			= GPIO_MODE_ALTFN;
+	USARTpin.pinConfig.pinAltFunMode 	= GPIO_AF7;
+	USARTpin.pinConfig.pinOPType 		= GPIO_OP_TYPE_PP;
+	USARTpin.pinConfig.pinPuPdControl 	= GPIO_PIN_PU;
+	USARTpin.pinConfig.pinSpeed			= GPIO_OP_SPEED_HIGH;
+
+	// TX
+	USARTpin.pinConfig.pinNumber = GPIO_PIN_NO_9;
+	GPIO_Init(&USARTpin);
+
+	// RX
+	USARTpin.pinConfig.pinNumber = GPIO_PIN_NO_10;
+	GPIO_Init(&USARTpin);
+}
+
+/*!
+ * @fn			- USART1_Init
+ *
+ * @brief 		- Configures USART1 8N1 with its DMA streams and interrupts
+ *
+ * @param[in]	- baudRate: bits per second
+ * @param[out]	- none
+ *
+ * @return 		- @USART_STATUS
+ *
+ * @note		- Every event runs in the ISR: the flows poll their counters
+*/
+static uint8_t USART1_Init (uint32_t baudRate)
+{
+	uint8_t status;
+
+	UsartHandle.p_USARTx 				= USART1;
+	UsartHandle.UsartConfig.baudRate	= baudRate;
+	UsartHandle.UsartConfig.mode		= USART_MODE_TXRX;
+	UsartHandle.UsartConfig.wordLength	= USART_WORDLEN_8BITS;
+	UsartHandle.UsartConfig.stopBits	= USART_STOPBITS_1;
+	UsartHandle.UsartConfig.parity		= USART_PARITY_NONE;
+	UsartHandle.fastEvents 				= 0xFF;
+
+	status = USART_Init(&UsartHandle);
+	if (USART_OK != status)
+	{
+		return status;
+	}
+
+	USART_IRQBind(&UsartHandle, ENABLE);
+	NVIC_SetPriority(USART_IRQNumber(USART1), NVIC_PLAN_PREEMPT_DATA, 0);
+	NVIC_SetPriority(USART_RxDmaIRQNumber(&UsartHandle), NVIC_PLAN_PREEMPT_DATA, 0);
+	IRQInterruptConfig(USART_IRQNumber(USART1), ENABLE);
+	IRQInterruptConfig(USART_RxDmaIRQNumber(&UsartHandle), ENABLE);
+
+	return USART_RxStart(&UsartHandle, RxRing, sizeof(RxRing));
+}
+
+/*!
+ * @fn			- USART2_ConsoleInit
+ *
+ * @brief 		- Configures the USART2 transmitter on the ST-LINK virtual COM port
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- @USART_STATUS
+ *
+ * @note		- PIN Alternate Function Mode: AF7, PA2: USART2_TX
+*/
+static uint8_t USART2_ConsoleInit (void)
+{
+	GPIO_Handle_t USARTpin;
+	uint8_t status;
+
+	USARTpin.p_GPIOx 					= GPIOA;
+	USARTpin.pinConfig.pinNumber 		= GPIO_PIN_NO_2;
+	USARTpin.pinConfig.pinMode 			= GPIO_MODE_ALTFN;
+	USARTpin.pinConfig.pinAltFunMode 	= GPIO_AF7;
+	USARTpin.pinConfig.pinOPType 		= GPIO_OP_TYPE_PP;
+	USARTpin.pinConfig.pinPuPdControl 	= GPIO_PIN_PU;
+	USARTpin.pinConfig.pinSpeed			= GPIO_OP_SPEED_MEDIUM;
+	GPIO_Init(&USARTpin);
+
+	ConsoleHandle.p_USARTx 				= USART2;
+	ConsoleHandle.UsartConfig.baudRate	= USART_TEST_CONSOLE_BAUD;
+	ConsoleHandle.UsartConfig.mode		= USART_MODE_TX;
+	ConsoleHandle.UsartConfig.wordLength	= USART_WORDLEN_8BITS;
+	ConsoleHandle.UsartConfig.stopBits	= USART_STOPBITS_1;
+	ConsoleHandle.UsartConfig.parity	= USART_PARITY_NONE;
+
+	status = USART_Init(&ConsoleHandle);
+	if (USART_OK != status)
+	{
+		return status;
+	}
+
+	USART_IRQBind(&ConsoleHandle, ENABLE);
+	NVIC_SetPriority(USART_IRQNumber(USART2), NVIC_PLAN_PREEMPT_DATA, 1);
+	IRQInterruptConfig(USART_IRQNumber(USART2), ENABLE);
+	USART_ClockTrack(&ConsoleHandle, ENABLE);
+
+	return USART_OK;
+}
+
+/*!
+ * @fn			- TimePrintf
+ *
+ * @brief 		- Core cycles spent in one printf of a line
+ *
+ * @param[in]	- *p_Line: text, ends with a new line so stdout hands it to _write at once
+ * @param[out]	- none
+ *
+ * @return 		- Cycles
+ *
+ * @note		- none
+*/
+static uint32_t TimePrintf (const char *p_Line)
+{
+	uint32_t start = DWT_CYCCNT();
+
+	printf("%s", p_Line);
+
+	return DWT_CYCCNT() - start;
+}
+
+/*!
+ * @fn			- USART1_Close
+ *
+ * @brief 		- Releases USART1, its streams and its interrupts
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- none
+*/
+static void USART1_Close (void)
+{
+	IRQInterruptConfig(USART_IRQNumber(USART1), DISABLE);
+	IRQInterruptConfig(USART_RxDmaIRQNumber(&UsartHandle), DISABLE);
+	USART_IRQBind(&UsartHandle, DISABLE);
+	USART_DeInit(&UsartHandle);
+}
+
+/*!
+ * @fn			- Loopback
+ *
+ * @brief 		- Sends a buffer by DMA and checks every byte coming back through the ring
+ *
+ * @param[in]	- *p_TxBuffer: data to send
+ * @param[in]	- len: bytes
+ * @param[out]	- *p_Mismatch: bytes received with a wrong value, accumulated
+ *
+ * @return 		- Bytes received, less than len on timeout
+ *
+ * @note		- The ring is drained while the block is still on the line: with 1 KB of ring the
+ * 				  block of 4 KB only passes if the thread keeps up
+*/
+static uint32_t Loopback (const uint8_t *p_TxBuffer, uint16_t len, uint32_t *p_Mismatch)
+{
+	TIMEBASE_Timeout_t timeout;
+	uint32_t received = 0;
+
+	if (USART_ST_READY != USART_SendDataDMA(&UsartHandle, p_TxBuffer, len))
+	{
+		return 0;
+	}
+
+	TIMEBASE_TimeoutStart(&timeout, USART_TEST_TIMEOUT_US);
+	while ((received < len) && !TIMEBASE_TimeoutExpired(&timeout))
+	{
+		uint32_t count = USART_Read(&UsartHandle, RxChunk, sizeof(RxChunk));
+
+		for (uint32_t i = 0; (i < count) && (received < len); ++i, ++received)
+		{
+			if (RxChunk[i] != p_TxBuffer[received])
+			{
+				(*p_Mismatch)++;
+			}
+		}
+	}
+
+	while (USART_ST_READY != UsartHandle.TxState);
+
+	return received;
+}
+
+
+// === Public API Functions ===
+//
+/*!
+ * @fn			- USART_Test_LoopbackBenchmark
+ *
+ * @brief 		- Sustained DMA throughput and interrupt load of USART1 at 2 Mbaud and above
+ *
+ * @param[in]	- cycle: blocks of USART_TEST_BLOCK_SIZE per baud rate
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- PIN Alternate Function Mode: AF7
+ * 				  Nucleo F446RE Board, jumper between
+ * 				  	 PA9:  USART1_TX (CN10 21)
+ * 				  	 PA10: USART1_RX (CN10 33)
+ * 				  Runs on the performance profile (PCLK2 90 MHz) and returns on the low power profile.
+ * 				  A block of 4 KB costs about 8 half/full ring interrupts, 1 IDLE and 1 TC interrupt,
+ * 				  against 4096 RXNE and 4096 TXE interrupts of a byte-wise driver.
+*/
+void USART_Test_LoopbackBenchmark (uint16_t cycle)
+{
+	const uint32_t bauds[] = { 2000000U, 3000000U, 4500000U, 6000000U };
+	const uint16_t packets[] = { 1, 7, 64, 300 };
+
+	printf(" $ Executing USART Loopback Benchmark...\n");
+
+	CLOCK_Switch(CLOCK_PROFILE_PERFORMANCE);
+	USART1_PinInit();
+
+	for (uint16_t i = 0; i < NUM_OF(TxBlock); ++i)
+	{
+		TxBlock[i] = (uint8_t)((i * 7) ^ (i >> 8));
+	}
+
+	// 1. Sustained throughput: back to back blocks
+	for (uint8_t b = 0; b < NUM_OF(bauds); ++b)
+	{
+		uint32_t bytes = 0, mismatch = 0, cycles = 0;
+
+		if (USART_OK != USART1_Init(bauds[b]))
+		{
+			printf(" $ %lu baud out of reach of PCLK2 %lu Hz.\n", bauds[b], CLOCK_GetPclk2());
+			continue;
+		}
+
+		TxEvents = 0;
+		RxEvents = 0;
+		OverrunEvents = 0;
+		ErrorEvents = 0;
+		UsartHandle.IrqCount = 0;
+
+		for (uint16_t round = 0; round < cycle; ++round)
+		{
+			uint32_t start = DWT_CYCCNT();
+			bytes += Loopback(TxBlock, sizeof(TxBlock), &mismatch);
+			cycles += DWT_CYCCNT() - start;
+		}
+
+		// 10 bits per byte on the line: the efficiency is the payload rate against baud / 10
+		uint32_t us = cycles / (CLOCK_GetHclk() / 1000000U);
+		uint32_t rate = us ? (uint32_t)(((uint64_t)bytes * 1000000U) / us) : 0;
+		uint32_t efficiency = (uint32_t)(((uint64_t)rate * 1000U) / (USART_GetBaudRate(USART1) / 10));
+
+		printf(" $ %lu baud (BRR %lu baud, OVER8 %lu): %lu B in %lu us, %lu B/s, %lu.%lu %% of the line\n",
+			   bauds[b], USART_GetBaudRate(USART1), (USART1->CR1 >> USART_CR1REG_OVER8) & 1,
+			   bytes, us, rate, efficiency / 10, efficiency % 10);
+		printf("   IRQs %lu (%lu per KB), TX %u, RX %u, overrun %u (dropped %lu), errors %u (0x%02x), mismatch %lu\n",
+			   UsartHandle.IrqCount, bytes ? (UsartHandle.IrqCount * 1024U) / bytes : 0, TxEvents, RxEvents,
+			   OverrunEvents, UsartHandle.RxDropped, ErrorEvents, UsartHandle.ErrorFlags, mismatch);
+
+		USART1_Close();
+	}
+
+	// 2. Variable length packets at 2 Mbaud: one IDLE event per packet, no per byte interrupt
+	if (USART_OK == USART1_Init(bauds[0]))
+	{
+		for (uint8_t p = 0; p < NUM_OF(packets); ++p)
+		{
+			uint32_t mismatch = 0;
+
+			RxEvents = 0;
+			UsartHandle.IrqCount = 0;
+
+			uint32_t received = Loopback(TxBlock, packets[p], &mismatch);		// The tail only shows up with IDLE
+
+			printf(" $ Packet of %u B: received %lu, mismatch %lu, RX events %u, IRQs %lu\n",
+				   packets[p], received, mismatch, RxEvents, UsartHandle.IrqCount);
+		}
+
+		USART1_Close();
+	}
+
+	CLOCK_Switch(CLOCK_PROFILE_LOW_POWER);
+
+	printf(" $ ... Finished USART Loopback Benchmark.\n");
+}
+
+/*!
+ * @fn			- USART_Test_ConsoleLatency
+ *
+ * @brief 		- printf latency over ITM and over the buffered USART2 console, then both overflow policies
+ *
+ * @param[in]	- none
+ * @param[out]	- none
+ *
+ * @return 		- none
+ *
+ * @note		- Nucleo F446RE Board: USART2 TX is wired to the ST-LINK virtual COM port (115200 8N1).
+ * 				  The figures are collected first and printed over ITM at the end.
+*/
+void USART_Test_ConsoleLatency (void)
+{
+	static char line[CONSOLE_BUFFER_SIZE / 4];
+	const uint16_t lengths[] = { 8, 32, 128, sizeof(line) - 1 };
+	uint32_t itmCycles[NUM_OF(lengths)], consoleCycles[NUM_OF(lengths)];
+	CONSOLE_Stat_t dropStat, blockStat;
+
+	printf(" $ Executing USART Console Latency Test...\n");
+
+	if (USART_OK != USART2_ConsoleInit())
+	{
+		printf(" $ USART2 can not run %lu baud.\n", USART_TEST_CONSOLE_BAUD);
+		return;
+	}
+
+	// 1. Same lines over ITM, then through the console with an empty buffer
+	for (uint8_t i = 0; i < NUM_OF(lengths); ++i)
+	{
+		for (uint16_t c = 0; c < lengths[i]; ++c)
+		{
+			line[c] = 'a' + (c % 26);
+		}
+		line[lengths[i] - 1] = '\n';
+		line[lengths[i]] = '\0';
+
+		itmCycles[i] = TimePrintf(line);
+
+		CONSOLE_Init(&ConsoleHandle, CONSOLE_POLICY_DROP);
+		consoleCycles[i] = TimePrintf(line);
+		CONSOLE_DeInit();
+	}
+
+	// 2. Sixteen long lines at once: four times the buffer
+	CONSOLE_Init(&ConsoleHandle, CONSOLE_POLICY_DROP);
+	for (uint8_t n = 0; n < 16; ++n)
+	{
+		printf("%s", line);
+	}
+	CONSOLE_GetStat(&dropStat);
+	CONSOLE_DeInit();
+
+	CONSOLE_Init(&ConsoleHandle, CONSOLE_POLICY_BLOCK);
+	for (uint8_t n = 0; n < 16; ++n)
+	{
+		printf("%s", line);
+	}
+	CONSOLE_GetStat(&blockStat);
+	CONSOLE_DeInit();
+
+	IRQInterruptConfig(USART_IRQNumber(USART2), DISABLE);
+	USART_IRQBind(&ConsoleHandle, DISABLE);
+	USART_DeInit(&ConsoleHandle);
+
+	for (uint8_t i = 0; i < NUM_OF(lengths); ++i)
+	{
+		printf(" $ printf of %u B: ITM %lu cycles, console %lu cycles\n", lengths[i], itmCycles[i], consoleCycles[i]);
+	}
+	printf(" $ Drop policy:  written %lu B, dropped %lu B, high water %u B, longest write %lu cycles\n",
+		   dropStat.written, dropStat.dropped, dropStat.highWater, dropStat.maxWriteCycles);
+	printf(" $ Block policy: written %lu B, dropped %lu B, high water %u B, longest write %lu cycles\n",
+		   blockStat.written, blockStat.dropped, blockStat.highWater, blockStat.maxWriteCycles);
+	printf(" $ ... Finished USART Console Latency Test.\n");
+}
+
+/*!
+ * @fn			- USART_API_EventCallback
+ *
+ * @brief 		- Application callback of the USART test flows
+ *
+ * @param[in]	- *p_UsartHandle: pointer to the USART Handler
+ * @param[in]	- appEvent: @USART_API_EVENTS
+ *
+ * @return 		- none
+ *
+ * @note		- Counts only: the flows read the ring themselves
+*/
+void USART_API_EventCallback (USART_Handle_t *p_UsartHandle, uint8_t appEvent)
+{
+	switch (appEvent)
+	{
+		case USART_EVENT_TX_CMPLT:
+			TxEvents++;
+			break;
+		case USART_EVENT_RX_DATA:
+			RxEvents++;
+			break;
+		case USART_EVENT_RX_OVERRUN:
+			OverrunEvents++;
+			break;
+		default:
+			ErrorEvents++;
+			break;
+	}
+}
+
+/*** EOF ***/